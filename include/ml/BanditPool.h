@@ -17,7 +17,15 @@
 namespace lbcpp
 {
 
-class BanditPool : public Object, public ExecutionContextCallback
+/*
+** Pool of arms played with an UCB-like index policy.
+**
+** In multi-threaded mode, up to maxInFlightArms arms are evaluated concurrently
+** (by default, twice the number of threads of the context). Finished evaluations are
+** queued by the worker threads and observed in batches by the thread calling play(),
+** which blocks on an event while the window is full instead of polling.
+*/
+class BanditPool : public Object
 {
 public:
   BanditPool(const StochasticObjectivePtr& objective, double explorationCoefficient, bool optimizeMax = false, bool useMultiThreading = false);
@@ -37,6 +45,11 @@ public:
 
   void setArmObject(size_t index, const ObjectPtr& object);
 
+  void setMaxInFlightArms(size_t maxInFlightArms)
+    {this->maxInFlightArms = maxInFlightArms;}
+
+  size_t getMaxInFlightArms(ExecutionContext& context) const;
+
   size_t selectAndPlayArm(ExecutionContext& context);
   size_t sampleArmWithHighestReward(ExecutionContext& context) const;
   void observeObjective(size_t index, double objective);
@@ -57,6 +70,7 @@ protected:
   double explorationCoefficient;
   bool optimizeMax;
   bool useMultiThreading;
+  size_t maxInFlightArms;
 
   struct Arm
   {
@@ -92,7 +106,6 @@ protected:
 
   std::vector<Arm> arms;
 
-  virtual void workUnitFinished(const WorkUnitPtr& workUnit, const ObjectPtr& result, const ExecutionTracePtr& trace);
   double getIndexScore(Arm& arm) const;
 
   struct ArmScoreComparator
@@ -112,8 +125,19 @@ protected:
   void pushArmIntoQueue(size_t index, double score);
   int popArmFromQueue();
 
+  struct PlayArmWorkUnit;
+
+  CriticalSection finishedArmsLock;
+  std::vector< std::pair<size_t, double> > finishedArms; // (arm index, objective value)
+  juce::WaitableEvent finishedArmsEvent;
+  size_t numCurrentlyPlayedArms;
+
+  void armFinished(size_t index, double objectiveValue);
+  void observeFinishedArms();
+  void waitForFinishedArms();
+
   size_t getNumCurrentlyPlayedArms() const
-    {return arms.size() - queue.size();}
+    {return numCurrentlyPlayedArms;}
 };
 
 typedef ReferenceCountedObjectPtr<BanditPool> BanditPoolPtr;
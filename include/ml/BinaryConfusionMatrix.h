@@ -66,6 +66,8 @@ public:
   /* Object */
   virtual void saveToXml(XmlExporter& exporter) const;
   virtual bool loadFromXml(XmlImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
 
   bool operator ==(const BinaryConfusionMatrix& other) const;
   bool operator !=(const BinaryConfusionMatrix& other) const
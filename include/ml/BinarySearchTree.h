@@ -23,24 +23,24 @@ class BinarySearchTree : public Object
 public:
   BinarySearchTree(double value = DVector::missingValue) : value(value), left(BinarySearchTreePtr()), right(BinarySearchTreePtr()) {}
   
-  BinarySearchTreePtr getLeft() const
+  virtual BinarySearchTreePtr getLeft() const
     {return left;}
 
-  BinarySearchTreePtr getRight() const
+  virtual BinarySearchTreePtr getRight() const
     {return right;}
 
-  bool isLeaf() const
+  virtual bool isLeaf() const
     {return !left.exists() && !right.exists();}
 
   double getValue() const
     {return value;}
 
   /** Prune the left subtree from this node **/
-  void pruneLeft()
+  virtual void pruneLeft()
     {left = BinarySearchTreePtr();}
 
   /** Prune the right subtree from this node **/
-  void pruneRight()
+  virtual void pruneRight()
     {right = BinarySearchTreePtr();}
 
   virtual void insertValue(double attribute, const DenseDoubleVectorPtr& data, double y) = 0;
@@ -60,7 +60,7 @@ public:
   }
 
   /** Calculate the number of nodes in the tree **/
-  size_t getSize() const
+  virtual size_t getSize() const
   {
     size_t count = 1;
     if (left.exists())
@@ -120,19 +120,19 @@ public:
     }
   }
 
-  size_t getExamplesSeen() const
+  virtual size_t getExamplesSeen() const
     {return leftCorrelation->getExamplesSeen() + rightCorrelation->getExamplesSeen();}
 
-  ScalarVariableMeanAndVariancePtr getLeftStats()
+  virtual ScalarVariableMeanAndVariancePtr getLeftStats()
     {return leftStats;}
 
-  ScalarVariableMeanAndVariancePtr getRightStats()
+  virtual ScalarVariableMeanAndVariancePtr getRightStats()
     {return rightStats;}
 
-  MultiVariateRegressionStatisticsPtr getLeftCorrelation()
+  virtual MultiVariateRegressionStatisticsPtr getLeftCorrelation()
     {return leftCorrelation;}
 
-  MultiVariateRegressionStatisticsPtr getRightCorrelation()
+  virtual MultiVariateRegressionStatisticsPtr getRightCorrelation()
     {return rightCorrelation;}
 
   /* Calculate total regression statistics for a split
@@ -140,7 +140,7 @@ public:
    * \return a pair of PearsonCorrelationCoefficientPtrs where the first and second values represent statistics
    *         for left and right of the split respectively
    */
-  std::pair<MultiVariateRegressionStatisticsPtr, MultiVariateRegressionStatisticsPtr> getStatsForSplit(double splitValue)
+  virtual std::pair<MultiVariateRegressionStatisticsPtr, MultiVariateRegressionStatisticsPtr> getStatsForSplit(double splitValue)
   {
     MultiVariateRegressionStatisticsPtr leftMVRS, rightMVRS;
     leftMVRS = new MultiVariateRegressionStatistics();
@@ -186,6 +186,19 @@ public:
 
 protected:
   friend class ExtendedBinarySearchTreeClass;
+  friend class CompactExtendedBinarySearchTree;
+
+  // subclasses that fill the statistics themselves do not create them
+  ExtendedBinarySearchTree(double value, bool createStatistics) : BinarySearchTree(value)
+  {
+    if (createStatistics)
+    {
+      leftStats = new ScalarVariableMeanAndVariance();
+      rightStats = new ScalarVariableMeanAndVariance();
+      leftCorrelation = new MultiVariateRegressionStatistics();
+      rightCorrelation = new MultiVariateRegressionStatistics();
+    }
+  }
 
   ScalarVariableMeanAndVariancePtr leftStats;
   ScalarVariableMeanAndVariancePtr rightStats;
@@ -194,6 +207,393 @@ protected:
 
 };
 
+/**
+ * Extended binary search tree stored in contiguous arrays
+ *
+ * Nodes are kept in vectors and refer to their children by index. For each node, the
+ * statistics of the samples that went to its left (<=) and right (>) side are stored in one
+ * flat block of doubles: the upper triangle of X'X for the extended input (1, x_1, ..., x_d),
+ * X'y and sum(y^2). All the statistics of ExtendedBinarySearchTree can be derived from them,
+ * so the insertion is a single walk down the tree without any allocation.
+ *
+ * The splitting criteria walk the tree through getRoot(), which returns ExtendedBinarySearchTree
+ * views of the nodes. A view is created the first time its node is reached and is cached until
+ * the next insertion, so that the accessors of a view return its statistics by reference.
+ * Pruning a view frees the corresponding subtree of this tree.
+ *
+ * With maxNumNodes > 0, no node is created anymore once the tree is full: the samples are
+ * accumulated in the deepest existing node of their path, so that only existing node values
+ * remain split candidates. With quantisationStep > 0, attribute values are rounded to the
+ * nearest multiple of quantisationStep, which bounds the number of distinct values.
+ */
+class CompactExtendedBinarySearchTree : public Object
+{
+public:
+  CompactExtendedBinarySearchTree(size_t maxNumNodes = 0, double quantisationStep = 0.0)
+    : maxNumNodes(maxNumNodes), quantisationStep(quantisationStep), numAttributes(0), blockSize(0), root(-1), numNodes(0) {}
+
+  void insertValue(double attribute, const DenseDoubleVectorPtr& data, double y)
+  {
+    if (nodeViews.size())
+      nodeViews.clear(); // the statistics of the views become out of date
+    if (quantisationStep > 0.0)
+      attribute = quantisationStep * floor(attribute / quantisationStep + 0.5);
+    if (root < 0)
+    {
+      numAttributes = data->getNumValues();
+      size_t d = numAttributes + 1;
+      blockSize = d * (d + 1) / 2 + d + 1;
+      root = createNode(attribute);
+    }
+    jassert(data->getNumValues() == numAttributes);
+    const double* x = data->getValuePointer(0);
+
+    int index = root;
+    while (true)
+    {
+      double value = values[index];
+      bool isLeft = (attribute <= value);
+      pushSample(getStatistics(index, isLeft), x, y);
+      if (attribute == value)
+        break;
+      int& child = children[2 * index + (isLeft ? 0 : 1)];
+      if (child < 0)
+      {
+        if (maxNumNodes && numNodes >= maxNumNodes)
+          break;
+        int newNode = createNode(attribute); // may reallocate children
+        children[2 * index + (isLeft ? 0 : 1)] = newNode;
+        index = newNode;
+      }
+      else
+        index = child;
+    }
+  }
+
+  /** Calculate the number of nodes in the tree **/
+  size_t getSize() const
+    {return numNodes;}
+
+  size_t getNumAttributes() const
+    {return numAttributes;}
+
+  /** View of the root node, valid until the next insertion **/
+  ExtendedBinarySearchTreePtr getRoot() const
+    {return root < 0 ? ExtendedBinarySearchTreePtr(new ExtendedBinarySearchTree()) : getNodeView(root);}
+
+  /** Independent copy of this tree, made of ExtendedBinarySearchTree nodes **/
+  ExtendedBinarySearchTreePtr toExtendedBinarySearchTree() const
+    {return root < 0 ? new ExtendedBinarySearchTree() : makeExtendedBinarySearchTree(root);}
+
+  virtual ObjectPtr clone(ExecutionContext& context) const
+  {
+    ReferenceCountedObjectPtr<CompactExtendedBinarySearchTree> result = new CompactExtendedBinarySearchTree(maxNumNodes, quantisationStep);
+    result->numAttributes = numAttributes;
+    result->blockSize = blockSize;
+    result->values = values;
+    result->children = children;
+    result->statistics = statistics;
+    result->freeNodes = freeNodes;
+    result->root = root;
+    result->numNodes = numNodes;
+    return result;
+  }
+
+  lbcpp_UseDebuggingNewOperator
+
+protected:
+  friend class CompactExtendedBinarySearchTreeClass;
+  friend class CompactExtendedBinarySearchTreeNode;
+
+  size_t maxNumNodes;
+  double quantisationStep;
+
+  size_t numAttributes;
+  size_t blockSize;               // number of doubles of the statistics of one side of a node
+  std::vector<double> values;     // one value per node
+  std::vector<int> children;      // 2 per node: left and right child, -1 if none
+  std::vector<double> statistics; // 2 * blockSize doubles per node: left side, then right side
+  std::vector<int> freeNodes;
+  int root;
+  size_t numNodes;
+
+  // the views hold a plain pointer to this tree, which owns them
+  mutable std::vector<ExtendedBinarySearchTreePtr> nodeViews;
+
+  ExtendedBinarySearchTreePtr getNodeView(int index) const;
+
+  double* getStatistics(int index, bool isLeft)
+    {return &statistics[(2 * index + (isLeft ? 0 : 1)) * blockSize];}
+
+  const double* getStatistics(int index, bool isLeft) const
+    {return &statistics[(2 * index + (isLeft ? 0 : 1)) * blockSize];}
+
+  int getChild(int index, bool isLeft) const
+    {return children[2 * index + (isLeft ? 0 : 1)];}
+
+  int createNode(double value)
+  {
+    int index;
+    if (freeNodes.size())
+    {
+      index = freeNodes.back();
+      freeNodes.pop_back();
+      std::fill(statistics.begin() + 2 * index * blockSize, statistics.begin() + 2 * (index + 1) * blockSize, 0.0);
+    }
+    else
+    {
+      index = (int)values.size();
+      values.push_back(0.0);
+      children.resize(children.size() + 2);
+      statistics.resize(statistics.size() + 2 * blockSize, 0.0);
+    }
+    values[index] = value;
+    children[2 * index] = children[2 * index + 1] = -1;
+    ++numNodes;
+    return index;
+  }
+
+  void freeSubTree(int index)
+  {
+    if (getChild(index, true) >= 0)
+      freeSubTree(getChild(index, true));
+    if (getChild(index, false) >= 0)
+      freeSubTree(getChild(index, false));
+    if ((size_t)index < nodeViews.size())
+      nodeViews[index] = ExtendedBinarySearchTreePtr();
+    freeNodes.push_back(index);
+    --numNodes;
+  }
+
+  void pruneChild(int index, bool isLeft)
+  {
+    int& child = children[2 * index + (isLeft ? 0 : 1)];
+    if (child >= 0)
+    {
+      freeSubTree(child);
+      child = -1;
+    }
+  }
+
+  size_t getSubTreeSize(int index) const
+  {
+    size_t res = 1;
+    if (getChild(index, true) >= 0)
+      res += getSubTreeSize(getChild(index, true));
+    if (getChild(index, false) >= 0)
+      res += getSubTreeSize(getChild(index, false));
+    return res;
+  }
+
+  // the products are computed in the same way as in MultiVariateRegressionStatistics::push()
+  void pushSample(double* block, const double* x, double y) const
+  {
+    size_t d = numAttributes + 1;
+    double* xtx = block;
+    double* xty = block + d * (d + 1) / 2;
+    for (size_t i = 0; i < d; ++i)
+    {
+      double xi = i ? x[i - 1] : 1.0;
+      *xtx++ += xi * xi;
+      for (size_t j = i + 1; j < d; ++j)
+        *xtx++ += xi * (j ? x[j - 1] : 1.0);
+      xty[i] += xi * y;
+    }
+    xty[d] += y * y;
+  }
+
+  void addBlock(double* target, const double* block, double weight) const
+  {
+    for (size_t i = 0; i < blockSize; ++i)
+      target[i] += weight * block[i];
+  }
+
+  // index of (i, j), i <= j, in the upper triangle of X'X
+  size_t getXTXIndex(size_t i, size_t j) const
+    {return i * (2 * (numAttributes + 1) - i + 1) / 2 + j - i;}
+
+  ScalarVariableMeanAndVariancePtr makeScalarStatistics(const double* block) const
+  {
+    ScalarVariableMeanAndVariancePtr res = new ScalarVariableMeanAndVariance();
+    size_t d = numAttributes + 1;
+    const double* xty = block + d * (d + 1) / 2;
+    res->setStatistics(block[0], xty[0], xty[d]);
+    return res;
+  }
+
+  PearsonCorrelationCoefficientPtr makeCorrelationStatistics(const double* block, size_t attribute) const
+  {
+    PearsonCorrelationCoefficientPtr res = new PearsonCorrelationCoefficient();
+    size_t count = (size_t)block[0];
+    if (!count)
+      return res;
+    size_t d = numAttributes + 1;
+    const double* xty = block + d * (d + 1) / 2;
+    res->numSamples = count;
+    res->sumX = block[getXTXIndex(0, attribute + 1)];
+    res->sumXsquared = block[getXTXIndex(attribute + 1, attribute + 1)];
+    res->sumXY = xty[attribute + 1];
+    res->sumY = xty[0];
+    res->sumYsquared = xty[d];
+    return res;
+  }
+
+  MultiVariateRegressionStatisticsPtr makeRegressionStatistics(const double* block) const
+  {
+    MultiVariateRegressionStatisticsPtr res = new MultiVariateRegressionStatistics();
+    size_t count = (size_t)block[0];
+    if (!count)
+      return res;
+    size_t d = numAttributes + 1;
+    const double* xty = block + d * (d + 1) / 2;
+
+    res->stats.resize(numAttributes);
+    for (size_t i = 0; i < numAttributes; ++i)
+      res->stats[i] = makeCorrelationStatistics(block, i);
+
+    for (size_t i = 1; i < numAttributes; ++i)
+      for (size_t j = 0; j < i; ++j)
+        res->sumXiXj.push_back(block[getXTXIndex(j + 1, i + 1)]);
+
+    res->xtx.resize(d, d, false);
+    res->xty.resize(d, 1, false);
+    for (size_t i = 0; i < d; ++i)
+    {
+      for (size_t j = i; j < d; ++j)
+        res->xtx(i, j) = res->xtx(j, i) = block[getXTXIndex(i, j)];
+      res->xty(i, 0) = xty[i];
+    }
+    return res;
+  }
+
+  // same as ExtendedBinarySearchTree::getStatsForSplit(), summing the statistics blocks down the path of splitValue
+  std::pair<MultiVariateRegressionStatisticsPtr, MultiVariateRegressionStatisticsPtr> getStatsForSplit(int index, double splitValue) const
+  {
+    std::vector<double> leftBlock(blockSize, 0.0);
+    std::vector<double> rightBlock(blockSize, 0.0);
+    while (true)
+    {
+      int left = getChild(index, true);
+      int right = getChild(index, false);
+      if (splitValue < values[index] && left >= 0)
+      {
+        // the samples of this node that did not go down to its left child are on the right of the split
+        addBlock(&rightBlock[0], getStatistics(index, false), 1.0);
+        addBlock(&rightBlock[0], getStatistics(index, true), 1.0);
+        addBlock(&rightBlock[0], getStatistics(left, true), -1.0);
+        addBlock(&rightBlock[0], getStatistics(left, false), -1.0);
+        index = left;
+      }
+      else if (splitValue > values[index] && right >= 0)
+      {
+        addBlock(&leftBlock[0], getStatistics(index, true), 1.0);
+        index = right;
+      }
+      else
+      {
+        addBlock(&leftBlock[0], getStatistics(index, true), 1.0);
+        addBlock(&rightBlock[0], getStatistics(index, false), 1.0);
+        break;
+      }
+    }
+    return std::make_pair(makeRegressionStatistics(&leftBlock[0]), makeRegressionStatistics(&rightBlock[0]));
+  }
+
+  ExtendedBinarySearchTreePtr makeExtendedBinarySearchTree(int index) const
+  {
+    ExtendedBinarySearchTreePtr res = new ExtendedBinarySearchTree(values[index]);
+    const double* leftBlock = getStatistics(index, true);
+    const double* rightBlock = getStatistics(index, false);
+    res->leftStats = makeScalarStatistics(leftBlock);
+    res->rightStats = makeScalarStatistics(rightBlock);
+    res->leftCorrelation = makeRegressionStatistics(leftBlock);
+    res->rightCorrelation = makeRegressionStatistics(rightBlock);
+    if (getChild(index, true) >= 0)
+      res->left = makeExtendedBinarySearchTree(getChild(index, true));
+    if (getChild(index, false) >= 0)
+      res->right = makeExtendedBinarySearchTree(getChild(index, false));
+    return res;
+  }
+};
+
+typedef ReferenceCountedObjectPtr<CompactExtendedBinarySearchTree> CompactExtendedBinarySearchTreePtr;
+
+/**
+ * View of a node of a CompactExtendedBinarySearchTree, seen as an ExtendedBinarySearchTree
+ *
+ * The statistics are built from the arrays of the tree when the view is created, and the
+ * children views are shared through the tree. A view is valid until the next insertion into
+ * the tree or until it is pruned.
+ */
+class CompactExtendedBinarySearchTreeNode : public ExtendedBinarySearchTree
+{
+public:
+  CompactExtendedBinarySearchTreeNode(const CompactExtendedBinarySearchTree* tree, int index)
+    : ExtendedBinarySearchTree(tree->values[index], false), tree(const_cast<CompactExtendedBinarySearchTree* >(tree)), index(index)
+  {
+    const double* leftBlock = tree->getStatistics(index, true);
+    const double* rightBlock = tree->getStatistics(index, false);
+    leftStats = tree->makeScalarStatistics(leftBlock);
+    rightStats = tree->makeScalarStatistics(rightBlock);
+    leftCorrelation = tree->makeRegressionStatistics(leftBlock);
+    rightCorrelation = tree->makeRegressionStatistics(rightBlock);
+  }
+
+  virtual BinarySearchTreePtr getLeft() const
+    {return makeNode(tree->getChild(index, true));}
+
+  virtual BinarySearchTreePtr getRight() const
+    {return makeNode(tree->getChild(index, false));}
+
+  virtual bool isLeaf() const
+    {return tree->getChild(index, true) < 0 && tree->getChild(index, false) < 0;}
+
+  virtual void pruneLeft()
+    {tree->pruneChild(index, true);}
+
+  virtual void pruneRight()
+    {tree->pruneChild(index, false);}
+
+  virtual size_t getSize() const
+    {return tree->getSubTreeSize(index);}
+
+  virtual void insertValue(double attribute, const DenseDoubleVectorPtr& data, double y)
+    {jassert(false);} // samples are inserted through CompactExtendedBinarySearchTree::insertValue()
+
+  virtual BinarySearchTreePtr getNode(double val) const
+  {
+    int node = index;
+    while (node >= 0 && tree->values[node] != val)
+      node = tree->getChild(node, val < tree->values[node]);
+    return makeNode(node);
+  }
+
+  virtual std::pair<MultiVariateRegressionStatisticsPtr, MultiVariateRegressionStatisticsPtr> getStatsForSplit(double splitValue)
+    {return tree->getStatsForSplit(index, splitValue);}
+
+  virtual ObjectPtr clone(ExecutionContext& context) const
+    {return tree->makeExtendedBinarySearchTree(index);}
+
+  lbcpp_UseDebuggingNewOperator
+
+protected:
+  CompactExtendedBinarySearchTree* tree;
+  int index;
+
+  BinarySearchTreePtr makeNode(int node) const
+    {return node >= 0 ? BinarySearchTreePtr(tree->getNodeView(node)) : BinarySearchTreePtr();}
+};
+
+inline ExtendedBinarySearchTreePtr CompactExtendedBinarySearchTree::getNodeView(int index) const
+{
+  if (nodeViews.size() <= (size_t)index)
+    nodeViews.resize(values.size());
+  ExtendedBinarySearchTreePtr& res = nodeViews[index];
+  if (!res)
+    res = new CompactExtendedBinarySearchTreeNode(this, index);
+  return res;
+}
+
 } /* namespace lbcpp */
 
 #endif //!ML_DATA_BINARY_SEARCH_TREE_H_
@@ -0,0 +1,101 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: BinaryTable.h                  | Binary columnar Table format    |
+| Author  : Francis Maes                   |                                 |
+| Started : 16/10/2026 21:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_BINARY_TABLE_H_
+# define ML_BINARY_TABLE_H_
+
+# include <oil/Core/Table.h>
+
+namespace lbcpp
+{
+
+/*
+** Read-only, memory-mapped view on a binary table file.
+**
+** The file stores one contiguous block per column, in the native layout of the
+** corresponding vector: double for DVector, int64 for IVector, unsigned char for BVector.
+** String columns are stored as numRows + 1 offsets followed by the UTF-8 characters.
+** Missing values use the missingValue of each vector class.
+**
+** Columns are accessed directly in the mapping, without copy. createTable() builds an
+** ordinary Table with one bulk copy per numerical column.
+*/
+class BinaryTable : public ReferenceCountedObject
+{
+public:
+  virtual ~BinaryTable();
+
+  static bool save(ExecutionContext& context, const TablePtr& table, const juce::File& file);
+  static ReferenceCountedObjectPtr<BinaryTable> open(ExecutionContext& context, const juce::File& file);
+  static bool isBinaryTableFile(juce::InputStream& istr);
+
+  enum Storage
+  {
+    doubleStorage = 0,
+    integerStorage,
+    booleanStorage,
+    stringStorage
+  };
+
+  size_t getNumRows() const
+    {return numRows;}
+
+  size_t getNumColumns() const
+    {return columns.size();}
+
+  const ObjectPtr& getKey(size_t index) const
+    {jassert(index < columns.size()); return columns[index].key;}
+
+  const ClassPtr& getType(size_t index) const
+    {jassert(index < columns.size()); return columns[index].type;}
+
+  Storage getStorage(size_t index) const
+    {jassert(index < columns.size()); return columns[index].storage;}
+
+  const double* getDoubles(size_t index) const
+    {jassert(getStorage(index) == doubleStorage); return (const double* )columns[index].data;}
+
+  const juce::int64* getIntegers(size_t index) const
+    {jassert(getStorage(index) == integerStorage); return (const juce::int64* )columns[index].data;}
+
+  const unsigned char* getBooleans(size_t index) const
+    {jassert(getStorage(index) == booleanStorage); return (const unsigned char* )columns[index].data;}
+
+  // returns a pointer to the UTF-8 characters of a string cell, which are not null-terminated
+  const char* getString(size_t columnIndex, size_t rowIndex, size_t& length) const;
+  string getString(size_t columnIndex, size_t rowIndex) const;
+
+  TablePtr createTable(ExecutionContext& context) const;
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  struct Mapping;
+
+  struct Column
+  {
+    ObjectPtr key;
+    ClassPtr type;
+    Storage storage;
+    const char* data;
+  };
+
+  Mapping* mapping;
+  size_t numRows;
+  std::vector<Column> columns;
+
+  BinaryTable(Mapping* mapping);
+
+  bool readDirectory(ExecutionContext& context, const string& fileName);
+};
+
+typedef ReferenceCountedObjectPtr<BinaryTable> BinaryTablePtr;
+
+}; /* namespace lbcpp */
+
+#endif // !ML_BINARY_TABLE_H_
@@ -0,0 +1,77 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: DensityEstimation.h            | Density estimation in the       |
+| Author  : Francis Maes                   |  objective space                |
+| Started : 16/10/2026 17:30               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_DENSITY_ESTIMATION_H_
+# define ML_DENSITY_ESTIMATION_H_
+
+# include <oil/common.h>
+
+namespace lbcpp
+{
+
+/*
+** k-d tree on points that are stored row by row in a packed matrix, for nearest
+** neighbours queries in O(log N) on average. The points are not copied, they must
+** outlive the tree.
+*/
+class PointKDTree
+{
+public:
+  PointKDTree(const double* points, size_t numPoints, size_t numDimensions, size_t maxLeafSize = 8);
+
+  // distances from the point index to its k nearest other points, in increasing order
+  // (fewer than k distances if there are not enough points)
+  void findNearestNeighbourDistances(size_t index, size_t k, std::vector<double>& res) const;
+
+private:
+  const double* points;
+  size_t numPoints;
+  size_t numDimensions;
+  size_t maxLeafSize;
+
+  struct Node
+  {
+    size_t begin, end;   // range in indices
+    size_t splitDimension;
+    double splitValue;
+    size_t left, right;  // children, 0 for leaves (the root cannot be a child)
+  };
+  std::vector<Node> nodes;
+  std::vector<size_t> indices;
+
+  size_t build(size_t begin, size_t end);
+  void search(size_t node, const double* query, size_t excludedIndex, size_t k, std::vector<double>& heap) const;
+};
+
+/*
+** Density estimators of the multi-objective solvers, on points that are stored row by row
+** in a packed matrix, all objectives being minimised.
+**
+** computeStrengthsAndRawFitnesses() gives the strength of each point, the number of points
+** that it strictly dominates, and its raw fitness, the sum of the strengths of the points that
+** strictly dominate it (Zitzler et al., 2001). It makes two passes on the pairs of points, so
+** that its memory does not grow with the number of dominance relations.
+**
+** computeNearestNeighbourDistances() gives the euclidean distance of each point to its k-th
+** nearest other point (DBL_MAX if there are not k other points), using a PointKDTree.
+**
+** computeCrowdingDistances() gives the crowding distance of NSGA-II (Deb et al., 2002): the sum
+** over the objectives of the normalised distance between the two neighbours of the point, the
+** extreme points having a distance of DBL_MAX. The differences are normalised by the given
+** ranges, or by the ranges of the points if ranges is NULL.
+*/
+struct DensityEstimation
+{
+  static void computeStrengthsAndRawFitnesses(const double* points, size_t numPoints, size_t numObjectives, std::vector<double>& strengths, std::vector<double>& rawFitnesses);
+  static void computeNearestNeighbourDistances(const double* points, size_t numPoints, size_t numObjectives, size_t k, std::vector<double>& res);
+  static void computeCrowdingDistances(const double* points, size_t numPoints, size_t numObjectives, std::vector<double>& res, const double* ranges = NULL);
+};
+
+}; /* namespace lbcpp */
+
+#endif // !ML_DENSITY_ESTIMATION_H_
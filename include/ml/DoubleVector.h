@@ -196,6 +196,8 @@ public:
   virtual string toShortString() const;
   virtual void saveToXml(XmlExporter& exporter) const;
   virtual bool loadFromXml(XmlImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
   virtual size_t getSizeInBytes(bool recursively) const;
   virtual void clone(ExecutionContext& context, const ObjectPtr& target) const;
 
@@ -308,6 +310,8 @@ public:
   virtual void clone(ExecutionContext& context, const ObjectPtr& target) const;
   void saveToXml(XmlExporter& exporter) const;
   bool loadFromXml(XmlImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
   virtual size_t getSizeInBytes(bool recursively) const;
 
   // Lua
@@ -377,6 +381,8 @@ public:
   virtual void clone(ExecutionContext& context, const ObjectPtr& target) const;
   virtual bool loadFromXml(XmlImporter& importer);
   virtual void saveToXml(XmlExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
   
   lbcpp_UseDebuggingNewOperator
 
@@ -0,0 +1,60 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: DoubleVectorKernels.h          | Low-level kernels on arrays     |
+| Author  : Francis Maes                   |  of doubles                     |
+| Started : 16/10/2026 14:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_DATA_DOUBLE_VECTOR_KERNELS_H_
+# define ML_DATA_DOUBLE_VECTOR_KERNELS_H_
+
+# include <oil/common.h>
+
+namespace lbcpp
+{
+
+/*
+** Vectorised implementations of the inner loops of DenseDoubleVector and SparseDoubleVector.
+**
+** The implementation is chosen once, at the first call, depending on the processor:
+** AVX2 when the compiler supports runtime dispatch and the processor has it, then SSE2,
+** then a portable unrolled loop. Sums are accumulated in several partial sums, so the
+** results may differ from a sequential loop in the last bits.
+*/
+struct DoubleVectorKernels
+{
+  // sum_i a[i] * b[i]
+  static double dotProduct(const double* a, const double* b, size_t n);
+
+  // target[i] += weight * source[i]
+  static void addWeighted(double* target, const double* source, size_t n, double weight);
+
+  // sum_i values[i]^2
+  static double sumOfSquares(const double* values, size_t n);
+
+  // sum_i (a[i] - b[i])^2
+  static double squaredDistance(const double* a, const double* b, size_t n);
+
+  // max_i values[i], -DBL_MAX if n == 0
+  static double maximum(const double* values, size_t n);
+
+  // sum_i sparse[i].second * dense[sparse[i].first], over the sparse entries whose index is lower than denseSize
+  static double sparseDotProduct(const std::pair<size_t, double>* sparse, size_t numValues, const double* dense, size_t denseSize);
+
+  // dense[sparse[i].first] += weight * sparse[i].second
+  static void sparseAddWeighted(double* dense, const std::pair<size_t, double>* sparse, size_t numValues, double weight);
+
+  // target[i] = source[indices[i]], or 0 if indices[i] is not lower than sourceSize
+  static void gather(double* target, const double* source, size_t sourceSize, const size_t* indices, size_t n);
+
+  // replaces values[i] by exp(values[i]) / sum_j exp(values[j]), in place, and returns log(sum_j exp(values[j]))
+  static double softmax(double* values, size_t n);
+
+  // "avx2", "sse2" or "generic"
+  static const char* getInstructionSetName();
+};
+
+}; /* namespace lbcpp */
+
+#endif // !ML_DATA_DOUBLE_VECTOR_KERNELS_H_
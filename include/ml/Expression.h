@@ -149,7 +149,7 @@ public:
   const VectorPtr& getVector() const
     {return vector;}
 
-  ObjectPtr sampleElement(RandomGeneratorPtr random) const;
+  ObjectPtr sampleElement(const RandomGeneratorPtr& random) const;
 
 protected:
   Implementation implementation;
@@ -180,6 +180,23 @@ public:
   
   DataVectorPtr compute(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices = IndexSetPtr()) const;
 
+  /*
+  ** Native evaluation
+  ** Allocation-free evaluation on unboxed values (see Function::computeNative()).
+  ** stack must contain at least getNativeStackSize() doubles of scratch space.
+  */
+  virtual bool hasNativeCompute() const
+    {return false;}
+
+  virtual size_t getNativeStackSize() const
+    {return 0;}
+
+  virtual double computeNative(const double* inputs, double* stack) const
+    {jassertfalse; return DVector::missingValue;}
+
+  static double toNativeValue(const ObjectPtr& value);
+  static ObjectPtr fromNativeValue(const ClassPtr& type, double value);
+
   virtual size_t getNumSubNodes() const
     {return 0;}
     
@@ -204,16 +221,16 @@ public:
     {learnerStatistics = statistics;}
 
   size_t getDepth() const;
-  size_t getNodeDepth(ExpressionPtr node) const;
+  size_t getNodeDepth(const ExpressionPtr& node) const;
   size_t getTreeSize() const;
   ExpressionPtr getNodeByTreeIndex(size_t index) const;
 
-  ExpressionPtr cloneAndSubstitute(ExpressionPtr sourceNode, ExpressionPtr targetNode) const;
+  ExpressionPtr cloneAndSubstitute(const ExpressionPtr& sourceNode, const ExpressionPtr& targetNode) const;
   void getInternalNodes(std::vector<ExpressionPtr>& res) const;
   void getLeafNodes(std::vector<ExpressionPtr>& res) const;
-  ExpressionPtr sampleNode(RandomGeneratorPtr random, double functionSelectionProbability) const;
-  ExpressionPtr sampleNode(RandomGeneratorPtr random) const;
-  ExpressionPtr sampleSubNode(RandomGeneratorPtr random) const;
+  ExpressionPtr sampleNode(const RandomGeneratorPtr& random, double functionSelectionProbability) const;
+  ExpressionPtr sampleNode(const RandomGeneratorPtr& random) const;
+  ExpressionPtr sampleSubNode(const RandomGeneratorPtr& random) const;
 
   lbcpp_UseDebuggingNewOperator
 
@@ -243,6 +260,10 @@ public:
   virtual ObjectPtr compute(ExecutionContext& context, const std::vector<ObjectPtr>& inputs) const;
   virtual DataVectorPtr computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const;
 
+  virtual bool hasNativeCompute() const;
+  virtual double computeNative(const double* inputs, double* stack) const
+    {return inputs[inputIndex];}
+
   size_t getInputIndex() const
     {return inputIndex;}
 
@@ -268,6 +289,10 @@ public:
   virtual ObjectPtr compute(ExecutionContext& context, const std::vector<ObjectPtr>& inputs) const;
   virtual DataVectorPtr computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const;
 
+  virtual bool hasNativeCompute() const;
+  virtual double computeNative(const double* inputs, double* stack) const
+    {return toNativeValue(value);}
+
   const ObjectPtr& getValue() const
     {return value;}
 
@@ -297,6 +322,10 @@ public:
 
   virtual ObjectPtr compute(ExecutionContext& context, const std::vector<ObjectPtr>& inputs) const;
 
+  virtual bool hasNativeCompute() const;
+  virtual size_t getNativeStackSize() const;
+  virtual double computeNative(const double* inputs, double* stack) const;
+
   virtual size_t getNumSubNodes() const
     {return arguments.size();}
   virtual const ExpressionPtr& getSubNode(size_t index) const
@@ -396,6 +425,10 @@ public:
   virtual string toShortString() const;
   virtual ObjectPtr compute(ExecutionContext& context, const std::vector<ObjectPtr>& inputs) const;
 
+  virtual bool hasNativeCompute() const;
+  virtual size_t getNativeStackSize() const;
+  virtual double computeNative(const double* inputs, double* stack) const;
+
   virtual size_t getNumSubNodes() const;
   virtual const ExpressionPtr& getSubNode(size_t index) const;
 
@@ -437,6 +470,50 @@ protected:
   DataVectorPtr getSubSamples(ExecutionContext& context, const ExpressionPtr& subNode, const TablePtr& data, const IndexSetPtr& subIndices) const;
 };
 
+/*
+** Native Evaluator
+**
+** Evaluates an expression row by row on unboxed inputs, without any heap allocation.
+** The evaluator owns its scratch stack and is not thread-safe: use one evaluator per thread.
+*/
+class NativeExpressionEvaluator
+{
+public:
+  NativeExpressionEvaluator(const ExpressionPtr& expression = ExpressionPtr())
+    {setExpression(expression);}
+
+  void setExpression(const ExpressionPtr& expression);
+
+  const ExpressionPtr& getExpression() const
+    {return expression;}
+
+  // false if some node of the expression does not support native evaluation
+  bool isSupported() const
+    {return supported;}
+
+  double compute(const double* inputs)
+    {jassert(supported); return expression->computeNative(inputs, stack.size() ? &stack[0] : NULL);}
+
+  double compute(const std::vector<double>& inputs)
+    {return compute(inputs.size() ? &inputs[0] : NULL);}
+
+  // 0 = false, 1 = true, 2 = missing
+  unsigned char computeBoolean(const double* inputs)
+    {double res = compute(inputs); return res == DVector::missingValue ? 2 : (res ? 1 : 0);}
+
+  // row by row evaluation on a table whose columns are the expression inputs
+  // the predictions are stored into a DVector, a BVector or an IVector, depending on outputType
+  DataVectorPtr computeSamples(const TablePtr& data, const IndexSetPtr& indices, ClassPtr outputType = ClassPtr());
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  ExpressionPtr expression;
+  std::vector<double> stack;
+  std::vector<double> row;
+  bool supported;
+};
+
 class TreeNode : public Expression
 {
 public:
@@ -522,6 +599,11 @@ public:
   ObjectPtr compute(ExecutionContext &context, const std::vector<ObjectPtr>& inputs) const;
   DataVectorPtr computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const;
 
+  // the native value of a prediction is its mean
+  virtual bool hasNativeCompute() const;
+  virtual size_t getNativeStackSize() const;
+  virtual double computeNative(const double* inputs, double* stack) const;
+
   ExpressionPtr getModel() const
     {return model;}
 
@@ -564,6 +646,22 @@ public:
   }
 
   virtual ObjectPtr compute(ExecutionContext &context, const std::vector<ObjectPtr>& inputs) const;
+
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs, double* stack) const
+  {
+    size_t n = weights->getNumValues();
+    if (n == 0)
+      return 0.0;
+    const double* w = weights->getValuePointer(0);
+    double result = w[0];
+    for (size_t i = 1; i < n; ++i)
+      result += w[i] * inputs[i-1];
+    return result;
+  }
+
   /** Get a reference to the weight vector
    *  \return a reference to the weight vector, allowing it to be updated
    */
@@ -599,6 +697,24 @@ public:
     return LinearModelExpression::compute(normalized);
   }
 
+  virtual bool hasNativeCompute() const
+    {return weights->getNumValues() <= statistics.size() + 1;}
+
+  virtual double computeNative(const double* inputs, double* stack) const
+  {
+    size_t n = weights->getNumValues();
+    if (n == 0)
+      return 0.0;
+    const double* w = weights->getValuePointer(0);
+    double result = w[0];
+    for (size_t i = 1; i < n; ++i)
+    {
+      const ScalarVariableMeanAndVariancePtr& stats = statistics[i-1];
+      result += w[i] * normalize(inputs[i-1], stats->getMean(), stats->getStandardDeviation());
+    }
+    return result;
+  }
+
   ScalarVariableMeanAndVariancePtr getStatistics(size_t i) const
     {return statistics[i];}
 
@@ -48,6 +48,17 @@ public:
   virtual ObjectPtr compute(ExecutionContext& context, const ObjectPtr* inputs) const = 0;
   virtual DataVectorPtr compute(ExecutionContext& context, const std::vector<DataVectorPtr>& inputs, ClassPtr outputType) const;
 
+  /*
+  ** Native evaluation (optional)
+  ** Inputs and output are unboxed into doubles: booleans are 0 or 1, integers are converted
+  ** and missing values are represented by DVector::missingValue. See Expression::computeNative().
+  */
+  virtual bool hasNativeCompute() const
+    {return false;}
+
+  virtual double computeNative(const double* inputs) const
+    {jassertfalse; return 0.0;}
+
   lbcpp_UseDebuggingNewOperator
 };
 
@@ -0,0 +1,93 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: HyperVolume.h                  | Exact, incremental and Monte    |
+| Author  : Francis Maes                   |  Carlo hypervolume computation  |
+| Started : 16/10/2026 14:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_HYPER_VOLUME_H_
+# define ML_HYPER_VOLUME_H_
+
+# include "predeclarations.h"
+# include <map>
+
+namespace lbcpp
+{
+
+/*
+** Hypervolume of points that are stored row by row in a packed matrix, all objectives
+** being minimised, with respect to a reference point. Only the points that are strictly
+** better than the reference point on all the objectives contribute to the hypervolume.
+**
+** The exact computation is a sweep-line in O(N log N) for two objectives and the sweep
+** of Beume et al. (2009) in O(N log N) for three objectives. More objectives use the
+** WFG algorithm of While et al. (2012): the points are sliced by their last objective and
+** the exclusive contribution of each slice is computed recursively in one dimension less.
+**
+** The exclusive contribution of a point is the hypervolume that is lost when the point
+** is removed from the set (see the S-metric selection of SMS-EMOA).
+**
+** estimate() is a Monte Carlo estimator, that draws numSamples uniform points in the box
+** bounded by the ideal point of the set and the reference point. Its standard error is
+** returned in standardError, a 95% confidence interval being estimate +/- 1.96 standardError.
+*/
+struct HyperVolume
+{
+  static double compute(const double* points, size_t numPoints, size_t numObjectives, const double* reference);
+
+  static double computeContribution(const double* point, const double* otherPoints, size_t numOtherPoints, size_t numObjectives, const double* reference);
+  static void computeContributions(const double* points, size_t numPoints, size_t numObjectives, const double* reference, std::vector<double>& res);
+
+  static double estimate(const double* points, size_t numPoints, size_t numObjectives, const double* reference,
+                         const RandomGeneratorPtr& random, size_t numSamples, double& standardError);
+};
+
+/*
+** Hypervolume of a set of mutually non-dominated points, updated when a point is inserted or
+** removed, as in a ParetoFront: inserting a point that is weakly dominated by the set does
+** nothing and inserting a point discards the points that it dominates.
+**
+** With two objectives, the points are kept in a staircase and each update costs O(log N + K),
+** K being the number of discarded points. With more objectives, the hypervolume is updated
+** by the exclusive contribution of the point, that is computed in O(N log N) for three
+** objectives and with WFG otherwise.
+*/
+class IncrementalHyperVolume
+{
+public:
+  IncrementalHyperVolume() : numObjectives(0), value(0.0) {}
+
+  void initialize(size_t numObjectives, const std::vector<double>& reference);
+  void initialize(size_t numObjectives, const std::vector<double>& reference, const double* points, size_t numPoints);
+  void clear();
+
+  bool isInitialized() const
+    {return numObjectives > 0;}
+
+  size_t getNumObjectives() const
+    {return numObjectives;}
+
+  const std::vector<double>& getReference() const
+    {return reference;}
+
+  double getValue() const
+    {return value;}
+
+  // these functions return the variation of the hypervolume
+  double insert(const double* point);
+  double remove(const double* point);
+
+  double computeContribution(const double* point) const;
+
+private:
+  size_t numObjectives;
+  std::vector<double> reference;
+  double value;
+  std::map<double, double> staircase; // two objectives: first objective -> second objective
+  std::vector<double> points;         // more objectives: packed points
+};
+
+}; /* namespace lbcpp */
+
+#endif // !ML_HYPER_VOLUME_H_
@@ -53,6 +53,12 @@ public:
 
   void addInterval(size_t begin, size_t end);
 
+  // true if the indices are front(), front() + 1, ..., back(), without duplicates
+  bool isContiguous() const;
+
+  void resize(size_t size) // only shrinks the set, appended indices must remain sorted
+    {jassert(size <= v.size()); v.resize(size);}
+
   // Object
   virtual void clone(ExecutionContext& context, const ObjectPtr& target) const
     {target.staticCast<IndexSet>()->v = v;}
@@ -63,10 +69,18 @@ public:
   IndexSetPtr sampleBootStrap(RandomGeneratorPtr random) const;
   IndexSetPtr sampleSubset(RandomGeneratorPtr random, size_t subsetSize) const;
 
+  // the set from which this subset was extracted, e.g. the examples of the parent node in a tree
+  const IndexSetPtr& getParent() const
+    {return parent;}
+
+  void setParent(const IndexSetPtr& parent)
+    {this->parent = parent;}
+
 protected:
   friend class IndexSetClass;
 
   std::vector<size_t> v;
+  IndexSetPtr parent;
 };
 
 }; /* namespace lbcpp */
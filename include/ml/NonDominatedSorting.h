@@ -0,0 +1,36 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: NonDominatedSorting.h          | Non-dominated sorting of a      |
+| Author  : Francis Maes                   |  packed fitness matrix          |
+| Started : 16/10/2026 17:10               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_NON_DOMINATED_SORTING_H_
+# define ML_NON_DOMINATED_SORTING_H_
+
+# include <oil/common.h>
+
+namespace lbcpp
+{
+
+/*
+** Non-dominated sorting of points that are stored row by row in a packed matrix,
+** all objectives being minimised.
+**
+** The rank of a point is 0 if no other point strictly dominates it, and
+** 1 + the highest rank of the points that strictly dominate it otherwise. Identical points
+** have the same rank.
+**
+** Two objectives are handled with a sweep-line in O(N log N). More objectives use the
+** divide-and-conquer of Jensen (2003), in the version of Buzdalov and Shalyto (2014) that
+** supports equal objective values, in O(N log^(M-1) N).
+*/
+struct NonDominatedSorting
+{
+  static void computeRanks(const double* points, size_t numPoints, size_t numObjectives, std::vector<size_t>& ranks);
+};
+
+}; /* namespace lbcpp */
+
+#endif // !ML_NON_DOMINATED_SORTING_H_
@@ -29,6 +29,22 @@ class Objective : public ScalarProperty
 public:
   virtual void getObjectiveRange(double& worst, double& best) const = 0;
 
+  /* Same as evaluate(), except that the evaluation may stop as soon as the result is known to be
+  ** strictly worse than cutoff, in which case a value that is worse than cutoff is returned instead of
+  ** the result. A cutoff of DBL_MAX disables this, for the maximised objectives too. By default, the
+  ** cutoff is ignored.
+  */
+  virtual double evaluateWithCutoff(ExecutionContext& context, const ObjectPtr& object, double cutoff) const
+    {return evaluate(context, object);}
+
+  // evaluates several objects at once, objectives that can share work between the objects may override this
+  virtual void evaluateBatch(ExecutionContext& context, const std::vector<ObjectPtr>& objects, std::vector<double>& res, double cutoff = DBL_MAX) const
+  {
+    res.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+      res[i] = cutoff == DBL_MAX ? evaluate(context, objects[i]) : evaluateWithCutoff(context, objects[i], cutoff);
+  }
+
   bool isMinimization() const
     {double worst, best; getObjectiveRange(worst, best); return best < worst;}
   
@@ -78,8 +94,18 @@ public:
   virtual double evaluatePredictions(ExecutionContext& context, DataVectorPtr predictions) const = 0;
 
   virtual double evaluate(ExecutionContext& context, const ObjectPtr& object) const
+    {return evaluateExpression(context, object.staticCast<Expression>());}
+
+  virtual double evaluateWithCutoff(ExecutionContext& context, const ObjectPtr& object, double cutoff) const
+    {return evaluateExpression(context, object.staticCast<Expression>(), cutoff);}
+
+  /* Evaluates the predictions of an expression on the data, with the cutoff of evaluateWithCutoff().
+  ** The objectives that can compute and score the predictions block by block, without building a
+  ** DataVector, override this function and stop the execution once the partial result is worse than
+  ** the cutoff.
+  */
+  virtual double evaluateExpression(ExecutionContext& context, const ExpressionPtr& expression, double cutoff = DBL_MAX) const
   {
-    ExpressionPtr expression = object.staticCast<Expression>();
     DataVectorPtr predictions = computePredictions(context, expression);
     return evaluatePredictions(context, predictions);
   }
@@ -72,6 +72,8 @@ public:
   */
   FitnessLimitsPtr getFitnessLimits() const;
   FitnessPtr evaluate(ExecutionContext& context, const ObjectPtr& object) const;
+  // the cutoff of Objective::evaluateWithCutoff() is only used by single-objective problems
+  void evaluateBatch(ExecutionContext& context, const std::vector<ObjectPtr>& objects, std::vector<FitnessPtr>& res, double cutoff = DBL_MAX) const;
 
   /*
   ** Reference solutions
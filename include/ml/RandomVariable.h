@@ -110,6 +110,9 @@ public:
   virtual void push(const ScalarVariableMeanAndVariance& other)
     {ScalarVariableMean::push(other); samplesSumOfSquares += other.samplesSumOfSquares;}
 
+  void setStatistics(double count, double sum, double sumOfSquares)
+    {samplesCount = count; samplesSum = sum; samplesSumOfSquares = sumOfSquares;}
+
   virtual void subtract(const ScalarVariableMeanAndVariance& other)
   {
     samplesSum -= other.samplesSum;
@@ -696,6 +699,7 @@ public:
 
 protected:
   friend class MultiVariateRegressionStatisticsClass;
+  friend class CompactExtendedBinarySearchTree;
 
   std::vector<PearsonCorrelationCoefficientPtr> stats;
   std::vector<double> sumXiXj;
@@ -11,6 +11,7 @@
 
 # include "predeclarations.h"
 # include <ml/SolutionComparator.h>
+# include <ml/HyperVolume.h>
 
 namespace lbcpp
 {
@@ -32,6 +33,9 @@ public:
 
   size_t getNumObjectives() const;
   FitnessLimitsPtr getEmpiricalFitnessLimits() const;
+
+  // fitnesses to be minimized, one row per solution
+  void getPointsToBeMinimized(std::vector<double>& res) const;
 };
 
 class SolutionVector : public SolutionContainer
@@ -134,14 +138,30 @@ public:
    */
   ParetoFront(FitnessLimitsPtr limits, const string& path);
   ParetoFront(FitnessLimitsPtr limits, const std::vector<SolutionAndFitness>& solutions, SolutionComparatorPtr comparator = SolutionComparatorPtr())
-    : SolutionVector(limits, solutions, comparator) {}
-  ParetoFront(FitnessLimitsPtr limits) : SolutionVector(limits) {}
-  ParetoFront() {}
+    : SolutionVector(limits, solutions, comparator), hyperVolumeNumSolutions(0) {}
+  ParetoFront(FitnessLimitsPtr limits) : SolutionVector(limits), hyperVolumeNumSolutions(0) {}
+  ParetoFront() : hyperVolumeNumSolutions(0) {}
 
   virtual void insertSolution(ObjectPtr solution, FitnessPtr fitness);
   virtual void insertSolutions(SolutionContainerPtr solutions);
+  virtual void removeSolution(size_t index);
 
+/** The hypervolume of the front with respect to a reference fitness, the worst possible fitness by default.
+ *  The hypervolume of the last reference fitness is cached and kept up to date by insertSolution() and
+ *  removeSolution(), so that it is only computed from scratch when the reference fitness changes or when
+ *  the number of solutions is changed by other means. The cache is protected by a lock, so that concurrent
+ *  calls are safe as long as the front is not modified. See HyperVolume for the algorithms.
+ */
   double computeHyperVolume(FitnessPtr referenceFitness = FitnessPtr()) const;
+
+/** Monte Carlo estimate of the hypervolume, for fronts with many objectives.
+ *  \param confidenceHalfWidth If not null, receives the half-width of the 95% confidence interval of the estimate.
+ */
+  double estimateHyperVolume(const RandomGeneratorPtr& random, size_t numSamples, FitnessPtr referenceFitness = FitnessPtr(), double* confidenceHalfWidth = NULL) const;
+
+/** The exclusive hypervolume contribution of each solution: the hypervolume lost if the solution is removed.
+ */
+  void computeHyperVolumeContributions(std::vector<double>& res, FitnessPtr referenceFitness = FitnessPtr()) const;
   
 /** The binary multiplicative epsilon indicator, \f$I(A,B)\f$, gives the minimum factor \f$\epsilon\f$
  *  by which each point in \f$A\f$ must be multiplied such that the resulting set weakly dominates \f$B\f$. 
@@ -161,6 +181,20 @@ public:
  *  NSGA-II". This is a measure for how well the solutions in this ParetoFront are spread out.
  */
   double computeSpreadIndicator() const;
+
+  virtual void clone(ExecutionContext& context, const ObjectPtr& target) const;
+
+protected:
+  // the cache is updated by computeHyperVolume(), which may be called by several threads at the same time
+  // (modifying the front still requires exclusive access, as for the other containers)
+  mutable CriticalSection hyperVolumeLock;
+  mutable IncrementalHyperVolume hyperVolume; // hypervolume of the last reference fitness
+  mutable size_t hyperVolumeNumSolutions;     // number of solutions when the hypervolume was last updated
+
+  bool isHyperVolumeUpToDate() const
+    {return hyperVolume.isInitialized() && hyperVolumeNumSolutions == solutions.size();}
+
+  void updateHyperVolume(bool wasUpToDate, const FitnessPtr& fitness, bool isInsertion);
 };
 
 class CrowdingArchive : public ParetoFront
@@ -188,13 +222,91 @@ protected:
   size_t maxSize;
 };
 
+/** A ParetoFront indexed by an ND-Tree (Jaszkiewicz and Lust, 2018).
+ *  Each node of the tree bounds the fitnesses of its solutions by an ideal and a nadir point,
+ *  so that insertSolution() only compares the new fitness to the solutions of the nodes whose
+ *  bounds do not already decide the dominance relation, instead of scanning the whole front.
+ *  Solutions are kept in the same lexicographic order as in ParetoFront, so that computeSpreadIndicator()
+ *  still sees neighbouring fitnesses; this costs a linear renumbering of the indices stored in the tree, but
+ *  no fitness comparison. Contrary to ParetoFront, only the fitnesses are compared. The index is rebuilt if
+ *  the number of solutions is changed by other means than insertSolution() and removeSolution().
+ */
+class NDTreeParetoFront : public ParetoFront
+{
+public:
+  NDTreeParetoFront(FitnessLimitsPtr limits, size_t maxLeafSize = 20, size_t numChildren = 0);
+  NDTreeParetoFront();
+  virtual ~NDTreeParetoFront();
+
+  virtual void insertSolution(ObjectPtr solution, FitnessPtr fitness);
+  virtual void removeSolution(size_t index);
+
+  virtual void clone(ExecutionContext& context, const ObjectPtr& target) const;
+
+  lbcpp_UseDebuggingNewOperator
+
+protected:
+  friend class NDTreeParetoFrontClass;
+
+  size_t maxLeafSize;
+  size_t numChildren; // number of children created when splitting a leaf, 0 for numObjectives + 1
+
+  struct Node
+  {
+    Node(Node* parent) : parent(parent) {}
+    ~Node();
+
+    Node* parent;
+    std::vector<Node*> children;
+    std::vector<size_t> solutionIndices; // leaves only
+    std::vector<double> ideal;
+    std::vector<double> nadir;
+
+    bool isLeaf() const
+      {return children.empty();}
+
+    bool isEmpty() const
+      {return children.empty() && solutionIndices.empty();}
+  };
+
+  Node* root;
+  size_t numObjectives;
+  std::vector<double> points; // fitnesses to be minimized, one row per solution
+  std::vector<Node*> leaves;  // leaf of each solution
+  size_t numIndexedSolutions;
+
+  void rebuildIndex();
+  bool updateNode(Node* node, const double* point, std::vector<size_t>& dominatedSolutions);
+  void insertIntoNode(Node* node, size_t index);
+  void splitLeaf(Node* node);
+  Node* findClosestChild(Node* node, const double* point) const;
+  void updateBounds(Node* node, const double* point) const;
+  void collectSolutions(Node* node, std::vector<size_t>& res) const;
+  void removeEmptyNodes(Node* node);
+  void shiftIndices(Node* node, size_t firstIndex);
+  void remapIndices(Node* node, const std::vector<size_t>& newIndices);
+  void removeSolutionsFromVectors(const std::vector<size_t>& sortedIndices);
+};
+
+/** A ParetoFront of bounded size that, when it is full, removes the solution whose fitness is the
+ *  closest to the fitnesses of its nearest neighbours, as the archive truncation of SPEA2. The objectives
+ *  are normalised by the fitness limits and ties are broken by the distances to the second and third
+ *  nearest neighbours.
+ */
 class ClusteringArchive : public ParetoFront
 {
 public:
-  virtual void insertSolution(ObjectPtr solution, FitnessPtr fitness)
-  {}
+  ClusteringArchive(size_t maxSize, FitnessLimitsPtr limits) : ParetoFront(limits), maxSize(maxSize)
+    {reserve(maxSize + 1);}
+
+  ClusteringArchive(size_t maxSize = 100) : maxSize(maxSize)
+    {reserve(maxSize + 1);}
+
+  virtual void insertSolution(ObjectPtr solution, FitnessPtr fitness);
 
 protected:
+  friend class ClusteringArchiveClass;
+
   size_t maxSize;
 };
 
@@ -68,13 +68,22 @@ public:
 protected:
   typedef std::pair<ObjectPtr, FitnessPtr> SolutionAndFitnessPair;
 
+  enum {defaultEvaluationBatchSize = 8};
+
+  // evaluates the objects in parallel, by work units of batchSize objects, then adds them to the callback in order until it asks to stop
+  // at most callback->getNumRemainingEvaluations() objects are evaluated
+  // returns the number of added objects, the fitnesses of the other ones are left null
+  // cutoff is given to Problem::evaluateBatch(), the fitnesses that are worse than cutoff may then be bounds
+  size_t evaluateSolutions(ExecutionContext& context, const std::vector<ObjectPtr>& objects, std::vector<FitnessPtr>& fitnesses, size_t batchSize = defaultEvaluationBatchSize, double cutoff = DBL_MAX);
+
   ProblemPtr problem;
   SolverCallbackPtr callback;
   SolverVerbosity verbosity;
 };
 
 extern SolverPtr nrpaSolver(SamplerPtr sampler, size_t level, size_t numIterationsPerLevel);
-extern SolverPtr beamNRPASolver(SamplerPtr sampler, size_t level, size_t numIterationsPerLevel, size_t beamSizeAtFirstLevel, size_t beamSizeAtHigherLevels);
+extern SolverPtr beamNRPASolver(SamplerPtr sampler, size_t level, size_t numIterationsPerLevel, size_t beamSizeAtFirstLevel, size_t beamSizeAtHigherLevels, bool parallelSubSearches = false);
+extern SolverPtr parallelNRPASolver(SamplerPtr sampler, size_t level, size_t numIterationsPerLevel, size_t numWorkers, size_t synchronisationPeriod = 1, bool leafParallelism = false);
 
 // learners
 extern SolverPtr exhaustiveConditionLearner(SamplerPtr expressionsSampler);
@@ -116,15 +125,29 @@ class PopulationBasedSolver : public IterativeSolver
 {
 public:
   PopulationBasedSolver(size_t populationSize = 100, size_t numGenerations = 0)
-    : IterativeSolver(numGenerations), populationSize(populationSize) {}
+    : IterativeSolver(numGenerations), populationSize(populationSize), evaluationBatchSize(defaultEvaluationBatchSize) {}
+
+  /** Number of solutions evaluated by each work unit of evaluatePopulation().
+   *  Each work unit runs with its own random generator, seeded from the random generator of the
+   *  context and the index of its first solution, so that the results do not depend on the number of threads.
+   */
+  void setEvaluationBatchSize(size_t evaluationBatchSize)
+    {jassert(evaluationBatchSize > 0); this->evaluationBatchSize = evaluationBatchSize;}
+
+  size_t getEvaluationBatchSize() const
+    {return evaluationBatchSize;}
 
 protected:
   friend class PopulationBasedSolverClass;
 
   size_t populationSize;
+  size_t evaluationBatchSize;
+
+  size_t evaluatePopulation(ExecutionContext& context, const std::vector<ObjectPtr>& objects, std::vector<FitnessPtr>& fitnesses, double cutoff = DBL_MAX)
+    {return evaluateSolutions(context, objects, fitnesses, evaluationBatchSize, cutoff);}
 
   SolutionVectorPtr sampleAndEvaluatePopulation(ExecutionContext& context, SamplerPtr sampler, size_t populationSize);
-  void computeMissingFitnesses(ExecutionContext& context, const SolutionVectorPtr& population);
+  void computeMissingFitnesses(ExecutionContext& context, const SolutionVectorPtr& population, double cutoff = DBL_MAX);
   void learnSampler(ExecutionContext& context, SolutionVectorPtr solutions, SamplerPtr sampler);
 };
 
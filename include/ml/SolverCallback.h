@@ -39,11 +39,15 @@ class SolverCallback : public Object
 {
 public:
   virtual void solverStarted(ExecutionContext& context, SolverPtr solver) {}
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness) = 0;
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness) = 0;
   virtual void solverStopped(ExecutionContext& context, SolverPtr solver) {}
   
   virtual bool shouldStop()
   {return false;}
+
+  // upper bound on the number of solutions that can still be evaluated before shouldStop() returns true
+  virtual size_t getNumRemainingEvaluations()
+  {return (size_t)-1;}
 };
 
 extern SolverCallbackPtr storeBestFitnessSolverCallback(FitnessPtr& bestFitness);
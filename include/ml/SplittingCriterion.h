@@ -28,6 +28,9 @@ public:
   virtual double computeCriterion() const = 0;
   virtual ObjectPtr computeVote(const IndexSetPtr& indices) = 0;
 
+  // returns a copy configured on the same examples, which can be used concurrently with this criterion
+  ReferenceCountedObjectPtr<SplittingCriterion> cloneAndConfigure(ExecutionContext& context) const;
+
   void ensureIsUpToDate();
   void invalidate()
     {upToDate = false;}
@@ -72,6 +72,12 @@ typedef ReferenceCountedObjectPtr<ParetoFront> ParetoFrontPtr;
 class CrowdingArchive;
 typedef ReferenceCountedObjectPtr<CrowdingArchive> CrowdingArchivePtr;
 
+class ClusteringArchive;
+typedef ReferenceCountedObjectPtr<ClusteringArchive> ClusteringArchivePtr;
+
+class NDTreeParetoFront;
+typedef ReferenceCountedObjectPtr<NDTreeParetoFront> NDTreeParetoFrontPtr;
+
 class SolverEvaluator;
 typedef ReferenceCountedObjectPtr<SolverEvaluator> SolverEvaluatorPtr;
 
@@ -27,6 +27,7 @@
 
 # include "Core/Loader.h"
 # include "Core/XmlSerialisation.h"
+# include "Core/BinarySerialisation.h"
 # include "Core/RandomGenerator.h"
 
 # include "Execution/ExecutionContext.h"
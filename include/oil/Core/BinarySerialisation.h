@@ -0,0 +1,150 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: BinarySerialisation.h          | Binary Importer/Exporter        |
+| Author  : Francis Maes                   |                                 |
+| Started : 17/10/2026 10:05               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef OIL_CORE_BINARY_SERIALISATION_H_
+# define OIL_CORE_BINARY_SERIALISATION_H_
+
+# include "Object.h"
+
+namespace lbcpp
+{
+
+/*
+** Binary archives
+**
+** A binary archive starts with a header (magic, version and byte order mark), followed by
+** the root object. Objects are written depth-first, through Object::saveToBinary(), whose
+** default implementation relies on the same introspection as the xml format.
+**
+** Objects are numbered in the order in which they are first written: an object that is met
+** again is written as a reference to its number, which preserves sharing and cycles.
+** Type names and variable names are written once and then referred to by their index.
+**
+** Numbers are written in little-endian order, except raw blocks (e.g. the content of a DVector)
+** that are written in native order. Archives written on a machine with another byte order
+** are rejected.
+*/
+class BinaryExporter
+{
+public:
+  BinaryExporter(ExecutionContext& context, juce::OutputStream& ostr);
+
+  static bool saveToFile(ExecutionContext& context, const ObjectPtr& object, const juce::File& file);
+  static bool isBinaryFileName(const juce::File& file);
+
+  static const char* fileExtension;
+
+  void writeHeader();
+
+  void writeObject(const ObjectPtr& object, ClassPtr expectedType);
+  void writeType(ClassPtr type);
+  void writeName(const string& name);
+
+  // registers an object that is not written, but that the importer re-creates by itself
+  // at the same position (see Object::computeGeneratedObject())
+  void writeGeneratedObject(const ObjectPtr& object);
+
+  void writeBool(bool value)
+    {ostr.writeBool(value);}
+
+  void writeSize(size_t value)
+    {ostr.writeInt64((juce::int64)value);}
+
+  void writeInteger(juce::int64 value)
+    {ostr.writeInt64(value);}
+
+  void writeDouble(double value)
+    {ostr.writeDouble(value);}
+
+  void writeString(const string& value)
+    {ostr.writeString(value);}
+
+  void writeBlock(const void* data, size_t size);
+
+  bool isOk() const
+    {return ok;}
+
+  ExecutionContext& getContext()
+    {return context;}
+
+private:
+  ExecutionContext& context;
+  juce::OutputStream& ostr;
+  bool ok;
+
+  typedef std::map<ObjectPtr, size_t> ObjectIdentifiersMap;
+  ObjectIdentifiersMap objectIdentifiers;
+  std::map<ClassPtr, size_t> typeIdentifiers;
+  std::map<string, size_t> nameIdentifiers;
+};
+
+class BinaryImporter
+{
+public:
+  BinaryImporter(ExecutionContext& context, juce::InputStream& istr);
+
+  static ObjectPtr loadFromFile(ExecutionContext& context, const juce::File& file);
+  static bool isBinaryFile(juce::InputStream& istr);
+
+  bool readHeader();
+  ObjectPtr load();
+
+  ObjectPtr readObject(ClassPtr expectedType);
+  ClassPtr readType();
+  string readName();
+
+  // see BinaryExporter::writeGeneratedObject()
+  void readGeneratedObject(const ObjectPtr& object);
+
+  bool readBool()
+    {return istr.readBool();}
+
+  size_t readSize()
+    {return (size_t)istr.readInt64();}
+
+  // reads a number of elements that take at least minElementSize bytes each in the stream,
+  // and fails if the rest of the stream can not hold them (see BinaryExporter::writeSize())
+  bool readNumElements(size_t& res, size_t minElementSize = 1);
+
+  juce::int64 readInteger()
+    {return istr.readInt64();}
+
+  double readDouble()
+    {return istr.readDouble();}
+
+  string readString()
+    {return istr.readString();}
+
+  bool readBlock(void* data, size_t size);
+
+  void errorMessage(const string& where, const string& what);
+  void warningMessage(const string& where, const string& what) const;
+  void unknownVariableWarning(ClassPtr type, const string& variableName);
+
+  bool isOk() const
+    {return ok;}
+
+  ExecutionContext& getContext()
+    {return context;}
+
+private:
+  ExecutionContext& context;
+  juce::InputStream& istr;
+  bool ok;
+
+  std::vector<ObjectPtr> objects;
+  std::vector<ClassPtr> types;
+  std::vector<string> names;
+  std::set<std::pair<ClassPtr, string> > unknownVariables; // store unknown variables to produce warnings only once
+
+  bool readIdentifier(size_t numIdentifiers, const string& what, size_t& res);
+};
+
+}; /* namespace lbcpp */
+
+#endif // !OIL_CORE_BINARY_SERIALISATION_H_
@@ -22,6 +22,10 @@ public:
   Boolean(bool value = false)
     : value(value) {}
 
+  // for the booleanClass, these functions return shared instances, that must not be modified
+  static BooleanPtr create(bool value);
+  static BooleanPtr create(ClassPtr type, bool value);
+
   void set(bool value)
     {this->value = value;}
 
@@ -43,6 +47,10 @@ public:
   
   virtual bool loadFromXml(XmlImporter& importer);
   virtual void saveToXml(XmlExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
+  lbcpp_UseSmallObjectAllocator
 
 protected:
   bool value;
@@ -14,6 +14,14 @@ namespace lbcpp
 {
 
 struct TemplateClassCache;
+struct ClassManagerIndex;
+
+/*
+** The lookups (getType(), findType(), getTypeByShortName()) do not take any lock: they read
+** hash tables whose entries are published atomically and are never modified nor deleted
+** before shutdown(). The declarations and the template instantiations are serialized by
+** typesLock.
+*/
 class ClassManager
 {
 public:
@@ -36,12 +44,13 @@ public:
 
 private:
   typedef std::map<string, ClassPtr> TypeMap;
-  typedef std::map<string, TemplateClassCache> TemplateClassMap;
+  typedef std::map<string, TemplateClassCache* > TemplateClassMap;
 
   CriticalSection typesLock;
   TypeMap types;
   TypeMap typesByShortName;
   TemplateClassMap templateTypes;
+  ClassManagerIndex* index;
  
   bool hasTemplateClass(const string& templateTypeName) const;
   TemplateClassCache* getTemplateClass(ExecutionContext& context, const string& templateTypeName) const;
@@ -43,6 +43,10 @@ public:
 
   virtual bool loadFromXml(XmlImporter& importer);
   virtual void saveToXml(XmlExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
+  lbcpp_UseSmallObjectAllocator
 
 protected:
   double value;
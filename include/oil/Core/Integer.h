@@ -23,7 +23,9 @@ public:
   Integer(juce::int64 value = 0)
     : value(value) {}
 
+  // for the integerClass and the positiveIntegerClass, small values are shared instances, that must not be modified
   static IntegerPtr create(ClassPtr type, juce::int64 value);
+  static IntegerPtr create(juce::int64 value);
   
   static juce::int64 get(ObjectPtr object)
     {return object.staticCast<Integer>()->get();}
@@ -45,6 +47,10 @@ public:
 
   virtual bool loadFromXml(XmlImporter& importer);
   virtual void saveToXml(XmlExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
+  lbcpp_UseSmallObjectAllocator
 
 protected:
   juce::int64 value;
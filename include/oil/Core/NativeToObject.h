@@ -18,7 +18,7 @@ namespace lbcpp
 ** Atomic Types
 */
 inline ObjectPtr nativeToObject(const bool& source, const ClassPtr& expectedType)
-  {return new Boolean(expectedType, source);}
+  {return Boolean::create(expectedType, source);}
 
 inline ObjectPtr nativeToObject(const unsigned char& source, const ClassPtr& expectedType)
   {return Integer::create(expectedType, source);}
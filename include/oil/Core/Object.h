@@ -56,6 +56,9 @@ public:
   /**
   ** Saves variable to a file
   **
+  ** Files whose extension is BinaryExporter::fileExtension are saved
+  ** in the binary format, other files are saved in xml.
+  **
   ** @param file : output file
   ** @param callback : A callback that can receive errors and warnings
   **
@@ -135,6 +138,23 @@ public:
   */
   virtual bool loadFromXml(XmlImporter& importer);
 
+  /**
+  ** Override this function to save the object to a binary archive
+  ** (see BinarySerialisation.h). The default implementation saves the member variables.
+  **
+  ** @param exporter : the binary exporter
+  */
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
+  /**
+  ** Override this function to load the object from a binary archive
+  **
+  ** @param importer : the binary importer
+  ** @return false is the loading fails, true otherwise. If loading fails,
+  ** loadFromBinary() is responsible for declaring an error to the importer.
+  */
+  virtual bool loadFromBinary(BinaryImporter& importer);
+
   /**
   ** Override this function to load the object from a string
   **
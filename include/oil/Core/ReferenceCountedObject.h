@@ -206,10 +206,11 @@ public:
 #ifdef LBCPP_ENABLE_CPP0X_RVALUES
   ReferenceCountedObjectPtr<T>& operator =(ReferenceCountedObjectPtr<T>&& other)
   {
-    if (ptr)
-      cast(ptr).decrementReferenceCounter();
+    T* oldPtr = ptr; // released last, so that self-assignment is safe
     ptr = other.ptr;
     other.ptr = NULL;
+    if (oldPtr)
+      cast(oldPtr).decrementReferenceCounter();
     return *this;
   }
 
@@ -217,10 +218,11 @@ public:
   ReferenceCountedObjectPtr<T>& operator =(ReferenceCountedObjectPtr<O>&& other)
   {
     jassert(!other.get() || dynamic_cast<T* >(other.get()));
-    if (ptr)
-      cast(ptr).decrementReferenceCounter();
-    ptr = (T* )other.get();
+    T* oldPtr = ptr;
+    ptr = static_cast<T* >(other.get());
     other.setPointerToNull();
+    if (oldPtr)
+      cast(oldPtr).decrementReferenceCounter();
     return *this;
   }
 #endif // LBCPP_ENABLE_CPP0X_RVALUES
@@ -328,6 +330,10 @@ public:
   inline bool isInstanceOf() const
     {return dynamic_cast<O* >(ptr) != NULL;}
 
+  /** Exchanges the objects referenced by two pointers, without touching their reference counts. */
+  void swap(ReferenceCountedObjectPtr<T>& other)
+    {T* tmp = ptr; ptr = other.ptr; other.ptr = tmp;}
+
   // internal
   void setPointerToNull()
 	  {ptr = NULL;}
@@ -354,6 +360,67 @@ template<class T>
 inline ReferenceCountedObjectPtr<T> refCountedPointerFromThis(const T* pthis)
   {return ReferenceCountedObjectPtr<T>(const_cast<T* >(pthis));}
 
+/**
+    Non-owning pointer to a reference-counted object.
+
+    Creating, copying and destroying a BorrowedObjectPtr never touches the
+    reference count of the object, hence it is a plain pointer copy. The caller
+    must make sure that the object is kept alive by an owning pointer during the
+    whole lifetime of the borrowed pointer.
+
+    A BorrowedObjectPtr<T> has the same layout as a ReferenceCountedObjectPtr<T>,
+    so that it can be given to functions taking a const ReferenceCountedObjectPtr<T>&
+    (these functions may still copy it into an owning pointer if they need to keep
+    the object) and arrays of borrowed pointers can be given to functions taking
+    arrays of pointers, with toPointerArray().
+
+    e.g. @code
+    std::vector< BorrowedObjectPtr<Object> > inputs(n);
+    for (size_t i = 0; i < n; ++i)
+      inputs[i] = values[i]; // no reference count update
+    function->compute(context, BorrowedObjectPtr<Object>::toPointerArray(&inputs[0]));
+    @endcode
+
+    @see ReferenceCountedObjectPtr
+*/
+template<class T>
+class BorrowedObjectPtr
+{
+public:
+  BorrowedObjectPtr(T* ptr = NULL) : ptr(ptr) {}
+
+  template<class O>
+  BorrowedObjectPtr(const ReferenceCountedObjectPtr<O>& other) : ptr(static_cast<T* >(other.get()))
+    {jassert(!other.get() || dynamic_cast<T* >(other.get()));}
+
+  /** Returns a reference to an owning pointer on the same object. */
+  operator const ReferenceCountedObjectPtr<T>& () const
+    {return *(const ReferenceCountedObjectPtr<T>* )this;}
+
+  static const ReferenceCountedObjectPtr<T>* toPointerArray(const BorrowedObjectPtr<T>* pointers)
+    {return (const ReferenceCountedObjectPtr<T>* )pointers;}
+
+  T* get() const
+    {return ptr;}
+
+  T* operator -> () const
+    {return ptr;}
+
+  T& operator * () const
+    {jassert(ptr); return *ptr;}
+
+  operator bool () const
+    {return ptr != NULL;}
+
+private:
+  T* ptr;
+};
+
+/** Same as refCountedPointerFromThis(), without updating the reference count of the object. */
+template<class T>
+inline BorrowedObjectPtr<T> borrowedPointerFromThis(const T* pthis)
+  {return BorrowedObjectPtr<T>(const_cast<T* >(pthis));}
+
 /*
 ** Visual studio bug: this should work, but does not work
 *
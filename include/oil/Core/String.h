@@ -42,6 +42,8 @@ public:
 
   virtual bool loadFromXml(XmlImporter& importer);
   virtual void saveToXml(XmlExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
 
 protected:
   string value;
@@ -74,6 +76,8 @@ public:
   virtual bool loadFromString(ExecutionContext& context, const string& str);
 
   virtual void saveToXml(XmlExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
 };
 
 extern ClassPtr fileClass;
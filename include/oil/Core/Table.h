@@ -23,6 +23,7 @@ public:
   void addColumn(const string& name, const ClassPtr& type);
   void addRow(const std::vector<ObjectPtr>& elements);
   void resize(size_t numRows);
+  void reserve(size_t numRows);
 
   size_t getNumColumns() const
     {return columns.size();}
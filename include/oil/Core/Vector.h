@@ -58,6 +58,9 @@ public:
   virtual bool loadFromXml(XmlImporter& importer);
   virtual void saveToXml(XmlExporter& exporter) const;
 
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
   virtual void clone(ExecutionContext& context, const ObjectPtr& target) const;
   virtual int compare(const ObjectPtr& otherObject) const;
 
@@ -163,13 +166,17 @@ public:
   virtual string toString() const;
   virtual size_t getSizeInBytes(bool recursively) const;
 
+  // raw values
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
   enum {missingValue = 2};
 
   unsigned char objectToNativeImpl(const ObjectPtr& value) const
     {jassert(value); return Boolean::get(value) ? 1 : 0;}
 
   ObjectPtr nativeToObjectImpl(unsigned char value) const
-    {jassert(value != 2); return new Boolean(BaseClass::getElementsType(), value == 1);}
+    {jassert(value != 2); return Boolean::create(BaseClass::getElementsType(), value == 1);}
 
   lbcpp_UseDebuggingNewOperator
 };
@@ -189,6 +196,10 @@ public:
   void append(juce::int64 value)
     {v.push_back(value);}
 
+  // raw values
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
   static juce::int64 missingValue;
 
   juce::int64 objectToNativeImpl(const ObjectPtr& value) const
@@ -215,6 +226,10 @@ public:
   void append(double value)
     {v.push_back(value);}
 
+  // raw values
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
   static double missingValue;
 
   double objectToNativeImpl(const ObjectPtr& value) const
@@ -238,6 +253,9 @@ public:
   SVector(size_t initialSize = 0, const string& initialValue = missingValue)
     : BaseClass(stringClass, initialSize, initialValue) {}
 
+  virtual bool loadFromBinary(BinaryImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+
   static string missingValue;
 
   string objectToNativeImpl(const ObjectPtr& value) const
@@ -256,9 +274,9 @@ class OVector : public VectorT<OVector, ObjectPtr>
 public:
   typedef VectorT<OVector, ObjectPtr> BaseClass;
 
-  OVector(ClassPtr elementsType, size_t initialSize, ObjectPtr initialValue = ObjectPtr())
+  OVector(ClassPtr elementsType, size_t initialSize, const ObjectPtr& initialValue = ObjectPtr())
     : BaseClass(elementsType, initialSize, initialValue) {}
-  OVector(size_t initialSize = 0, ObjectPtr initialValue = ObjectPtr())
+  OVector(size_t initialSize = 0, const ObjectPtr& initialValue = ObjectPtr())
     : BaseClass(objectClass, initialSize, initialValue) {}
 
   template<class T>
@@ -126,6 +126,8 @@ public:
   /* Object */
   virtual void saveToXml(XmlExporter& exporter) const;
   virtual bool loadFromXml(XmlImporter& importer);
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
 
   virtual string toString() const;
   virtual string toShortString() const;
@@ -43,6 +43,8 @@ struct ApplicationContext;
 
 class XmlExporter;
 class XmlImporter;
+class BinaryExporter;
+class BinaryImporter;
 
 class Object;
 typedef ReferenceCountedObjectPtr<Object> ObjectPtr;
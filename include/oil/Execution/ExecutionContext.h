@@ -23,6 +23,8 @@ public:
   virtual ~ExecutionContext();
   
   virtual bool isMultiThread() const = 0;
+  virtual size_t getNumThreads() const
+    {return 1;}
 
   /*
   ** Checks
@@ -125,6 +127,7 @@ extern void setDefaultExecutionContext(ExecutionContextPtr defaultContext);
 
 extern ExecutionContextPtr singleThreadedExecutionContext(const juce::File& projectDirectory = juce::File::nonexistent);
 extern ExecutionContextPtr multiThreadedExecutionContext(size_t numThreads, const juce::File& projectDirectory = juce::File::nonexistent);
+extern ExecutionContextPtr workStealingExecutionContext(size_t numThreads, const juce::File& projectDirectory = juce::File::nonexistent);
 
 extern ExecutionContextPtr defaultConsoleExecutionContext(bool noMultiThreading = false);
 
@@ -33,6 +33,9 @@ public:
   virtual void saveToXml(XmlExporter& exporter) const;
   virtual bool loadFromXml(XmlImporter& importer);
 
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+
 protected:
   friend class ExecutionTraceItemClass;
 
@@ -53,6 +56,9 @@ public:
   virtual void saveToXml(XmlExporter& exporter) const;
   virtual bool loadFromXml(XmlImporter& importer);
 
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+
 protected:
   friend class MessageExecutionTraceItemClass;
 
@@ -98,7 +104,8 @@ public:
   void setReturnValue(const ObjectPtr& value)
     {returnValue = value;}
 
-  void setResult(const string& name, const ObjectPtr& value);
+  // if maxNumResults is not zero, new results are ignored once this number is reached
+  bool setResult(const string& name, const ObjectPtr& value, size_t maxNumResults = 0);
   std::vector< std::pair<string, ObjectPtr> > getResults() const;
 
   VectorPtr getResultsVector(ExecutionContext& context) const;
@@ -142,6 +149,9 @@ public:
   virtual bool loadFromXml(XmlImporter& importer);
   bool loadSubItemsFromXml(XmlImporter& importer);
 
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+
 protected:
   friend class ExecutionTraceNodeClass;
 
@@ -175,6 +185,10 @@ public:
   ExecutionTraceNodePtr getRootNode() const
     {ScopedLock _(lock); return root;}
   ExecutionTraceNodePtr findNode(const ExecutionStackPtr& stack) const;
+  ExecutionTraceNodePtr findDeepestNode(const ExecutionStackPtr& stack, size_t& depth) const;
+
+  string getContextDescription() const
+    {ScopedLock _(lock); return context;}
 
   juce::Time getStartTime() const
     {ScopedLock _(lock); return startTime;}
@@ -182,6 +196,9 @@ public:
   virtual void saveToXml(XmlExporter& exporter) const;
   virtual bool loadFromXml(XmlImporter& importer);
 
+  virtual void saveToBinary(BinaryExporter& exporter) const;
+  virtual bool loadFromBinary(BinaryImporter& importer);
+
 protected:
   friend class ExecutionTraceClass;
 
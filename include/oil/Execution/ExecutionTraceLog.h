@@ -0,0 +1,156 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ExecutionTraceLog.h            | Append-only Execution Trace Log |
+| Author  : Francis Maes                   |                                 |
+| Started : 17/10/2026 14:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef OIL_EXECUTION_TRACE_LOG_H_
+# define OIL_EXECUTION_TRACE_LOG_H_
+
+# include "ExecutionTrace.h"
+
+namespace lbcpp
+{
+
+/*
+** Compact description of one change made to an execution trace.
+** Nodes are identified by their address, which stays valid as long as the trace exists.
+*/
+struct ExecutionTraceRecord
+{
+  enum Type
+  {
+    enterRecord = 0,  // creation of the node "child" under "node"
+    leaveRecord,      // end of "node", value is the return value
+    messageRecord,
+    progressRecord,   // value is the progression
+    resultRecord
+  };
+
+  ExecutionTraceRecord(Type type, const ExecutionTraceNodePtr& node, double time)
+    : type(type), node(getNodeIdentifier(node)), child(0), time(time), messageType(informationMessageType) {}
+  ExecutionTraceRecord()
+    : type(messageRecord), node(0), child(0), time(0.0), messageType(informationMessageType) {}
+
+  static juce::int64 getNodeIdentifier(const ExecutionTraceNodePtr& node)
+    {return (juce::int64)(juce::pointer_sized_int)node.get();}
+
+  // saves the value immediately, since the writer thread runs while the object may still be modified
+  void setValue(ExecutionContext& context, const ObjectPtr& value);
+
+  // records that are not needed to rebuild the structure of the trace
+  bool isDroppable() const
+    {return type == progressRecord || type == resultRecord || (type == messageRecord && messageType == informationMessageType);}
+
+  Type type;
+  juce::int64 node;
+  juce::int64 child;
+  double time;
+  ExecutionMessageType messageType;
+  string name;      // description of the created node, message or result name
+  string where;
+  ObjectPtr value;              // loaded value, when reading a log
+  juce::MemoryBlock valueData;  // value in the binary format, when writing a log
+};
+
+/*
+** Bounded buffer of records, filled by one thread and emptied by the auto-save thread.
+** When the buffer is full, droppable records are discarded, the other records are always kept.
+*/
+class ExecutionTraceRecordBuffer : public ReferenceCountedObject
+{
+public:
+  ExecutionTraceRecordBuffer(size_t capacity)
+    : capacity(capacity), numDroppedRecords(0) {}
+
+  void push(const ExecutionTraceRecord& record)
+  {
+    ScopedLock _(lock);
+    if (records.size() >= capacity && record.isDroppable())
+      ++numDroppedRecords;
+    else
+      records.push_back(record);
+  }
+
+  // moves the buffered records at the end of res and returns the number of records dropped since the last call
+  size_t flush(std::vector<ExecutionTraceRecord>& res)
+  {
+    ScopedLock _(lock);
+    res.insert(res.end(), records.begin(), records.end());
+    records.clear();
+    size_t n = numDroppedRecords;
+    numDroppedRecords = 0;
+    return n;
+  }
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  CriticalSection lock;
+  size_t capacity;
+  std::vector<ExecutionTraceRecord> records;
+  size_t numDroppedRecords;
+};
+
+typedef ReferenceCountedObjectPtr<ExecutionTraceRecordBuffer> ExecutionTraceRecordBufferPtr;
+
+/*
+** Append-only log of execution trace records.
+**
+** The log starts with a header (magic, version, context description and identifier of
+** the root node), followed by the records in the order in which they were written.
+** Record values are saved in the binary format (see BinarySerialisation.h).
+** A log that was interrupted in the middle of a record can still be loaded.
+*/
+class ExecutionTraceLogWriter
+{
+public:
+  ExecutionTraceLogWriter(ExecutionContext& context, const juce::File& file);
+  ~ExecutionTraceLogWriter();
+
+  bool open(const ExecutionTracePtr& trace);
+  bool write(const std::vector<ExecutionTraceRecord>& records);
+  void close();
+
+  bool isOpened() const
+    {return ostr != NULL;}
+
+  const juce::File& getFile() const
+    {return file;}
+
+  static const char* fileExtension;
+
+private:
+  ExecutionContext& context;
+  juce::File file;
+  juce::FileOutputStream* ostr;
+};
+
+class ExecutionTraceLogReader
+{
+public:
+  ExecutionTraceLogReader(ExecutionContext& context, juce::InputStream& istr);
+
+  static ExecutionTracePtr loadFromFile(ExecutionContext& context, const juce::File& file);
+  static bool isExecutionTraceLog(juce::InputStream& istr);
+
+  ExecutionTracePtr load();
+
+private:
+  ExecutionContext& context;
+  juce::InputStream& istr;
+
+  typedef std::map<juce::int64, ExecutionTraceNodePtr> NodeMap;
+  NodeMap nodes;
+  typedef std::map<juce::int64, std::vector<ExecutionTraceRecord> > PendingRecordsMap;
+  PendingRecordsMap pendingRecords; // records whose node has not been created yet
+
+  bool readRecord(ExecutionTraceRecord& res);
+  void applyRecord(const ExecutionTraceRecord& record);
+};
+
+}; /* namespace lbcpp */
+
+#endif // !OIL_EXECUTION_TRACE_LOG_H_
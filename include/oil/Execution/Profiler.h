@@ -0,0 +1,91 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: Profiler.h                     | Hot-path Profiler               |
+| Author  : Francis Maes                   |                                 |
+| Started : 17/10/2026 16:10               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef OIL_EXECUTION_PROFILER_H_
+# define OIL_EXECUTION_PROFILER_H_
+
+# include "predeclarations.h"
+
+namespace lbcpp
+{
+
+/*
+** Instrumentation and sampling profiler.
+**
+** When enabled, each thread builds its own call tree of profiled scopes: the scopes of
+** ExecutionContext::enterScope()/leaveScope(), keyed by the class of the work unit if
+** any and by the scope description otherwise, and the ProfiledScope instances, that do not
+** send any notification and can be used in hot paths.
+** Each node of the tree counts its calls, its total and self time, measured with the
+** processor cycle counter, and the number of Objects allocated within the scope.
+**
+** If a sampling interval is given, a background thread also periodically counts, for each
+** thread, the scope being executed.
+**
+** The profiles of all the threads are merged when reporting. getSummary() aggregates the
+** nodes by scope and saveFlameGraph() writes the self times in the "folded stacks"
+** format of flamegraph.pl (one line per call path: "a;b;c <microseconds>").
+**
+** Profiling is off by default and is controlled by start(), stop() and reset(). Since the
+** call trees are modified without lock by their threads, reports must be made once profiling
+** is stopped, and reset() must not be called while profiling.
+*/
+class Profiler
+{
+public:
+  static void start(size_t samplingIntervalInMilliseconds = 0);
+  static void stop();
+  static void reset();
+
+  static bool isEnabled()
+    {return enabled;}
+
+  static void enter(const string& name)
+    {if (enabled) enterImpl(name);}
+
+  static void leave()
+    {if (enabled) leaveImpl();}
+
+  static void countAllocation()
+    {if (enabled) countAllocationImpl();}
+
+  static string getSummary();
+  static bool saveFlameGraph(ExecutionContext& context, const juce::File& file);
+
+  static juce::int64 getCycleCount();
+
+private:
+  static volatile bool enabled;
+
+  static void enterImpl(const string& name);
+  static void leaveImpl();
+  static void countAllocationImpl();
+};
+
+/*
+** Profiled scope that does not appear in the execution stack: it only costs a few
+** hundreds of cycles when profiling is enabled, and a test when it is not.
+** Since the name is compared at each call, hot paths should give a static string.
+*/
+class ProfiledScope
+{
+public:
+  ProfiledScope(const string& name)
+    : active(Profiler::isEnabled())
+    {if (active) Profiler::enter(name);}
+
+  ~ProfiledScope()
+    {if (active) Profiler::leave();}
+
+private:
+  bool active;
+};
+
+}; /* namespace lbcpp */
+
+#endif //!OIL_EXECUTION_PROFILER_H_
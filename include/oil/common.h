@@ -15,7 +15,7 @@
 #   define LBCPP_ENABLE_CPP0X_RVALUES
 #  endif
 # else 
-#  ifdef __GXX_EXPERIMENTAL_CXX0X__
+#  if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 #   define LBCPP_ENABLE_CPP0X_RVALUES
 #  endif
 # endif
@@ -89,8 +89,23 @@ extern void debugFree(void* const block);
   static void* operator new (size_t sz, void* p)  { return ::operator new (sz, p); } \
   static void operator delete (void* p)           { lbcpp::debugFree (p); }
 
+# define lbcpp_UseSmallObjectAllocator lbcpp_UseDebuggingNewOperator
+
 #else 
 # define lbcpp_UseDebuggingNewOperator 
+
+/*
+** Per-thread pool allocator for the small objects that are allocated and released at a high
+** rate, such as boxed scalars. Blocks of more than 64 bytes are forwarded to the default allocator.
+*/
+extern void* smallObjectAllocate(size_t size);
+extern void smallObjectFree(void* block, size_t size);
+
+# define lbcpp_UseSmallObjectAllocator \
+  static void* operator new (size_t sz)           { return lbcpp::smallObjectAllocate(sz); } \
+  static void* operator new (size_t sz, void* p)  { return ::operator new (sz, p); } \
+  static void operator delete (void* p, size_t sz) { lbcpp::smallObjectFree(p, sz); }
+
 #endif // JUCE_DEBUG
 
 }; /* namespace lbcpp */
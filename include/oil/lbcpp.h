@@ -34,6 +34,8 @@
 # include "Execution/ExecutionStack.h"
 # include "Execution/ExecutionContext.h"
 # include "Execution/ExecutionTrace.h"
+# include "Execution/ExecutionTraceLog.h"
+# include "Execution/Profiler.h"
 # include "Execution/Notification.h"
 # include "Execution/WorkUnit.h"
 # include "Execution/TestUnit.h"
@@ -12,43 +12,40 @@
 using namespace lbcpp;
 
 BanditPool::BanditPool(const StochasticObjectivePtr& objective, double explorationCoefficient, bool optimizeMax, bool useMultiThreading) 
-  : objective(objective), explorationCoefficient(explorationCoefficient), optimizeMax(optimizeMax), useMultiThreading(useMultiThreading)
+  : objective(objective), explorationCoefficient(explorationCoefficient), optimizeMax(optimizeMax), useMultiThreading(useMultiThreading),
+    maxInFlightArms(0), numCurrentlyPlayedArms(0)
 {
 }
 
-BanditPool::BanditPool() : explorationCoefficient(0.0)
+BanditPool::BanditPool() : explorationCoefficient(0.0), optimizeMax(false), useMultiThreading(false), maxInFlightArms(0), numCurrentlyPlayedArms(0)
 {
 }
 
+size_t BanditPool::getMaxInFlightArms(ExecutionContext& context) const
+{
+  if (!useMultiThreading || !context.isMultiThread())
+    return 1;
+  return maxInFlightArms ? maxInFlightArms : 2 * context.getNumThreads();
+}
+
 void BanditPool::play(ExecutionContext& context, size_t numTimeSteps, bool showProgression)
 {
+  size_t window = getMaxInFlightArms(context);
   for (size_t i = 0; i < numTimeSteps; ++i)
   {
     if (showProgression)
       context.progressCallback(new ProgressionState(i + 1, numTimeSteps, T("Steps")));
 
-    selectAndPlayArm(context);
+    // wait until there is room in the window and an arm to play
+    while (numCurrentlyPlayedArms && (numCurrentlyPlayedArms >= window || queue.empty()))
+      waitForFinishedArms();
 
-    if (useMultiThreading && context.isMultiThread())
-    {
-      context.flushCallbacks();
-      //context.informationCallback(T("Num played: ") + string((int)j + 1) + T(" num currently evaluated: " ) + string((int)getNumCurrentlyEvaluatedFormulas()));
-      
-      while (getNumCurrentlyPlayedArms() >= 25)
-      {
-        //context.informationCallback(T("Waiting - Num played: ") + string((int)j + 1) + T(" num currently evaluated: " ) + string((int)getNumCurrentlyEvaluatedFormulas()));
-        Thread::sleep(1);
-        context.flushCallbacks();
-      }
-    }
+    selectAndPlayArm(context);
+    observeFinishedArms();
   }
 
-  if (useMultiThreading && context.isMultiThread())
-    while (getNumCurrentlyPlayedArms() > 0)
-    {
-      Thread::sleep(10);
-      context.flushCallbacks();
-    }
+  while (numCurrentlyPlayedArms)
+    waitForFinishedArms();
 }
 
 void BanditPool::playIterations(ExecutionContext& context, size_t numIterations, size_t stepsPerIteration)
@@ -78,18 +75,24 @@ size_t BanditPool::getArmPlayedCount(size_t index) const
 void BanditPool::setArmObject(size_t index, const ObjectPtr& object)
   {jassert(index < arms.size()); arms[index].object = object;}
 
-struct PlayArmWorkUnit : public WorkUnit
+struct BanditPool::PlayArmWorkUnit : public WorkUnit
 {
-  PlayArmWorkUnit(StochasticObjectivePtr objective, const ObjectPtr& object, size_t instanceIndex, size_t armIndex)
-    : objective(objective), object(object), instanceIndex(instanceIndex), armIndex(armIndex) {}
+  PlayArmWorkUnit(BanditPool* pool, StochasticObjectivePtr objective, const ObjectPtr& object, size_t instanceIndex, size_t armIndex)
+    : pool(pool), objective(objective), object(object), instanceIndex(instanceIndex), armIndex(armIndex) {}
 
+  BanditPool* pool; // NULL when played synchronously
   StochasticObjectivePtr objective;
   ObjectPtr object;
   size_t instanceIndex;
   size_t armIndex;
 
   virtual ObjectPtr run(ExecutionContext& context)
-   {return new Double(objective->evaluate(context, object, instanceIndex));}
+  {
+    double res = objective->evaluate(context, object, instanceIndex);
+    if (pool)
+      pool->armFinished(armIndex, res);
+    return new Double(res);
+  }
 };
 
 size_t BanditPool::selectAndPlayArm(ExecutionContext& context)
@@ -99,19 +102,50 @@ size_t BanditPool::selectAndPlayArm(ExecutionContext& context)
     return (size_t)-1;
 
   Arm& arm = arms[index];
-  WorkUnitPtr workUnit = new PlayArmWorkUnit(objective, arm.object, arm.playedCount, index);
   if (useMultiThreading && context.isMultiThread())
-    context.pushWorkUnit(workUnit, this, false);
+  {
+    ++numCurrentlyPlayedArms;
+    context.pushWorkUnit(new PlayArmWorkUnit(this, objective, arm.object, arm.playedCount, index), (int* )NULL, false);
+  }
   else
   {
+    WorkUnitPtr workUnit = new PlayArmWorkUnit(NULL, objective, arm.object, arm.playedCount, index);
     double objective = Double::get(context.run(workUnit, false));
     observeObjective(index, objective);
   }
   return (size_t)index;
 }
 
-void BanditPool::workUnitFinished(const WorkUnitPtr& workUnit, const ObjectPtr& result, const ExecutionTracePtr& trace)
-  {observeObjective(workUnit.staticCast<PlayArmWorkUnit>()->armIndex, Double::get(result));}
+// called by the worker threads
+void BanditPool::armFinished(size_t index, double objectiveValue)
+{
+  {
+    ScopedLock _(finishedArmsLock);
+    finishedArms.push_back(std::make_pair(index, objectiveValue));
+  }
+  finishedArmsEvent.signal();
+}
+
+void BanditPool::observeFinishedArms()
+{
+  std::vector< std::pair<size_t, double> > batch;
+  {
+    ScopedLock _(finishedArmsLock);
+    if (finishedArms.empty())
+      return;
+    batch.swap(finishedArms);
+  }
+  jassert(batch.size() <= numCurrentlyPlayedArms);
+  numCurrentlyPlayedArms -= batch.size();
+  for (size_t i = 0; i < batch.size(); ++i)
+    observeObjective(batch[i].first, batch[i].second);
+}
+
+void BanditPool::waitForFinishedArms()
+{
+  finishedArmsEvent.wait();
+  observeFinishedArms();
+}
 
 void BanditPool::observeObjective(size_t index, double objectiveValue)
 {
@@ -10,7 +10,7 @@
 # define ML_COMPARATOR_SPEA2_H_
 
 # include <ml/SolutionComparator.h>
-# include <algorithm>
+# include <ml/DensityEstimation.h>
 
 namespace lbcpp
 {
@@ -20,51 +20,28 @@ class SPEA2Comparator : public SolutionComparator
 public:
   virtual void initialize(const SolutionContainerPtr& solutions)
   {
-    SolutionComparatorPtr dominance = dominanceComparator();
-    dominance->initialize(solutions);
     size_t n = solutions->getNumSolutions();
-    fitness = std::vector<double>(n, 0.0);
+    size_t numObjectives = solutions->getNumObjectives();
+    std::vector<double> points;
+    solutions->getPointsToBeMinimized(points);
+    const double* data = points.size() ? &points[0] : NULL;
 
-    double* strength = new double[n];
-    std::fill_n(strength, n, 0.0);
-    
-    double* rawFitness = new double[n];
-    std::fill_n(rawFitness, n, 0.0);
-
-    double** distance = new double*[n];
-    for (size_t i = 0; i < n; ++i)
-      distance[i] = new double[n];
-    calculateDistanceMatrix(solutions, distance);
-
-    // calculate strength value
-    for (size_t i = 0; i < n; ++i)
-      for (size_t j = 0; j < n; ++j)
-        if (dominance->compareSolutions(i, j) == -1)
-          strength[i] += 1.0;
-
-    // calculate raw fitness
-    for (size_t i = 0; i < n; ++i)
-      for (size_t j = 0; j < n; ++j)
-        if (dominance->compareSolutions(i, j) == 1)
-          rawFitness[i] += strength[j];
+    // strength and raw fitness values
+    std::vector<double> strength, rawFitness;
+    DensityEstimation::computeStrengthsAndRawFitnesses(data, n, numObjectives, strength, rawFitness);
 
     // Add the distance to the k-th individual. In the reference paper of SPEA2, 
     // k = sqrt(population.size()), but a value of k = 1 recommended. See
     // http://www.tik.ee.ethz.ch/pisa/selectors/spea2/spea2_documentation.txt
+    // The distances are measured between the solutions, that are DenseDoubleVectors.
     size_t k = 1;
-    double kDistance = 0.0;
-    for (size_t i = 0; i < n; ++i)
-    {
-      std::sort(distance[i], distance[i] + n);
-      kDistance = 1.0 / (distance[i][k] + 2.0);
-      fitness[i] = rawFitness[i] + kDistance;
-    }
-    
-    delete[] strength;
-    delete[] rawFitness;
+    std::vector<double> distance;
+    std::vector<double> solutionPoints;
+    size_t numDimensions = getSolutionPoints(solutions, solutionPoints);
+    DensityEstimation::computeNearestNeighbourDistances(solutionPoints.size() ? &solutionPoints[0] : NULL, n, numDimensions, k, distance);
+    fitness.resize(n);
     for (size_t i = 0; i < n; ++i)
-      delete[] distance[i];
-    delete[] distance;
+      fitness[i] = rawFitness[i] + 1.0 / (distance[i] + 2.0);
   }
 
   virtual int compareSolutions(size_t index1, size_t index2)
@@ -78,15 +55,21 @@ public:
 protected:
   std::vector<double> fitness;
 
-  void calculateDistanceMatrix(const SolutionContainerPtr& solutions, double** matrix)
+  // packs the solutions row by row and returns their dimension
+  static size_t getSolutionPoints(const SolutionContainerPtr& solutions, std::vector<double>& res)
   {
-    for (size_t i = 0; i < solutions->getNumSolutions(); ++i)
-      for (size_t j = i; j < solutions->getNumSolutions(); ++j)
-      {
-        matrix[i][j] = solutions->getSolution(i).staticCast<DenseDoubleVector>()->distanceTo(solutions->getSolution(j).staticCast<DenseDoubleVector>());
-        matrix[j][i] = matrix[i][j];
-      }
+    size_t n = solutions->getNumSolutions();
+    size_t numDimensions = n ? solutions->getSolution(0).staticCast<DenseDoubleVector>()->getNumValues() : 0;
+    res.resize(n * numDimensions);
+    for (size_t i = 0; i < n; ++i)
+    {
+      const std::vector<double>& values = solutions->getSolution(i).staticCast<DenseDoubleVector>()->getValues();
+      jassert(values.size() >= numDimensions);
+      std::copy(values.begin(), values.begin() + numDimensions, res.begin() + i * numDimensions);
+    }
+    return numDimensions;
   }
+
 };
 
 } /* namespace lbcpp */
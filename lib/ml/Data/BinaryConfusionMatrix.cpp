@@ -8,6 +8,7 @@
 #include "precompiled.h"
 #include <ml/BinaryConfusionMatrix.h>
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Core/DefaultClass.h>
 #include <oil/Core/Integer.h>
 using namespace lbcpp;
@@ -201,6 +202,24 @@ bool BinaryConfusionMatrix::loadFromXml(XmlImporter& importer)
   return true;
 }
 
+void BinaryConfusionMatrix::saveToBinary(BinaryExporter& exporter) const
+{
+  exporter.writeSize(truePositive);
+  exporter.writeSize(falsePositive);
+  exporter.writeSize(falseNegative);
+  exporter.writeSize(trueNegative);
+}
+
+bool BinaryConfusionMatrix::loadFromBinary(BinaryImporter& importer)
+{
+  truePositive = importer.readSize();
+  falsePositive = importer.readSize();
+  falseNegative = importer.readSize();
+  trueNegative = importer.readSize();
+  totalCount = truePositive + falsePositive + falseNegative + trueNegative;
+  return importer.isOk();
+}
+
 bool BinaryConfusionMatrix::operator ==(const BinaryConfusionMatrix& other) const
 {
   return truePositive == other.truePositive && falsePositive == other.falsePositive && 
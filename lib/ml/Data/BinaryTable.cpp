@@ -0,0 +1,556 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: BinaryTable.cpp                | Binary columnar Table format    |
+| Author  : Francis Maes                   |                                 |
+| Started : 16/10/2026 21:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <ml/BinaryTable.h>
+#include <ml/Expression.h>
+#include <oil/Core/Enumeration.h>
+#include <oil/Core/ClassManager.h>
+
+#ifdef JUCE_WIN32
+# include <windows.h>
+# pragma warning(disable:4996) // microsoft visual does not like fopen()/fclose()
+#else // linux or macos x
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif // JUCE_WIN32
+using namespace lbcpp;
+
+/*
+** File layout
+**
+** header    : magic, version, byte order mark, numRows, numColumns, directory size, data offset
+** directory : for each column, its key, its type, its storage and the offset of its data
+** data      : one block per column, each aligned on 64 bytes
+**
+** Integers in the header and in the directory, as well as the column data, are written in
+** the native byte order. The byte order mark is used to reject files written on a machine
+** with a different one.
+*/
+namespace lbcpp
+{
+
+static const char binaryTableMagic[8] = {'L', 'B', 'C', 'P', 'P', 'T', 'B', 'L'};
+static const juce::uint32 binaryTableVersion = 1;
+static const juce::uint32 binaryTableByteOrderMark = 0x01020304;
+static const size_t binaryTableAlignment = 64;
+
+struct BinaryTableHeader
+{
+  char magic[8];
+  juce::uint32 version;
+  juce::uint32 byteOrderMark;
+  juce::uint64 numRows;
+  juce::uint64 numColumns;
+  juce::uint64 directorySize;
+  juce::uint64 dataOffset;
+};
+
+enum BinaryTableKeyKind
+{
+  stringKey = 0,
+  variableExpressionKey
+};
+
+enum BinaryTableTypeKind
+{
+  namedType = 0,
+  inlineEnumerationType
+};
+
+static inline size_t alignBinaryTableOffset(size_t offset)
+  {return (offset + binaryTableAlignment - 1) & ~(binaryTableAlignment - 1);}
+
+/*
+** Directory writing / reading
+*/
+struct BinaryTableDirectoryWriter
+{
+  std::vector<char> buffer;
+
+  void write(const void* data, size_t size)
+    {buffer.insert(buffer.end(), (const char* )data, (const char* )data + size);}
+
+  void writeByte(unsigned char value)
+    {write(&value, 1);}
+
+  void writeUInt64(juce::uint64 value)
+    {write(&value, sizeof (value));}
+
+  void writeString(const string& value)
+  {
+    const char* utf8 = value.toUTF8();
+    size_t length = strlen(utf8);
+    writeUInt64(length);
+    write(utf8, length);
+  }
+};
+
+struct BinaryTableDirectoryReader
+{
+  BinaryTableDirectoryReader(const char* ptr, size_t size)
+    : ptr(ptr), end(ptr + size), ok(true) {}
+
+  const char* ptr;
+  const char* end;
+  bool ok;
+
+  bool read(void* data, size_t size)
+  {
+    if (!ok || (size_t)(end - ptr) < size)
+      return (ok = false);
+    memcpy(data, ptr, size);
+    ptr += size;
+    return true;
+  }
+
+  unsigned char readByte()
+    {unsigned char res = 0; read(&res, 1); return res;}
+
+  juce::uint64 readUInt64()
+    {juce::uint64 res = 0; read(&res, sizeof (res)); return res;}
+
+  string readString()
+  {
+    juce::uint64 length = readUInt64();
+    if (!ok || (juce::uint64)(end - ptr) < length)
+    {
+      ok = false;
+      return string::empty;
+    }
+    string res = string::fromUTF8((const juce::uint8* )ptr, (int)length);
+    ptr += length;
+    return res;
+  }
+};
+
+static bool getBinaryTableStorage(const ClassPtr& type, BinaryTable::Storage& res)
+{
+  if (type->inheritsFrom(booleanClass))
+    res = BinaryTable::booleanStorage;
+  else if (type->inheritsFrom(integerClass))
+    res = BinaryTable::integerStorage;
+  else if (type->inheritsFrom(doubleClass))
+    res = BinaryTable::doubleStorage;
+  else if (type->inheritsFrom(stringClass))
+    res = BinaryTable::stringStorage;
+  else
+    return false;
+  return true;
+}
+
+static size_t getBinaryTableColumnSize(BinaryTable::Storage storage, const VectorPtr& data, size_t numRows)
+{
+  switch (storage)
+  {
+  case BinaryTable::doubleStorage: return numRows * sizeof (double);
+  case BinaryTable::integerStorage: return numRows * sizeof (juce::int64);
+  case BinaryTable::booleanStorage: return numRows;
+  case BinaryTable::stringStorage:
+    {
+      const SVectorPtr& strings = data.staticCast<SVector>();
+      size_t res = (numRows + 1) * sizeof (juce::uint64);
+      for (size_t i = 0; i < numRows; ++i)
+        res += strlen(strings->get(i).toUTF8());
+      return res;
+    }
+  default:
+    jassertfalse;
+    return 0;
+  };
+}
+
+static bool writeBinaryTableColumn(FILE* f, BinaryTable::Storage storage, const VectorPtr& data, size_t numRows)
+{
+  if (!numRows)
+    return true;
+  switch (storage)
+  {
+  case BinaryTable::doubleStorage:
+    return fwrite(data.staticCast<DVector>()->getDataPointer(), sizeof (double), numRows, f) == numRows;
+  case BinaryTable::integerStorage:
+    return fwrite(data.staticCast<IVector>()->getDataPointer(), sizeof (juce::int64), numRows, f) == numRows;
+  case BinaryTable::booleanStorage:
+    return fwrite(data.staticCast<BVector>()->getDataPointer(), 1, numRows, f) == numRows;
+  case BinaryTable::stringStorage:
+    {
+      const SVectorPtr& strings = data.staticCast<SVector>();
+      std::vector<juce::uint64> offsets(numRows + 1);
+      offsets[0] = 0;
+      for (size_t i = 0; i < numRows; ++i)
+        offsets[i + 1] = offsets[i] + strlen(strings->get(i).toUTF8());
+      if (fwrite(&offsets[0], sizeof (juce::uint64), offsets.size(), f) != offsets.size())
+        return false;
+      for (size_t i = 0; i < numRows; ++i)
+      {
+        const char* utf8 = strings->get(i).toUTF8();
+        size_t length = (size_t)(offsets[i + 1] - offsets[i]);
+        if (length && fwrite(utf8, 1, length, f) != length)
+          return false;
+      }
+      return true;
+    }
+  default:
+    jassertfalse;
+    return false;
+  };
+}
+
+static bool writeBinaryTablePadding(FILE* f, size_t size)
+{
+  static const char zeros[binaryTableAlignment] = {0};
+  return !size || fwrite(zeros, 1, size, f) == size;
+}
+
+/*
+** Memory mapping
+*/
+struct BinaryTable::Mapping
+{
+  Mapping() : data(NULL), size(0)
+#ifdef JUCE_WIN32
+    , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL)
+#endif // JUCE_WIN32
+    {}
+
+  ~Mapping()
+  {
+#ifdef JUCE_WIN32
+    if (data)
+      UnmapViewOfFile(data);
+    if (mappingHandle)
+      CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+      CloseHandle(fileHandle);
+#else // linux or macos x
+    if (data)
+      munmap((void* )data, size);
+#endif // JUCE_WIN32
+  }
+
+  const char* data;
+  size_t size;
+#ifdef JUCE_WIN32
+  HANDLE fileHandle;
+  HANDLE mappingHandle;
+#endif // JUCE_WIN32
+
+  bool open(const juce::File& file)
+  {
+#ifdef JUCE_WIN32
+    fileHandle = CreateFileW(file.getFullPathName(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+      return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+      return false;
+    size = (size_t)fileSize.QuadPart;
+    mappingHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mappingHandle)
+      return false;
+    data = (const char* )MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    return data != NULL;
+#else // linux or macos x
+    int fd = ::open(file.getFullPathName().toUTF8(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+      close(fd);
+      return false;
+    }
+    size = (size_t)st.st_size;
+    void* ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps its own reference on the file
+    if (ptr == MAP_FAILED)
+      return false;
+    data = (const char* )ptr;
+    return true;
+#endif // JUCE_WIN32
+  }
+};
+
+}; /* namespace lbcpp */
+
+/*
+** BinaryTable
+*/
+BinaryTable::BinaryTable(Mapping* mapping)
+  : mapping(mapping), numRows(0) {}
+
+BinaryTable::~BinaryTable()
+  {delete mapping;}
+
+bool BinaryTable::isBinaryTableFile(juce::InputStream& istr)
+{
+  juce::int64 position = istr.getPosition();
+  char magic[sizeof (binaryTableMagic)];
+  bool res = istr.read(magic, sizeof (magic)) == (int)sizeof (magic) && !memcmp(magic, binaryTableMagic, sizeof (magic));
+  istr.setPosition(position);
+  return res;
+}
+
+bool BinaryTable::save(ExecutionContext& context, const TablePtr& table, const juce::File& file)
+{
+  size_t numRows = table->getNumRows();
+  size_t numColumns = table->getNumColumns();
+
+  // build directory
+  BinaryTableDirectoryWriter directory;
+  std::vector<Storage> storages(numColumns);
+  std::vector<size_t> offsets(numColumns);
+  size_t offset = 0;
+  for (size_t i = 0; i < numColumns; ++i)
+  {
+    ObjectPtr key = table->getKey(i);
+    ClassPtr type = table->getType(i);
+    if (!getBinaryTableStorage(type, storages[i]))
+    {
+      context.errorCallback(T("BinaryTable::save"), T("Unsupported type for column ") + table->getDescription(i).quoted() + T(": ") + type->getName());
+      return false;
+    }
+
+    VariableExpressionPtr variable = key.dynamicCast<VariableExpression>();
+    if (variable)
+    {
+      directory.writeByte(variableExpressionKey);
+      directory.writeString(variable->toShortString());
+      directory.writeUInt64(variable->getInputIndex());
+    }
+    else
+    {
+      directory.writeByte(stringKey);
+      directory.writeString(key->toShortString());
+    }
+
+    DefaultEnumerationPtr enumeration = type.dynamicCast<DefaultEnumeration>();
+    if (typeManager().findType(type->getName()) == type || !enumeration)
+    {
+      directory.writeByte(namedType);
+      directory.writeString(type->getName());
+    }
+    else
+    {
+      directory.writeByte(inlineEnumerationType);
+      directory.writeString(enumeration->getName());
+      directory.writeUInt64(enumeration->getNumElements());
+      for (size_t j = 0; j < enumeration->getNumElements(); ++j)
+        directory.writeString(enumeration->getElement(j)->getName());
+    }
+
+    directory.writeByte((unsigned char)storages[i]);
+    offsets[i] = offset;
+    directory.writeUInt64(offset);
+    offset = alignBinaryTableOffset(offset + getBinaryTableColumnSize(storages[i], table->getData(i), numRows));
+  }
+
+  BinaryTableHeader header;
+  memcpy(header.magic, binaryTableMagic, sizeof (binaryTableMagic));
+  header.version = binaryTableVersion;
+  header.byteOrderMark = binaryTableByteOrderMark;
+  header.numRows = numRows;
+  header.numColumns = numColumns;
+  header.directorySize = directory.buffer.size();
+  header.dataOffset = alignBinaryTableOffset(sizeof (header) + directory.buffer.size());
+
+  // write file
+  FILE* f = fopen(file.getFullPathName().toUTF8(), "wb");
+  if (!f)
+  {
+    context.errorCallback(T("BinaryTable::save"), T("Could not open file ") + file.getFullPathName());
+    return false;
+  }
+  bool ok = fwrite(&header, sizeof (header), 1, f) == 1 &&
+    (directory.buffer.empty() || fwrite(&directory.buffer[0], 1, directory.buffer.size(), f) == directory.buffer.size()) &&
+    writeBinaryTablePadding(f, (size_t)header.dataOffset - sizeof (header) - directory.buffer.size());
+  size_t position = 0;
+  for (size_t i = 0; ok && i < numColumns; ++i)
+  {
+    ok = writeBinaryTablePadding(f, offsets[i] - position) &&
+      writeBinaryTableColumn(f, storages[i], table->getData(i), numRows);
+    position = offsets[i] + getBinaryTableColumnSize(storages[i], table->getData(i), numRows);
+  }
+  if (fclose(f) != 0)
+    ok = false;
+  if (!ok)
+    context.errorCallback(T("BinaryTable::save"), T("Could not write file ") + file.getFullPathName());
+  return ok;
+}
+
+BinaryTablePtr BinaryTable::open(ExecutionContext& context, const juce::File& file)
+{
+  Mapping* mapping = new Mapping();
+  if (!mapping->open(file))
+  {
+    delete mapping;
+    context.errorCallback(T("BinaryTable::open"), T("Could not map file ") + file.getFullPathName());
+    return BinaryTablePtr();
+  }
+  BinaryTablePtr res = new BinaryTable(mapping);
+  if (!res->readDirectory(context, file.getFullPathName()))
+    return BinaryTablePtr();
+  return res;
+}
+
+bool BinaryTable::readDirectory(ExecutionContext& context, const string& fileName)
+{
+  BinaryTableHeader header;
+  if (mapping->size < sizeof (header))
+  {
+    context.errorCallback(T("BinaryTable::open"), fileName + T(" is not a binary table file"));
+    return false;
+  }
+  memcpy(&header, mapping->data, sizeof (header));
+  if (memcmp(header.magic, binaryTableMagic, sizeof (binaryTableMagic)))
+  {
+    context.errorCallback(T("BinaryTable::open"), fileName + T(" is not a binary table file"));
+    return false;
+  }
+  if (header.version != binaryTableVersion)
+  {
+    context.errorCallback(T("BinaryTable::open"), T("Unsupported binary table version: ") + string((int)header.version));
+    return false;
+  }
+  if (header.byteOrderMark != binaryTableByteOrderMark)
+  {
+    context.errorCallback(T("BinaryTable::open"), fileName + T(" was written with a different byte order"));
+    return false;
+  }
+  if (header.dataOffset > mapping->size || sizeof (header) + header.directorySize > header.dataOffset)
+  {
+    context.errorCallback(T("BinaryTable::open"), fileName + T(" is truncated"));
+    return false;
+  }
+
+  numRows = (size_t)header.numRows;
+  columns.resize((size_t)header.numColumns);
+  const char* data = mapping->data + header.dataOffset;
+  size_t dataSize = mapping->size - (size_t)header.dataOffset;
+  BinaryTableDirectoryReader reader(mapping->data + sizeof (header), (size_t)header.directorySize);
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    Column& column = columns[i];
+
+    // key
+    unsigned char keyKind = reader.readByte();
+    string keyName = reader.readString();
+    size_t inputIndex = keyKind == variableExpressionKey ? (size_t)reader.readUInt64() : 0;
+
+    // type
+    unsigned char typeKind = reader.readByte();
+    string typeName = reader.readString();
+    if (!reader.ok)
+      break;
+    if (typeKind == inlineEnumerationType)
+    {
+      DefaultEnumerationPtr enumeration = new DefaultEnumeration(typeName);
+      size_t numElements = (size_t)reader.readUInt64();
+      for (size_t j = 0; reader.ok && j < numElements; ++j)
+        enumeration->findOrAddElement(context, reader.readString());
+      column.type = enumeration;
+    }
+    else
+    {
+      column.type = typeManager().getType(context, typeName);
+      if (!column.type)
+        return false;
+    }
+
+    if (keyKind == variableExpressionKey)
+      column.key = new VariableExpression(column.type, keyName, inputIndex);
+    else
+      column.key = new String(keyName);
+
+    // data
+    column.storage = (Storage)reader.readByte();
+    size_t offset = (size_t)reader.readUInt64();
+    Storage expectedStorage;
+    if (!reader.ok || !getBinaryTableStorage(column.type, expectedStorage) || expectedStorage != column.storage)
+    {
+      context.errorCallback(T("BinaryTable::open"), T("Invalid storage for column ") + keyName.quoted());
+      return false;
+    }
+    size_t elementSize = column.storage == doubleStorage ? sizeof (double) :
+      (column.storage == integerStorage ? sizeof (juce::int64) :
+      (column.storage == booleanStorage ? 1 : sizeof (juce::uint64)));
+    size_t minimumSize = (numRows + (column.storage == stringStorage ? 1 : 0)) * elementSize;
+    if (offset > dataSize || dataSize - offset < minimumSize)
+    {
+      context.errorCallback(T("BinaryTable::open"), fileName + T(" is truncated"));
+      return false;
+    }
+    column.data = data + offset;
+    if (column.storage == stringStorage)
+    {
+      const juce::uint64* offsets = (const juce::uint64* )column.data;
+      if (offsets[numRows] > dataSize - offset - minimumSize)
+      {
+        context.errorCallback(T("BinaryTable::open"), fileName + T(" is truncated"));
+        return false;
+      }
+    }
+  }
+  if (!reader.ok)
+  {
+    context.errorCallback(T("BinaryTable::open"), T("Invalid column directory in ") + fileName);
+    return false;
+  }
+  return true;
+}
+
+const char* BinaryTable::getString(size_t columnIndex, size_t rowIndex, size_t& length) const
+{
+  jassert(getStorage(columnIndex) == stringStorage && rowIndex < numRows);
+  const juce::uint64* offsets = (const juce::uint64* )columns[columnIndex].data;
+  length = (size_t)(offsets[rowIndex + 1] - offsets[rowIndex]);
+  return (const char* )(offsets + numRows + 1) + offsets[rowIndex];
+}
+
+string BinaryTable::getString(size_t columnIndex, size_t rowIndex) const
+{
+  size_t length;
+  const char* str = getString(columnIndex, rowIndex, length);
+  return string::fromUTF8((const juce::uint8* )str, (int)length);
+}
+
+TablePtr BinaryTable::createTable(ExecutionContext& context) const
+{
+  TablePtr res = new Table(numRows);
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    const Column& column = columns[i];
+    res->addColumn(column.key, column.type);
+    VectorPtr data = res->getData(i);
+    if (!numRows)
+      continue;
+    switch (column.storage)
+    {
+    case doubleStorage:
+      memcpy(data.staticCast<DVector>()->getDataPointer(), column.data, numRows * sizeof (double));
+      break;
+    case integerStorage:
+      memcpy(data.staticCast<IVector>()->getDataPointer(), column.data, numRows * sizeof (juce::int64));
+      break;
+    case booleanStorage:
+      memcpy(data.staticCast<BVector>()->getDataPointer(), column.data, numRows);
+      break;
+    case stringStorage:
+      {
+        const SVectorPtr& strings = data.staticCast<SVector>();
+        for (size_t j = 0; j < numRows; ++j)
+          strings->set(j, getString(i, j));
+      }
+      break;
+    default:
+      jassertfalse;
+    };
+  }
+  return res;
+}
@@ -7,8 +7,10 @@
                                `--------------------------------------------*/
 #include "precompiled.h"
 #include <ml/DoubleVector.h>
+#include <ml/DoubleVectorKernels.h>
 #include <oil/Lua/Lua.h>
 #include <oil/Core/Double.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Execution/ExecutionContext.h>
 #include "FeatureGeneratorCallbacks.hpp"
 using namespace lbcpp;
@@ -545,6 +547,35 @@ bool SparseDoubleVector::loadFromXml(XmlImporter& importer)
   return true;
 }
 
+void SparseDoubleVector::saveToBinary(BinaryExporter& exporter) const
+{
+  Object::saveToBinary(exporter);
+  size_t n = values.size();
+  exporter.writeSize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    exporter.writeSize(values[i].first);
+    exporter.writeDouble(values[i].second);
+  }
+}
+
+bool SparseDoubleVector::loadFromBinary(BinaryImporter& importer)
+{
+  if (!Object::loadFromBinary(importer))
+    return false;
+  size_t n;
+  if (!importer.readNumElements(n, sizeof (juce::int64) + sizeof (double)))
+    return false;
+  values.resize(n);
+  for (size_t i = 0; i < values.size() && importer.isOk(); ++i)
+  {
+    values[i].first = importer.readSize();
+    values[i].second = importer.readDouble();
+  }
+  updateLastIndex();
+  return importer.isOk();
+}
+
 size_t SparseDoubleVector::getSizeInBytes(bool recursively) const
 {
   size_t res = Object::getSizeInBytes(recursively);
@@ -634,26 +665,15 @@ void SparseDoubleVector::addWeightedTo(const DenseDoubleVectorPtr& denseVector,
     return;
   denseVector->ensureSize(offsetInDenseVector + (size_t)(lastIndex + 1));
   double* target = denseVector->getValuePointer(offsetInDenseVector);
-  for (size_t i = 0; i < values.size(); ++i)
-    target[values[i].first] += values[i].second * weight;
+  DoubleVectorKernels::sparseAddWeighted(target, &values[0], values.size(), weight);
 }
 
 double SparseDoubleVector::dotProduct(const DenseDoubleVectorPtr& denseVector, size_t offsetInDenseVector) const
 {
-  double res = 0.0;
-  if (denseVector->getNumValues())
-  {
-    const double* target = denseVector->getValuePointer(offsetInDenseVector);
-    size_t n = denseVector->getNumValues();
-    for (size_t i = 0; i < values.size(); ++i)
-    {
-      size_t index = values[i].first;
-      if (index >= n)
-        break;
-      res += target[index] * values[i].second;
-    }
-  }
-  return res;
+  if (!denseVector->getNumValues() || values.empty())
+    return 0.0;
+  const double* target = denseVector->getValuePointer(offsetInDenseVector);
+  return DoubleVectorKernels::sparseDotProduct(&values[0], values.size(), target, denseVector->getNumValues());
 }
 
 void SparseDoubleVector::computeFeatures(FeatureGeneratorCallback& callback) const
@@ -959,6 +979,27 @@ bool DenseDoubleVector::loadFromXml(XmlImporter& importer)
   return ok;
 }
 
+void DenseDoubleVector::saveToBinary(BinaryExporter& exporter) const
+{
+  Object::saveToBinary(exporter);
+  size_t n = getNumValues();
+  exporter.writeSize(n);
+  if (n)
+    exporter.writeBlock(getValuePointer(0), n * sizeof (double));
+}
+
+bool DenseDoubleVector::loadFromBinary(BinaryImporter& importer)
+{
+  if (!Object::loadFromBinary(importer))
+    return false;
+  size_t n;
+  if (!importer.readNumElements(n, sizeof (double)))
+    return false;
+  ensureSize(n);
+  values->resize(n);
+  return !n || importer.readBlock(getValuePointer(0), n * sizeof (double));
+}
+
 size_t DenseDoubleVector::getSizeInBytes(bool recursively) const
 {
   size_t res = Object::getSizeInBytes(recursively);
@@ -999,10 +1040,12 @@ void DenseDoubleVector::multiplyByScalar(double value)
 
 double DenseDoubleVector::computeLogSumOfExponentials() const
 {
-  double highestValue = getMaximumValue();
+  size_t n = getNumValues();
+  const double* source = n ? getValuePointer(0) : NULL;
+  double highestValue = DoubleVectorKernels::maximum(source, n);
   double res = 0.0;
-  for (size_t i = 0; i < values->size(); ++i)
-    res += exp((*values)[i] - highestValue);
+  for (size_t i = 0; i < n; ++i)
+    res += exp(source[i] - highestValue);
   return log(res) + highestValue;
 }
 
@@ -1032,11 +1075,9 @@ double DenseDoubleVector::computeEntropy(double l1norm) const
 
 double DenseDoubleVector::distanceTo(const DenseDoubleVectorPtr& other) const
 {
-  jassert(this->getNumValues() == other->getNumValues());
-  double distance = 0.0;
-  for (size_t i = 0; i < this->getNumValues(); ++i)
-    distance += (this->getValue(i) - other->getValue(i)) * (this->getValue(i) - other->getValue(i));
-  return sqrt(distance);
+  size_t n = getNumValues();
+  jassert(n == other->getNumValues());
+  return n ? sqrt(DoubleVectorKernels::squaredDistance(getValuePointer(0), other->getValuePointer(0), n)) : 0.0;
 }
 
 // DoubleVector
@@ -1050,7 +1091,7 @@ double DenseDoubleVector::l1norm() const
   {return values ? defaultL1Norm(*this) : 0.0;}
 
 double DenseDoubleVector::sumOfSquares() const
-  {return values ? defaultSumOfSquares(*this) : 0.0;}
+  {return values && values->size() ? DoubleVectorKernels::sumOfSquares(getValuePointer(0), values->size()) : 0.0;}
 
 double DenseDoubleVector::getExtremumValue(bool lookForMaximum, size_t* index) const
   {return defaultGetExtremumValue(*this, lookForMaximum, index);}
@@ -1082,36 +1123,18 @@ void DenseDoubleVector::addWeightedTo(const SparseDoubleVectorPtr& sparseVector,
 
 void DenseDoubleVector::addWeightedTo(const DenseDoubleVectorPtr& denseVector, size_t offsetInDenseVector, double weight) const
 {
-  if (values)
+  if (values && values->size())
   {
     denseVector->ensureSize(offsetInDenseVector + values->size());
-    double* target = denseVector->getValuePointer(offsetInDenseVector);
-    const double* source = getValuePointer(0);
-    const double* limit = getValuePointer(values->size());
-    while (source < limit)
-    {
-      *target += weight * (*source);
-      ++source;
-      ++target;
-    }
+    DoubleVectorKernels::addWeighted(denseVector->getValuePointer(offsetInDenseVector), getValuePointer(0), values->size(), weight);
   }
 }
 
 double DenseDoubleVector::dotProduct(const DenseDoubleVectorPtr& denseVector, size_t offsetInDenseVector) const
 {
-  if (!values || !denseVector->values)
+  if (!values || !denseVector->values || values->empty())
     return 0.0;
-  const double* target = denseVector->getValuePointer(offsetInDenseVector);
-  const double* source = getValuePointer(0);
-  const double* limit = getValuePointer(values->size());
-  double res = 0.0;
-  while (source < limit)
-  {
-    res += (*source) * (*target);
-    ++source;
-    ++target;
-  }
-  return res;
+  return DoubleVectorKernels::dotProduct(getValuePointer(0), denseVector->getValuePointer(offsetInDenseVector), values->size());
 }
 
 void DenseDoubleVector::computeFeatures(FeatureGeneratorCallback& callback) const
@@ -1147,11 +1170,8 @@ double DenseDoubleVector::l2norm(const DoubleVectorPtr& vector) const
   else if (vector.isInstanceOf<DenseDoubleVector> ())
   {
     DenseDoubleVectorPtr tmpVector = vector;
-    for (size_t i = 0; i < numElements; i++)
-    {
-      const double diff = (*values)[i] - (*(tmpVector->values))[i];
-      distance += diff * diff;
-    }
+    if (numElements)
+      distance = DoubleVectorKernels::squaredDistance(getValuePointer(0), tmpVector->getValuePointer(0), numElements);
   }
   else
   {
@@ -1487,3 +1507,32 @@ void CompositeDoubleVector::saveToXml(XmlExporter& exporter) const
     exporter.leave();
   }
 }
+
+bool CompositeDoubleVector::loadFromBinary(BinaryImporter& importer)
+{
+  size_t n;
+  if (!importer.readNumElements(n, sizeof (juce::int64) + 1))
+    return false;
+  vectors.resize(n);
+  for (size_t i = 0; i < vectors.size() && importer.isOk(); ++i)
+  {
+    vectors[i].first = importer.readSize();
+    vectors[i].second = importer.readObject(doubleVectorClass()).staticCast<DoubleVector>();
+    if (!vectors[i].second)
+    {
+      importer.errorMessage(T("CompositeDoubleVector::loadFromBinary"), T("Could not read sub vector"));
+      return false;
+    }
+  }
+  return importer.isOk();
+}
+
+void CompositeDoubleVector::saveToBinary(BinaryExporter& exporter) const
+{
+  exporter.writeSize(vectors.size());
+  for (size_t i = 0; i < vectors.size(); ++i)
+  {
+    exporter.writeSize(vectors[i].first);
+    exporter.writeObject(vectors[i].second, doubleVectorClass());
+  }
+}
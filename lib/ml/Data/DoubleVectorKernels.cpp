@@ -0,0 +1,420 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: DoubleVectorKernels.cpp        | Low-level kernels on arrays     |
+| Author  : Francis Maes                   |  of doubles                     |
+| Started : 16/10/2026 14:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <ml/DoubleVectorKernels.h>
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define LBCPP_KERNELS_SSE2
+# include <emmintrin.h>
+#endif // SSE2
+
+#if defined(LBCPP_KERNELS_SSE2) && (defined(__x86_64__) || defined(__i386__)) && \
+  (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+# define LBCPP_KERNELS_AVX2
+# include <immintrin.h>
+# define LBCPP_KERNELS_AVX2_FUNCTION __attribute__((target("avx2")))
+#endif // AVX2
+
+using namespace lbcpp;
+
+namespace lbcpp
+{
+
+/*
+** Generic implementation
+*/
+struct GenericDoubleVectorKernels
+{
+  static double dotProduct(const double* a, const double* b, size_t n)
+  {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+      s0 += a[i] * b[i];
+      s1 += a[i + 1] * b[i + 1];
+      s2 += a[i + 2] * b[i + 2];
+      s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i)
+      s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  static void addWeighted(double* target, const double* source, size_t n, double weight)
+  {
+    for (size_t i = 0; i < n; ++i)
+      target[i] += weight * source[i];
+  }
+
+  static double sumOfSquares(const double* values, size_t n)
+    {return dotProduct(values, values, n);}
+
+  static double squaredDistance(const double* a, const double* b, size_t n)
+  {
+    double s0 = 0.0, s1 = 0.0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+      double d0 = a[i] - b[i];
+      double d1 = a[i + 1] - b[i + 1];
+      s0 += d0 * d0;
+      s1 += d1 * d1;
+    }
+    for (; i < n; ++i)
+    {
+      double d = a[i] - b[i];
+      s0 += d * d;
+    }
+    return s0 + s1;
+  }
+
+  static double maximum(const double* values, size_t n)
+  {
+    double res = -DBL_MAX;
+    for (size_t i = 0; i < n; ++i)
+      if (values[i] > res)
+        res = values[i];
+    return res;
+  }
+};
+
+/*
+** SSE2 implementation
+*/
+#ifdef LBCPP_KERNELS_SSE2
+struct SSE2DoubleVectorKernels
+{
+  static double horizontalSum(__m128d v)
+  {
+    double tmp[2];
+    _mm_storeu_pd(tmp, v);
+    return tmp[0] + tmp[1];
+  }
+
+  static double dotProduct(const double* a, const double* b, size_t n)
+  {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+      s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+      s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double res = horizontalSum(_mm_add_pd(s0, s1));
+    for (; i < n; ++i)
+      res += a[i] * b[i];
+    return res;
+  }
+
+  static void addWeighted(double* target, const double* source, size_t n, double weight)
+  {
+    __m128d w = _mm_set1_pd(weight);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+      _mm_storeu_pd(target + i, _mm_add_pd(_mm_loadu_pd(target + i), _mm_mul_pd(w, _mm_loadu_pd(source + i))));
+    for (; i < n; ++i)
+      target[i] += weight * source[i];
+  }
+
+  static double sumOfSquares(const double* values, size_t n)
+  {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128d v0 = _mm_loadu_pd(values + i);
+      __m128d v1 = _mm_loadu_pd(values + i + 2);
+      s0 = _mm_add_pd(s0, _mm_mul_pd(v0, v0));
+      s1 = _mm_add_pd(s1, _mm_mul_pd(v1, v1));
+    }
+    double res = horizontalSum(_mm_add_pd(s0, s1));
+    for (; i < n; ++i)
+      res += values[i] * values[i];
+    return res;
+  }
+
+  static double squaredDistance(const double* a, const double* b, size_t n)
+  {
+    __m128d s0 = _mm_setzero_pd();
+    __m128d s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+      __m128d d0 = _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+      __m128d d1 = _mm_sub_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2));
+      s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+      s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+    }
+    double res = horizontalSum(_mm_add_pd(s0, s1));
+    for (; i < n; ++i)
+    {
+      double d = a[i] - b[i];
+      res += d * d;
+    }
+    return res;
+  }
+
+  static double maximum(const double* values, size_t n)
+  {
+    // _mm_max_pd(x, m) returns m when x is NaN, so NaNs are ignored as in the generic implementation
+    __m128d m = _mm_set1_pd(-DBL_MAX);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+      m = _mm_max_pd(_mm_loadu_pd(values + i), m);
+    double tmp[2];
+    _mm_storeu_pd(tmp, m);
+    double res = tmp[0] > tmp[1] ? tmp[0] : tmp[1];
+    for (; i < n; ++i)
+      if (values[i] > res)
+        res = values[i];
+    return res;
+  }
+};
+#endif // LBCPP_KERNELS_SSE2
+
+/*
+** AVX2 implementation
+*/
+#ifdef LBCPP_KERNELS_AVX2
+struct AVX2DoubleVectorKernels
+{
+  LBCPP_KERNELS_AVX2_FUNCTION static double horizontalSum(__m256d v)
+  {
+    double tmp[4];
+    _mm256_storeu_pd(tmp, v);
+    return (tmp[0] + tmp[1]) + (tmp[2] + tmp[3]);
+  }
+
+  LBCPP_KERNELS_AVX2_FUNCTION static double dotProduct(const double* a, const double* b, size_t n)
+  {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+      s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+      s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    double res = horizontalSum(_mm256_add_pd(s0, s1));
+    for (; i < n; ++i)
+      res += a[i] * b[i];
+    return res;
+  }
+
+  LBCPP_KERNELS_AVX2_FUNCTION static void addWeighted(double* target, const double* source, size_t n, double weight)
+  {
+    __m256d w = _mm256_set1_pd(weight);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+      _mm256_storeu_pd(target + i, _mm256_add_pd(_mm256_loadu_pd(target + i), _mm256_mul_pd(w, _mm256_loadu_pd(source + i))));
+    for (; i < n; ++i)
+      target[i] += weight * source[i];
+  }
+
+  LBCPP_KERNELS_AVX2_FUNCTION static double sumOfSquares(const double* values, size_t n)
+  {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256d v0 = _mm256_loadu_pd(values + i);
+      __m256d v1 = _mm256_loadu_pd(values + i + 4);
+      s0 = _mm256_add_pd(s0, _mm256_mul_pd(v0, v0));
+      s1 = _mm256_add_pd(s1, _mm256_mul_pd(v1, v1));
+    }
+    double res = horizontalSum(_mm256_add_pd(s0, s1));
+    for (; i < n; ++i)
+      res += values[i] * values[i];
+    return res;
+  }
+
+  LBCPP_KERNELS_AVX2_FUNCTION static double squaredDistance(const double* a, const double* b, size_t n)
+  {
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+      __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+      __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+      s0 = _mm256_add_pd(s0, _mm256_mul_pd(d0, d0));
+      s1 = _mm256_add_pd(s1, _mm256_mul_pd(d1, d1));
+    }
+    double res = horizontalSum(_mm256_add_pd(s0, s1));
+    for (; i < n; ++i)
+    {
+      double d = a[i] - b[i];
+      res += d * d;
+    }
+    return res;
+  }
+
+  LBCPP_KERNELS_AVX2_FUNCTION static double maximum(const double* values, size_t n)
+  {
+    __m256d m = _mm256_set1_pd(-DBL_MAX);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+      m = _mm256_max_pd(_mm256_loadu_pd(values + i), m);
+    double tmp[4];
+    _mm256_storeu_pd(tmp, m);
+    double res = tmp[0];
+    for (size_t j = 1; j < 4; ++j)
+      if (tmp[j] > res)
+        res = tmp[j];
+    for (; i < n; ++i)
+      if (values[i] > res)
+        res = values[i];
+    return res;
+  }
+};
+#endif // LBCPP_KERNELS_AVX2
+
+/*
+** Dispatch
+*/
+struct DoubleVectorKernelsTable
+{
+  const char* name;
+  double (*dotProduct)(const double* a, const double* b, size_t n);
+  void (*addWeighted)(double* target, const double* source, size_t n, double weight);
+  double (*sumOfSquares)(const double* values, size_t n);
+  double (*squaredDistance)(const double* a, const double* b, size_t n);
+  double (*maximum)(const double* values, size_t n);
+};
+
+template<class Implementation>
+static DoubleVectorKernelsTable makeDoubleVectorKernelsTable(const char* name)
+{
+  DoubleVectorKernelsTable res;
+  res.name = name;
+  res.dotProduct = &Implementation::dotProduct;
+  res.addWeighted = &Implementation::addWeighted;
+  res.sumOfSquares = &Implementation::sumOfSquares;
+  res.squaredDistance = &Implementation::squaredDistance;
+  res.maximum = &Implementation::maximum;
+  return res;
+}
+
+static DoubleVectorKernelsTable selectDoubleVectorKernels()
+{
+#ifdef LBCPP_KERNELS_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return makeDoubleVectorKernelsTable<AVX2DoubleVectorKernels>("avx2");
+#endif // LBCPP_KERNELS_AVX2
+#ifdef LBCPP_KERNELS_SSE2
+  return makeDoubleVectorKernelsTable<SSE2DoubleVectorKernels>("sse2");
+#else
+  return makeDoubleVectorKernelsTable<GenericDoubleVectorKernels>("generic");
+#endif // LBCPP_KERNELS_SSE2
+}
+
+// the table is built once by the (thread-safe) initialization of the local static
+static const DoubleVectorKernelsTable& getDoubleVectorKernels()
+{
+  static const DoubleVectorKernelsTable table = selectDoubleVectorKernels();
+  return table;
+}
+
+}; /* namespace lbcpp */
+
+/*
+** DoubleVectorKernels
+*/
+double DoubleVectorKernels::dotProduct(const double* a, const double* b, size_t n)
+  {return getDoubleVectorKernels().dotProduct(a, b, n);}
+
+void DoubleVectorKernels::addWeighted(double* target, const double* source, size_t n, double weight)
+  {getDoubleVectorKernels().addWeighted(target, source, n, weight);}
+
+double DoubleVectorKernels::sumOfSquares(const double* values, size_t n)
+  {return getDoubleVectorKernels().sumOfSquares(values, n);}
+
+double DoubleVectorKernels::squaredDistance(const double* a, const double* b, size_t n)
+  {return getDoubleVectorKernels().squaredDistance(a, b, n);}
+
+double DoubleVectorKernels::maximum(const double* values, size_t n)
+  {return getDoubleVectorKernels().maximum(values, n);}
+
+const char* DoubleVectorKernels::getInstructionSetName()
+  {return getDoubleVectorKernels().name;}
+
+struct SparseEntryIndexLess
+{
+  bool operator()(const std::pair<size_t, double>& entry, size_t index) const
+    {return entry.first < index;}
+};
+
+double DoubleVectorKernels::sparseDotProduct(const std::pair<size_t, double>* sparse, size_t numValues, const double* dense, size_t denseSize)
+{
+  // entries are sorted by index: only keep those that fall into the dense vector
+  const std::pair<size_t, double>* limit = std::lower_bound(sparse, sparse + numValues, denseSize, SparseEntryIndexLess());
+  size_t n = limit - sparse;
+
+  // the gathers are independent, unrolling lets the processor overlap their cache misses
+  double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    s0 += sparse[i].second * dense[sparse[i].first];
+    s1 += sparse[i + 1].second * dense[sparse[i + 1].first];
+    s2 += sparse[i + 2].second * dense[sparse[i + 2].first];
+    s3 += sparse[i + 3].second * dense[sparse[i + 3].first];
+  }
+  for (; i < n; ++i)
+    s0 += sparse[i].second * dense[sparse[i].first];
+  return (s0 + s1) + (s2 + s3);
+}
+
+void DoubleVectorKernels::sparseAddWeighted(double* dense, const std::pair<size_t, double>* sparse, size_t numValues, double weight)
+{
+  // indices are distinct, so the four updates of an iteration never alias
+  size_t i = 0;
+  for (; i + 4 <= numValues; i += 4)
+  {
+    double v0 = sparse[i].second * weight;
+    double v1 = sparse[i + 1].second * weight;
+    double v2 = sparse[i + 2].second * weight;
+    double v3 = sparse[i + 3].second * weight;
+    dense[sparse[i].first] += v0;
+    dense[sparse[i + 1].first] += v1;
+    dense[sparse[i + 2].first] += v2;
+    dense[sparse[i + 3].first] += v3;
+  }
+  for (; i < numValues; ++i)
+    dense[sparse[i].first] += sparse[i].second * weight;
+}
+
+void DoubleVectorKernels::gather(double* target, const double* source, size_t sourceSize, const size_t* indices, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    target[i] = indices[i] < sourceSize ? source[indices[i]] : 0.0;
+}
+
+double DoubleVectorKernels::softmax(double* values, size_t n)
+{
+  if (!n)
+    return -DBL_MAX;
+  double highestValue = maximum(values, n);
+  double Z = 0.0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    values[i] = exp(values[i] - highestValue);
+    Z += values[i];
+  }
+  double invZ = 1.0 / Z;
+  for (size_t i = 0; i < n; ++i)
+    values[i] *= invZ;
+  return log(Z) + highestValue;
+}
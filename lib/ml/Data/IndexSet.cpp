@@ -29,6 +29,17 @@ void IndexSet::addInterval(size_t begin, size_t end)
     v[s + i] = i;
 }
 
+bool IndexSet::isContiguous() const
+{
+  if (v.empty())
+    return false;
+  size_t begin = v.front();
+  for (size_t i = 1; i < v.size(); ++i)
+    if (v[i] != begin + i)
+      return false;
+  return true;
+}
+
 IndexSetPtr IndexSet::sampleSubset(RandomGeneratorPtr random, size_t subsetSize) const
 {
   IndexSetPtr res = new IndexSet();
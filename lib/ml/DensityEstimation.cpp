@@ -0,0 +1,233 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: DensityEstimation.cpp          | Density estimation in the       |
+| Author  : Francis Maes                   |  objective space                |
+| Started : 16/10/2026 17:45               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <ml/DensityEstimation.h>
+#include <algorithm>
+using namespace lbcpp;
+
+namespace lbcpp
+{
+
+struct PointCoordinateLess
+{
+  PointCoordinateLess(const double* points, size_t numDimensions, size_t dimension)
+    : points(points), numDimensions(numDimensions), dimension(dimension) {}
+
+  const double* points;
+  size_t numDimensions;
+  size_t dimension;
+
+  bool operator()(size_t a, size_t b) const
+    {return points[a * numDimensions + dimension] < points[b * numDimensions + dimension];}
+};
+
+}; /* namespace lbcpp */
+
+static double squaredDistanceBetweenPoints(const double* point1, const double* point2, size_t numDimensions)
+{
+  double res = 0.0;
+  for (size_t i = 0; i < numDimensions; ++i)
+    res += (point1[i] - point2[i]) * (point1[i] - point2[i]);
+  return res;
+}
+
+// returns -1 if point1 strictly dominates point2, 1 if point2 strictly dominates point1 and 0 otherwise
+static int compareDominance(const double* point1, const double* point2, size_t numObjectives)
+{
+  bool isBetter1 = false, isBetter2 = false;
+  for (size_t k = 0; k < numObjectives && !(isBetter1 && isBetter2); ++k)
+  {
+    if (point1[k] < point2[k])
+      isBetter1 = true;
+    else if (point2[k] < point1[k])
+      isBetter2 = true;
+  }
+  if (isBetter1 == isBetter2)
+    return 0;
+  return isBetter1 ? -1 : 1;
+}
+
+/*
+** PointKDTree
+*/
+PointKDTree::PointKDTree(const double* points, size_t numPoints, size_t numDimensions, size_t maxLeafSize)
+  : points(points), numPoints(numPoints), numDimensions(numDimensions), maxLeafSize(maxLeafSize ? maxLeafSize : 1)
+{
+  indices.resize(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    indices[i] = i;
+  if (numPoints)
+  {
+    nodes.reserve(2 * (numPoints / this->maxLeafSize) + 1);
+    build(0, numPoints);
+  }
+}
+
+size_t PointKDTree::build(size_t begin, size_t end)
+{
+  size_t res = nodes.size();
+  nodes.push_back(Node());
+  nodes[res].begin = begin;
+  nodes[res].end = end;
+  nodes[res].splitDimension = 0;
+  nodes[res].splitValue = 0.0;
+  nodes[res].left = nodes[res].right = 0;
+  if (end - begin <= maxLeafSize)
+    return res;
+
+  // split at the median of the dimension with the largest spread
+  size_t bestDimension = 0;
+  double bestSpread = -1.0;
+  for (size_t d = 0; d < numDimensions; ++d)
+  {
+    double lower = DBL_MAX, upper = -DBL_MAX;
+    for (size_t i = begin; i < end; ++i)
+    {
+      double value = points[indices[i] * numDimensions + d];
+      lower = std::min(lower, value);
+      upper = std::max(upper, value);
+    }
+    if (upper - lower > bestSpread)
+    {
+      bestSpread = upper - lower;
+      bestDimension = d;
+    }
+  }
+  if (bestSpread <= 0.0)
+    return res; // identical points
+
+  size_t middle = begin + (end - begin) / 2;
+  std::nth_element(indices.begin() + begin, indices.begin() + middle, indices.begin() + end, PointCoordinateLess(points, numDimensions, bestDimension));
+  nodes[res].splitDimension = bestDimension;
+  nodes[res].splitValue = points[indices[middle] * numDimensions + bestDimension];
+  size_t left = build(begin, middle);
+  size_t right = build(middle, end);
+  nodes[res].left = left;
+  nodes[res].right = right;
+  return res;
+}
+
+void PointKDTree::findNearestNeighbourDistances(size_t index, size_t k, std::vector<double>& res) const
+{
+  jassert(index < numPoints);
+  res.clear();
+  if (!k || numPoints < 2)
+    return;
+  res.reserve(k + 1);
+  search(0, points + index * numDimensions, index, k, res);
+  std::sort_heap(res.begin(), res.end());
+  for (size_t i = 0; i < res.size(); ++i)
+    res[i] = sqrt(res[i]);
+}
+
+// heap is a max-heap of the k smallest squared distances found so far
+void PointKDTree::search(size_t nodeIndex, const double* query, size_t excludedIndex, size_t k, std::vector<double>& heap) const
+{
+  const Node& node = nodes[nodeIndex];
+  if (!node.left)
+  {
+    for (size_t i = node.begin; i < node.end; ++i)
+    {
+      size_t index = indices[i];
+      if (index == excludedIndex)
+        continue;
+      double distance = squaredDistanceBetweenPoints(query, points + index * numDimensions, numDimensions);
+      if (heap.size() < k)
+      {
+        heap.push_back(distance);
+        std::push_heap(heap.begin(), heap.end());
+      }
+      else if (distance < heap.front())
+      {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = distance;
+        std::push_heap(heap.begin(), heap.end());
+      }
+    }
+    return;
+  }
+
+  double delta = query[node.splitDimension] - node.splitValue;
+  search(delta < 0.0 ? node.left : node.right, query, excludedIndex, k, heap);
+  if (heap.size() < k || delta * delta < heap.front())
+    search(delta < 0.0 ? node.right : node.left, query, excludedIndex, k, heap);
+}
+
+/*
+** DensityEstimation
+*/
+void DensityEstimation::computeStrengthsAndRawFitnesses(const double* points, size_t numPoints, size_t numObjectives, std::vector<double>& strengths, std::vector<double>& rawFitnesses)
+{
+  strengths.assign(numPoints, 0.0);
+  rawFitnesses.assign(numPoints, 0.0);
+
+  // two passes on the pairs of points, so that the dominance relation does not need to be stored
+  for (int pass = 0; pass < 2; ++pass)
+    for (size_t i = 0; i < numPoints; ++i)
+      for (size_t j = i + 1; j < numPoints; ++j)
+      {
+        int dominance = compareDominance(points + i * numObjectives, points + j * numObjectives, numObjectives);
+        if (dominance < 0)
+        {
+          if (pass == 0)
+            strengths[i] += 1.0;
+          else
+            rawFitnesses[j] += strengths[i];
+        }
+        else if (dominance > 0)
+        {
+          if (pass == 0)
+            strengths[j] += 1.0;
+          else
+            rawFitnesses[i] += strengths[j];
+        }
+      }
+}
+
+void DensityEstimation::computeNearestNeighbourDistances(const double* points, size_t numPoints, size_t numObjectives, size_t k, std::vector<double>& res)
+{
+  res.assign(numPoints, DBL_MAX);
+  if (!k || numPoints <= k)
+    return;
+  PointKDTree tree(points, numPoints, numObjectives);
+  std::vector<double> distances;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    tree.findNearestNeighbourDistances(i, k, distances);
+    res[i] = distances[k - 1];
+  }
+}
+
+void DensityEstimation::computeCrowdingDistances(const double* points, size_t numPoints, size_t numObjectives, std::vector<double>& res, const double* ranges)
+{
+  res.assign(numPoints, 0.0);
+  if (numPoints <= 2)
+  {
+    res.assign(numPoints, DBL_MAX);
+    return;
+  }
+
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+  for (size_t objective = 0; objective < numObjectives; ++objective)
+  {
+    std::sort(order.begin(), order.end(), PointCoordinateLess(points, numObjectives, objective));
+    const double* first = points + order.front() * numObjectives;
+    const double* last = points + order.back() * numObjectives;
+    res[order.front()] = DBL_MAX;
+    res[order.back()] = DBL_MAX;
+    double range = ranges ? ranges[objective] : last[objective] - first[objective];
+    if (range == 0.0)
+      continue; // all the points have the same value
+    double invRange = 1.0 / fabs(range);
+    for (size_t i = 1; i < numPoints - 1; ++i)
+      if (res[order[i]] != DBL_MAX)
+        res[order[i]] += (points[order[i + 1] * numObjectives + objective] - points[order[i - 1] * numObjectives + objective]) * invRange;
+  }
+}
@@ -10,6 +10,7 @@
 # define ML_EXPRESSION_CLASSIFICATION_OBJECTIVES_H_
 
 # include <ml/Objective.h>
+# include "ExpressionProgram.h"
 
 namespace lbcpp
 {
@@ -25,6 +26,30 @@ public:
     {worst = 0.0; best = 1.0;}
 };
 
+/*
+** Counts the predictions of a boolean ExpressionProgram that are equal to the supervisions,
+** block by block. The execution stops when the accuracy cannot reach minNumSuccesses anymore.
+*/
+struct BinaryAccuracyBlockCallback : public ExpressionProgram::BlockCallback
+{
+  BinaryAccuracyBlockCallback(const unsigned char* supervisions, size_t numRows, double minNumSuccesses)
+    : supervisions(supervisions), numRemainingRows(numRows), minNumSuccesses(minNumSuccesses), numSuccesses(0) {}
+
+  const unsigned char* supervisions;
+  size_t numRemainingRows;
+  double minNumSuccesses;
+  size_t numSuccesses;
+
+  virtual bool processBooleanBlock(const size_t* rows, const unsigned char* values, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+      if (supervisions[rows[i]] == values[i])
+        ++numSuccesses;
+    numRemainingRows -= count;
+    return (double)(numSuccesses + numRemainingRows) >= minNumSuccesses;
+  }
+};
+
 class BinaryAccuracyObjective : public AccuracyObjective
 {
 public:
@@ -35,19 +60,57 @@ public:
   virtual double evaluatePredictions(ExecutionContext& context, DataVectorPtr predictions) const
   {
     BVectorPtr supervisions = getSupervisions().staticCast<BVector>();
+    const unsigned char* supervisionValues = supervisions->getDataPointer();
+    const std::vector<size_t>& rows = predictions->getIndices()->getIndices();
+    const VectorPtr& vector = predictions->getVector();
     
     // compute num successes
     size_t numSuccesses = 0;
-    for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it)
+    if (predictions->getImplementation() == DataVector::ownedVectorImpl && vector.isInstanceOf<BVector>())
     {
-      unsigned char supervision = supervisions->get(it.getIndex());
-      unsigned char prediction = it.getRawBoolean();
-      if (supervision == prediction)
-        ++numSuccesses;
+      const unsigned char* values = vector.staticCast<BVector>()->getDataPointer();
+      for (size_t i = 0; i < rows.size(); ++i)
+        if (supervisionValues[rows[i]] == values[i])
+          ++numSuccesses;
+    }
+    else if (predictions->getImplementation() == DataVector::cachedVectorImpl && vector.isInstanceOf<BVector>())
+    {
+      const unsigned char* values = vector.staticCast<BVector>()->getDataPointer();
+      for (size_t i = 0; i < rows.size(); ++i)
+        if (supervisionValues[rows[i]] == values[rows[i]])
+          ++numSuccesses;
+    }
+    else
+    {
+      for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it)
+      {
+        unsigned char supervision = supervisionValues[it.getIndex()];
+        unsigned char prediction = it.getRawBoolean();
+        if (supervision == prediction)
+          ++numSuccesses;
+      }
     }
 
     return numSuccesses / (double)supervisions->getNumElements();
   }
+
+  virtual double evaluateExpression(ExecutionContext& context, const ExpressionPtr& expression, double cutoff = DBL_MAX) const
+  {
+    if (data->getDataByKey(expression))
+      return SupervisedLearningObjective::evaluateExpression(context, expression, cutoff);
+    ExpressionProgram program;
+    if (!program.compile(expression, data) || !program.isBoolean())
+      return evaluatePredictions(context, program.computePredictions(context, expression, data, indices));
+
+    // the accuracy is maximised: the execution stops when it cannot reach cutoff anymore, unless cutoff is DBL_MAX
+    BVectorPtr supervisions = getSupervisions().staticCast<BVector>();
+    double numElements = (double)supervisions->getNumElements();
+    BinaryAccuracyBlockCallback callback(supervisions->getDataPointer(), indices->size(), cutoff == DBL_MAX ? 0.0 : cutoff * numElements);
+    if (program.execute(indices, callback))
+      return callback.numSuccesses / numElements;
+    else
+      return (callback.numSuccesses + callback.numRemainingRows) / numElements; // upper bound of the accuracy, below cutoff
+  }
 };
 
 class MultiClassAccuracyObjective : public AccuracyObjective
@@ -63,7 +126,18 @@ public:
     
     // compute num successes
     size_t numSuccesses = 0;
-    if (predictions->getElementsType()->inheritsFrom(integerClass))
+    const VectorPtr& vector = predictions->getVector();
+    if (predictions->getImplementation() != DataVector::constantValueImpl && vector.isInstanceOf<IVector>())
+    {
+      const std::vector<size_t>& rows = predictions->getIndices()->getIndices();
+      const juce::int64* supervisionValues = supervisions->getDataPointer();
+      const juce::int64* values = vector.staticCast<IVector>()->getDataPointer();
+      bool isOwned = predictions->getImplementation() == DataVector::ownedVectorImpl;
+      for (size_t i = 0; i < rows.size(); ++i)
+        if ((int)supervisionValues[rows[i]] == (int)values[isOwned ? i : rows[i]])
+          ++numSuccesses;
+    }
+    else if (predictions->getElementsType()->inheritsFrom(integerClass))
     {
       for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it)
       {
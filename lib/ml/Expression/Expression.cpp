@@ -12,6 +12,7 @@
 #include <oil/Core/Table.h>
 #include <algorithm>
 #include "IncrementalLearner/HoeffdingTreeIncrementalLearner.h"
+#include "ExpressionProgram.h"
 using namespace lbcpp;
 
 /*
@@ -36,7 +37,7 @@ DataVectorPtr DataVector::createConstant(IndexSetPtr indices, const ObjectPtr& c
   return res;
 }
 
-ObjectPtr DataVector::sampleElement(RandomGeneratorPtr random) const
+ObjectPtr DataVector::sampleElement(const RandomGeneratorPtr& random) const
 {
   if (implementation == constantValueImpl)
     return constantRawObject;
@@ -90,13 +91,13 @@ size_t Expression::getDepth() const // returns 1 for a leaf node
   return res + 1;
 }
 
-size_t Expression::getNodeDepth(ExpressionPtr node) const // returns 1 if (node == this)
+size_t Expression::getNodeDepth(const ExpressionPtr& node) const // returns 1 if (node == this)
 {
   if (node.get() == this)
     return 1;
   for (size_t i = 0; i < getNumSubNodes(); ++i)
   {
-    ExpressionPtr subNode = getSubNode(i);
+    const ExpressionPtr& subNode = getSubNode(i);
     if (subNode)
     {
       size_t res = subNode->getNodeDepth(node);
@@ -112,21 +113,21 @@ size_t Expression::getTreeSize() const
   size_t res = 1;
   for (size_t i = 0; i < getNumSubNodes(); ++i)
   {
-    ExpressionPtr subNode = getSubNode(i);
+    const ExpressionPtr& subNode = getSubNode(i);
     if (subNode)
       res += subNode->getTreeSize();
   }
   return res;
 }
 
-static ExpressionPtr getNodeByTreeIndexRec(ExpressionPtr expression, size_t& index)
+static ExpressionPtr getNodeByTreeIndexRec(const ExpressionPtr& expression, size_t& index)
 {
   if (index == 0)
     return expression;
   index -= 1;
   for (size_t i = 0; i < expression->getNumSubNodes(); ++i)
   {
-    ExpressionPtr subNode = expression->getSubNode(i);
+    const ExpressionPtr& subNode = expression->getSubNode(i);
     if (subNode)
     {
       ExpressionPtr res = getNodeByTreeIndexRec(subNode, index);
@@ -138,9 +139,9 @@ static ExpressionPtr getNodeByTreeIndexRec(ExpressionPtr expression, size_t& ind
 }
 
 ExpressionPtr Expression::getNodeByTreeIndex(size_t index) const
-  {return getNodeByTreeIndexRec(refCountedPointerFromThis(this), index);}
+  {return getNodeByTreeIndexRec(borrowedPointerFromThis(this), index);}
 
-ExpressionPtr Expression::cloneAndSubstitute(ExpressionPtr sourceNode, ExpressionPtr targetNode) const
+ExpressionPtr Expression::cloneAndSubstitute(const ExpressionPtr& sourceNode, const ExpressionPtr& targetNode) const
 {
   if (this == sourceNode.get())
     return targetNode;
@@ -177,10 +178,10 @@ void Expression::getLeafNodes(std::vector<ExpressionPtr>& res) const
     res.push_back(refCountedPointerFromThis(this));
 }
 
-ExpressionPtr Expression::sampleNode(RandomGeneratorPtr random) const
+ExpressionPtr Expression::sampleNode(const RandomGeneratorPtr& random) const
   {return getNodeByTreeIndex(random->sampleSize(getTreeSize()));}
 
-ExpressionPtr Expression::sampleNode(RandomGeneratorPtr random, double functionSelectionProbability) const
+ExpressionPtr Expression::sampleNode(const RandomGeneratorPtr& random, double functionSelectionProbability) const
 {
   if (getNumSubNodes() == 0)
     return refCountedPointerFromThis(this);
@@ -194,7 +195,7 @@ ExpressionPtr Expression::sampleNode(RandomGeneratorPtr random, double functionS
   return nodes[random->sampleSize(nodes.size())];
 }
 
-ExpressionPtr Expression::sampleSubNode(RandomGeneratorPtr random) const
+ExpressionPtr Expression::sampleSubNode(const RandomGeneratorPtr& random) const
 {
   size_t n = getNumSubNodes();
   jassert(n > 0);
@@ -204,13 +205,44 @@ ExpressionPtr Expression::sampleSubNode(RandomGeneratorPtr random) const
 DataVectorPtr Expression::compute(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const
 {
   IndexSetPtr idx = indices ? indices : new IndexSet(0, data->getNumRows());
-  VectorPtr samples = data->getDataByKey(refCountedPointerFromThis(this));
+  VectorPtr samples = data->getDataByKey(borrowedPointerFromThis<Object>(this));
   if (samples)
     return DataVector::createCached(idx, samples);
   else
     return computeSamples(context, data, idx);
 }
 
+double Expression::toNativeValue(const ObjectPtr& value)
+{
+  if (!value)
+    return DVector::missingValue;
+  if (value.isInstanceOf<Double>())
+    return Double::get(value);
+  if (value.isInstanceOf<Boolean>())
+    return Boolean::get(value) ? 1.0 : 0.0;
+  if (value.isInstanceOf<Integer>())
+    return (double)Integer::get(value);
+  jassertfalse;
+  return DVector::missingValue;
+}
+
+ObjectPtr Expression::fromNativeValue(const ClassPtr& type, double value)
+{
+  if (value == DVector::missingValue)
+    return ObjectPtr();
+  if (type->inheritsFrom(booleanClass))
+    return Boolean::create(type, value != 0.0);
+  if (type == integerClass)
+    return Integer::create(type, (juce::int64)value);
+  if (type->inheritsFrom(integerClass))
+    return new Integer(type, (juce::int64)value);
+  jassert(type->inheritsFrom(doubleClass));
+  return new Double(type, value);
+}
+
+static bool isNativeType(const ClassPtr& type)
+  {return type->inheritsFrom(doubleClass) || type->inheritsFrom(booleanClass) || type->inheritsFrom(integerClass);}
+
 /*
 ** VariableExpression
 */
@@ -229,6 +261,9 @@ string VariableExpression::toShortString() const
 ObjectPtr VariableExpression::compute(ExecutionContext& context, const std::vector<ObjectPtr>& inputs) const
   {return inputs[inputIndex];}
 
+bool VariableExpression::hasNativeCompute() const
+  {return isNativeType(type);}
+
 DataVectorPtr VariableExpression::computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const
 {
   jassertfalse; // if we reach this point, then the data for this variable is missing in the data table
@@ -252,6 +287,9 @@ ObjectPtr ConstantExpression::compute(ExecutionContext& context, const std::vect
 DataVectorPtr ConstantExpression::computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const
   {return DataVector::createConstant(indices, value);}
 
+bool ConstantExpression::hasNativeCompute() const
+  {return !value || value.isInstanceOf<Double>() || value.isInstanceOf<Boolean>() || value.isInstanceOf<Integer>();}
+
 /*
 ** FunctionExpression
 */
@@ -306,26 +344,56 @@ ObjectPtr FunctionExpression::compute(ExecutionContext& context, const std::vect
   }
   else if (n == 2)
   {
-    ObjectPtr v[2];
-    v[0] = arguments[0]->compute(context, inputs);
-    v[1] = arguments[1]->compute(context, inputs);
+    // the values are constructed in place, without intermediary copies
+    ObjectPtr v[2] = {arguments[0]->compute(context, inputs), arguments[1]->compute(context, inputs)};
     return function->compute(context, v);
   }
   else
   {
-    std::vector<ObjectPtr> inputValues(arguments.size());
-    for (size_t i = 0; i < arguments.size(); ++i)
-      inputValues[i] = arguments[i]->compute(context, inputs);
+    std::vector<ObjectPtr> inputValues(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      ObjectPtr value = arguments[i]->compute(context, inputs);
+      inputValues[i].swap(value);
+    }
     return function->compute(context, &inputValues[0]);
   }
 }
 
+bool FunctionExpression::hasNativeCompute() const
+{
+  if (!function->hasNativeCompute())
+    return false;
+  for (size_t i = 0; i < arguments.size(); ++i)
+    if (!arguments[i]->hasNativeCompute())
+      return false;
+  return true;
+}
+
+size_t FunctionExpression::getNativeStackSize() const
+{
+  // the arguments values are stored at the top of the stack, the remaining space is used to compute them
+  size_t res = 0;
+  for (size_t i = 0; i < arguments.size(); ++i)
+    res = std::max(res, arguments[i]->getNativeStackSize());
+  return arguments.size() + res;
+}
+
+double FunctionExpression::computeNative(const double* inputs, double* stack) const
+{
+  size_t n = arguments.size();
+  for (size_t i = 0; i < n; ++i)
+    stack[i] = arguments[i]->computeNative(inputs, stack + n);
+  return function->computeNative(stack);
+}
+
 DataVectorPtr FunctionExpression::computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const
 {
-  std::vector<DataVectorPtr> inputs(arguments.size());
-  for (size_t i = 0; i < inputs.size(); ++i)
-    inputs[i] = arguments[i]->compute(context, data, indices);
-  return function->compute(context, inputs, type);
+  // fast path: block-wise evaluation of built-in double and boolean functions
+  ExpressionPtr pthis = borrowedPointerFromThis<Expression>(this);
+  ExpressionProgram program;
+  program.compile(pthis, data);
+  return program.computePredictions(context, pthis, data, indices);
 }
 
 /*
@@ -412,6 +480,33 @@ ObjectPtr TestExpression::compute(ExecutionContext& context, const std::vector<O
   return subNode ? subNode->compute(context, inputs) : ObjectPtr();
 }
 
+bool TestExpression::hasNativeCompute() const
+{
+  return conditionNode && conditionNode->hasNativeCompute() &&
+    (!failureNode || failureNode->hasNativeCompute()) &&
+    (!successNode || successNode->hasNativeCompute()) &&
+    (!missingNode || missingNode->hasNativeCompute());
+}
+
+size_t TestExpression::getNativeStackSize() const
+{
+  size_t res = conditionNode->getNativeStackSize();
+  if (failureNode)
+    res = std::max(res, failureNode->getNativeStackSize());
+  if (successNode)
+    res = std::max(res, successNode->getNativeStackSize());
+  if (missingNode)
+    res = std::max(res, missingNode->getNativeStackSize());
+  return res;
+}
+
+double TestExpression::computeNative(const double* inputs, double* stack) const
+{
+  double condition = conditionNode->computeNative(inputs, stack);
+  const ExpressionPtr& subNode = (condition == DVector::missingValue ? missingNode : (condition ? successNode : failureNode));
+  return subNode ? subNode->computeNative(inputs, stack) : DVector::missingValue;
+}
+
 void TestExpression::dispatchIndices(const DataVectorPtr& conditionValues, IndexSetPtr& failureIndices, IndexSetPtr& successIndices, IndexSetPtr& missingIndices)
 {
   failureIndices = new IndexSet();
@@ -419,6 +514,9 @@ void TestExpression::dispatchIndices(const DataVectorPtr& conditionValues, Index
   successIndices = new IndexSet();
   successIndices->reserve(conditionValues->size() / 4);
   missingIndices = new IndexSet();
+  failureIndices->setParent(conditionValues->getIndices());
+  successIndices->setParent(conditionValues->getIndices());
+  missingIndices->setParent(conditionValues->getIndices());
   for (DataVector::const_iterator it = conditionValues->begin(); it != conditionValues->end(); ++it)
   {
     switch (it.getRawBoolean())
@@ -531,6 +629,8 @@ ObjectPtr LinearModelExpression::compute(ExecutionContext &context, const std::v
 
 DataVectorPtr LinearModelExpression::computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const
 {
+  if (hasNativeCompute())
+    return NativeExpressionEvaluator(refCountedPointerFromThis(this)).computeSamples(data, indices);
   DVectorPtr vector = new DVector(indices->size());
   size_t i = 0;
   for (IndexSet::const_iterator it = indices->begin(); it != indices->end(); ++it)
@@ -540,6 +640,8 @@ DataVectorPtr LinearModelExpression::computeSamples(ExecutionContext& context, c
 
 DataVectorPtr NormalizedLinearModelExpression::computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const
 {
+  if (hasNativeCompute())
+    return NativeExpressionEvaluator(refCountedPointerFromThis(this)).computeSamples(data, indices);
   DVectorPtr vector = new DVector(indices->size());
   size_t i = 0;
   for (IndexSet::const_iterator it = indices->begin(); it != indices->end(); ++it)
@@ -682,8 +784,36 @@ ObjectPtr HoeffdingTreeNode::compute(ExecutionContext &context, const std::vecto
   return new ScalarVariableConstMeanAndVariance(mean, stddev * stddev);
 }
 
+bool HoeffdingTreeNode::hasNativeCompute() const
+{
+  if (isLeaf())
+    return model && model->hasNativeCompute();
+  return left->hasNativeCompute() && right->hasNativeCompute();
+}
+
+size_t HoeffdingTreeNode::getNativeStackSize() const
+{
+  if (isLeaf())
+    return model->getNativeStackSize();
+  return std::max(left->getNativeStackSize(), right->getNativeStackSize());
+}
+
+double HoeffdingTreeNode::computeNative(const double* inputs, double* stack) const
+{
+  // same descent as findLeaf(), without the input vector
+  const TreeNode* node = this;
+  while (!node->isLeaf())
+  {
+    const HoeffdingTreeNode* n = static_cast<const HoeffdingTreeNode* >(node);
+    node = (inputs[n->testVariable] > n->testThreshold ? n->right : n->left).get();
+  }
+  return static_cast<const HoeffdingTreeNode* >(node)->model->computeNative(inputs, stack);
+}
+
 DataVectorPtr HoeffdingTreeNode::computeSamples(ExecutionContext& context, const TablePtr& data, const IndexSetPtr& indices) const
 {
+  if (hasNativeCompute())
+    return NativeExpressionEvaluator(refCountedPointerFromThis(this)).computeSamples(data, indices, doubleClass);
   DVectorPtr vector = new DVector(indices->size());
   size_t i = 0;
   for (IndexSet::const_iterator it = indices->begin(); it != indices->end(); ++it)
@@ -691,3 +821,80 @@ DataVectorPtr HoeffdingTreeNode::computeSamples(ExecutionContext& context, const
   return new DataVector(indices, vector);
 }
 
+/*
+** NativeExpressionEvaluator
+*/
+void NativeExpressionEvaluator::setExpression(const ExpressionPtr& expression)
+{
+  this->expression = expression;
+  supported = expression && expression->hasNativeCompute();
+  stack.resize(supported ? expression->getNativeStackSize() : 0);
+}
+
+DataVectorPtr NativeExpressionEvaluator::computeSamples(const TablePtr& data, const IndexSetPtr& indices, ClassPtr outputType)
+{
+  jassert(supported);
+  if (!outputType)
+    outputType = expression->getType();
+
+  // raw pointers on the native columns, the other columns are unboxed element by element
+  // if they contain native values, and are otherwise not used by the expression
+  size_t numColumns = data->getNumColumns();
+  std::vector<const double* > doubleColumns(numColumns, NULL);
+  std::vector<const unsigned char* > booleanColumns(numColumns, NULL);
+  std::vector<const juce::int64* > integerColumns(numColumns, NULL);
+  std::vector<bool> objectColumns(numColumns, false);
+  for (size_t i = 0; i < numColumns; ++i)
+  {
+    VectorPtr column = data->getData(i);
+    objectColumns[i] = isNativeType(data->getType(i));
+    if (column.isInstanceOf<DVector>())
+      doubleColumns[i] = column.staticCast<DVector>()->getDataPointer();
+    else if (column.isInstanceOf<BVector>())
+      booleanColumns[i] = column.staticCast<BVector>()->getDataPointer();
+    else if (column.isInstanceOf<IVector>())
+      integerColumns[i] = column.staticCast<IVector>()->getDataPointer();
+  }
+
+  size_t n = indices->size();
+  DVectorPtr doubleResults;
+  BVectorPtr booleanResults;
+  IVectorPtr integerResults;
+  VectorPtr results;
+  if (outputType->inheritsFrom(booleanClass))
+    results = booleanResults = new BVector(outputType, n);
+  else if (outputType->inheritsFrom(integerClass))
+    results = integerResults = new IVector(outputType, n);
+  else
+    results = doubleResults = new DVector(outputType, n);
+
+  row.resize(numColumns);
+  const double* inputs = numColumns ? &row[0] : NULL;
+  size_t i = 0;
+  for (IndexSet::const_iterator it = indices->begin(); it != indices->end(); ++it, ++i)
+  {
+    size_t index = *it;
+    for (size_t j = 0; j < numColumns; ++j)
+    {
+      if (doubleColumns[j])
+        row[j] = doubleColumns[j][index];
+      else if (booleanColumns[j])
+        row[j] = booleanColumns[j][index] == BVector::missingValue ? DVector::missingValue : (double)booleanColumns[j][index];
+      else if (integerColumns[j])
+        row[j] = integerColumns[j][index] == IVector::missingValue ? DVector::missingValue : (double)integerColumns[j][index];
+      else
+        row[j] = objectColumns[j] ? Expression::toNativeValue(data->getElement(index, j)) : DVector::missingValue;
+    }
+    if (booleanResults)
+      booleanResults->getDataPointer()[i] = computeBoolean(inputs);
+    else
+    {
+      double value = compute(inputs);
+      if (integerResults)
+        integerResults->getDataPointer()[i] = (value == DVector::missingValue ? IVector::missingValue : (juce::int64)value);
+      else
+        doubleResults->getDataPointer()[i] = value;
+    }
+  }
+  return new DataVector(indices, results);
+}
@@ -0,0 +1,404 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ExpressionProgram.cpp          | Flat program to evaluate        |
+| Author  : Francis Maes                   |  expressions on column blocks   |
+| Started : 16/10/2026 11:02               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#include "precompiled.h"
+#include "ExpressionProgram.h"
+#include "Function/DoubleFunctions.h"
+#include "Function/BooleanFunctions.h"
+#include <typeinfo>
+using namespace lbcpp;
+
+/*
+** Kernels
+**
+** The functions are called through qualified names, so that their computeDouble() and
+** computeBoolean() are inlined in the loops and give exactly the same results as the
+** element-wise implementations.
+*/
+namespace lbcpp
+{
+
+template<class FunctionType>
+static void unaryDoubleKernel(const Function* f, const double* input, double* output, size_t n)
+{
+  const FunctionType* function = static_cast<const FunctionType* >(f);
+  const double missing = DVector::missingValue;
+  for (size_t i = 0; i < n; ++i)
+  {
+    double value = input[i];
+    output[i] = value == missing ? missing : function->FunctionType::computeDouble(value);
+  }
+}
+
+template<class FunctionType>
+static void binaryDoubleKernel(const Function* f, const double* input1, const double* input2, double* output, size_t n)
+{
+  const FunctionType* function = static_cast<const FunctionType* >(f);
+  const double missing = DVector::missingValue;
+  for (size_t i = 0; i < n; ++i)
+  {
+    double d1 = input1[i];
+    double d2 = input2[i];
+    output[i] = (d1 == missing || d2 == missing) ? missing : function->FunctionType::computeDouble(d1, d2);
+  }
+}
+
+template<class FunctionType>
+static void binaryBooleanKernel(const Function* f, const unsigned char* input1, const unsigned char* input2, unsigned char* output, size_t n)
+{
+  const FunctionType* function = static_cast<const FunctionType* >(f);
+  for (size_t i = 0; i < n; ++i)
+  {
+    unsigned char b1 = input1[i];
+    unsigned char b2 = input2[i];
+    output[i] = (b1 == 2 || b2 == 2) ? 2 : (function->FunctionType::computeBoolean(b1 == 1, b2 == 1) ? 1 : 0);
+  }
+}
+
+static void notBooleanKernel(const unsigned char* input, unsigned char* output, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    unsigned char b = input[i];
+    output[i] = (b == 2 ? 2 : 1 - b);
+  }
+}
+
+static void ifThenElseBooleanKernel(const unsigned char* condition, const unsigned char* success, const unsigned char* failure, unsigned char* output, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    unsigned char b = condition[i];
+    output[i] = (b == 2 ? 2 : (b == 1 ? success[i] : failure[i]));
+  }
+}
+
+}; /* namespace lbcpp */
+
+/*
+** Compilation
+*/
+ExpressionProgram::Opcode ExpressionProgram::getFunctionOpcode(const FunctionPtr& function)
+{
+  // exact types are required, since subclasses may override computeDouble() or computeBoolean()
+  const std::type_info& type = typeid(*function);
+  if (type == typeid(OppositeDoubleFunction)) return oppositeDoubleOp;
+  if (type == typeid(InverseDoubleFunction)) return inverseDoubleOp;
+  if (type == typeid(AbsDoubleFunction)) return absDoubleOp;
+  if (type == typeid(LogDoubleFunction)) return logDoubleOp;
+  if (type == typeid(ProtectedLogDoubleFunction)) return protectedLogDoubleOp;
+  if (type == typeid(ExpDoubleFunction)) return expDoubleOp;
+  if (type == typeid(SqrtDoubleFunction)) return sqrtDoubleOp;
+  if (type == typeid(CosDoubleFunction)) return cosDoubleOp;
+  if (type == typeid(SinDoubleFunction)) return sinDoubleOp;
+
+  if (type == typeid(AddDoubleFunction)) return addDoubleOp;
+  if (type == typeid(SubDoubleFunction)) return subDoubleOp;
+  if (type == typeid(MulDoubleFunction)) return mulDoubleOp;
+  if (type == typeid(DivDoubleFunction)) return divDoubleOp;
+  if (type == typeid(ProtectedDivDoubleFunction)) return protectedDivDoubleOp;
+  if (type == typeid(PowDoubleFunction)) return powDoubleOp;
+  if (type == typeid(MinDoubleFunction)) return minDoubleOp;
+  if (type == typeid(MaxDoubleFunction)) return maxDoubleOp;
+
+  if (type == typeid(NotBooleanFunction)) return notBooleanOp;
+  if (type == typeid(AndBooleanFunction)) return andBooleanOp;
+  if (type == typeid(OrBooleanFunction)) return orBooleanOp;
+  if (type == typeid(NandBooleanFunction)) return nandBooleanOp;
+  if (type == typeid(NorBooleanFunction)) return norBooleanOp;
+  if (type == typeid(EqualBooleanFunction)) return equalBooleanOp;
+  if (type == typeid(IfThenElseBooleanFunction)) return ifThenElseBooleanOp;
+  return noOp;
+}
+
+bool ExpressionProgram::isBooleanOpcode(Opcode opcode)
+  {return opcode == loadBooleanColumnOp || opcode == loadBooleanConstantOp || (opcode >= notBooleanOp && opcode < noOp);}
+
+bool ExpressionProgram::compile(const ExpressionPtr& expression, const TablePtr& data)
+{
+  instructions.clear();
+  columns.clear();
+  numRegisters = 0;
+  outputType = expression->getType();
+  if (!compileNode(expression, data, 0, true))
+  {
+    instructions.clear();
+    columns.clear();
+    return false;
+  }
+  isBooleanProgram = isBooleanOpcode(instructions.back().opcode);
+  return true;
+}
+
+bool ExpressionProgram::compileNode(const ExpressionPtr& node, const TablePtr& data, size_t target, bool isRoot)
+{
+  if (numRegisters <= target)
+    numRegisters = target + 1;
+
+  // precomputed column
+  if (!isRoot)
+  {
+    VectorPtr column = data->getDataByKey(node);
+    if (column)
+    {
+      Instruction instruction(noOp, target);
+      if (column.isInstanceOf<DVector>())
+      {
+        instruction.opcode = loadDoubleColumnOp;
+        instruction.column = column.staticCast<DVector>()->getDataPointer();
+      }
+      else if (column.isInstanceOf<BVector>())
+      {
+        instruction.opcode = loadBooleanColumnOp;
+        instruction.column = column.staticCast<BVector>()->getDataPointer();
+      }
+      else
+        return false;
+      columns.push_back(column);
+      instructions.push_back(instruction);
+      return true;
+    }
+  }
+
+  // constant
+  ConstantExpressionPtr constantNode = node.dynamicCast<ConstantExpression>();
+  if (constantNode)
+  {
+    const ObjectPtr& value = constantNode->getValue();
+    Instruction instruction(noOp, target);
+    if (value.dynamicCast<Double>())
+    {
+      instruction.opcode = loadDoubleConstantOp;
+      instruction.constant = Double::get(value);
+    }
+    else if (value.dynamicCast<Boolean>())
+    {
+      instruction.opcode = loadBooleanConstantOp;
+      instruction.constant = Boolean::get(value) ? 1.0 : 0.0;
+    }
+    else
+      return false;
+    instructions.push_back(instruction);
+    return true;
+  }
+
+  // built-in function
+  FunctionExpressionPtr functionNode = node.dynamicCast<FunctionExpression>();
+  if (!functionNode)
+    return false;
+  const FunctionPtr& function = functionNode->getFunction();
+  Opcode opcode = getFunctionOpcode(function);
+  if (opcode == noOp)
+    return false;
+  bool isBooleanFunction = isBooleanOpcode(opcode);
+  size_t numArguments = functionNode->getNumArguments();
+  for (size_t i = 0; i < numArguments; ++i)
+  {
+    if (!compileNode(functionNode->getArgument(i), data, target + i, false))
+      return false;
+    // the last instruction computes the argument: check that it has the expected kind
+    if (isBooleanOpcode(instructions.back().opcode) != isBooleanFunction)
+      return false;
+  }
+  instructions.push_back(Instruction(opcode, target, function.get()));
+  return true;
+}
+
+/*
+** Execution
+*/
+namespace lbcpp
+{
+
+struct ExpressionProgramOutputCallback : public ExpressionProgram::BlockCallback
+{
+  ExpressionProgramOutputCallback(double* doubles, unsigned char* booleans)
+    : doubles(doubles), booleans(booleans) {}
+
+  double* doubles;
+  unsigned char* booleans;
+
+  virtual bool processDoubleBlock(const size_t* rows, const double* values, size_t count)
+  {
+    memcpy(doubles, values, count * sizeof (double));
+    doubles += count;
+    return true;
+  }
+
+  virtual bool processBooleanBlock(const size_t* rows, const unsigned char* values, size_t count)
+  {
+    memcpy(booleans, values, count * sizeof (unsigned char));
+    booleans += count;
+    return true;
+  }
+};
+
+}; /* namespace lbcpp */
+
+DataVectorPtr ExpressionProgram::execute(const IndexSetPtr& indices) const
+{
+  jassert(instructions.size());
+  size_t n = indices->size();
+  if (isBooleanProgram)
+  {
+    BVectorPtr result = new BVector(n);
+    ExpressionProgramOutputCallback callback(NULL, result->getDataPointer());
+    execute(indices, callback);
+    return new DataVector(indices, result);
+  }
+  else
+  {
+    DVectorPtr result = new DVector(outputType, n, 0.0);
+    ExpressionProgramOutputCallback callback(result->getDataPointer(), NULL);
+    execute(indices, callback);
+    return new DataVector(indices, result);
+  }
+}
+
+bool ExpressionProgram::execute(const IndexSetPtr& indices, BlockCallback& callback) const
+{
+  jassert(instructions.size());
+  size_t n = indices->size();
+  const size_t* rows = n ? &indices->getIndices()[0] : NULL;
+  bool isContiguous = indices->isContiguous(); // bootstrap samples are sorted but contain duplicates
+
+  // each register can hold one block of doubles or one block of booleans
+  std::vector<double> storage(numRegisters * blockSize);
+  std::vector<const void* > operands(numRegisters, (const void* )NULL);
+
+  for (size_t begin = 0; begin < n; begin += blockSize)
+  {
+    size_t count = (n - begin < (size_t)blockSize ? n - begin : (size_t)blockSize);
+    const size_t* blockRows = rows + begin;
+
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+      const Instruction& instruction = instructions[i];
+      size_t t = instruction.target;
+      double* doubleBuffer = &storage[t * blockSize];
+      unsigned char* booleanBuffer = (unsigned char* )doubleBuffer;
+      const double* d = (const double* )operands[t];
+      const unsigned char* b = (const unsigned char* )operands[t];
+
+#define EXPRESSION_PROGRAM_UNARY_DOUBLE(Op, FunctionClass) \
+      case Op: unaryDoubleKernel<FunctionClass>(instruction.function, d, doubleBuffer, count); \
+        operands[t] = doubleBuffer; break;
+#define EXPRESSION_PROGRAM_BINARY_DOUBLE(Op, FunctionClass) \
+      case Op: binaryDoubleKernel<FunctionClass>(instruction.function, d, (const double* )operands[t + 1], doubleBuffer, count); \
+        operands[t] = doubleBuffer; break;
+#define EXPRESSION_PROGRAM_BINARY_BOOLEAN(Op, FunctionClass) \
+      case Op: binaryBooleanKernel<FunctionClass>(instruction.function, b, (const unsigned char* )operands[t + 1], booleanBuffer, count); \
+        operands[t] = booleanBuffer; break;
+
+      switch (instruction.opcode)
+      {
+      case loadDoubleColumnOp:
+        {
+          const double* column = (const double* )instruction.column;
+          if (isContiguous)
+            operands[t] = column + rows[0] + begin; // no copy
+          else
+          {
+            for (size_t j = 0; j < count; ++j)
+              doubleBuffer[j] = column[blockRows[j]];
+            operands[t] = doubleBuffer;
+          }
+        }
+        break;
+
+      case loadBooleanColumnOp:
+        {
+          const unsigned char* column = (const unsigned char* )instruction.column;
+          if (isContiguous)
+            operands[t] = column + rows[0] + begin; // no copy
+          else
+          {
+            for (size_t j = 0; j < count; ++j)
+              booleanBuffer[j] = column[blockRows[j]];
+            operands[t] = booleanBuffer;
+          }
+        }
+        break;
+
+      case loadDoubleConstantOp:
+        std::fill(doubleBuffer, doubleBuffer + count, instruction.constant);
+        operands[t] = doubleBuffer;
+        break;
+
+      case loadBooleanConstantOp:
+        memset(booleanBuffer, instruction.constant ? 1 : 0, count);
+        operands[t] = booleanBuffer;
+        break;
+
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(oppositeDoubleOp, OppositeDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(inverseDoubleOp, InverseDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(absDoubleOp, AbsDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(logDoubleOp, LogDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(protectedLogDoubleOp, ProtectedLogDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(expDoubleOp, ExpDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(sqrtDoubleOp, SqrtDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(cosDoubleOp, CosDoubleFunction)
+      EXPRESSION_PROGRAM_UNARY_DOUBLE(sinDoubleOp, SinDoubleFunction)
+
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(addDoubleOp, AddDoubleFunction)
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(subDoubleOp, SubDoubleFunction)
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(mulDoubleOp, MulDoubleFunction)
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(divDoubleOp, DivDoubleFunction)
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(protectedDivDoubleOp, ProtectedDivDoubleFunction)
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(powDoubleOp, PowDoubleFunction)
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(minDoubleOp, MinDoubleFunction)
+      EXPRESSION_PROGRAM_BINARY_DOUBLE(maxDoubleOp, MaxDoubleFunction)
+
+      case notBooleanOp:
+        notBooleanKernel(b, booleanBuffer, count);
+        operands[t] = booleanBuffer;
+        break;
+
+      EXPRESSION_PROGRAM_BINARY_BOOLEAN(andBooleanOp, AndBooleanFunction)
+      EXPRESSION_PROGRAM_BINARY_BOOLEAN(orBooleanOp, OrBooleanFunction)
+      EXPRESSION_PROGRAM_BINARY_BOOLEAN(nandBooleanOp, NandBooleanFunction)
+      EXPRESSION_PROGRAM_BINARY_BOOLEAN(norBooleanOp, NorBooleanFunction)
+      EXPRESSION_PROGRAM_BINARY_BOOLEAN(equalBooleanOp, EqualBooleanFunction)
+
+      case ifThenElseBooleanOp:
+        ifThenElseBooleanKernel(b, (const unsigned char* )operands[t + 1], (const unsigned char* )operands[t + 2], booleanBuffer, count);
+        operands[t] = booleanBuffer;
+        break;
+
+      default:
+        jassertfalse;
+      };
+
+#undef EXPRESSION_PROGRAM_UNARY_DOUBLE
+#undef EXPRESSION_PROGRAM_BINARY_DOUBLE
+#undef EXPRESSION_PROGRAM_BINARY_BOOLEAN
+    }
+
+    // the result of the program is in the first register
+    bool shouldContinue = isBooleanProgram
+      ? callback.processBooleanBlock(blockRows, (const unsigned char* )operands[0], count)
+      : callback.processDoubleBlock(blockRows, (const double* )operands[0], count);
+    if (!shouldContinue)
+      return false;
+  }
+  return true;
+}
+
+DataVectorPtr ExpressionProgram::computePredictions(ExecutionContext& context, const ExpressionPtr& expression, const TablePtr& data, const IndexSetPtr& indices) const
+{
+  if (isCompiled())
+    return execute(indices);
+
+  FunctionExpressionPtr functionExpression = expression.dynamicCast<FunctionExpression>();
+  if (!functionExpression)
+    return expression->compute(context, data, indices);
+  std::vector<DataVectorPtr> inputs(functionExpression->getNumArguments());
+  for (size_t i = 0; i < inputs.size(); ++i)
+    inputs[i] = functionExpression->getArgument(i)->compute(context, data, indices);
+  return functionExpression->getFunction()->compute(context, inputs, functionExpression->getType());
+}
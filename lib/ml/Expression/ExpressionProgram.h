@@ -0,0 +1,135 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ExpressionProgram.h            | Flat program to evaluate        |
+| Author  : Francis Maes                   |  expressions on column blocks   |
+| Started : 16/10/2026 11:02               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_EXPRESSION_PROGRAM_H_
+# define ML_EXPRESSION_PROGRAM_H_
+
+# include <ml/Expression.h>
+
+namespace lbcpp
+{
+
+/*
+** An expression tree compiled into a postfix sequence of typed instructions.
+**
+** Leaves are either constants or DVector / BVector columns of the data table,
+** internal nodes are the built-in double and boolean functions. The program is
+** executed on blocks of rows: each instruction processes a whole block at once
+** with a tight loop, instead of dispatching on the DataVector implementation
+** for every element.
+*/
+class ExpressionProgram
+{
+public:
+  ExpressionProgram() : numRegisters(0), isBooleanProgram(false) {}
+
+  enum {blockSize = 256};
+
+  // returns false if some node of the expression is not supported
+  bool compile(const ExpressionPtr& expression, const TablePtr& data);
+
+  DataVectorPtr execute(const IndexSetPtr& indices) const;
+
+  // receives the results of the program block by block, instead of a DataVector
+  struct BlockCallback
+  {
+    virtual ~BlockCallback() {}
+
+    // values[i] is the result on row rows[i], return false to stop the execution
+    virtual bool processDoubleBlock(const size_t* rows, const double* values, size_t count)
+      {jassertfalse; return false;}
+    virtual bool processBooleanBlock(const size_t* rows, const unsigned char* values, size_t count)
+      {jassertfalse; return false;}
+  };
+
+  // returns false if the execution was stopped by the callback
+  bool execute(const IndexSetPtr& indices, BlockCallback& callback) const;
+
+  // to be called after compile(expression, data): executes the program if the compilation succeeded, and
+  // otherwise computes the arguments of the root function, that may compile, without compiling the root again
+  DataVectorPtr computePredictions(ExecutionContext& context, const ExpressionPtr& expression, const TablePtr& data, const IndexSetPtr& indices) const;
+
+  bool isCompiled() const
+    {return !instructions.empty();}
+
+  bool isBoolean() const
+    {return isBooleanProgram;}
+
+  size_t getNumInstructions() const
+    {return instructions.size();}
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  enum Opcode
+  {
+    // leaves
+    loadDoubleColumnOp = 0,
+    loadBooleanColumnOp,
+    loadDoubleConstantOp,
+    loadBooleanConstantOp,
+
+    // double -> double
+    oppositeDoubleOp,
+    inverseDoubleOp,
+    absDoubleOp,
+    logDoubleOp,
+    protectedLogDoubleOp,
+    expDoubleOp,
+    sqrtDoubleOp,
+    cosDoubleOp,
+    sinDoubleOp,
+
+    // double x double -> double
+    addDoubleOp,
+    subDoubleOp,
+    mulDoubleOp,
+    divDoubleOp,
+    protectedDivDoubleOp,
+    powDoubleOp,
+    minDoubleOp,
+    maxDoubleOp,
+
+    // booleans
+    notBooleanOp,
+    andBooleanOp,
+    orBooleanOp,
+    nandBooleanOp,
+    norBooleanOp,
+    equalBooleanOp,
+    ifThenElseBooleanOp,
+
+    noOp
+  };
+
+  struct Instruction
+  {
+    Instruction(Opcode opcode, size_t target, const Function* function = NULL)
+      : opcode(opcode), target(target), function(function), column(NULL), constant(0.0) {}
+
+    Opcode opcode;
+    size_t target;             // registers target, target + 1, ... are the operands
+    const Function* function;  // function whose computeDouble() / computeBoolean() is inlined
+    const void* column;        // loadDoubleColumnOp and loadBooleanColumnOp
+    double constant;           // loadDoubleConstantOp and loadBooleanConstantOp
+  };
+
+  std::vector<Instruction> instructions;
+  std::vector<VectorPtr> columns; // keeps the columns alive while the program exists
+  size_t numRegisters;
+  bool isBooleanProgram;
+  ClassPtr outputType;
+
+  bool compileNode(const ExpressionPtr& node, const TablePtr& data, size_t target, bool isRoot);
+  static Opcode getFunctionOpcode(const FunctionPtr& function);
+  static bool isBooleanOpcode(Opcode opcode);
+};
+
+}; /* namespace lbcpp */
+
+#endif // !ML_EXPRESSION_PROGRAM_H_
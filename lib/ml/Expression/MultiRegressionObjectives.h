@@ -34,7 +34,7 @@ public:
     double squaredError = 0.0;
     for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it)
     {
-      DenseDoubleVectorPtr vector = it.getRawObject().staticCast<DenseDoubleVector>();
+      const DenseDoubleVectorPtr& vector = it.getRawObject().staticCast<DenseDoubleVector>();
       for (size_t i = 0; i < numOutputs; ++i)
       {
         double prediction = vector->getValue(i);
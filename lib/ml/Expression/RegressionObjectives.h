@@ -10,10 +10,82 @@
 # define ML_EXPRESSION_REGRESSION_OBJECTIVES_H_
 
 # include <ml/Objective.h>
+# include "ExpressionProgram.h"
 
 namespace lbcpp
 {
 
+/*
+** Sum of the squared differences between the supervisions and the predictions,
+** missing or invalid predictions being replaced by 0.0. The predictions are accumulated
+** in row order, so that all the paths give exactly the same result.
+*/
+struct SquaredErrorAccumulator
+{
+  SquaredErrorAccumulator(const double* supervisions) : supervisions(supervisions), squaredError(0.0) {}
+
+  const double* supervisions;
+  double squaredError;
+
+  void add(size_t row, double prediction)
+  {
+    if (prediction == DVector::missingValue || !isNumberValid(prediction))
+      prediction = 0.0;
+    double delta = supervisions[row] - prediction;
+    squaredError += delta * delta;
+  }
+
+  // predictions[i] is the prediction for row rows[i]
+  void add(const size_t* rows, const double* predictions, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+      add(rows[i], predictions[i]);
+  }
+
+  void add(const DataVectorPtr& predictions)
+  {
+    const std::vector<size_t>& rows = predictions->getIndices()->getIndices();
+    const VectorPtr& vector = predictions->getVector();
+    if (predictions->getImplementation() == DataVector::ownedVectorImpl && vector.isInstanceOf<DVector>())
+    {
+      if (rows.size())
+        add(&rows[0], vector.staticCast<DVector>()->getDataPointer(), rows.size());
+    }
+    else if (predictions->getImplementation() == DataVector::cachedVectorImpl && vector.isInstanceOf<DVector>())
+    {
+      const double* values = vector.staticCast<DVector>()->getDataPointer();
+      for (size_t i = 0; i < rows.size(); ++i)
+        add(rows[i], values[rows[i]]);
+    }
+    else
+    {
+      bool areDoubles = predictions->getElementsType()->inheritsFrom(doubleClass);
+      for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it)
+        add(it.getIndex(), areDoubles ? it.getRawDouble() : it.getRawObject()->toDouble());
+    }
+  }
+};
+
+/*
+** Accumulates the squared errors of the predictions of an ExpressionProgram block by block,
+** without building a DataVector. Since the squared errors are positive, the execution can stop
+** as soon as the partial sum exceeds maxSquaredError.
+*/
+struct SquaredErrorBlockCallback : public ExpressionProgram::BlockCallback
+{
+  SquaredErrorBlockCallback(const double* supervisions, double maxSquaredError)
+    : accumulator(supervisions), maxSquaredError(maxSquaredError) {}
+
+  SquaredErrorAccumulator accumulator;
+  double maxSquaredError;
+
+  virtual bool processDoubleBlock(const size_t* rows, const double* values, size_t count)
+  {
+    accumulator.add(rows, values, count);
+    return accumulator.squaredError <= maxSquaredError;
+  }
+};
+
 class MSERegressionObjective : public SupervisedLearningObjective
 {
 public:
@@ -27,21 +99,32 @@ public:
   virtual double evaluatePredictions(ExecutionContext& context, DataVectorPtr predictions) const
   {
     DVectorPtr supervisions = getSupervisions().staticCast<DVector>();
-    
-    // compute mean absolute error
-    double squaredError = 0.0;
-    bool areDoubles = predictions->getElementsType()->inheritsFrom(doubleClass);
-    for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it)
-    {
-      double prediction =  (areDoubles ? it.getRawDouble() : it.getRawObject()->toDouble());
-      if (prediction == DVector::missingValue || !isNumberValid(prediction))
-        prediction = 0.0;
-      double delta = supervisions->get(it.getIndex()) - prediction;
-      squaredError += delta * delta;
-    }
-    // mean squared error
-    return squaredError / (double)supervisions->getNumElements();
+    SquaredErrorAccumulator accumulator(supervisions->getDataPointer());
+    accumulator.add(predictions);
+    return getValueFromSquaredError(accumulator.squaredError);
   }
+
+  virtual double evaluateExpression(ExecutionContext& context, const ExpressionPtr& expression, double cutoff = DBL_MAX) const
+  {
+    if (data->getDataByKey(expression))
+      return SupervisedLearningObjective::evaluateExpression(context, expression, cutoff);
+    ExpressionProgram program;
+    if (!program.compile(expression, data) || program.isBoolean())
+      return evaluatePredictions(context, program.computePredictions(context, expression, data, indices));
+
+    // when stopped, the partial sum gives a value that is already worse than cutoff
+    SquaredErrorBlockCallback callback(getSupervisions().staticCast<DVector>()->getDataPointer(), cutoff == DBL_MAX ? DBL_MAX : getMaxSquaredError(cutoff));
+    program.execute(indices, callback);
+    return getValueFromSquaredError(callback.accumulator.squaredError);
+  }
+
+protected:
+  virtual double getValueFromSquaredError(double squaredError) const
+    {return squaredError / (double)getSupervisions()->getNumElements();}
+
+  // the largest sum of squared errors whose value is not worse than cutoff
+  virtual double getMaxSquaredError(double cutoff) const
+    {return cutoff * (double)getSupervisions()->getNumElements();}
 };
 
 class RMSERegressionObjective : public MSERegressionObjective
@@ -51,8 +134,12 @@ public:
     : MSERegressionObjective(data, supervision) {}
   RMSERegressionObjective() {}
 
-  virtual double evaluatePredictions(ExecutionContext& context, DataVectorPtr predictions) const
-    {return sqrt(MSERegressionObjective::evaluatePredictions(context, predictions));}
+protected:
+  virtual double getValueFromSquaredError(double squaredError) const
+    {return sqrt(MSERegressionObjective::getValueFromSquaredError(squaredError));}
+
+  virtual double getMaxSquaredError(double cutoff) const
+    {return MSERegressionObjective::getMaxSquaredError(cutoff * cutoff);}
 };
 
 class NormalizedRMSERegressionObjective : public RMSERegressionObjective
@@ -65,10 +152,16 @@ public:
   virtual void getObjectiveRange(double& worst, double& best) const
     {worst = 0.0; best = 1.0;}
 
-  virtual double evaluatePredictions(ExecutionContext& context, DataVectorPtr predictions) const
+protected:
+  virtual double getValueFromSquaredError(double squaredError) const
+    {return 1.0 / (1.0 + RMSERegressionObjective::getValueFromSquaredError(squaredError));}
+
+  // this objective is maximised: the values below cutoff are the ones that are worse
+  virtual double getMaxSquaredError(double cutoff) const
   {
-    double rmse = RMSERegressionObjective::evaluatePredictions(context, predictions);
-    return 1.0 / (1.0 + rmse);
+    if (cutoff <= 0.0)
+      return DBL_MAX;
+    return cutoff >= 1.0 ? 0.0 : RMSERegressionObjective::getMaxSquaredError(1.0 / cutoff - 1.0);
   }
 };
 
@@ -92,26 +185,25 @@ public:
 
   virtual double evaluatePredictions(ExecutionContext& context, DataVectorPtr predictions) const
   {
-    double sumSquaredError = 0.0;
-    double sumSquaredErrorsFromMean = 0.0;
-    
-    DVectorPtr supervisions = getSupervisions().staticCast<DVector>();
-    
-    // compute mean absolute error
-    bool areDoubles = predictions->getElementsType()->inheritsFrom(doubleClass);
-    
-    for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it)
-    {
-      double prediction =  (areDoubles ? it.getRawDouble() : it.getRawObject()->toDouble());
-      if (prediction == DVector::missingValue || !isNumberValid(prediction))
-        prediction = 0.0;
-      double delta = supervisions->get(it.getIndex()) - prediction;
-      sumSquaredError += delta * delta;
-      delta = supervisions->get(it.getIndex()) - meanTarget;
-      sumSquaredErrorsFromMean += delta * delta;
-    }
-    
-    return sqrt(sumSquaredError / sumSquaredErrorsFromMean);
+    const double* supervisions = getSupervisions().staticCast<DVector>()->getDataPointer();
+    SquaredErrorAccumulator accumulator(supervisions);
+    accumulator.add(predictions);
+    return sqrt(accumulator.squaredError / computeSquaredErrorFromMean(predictions->getIndices(), supervisions));
+  }
+
+  virtual double evaluateExpression(ExecutionContext& context, const ExpressionPtr& expression, double cutoff = DBL_MAX) const
+  {
+    if (data->getDataByKey(expression))
+      return SupervisedLearningObjective::evaluateExpression(context, expression, cutoff);
+    ExpressionProgram program;
+    if (!program.compile(expression, data) || program.isBoolean())
+      return evaluatePredictions(context, program.computePredictions(context, expression, data, indices));
+
+    const double* supervisions = getSupervisions().staticCast<DVector>()->getDataPointer();
+    double squaredErrorFromMean = computeSquaredErrorFromMean(indices, supervisions);
+    SquaredErrorBlockCallback callback(supervisions, cutoff == DBL_MAX ? DBL_MAX : cutoff * cutoff * squaredErrorFromMean);
+    program.execute(indices, callback);
+    return sqrt(callback.accumulator.squaredError / squaredErrorFromMean);
   }
   
   virtual void getObjectiveRange(double& worst, double& best) const
@@ -119,6 +211,17 @@ public:
 
 protected:
   double meanTarget;
+
+  double computeSquaredErrorFromMean(const IndexSetPtr& indices, const double* supervisions) const
+  {
+    double res = 0.0;
+    for (IndexSet::const_iterator it = indices->begin(); it != indices->end(); ++it)
+    {
+      double delta = supervisions[*it] - meanTarget;
+      res += delta * delta;
+    }
+    return res;
+  }
 };
 
 }; /* namespace lbcpp */
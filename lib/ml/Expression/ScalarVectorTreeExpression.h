@@ -46,6 +46,18 @@ public:
     }
   }
 
+  // only trees with scalar predictions can be evaluated natively
+  virtual bool hasNativeCompute() const
+    {return isLeaf() ? prediction && prediction->getNumValues() == 1 : left->hasNativeCompute() && right->hasNativeCompute();}
+
+  virtual double computeNative(const double* inputs, double* stack) const
+  {
+    const ScalarVectorTreeNode* node = this;
+    while (!node->isLeaf())
+      node = static_cast<const ScalarVectorTreeNode* >((inputs[node->testVariable] < node->testThreshold ? node->left : node->right).get());
+    return node->prediction->getValue(0);
+  }
+
   virtual void addSample(const ObjectPtr& input, const ObjectPtr& output)
     {samples.push_back(Sample(input, output));}
   
@@ -100,6 +112,8 @@ protected:
 
   virtual DataVectorPtr computeSamples (ExecutionContext &context, const TablePtr &data, const IndexSetPtr &indices) const
   {
+    if (hasNativeCompute())
+      return NativeExpressionEvaluator(refCountedPointerFromThis(this)).computeSamples(data, indices, doubleClass);
     DVectorPtr vector;
     ObjectPtr pred = compute(context, data->getRow(0));
     vector = new DVector(pred->getClass(), indices->size());
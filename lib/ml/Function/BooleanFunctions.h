@@ -31,7 +31,13 @@ public:
     {return "!" + inputs[0]->toShortString();}
   
   virtual ObjectPtr compute(ExecutionContext& context, const ObjectPtr* inputs) const
-    {return inputs[0] ? new Boolean(!Boolean::get(inputs[0])) : ObjectPtr();}
+    {return inputs[0] ? ObjectPtr(Boolean::create(!Boolean::get(inputs[0]))) : ObjectPtr();}
+
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+    {return inputs[0] == DVector::missingValue ? DVector::missingValue : (inputs[0] ? 0.0 : 1.0);}
 
   virtual DataVectorPtr compute(ExecutionContext& context, const std::vector<DataVectorPtr>& inputs, ClassPtr outputType) const
   {
@@ -72,7 +78,17 @@ public:
   {
     if (!inputs[0] || !inputs[1])
       return ObjectPtr();
-    return new Boolean(computeBoolean(Boolean::get(inputs[0]), Boolean::get(inputs[1])));
+    return Boolean::create(computeBoolean(Boolean::get(inputs[0]), Boolean::get(inputs[1])));
+  }
+
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+  {
+    if (inputs[0] == DVector::missingValue || inputs[1] == DVector::missingValue)
+      return DVector::missingValue;
+    return computeBoolean(inputs[0] != 0.0, inputs[1] != 0.0) ? 1.0 : 0.0;
   }
 
   virtual DataVectorPtr compute(ExecutionContext& context, const std::vector<DataVectorPtr>& inputs, ClassPtr outputType) const
@@ -172,6 +188,12 @@ public:
     return Boolean::get(inputs[0]) ? inputs[1] : inputs[2];
   }
 
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+    {return inputs[0] == DVector::missingValue ? DVector::missingValue : (inputs[0] ? inputs[1] : inputs[2]);}
+
   virtual DataVectorPtr compute(ExecutionContext& context, const std::vector<DataVectorPtr>& inputs, ClassPtr outputType) const
   {
     DataVector::const_iterator it1 = inputs[0]->begin();
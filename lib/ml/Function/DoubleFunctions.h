@@ -32,6 +32,12 @@ public:
     return res == DVector::missingValue ? ObjectPtr() : ObjectPtr(new Double(res));
   }
 
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+    {return inputs[0] == DVector::missingValue ? DVector::missingValue : computeDouble(inputs[0]);}
+
   virtual DataVectorPtr compute(ExecutionContext& context, const std::vector<DataVectorPtr>& in, ClassPtr outputType) const
   {
     const DataVectorPtr& inputs = in[0];
@@ -158,6 +164,16 @@ public:
     return new Double(res);
   }
 
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+  {
+    if (inputs[0] == DVector::missingValue || inputs[1] == DVector::missingValue)
+      return DVector::missingValue;
+    return computeDouble(inputs[0], inputs[1]);
+  }
+
   virtual DataVectorPtr compute(ExecutionContext& context, const std::vector<DataVectorPtr>& inputs, ClassPtr outputType) const
   {
     DataVector::const_iterator it1 = inputs[0]->begin();
@@ -65,7 +65,7 @@ public:
       size_t n = features->getNumElements();
       VectorPtr res = vector(positiveIntegerClass, n);
       for (size_t i = 0; i < n; ++i)
-        res->setElement(i, new PositiveInteger(i));
+        res->setElement(i, Integer::create(positiveIntegerClass, i));
       return res;
     }
   }
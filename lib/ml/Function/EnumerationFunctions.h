@@ -40,7 +40,7 @@ public:
   {
     if (!inputs[0])
       return ObjectPtr();
-    return new Boolean(Integer::get(inputs[0]) == (juce::int64)value);
+    return Boolean::create(Integer::get(inputs[0]) == (juce::int64)value);
   }
 
   virtual VectorPtr getVariableCandidateValues(size_t index, const std::vector<ClassPtr>& inputTypes) const
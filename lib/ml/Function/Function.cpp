@@ -35,15 +35,16 @@ DataVectorPtr Function::compute(ExecutionContext& context, const std::vector<Dat
   for (size_t i = 0; i < it.size(); ++i)
     it[i] = inputs[i]->begin();
 
+  // the inputs are owned by the data vectors, so they are borrowed without updating their reference counts
+  std::vector< BorrowedObjectPtr<Object> > inputValues(inputs.size());
   for (size_t i = 0; i < n; ++i)
   {
-    std::vector<ObjectPtr> inputValues(inputs.size());
     for (size_t j = 0; j < inputValues.size(); ++j)
     {
       inputValues[j] = it[j].getRawObject();
       ++(it[j]);
     }
-    res->setElement(i, compute(context, &inputValues[0]));
+    res->setElement(i, compute(context, BorrowedObjectPtr<Object>::toPointerArray(&inputValues[0])));
   }
   return new DataVector(inputs[0]->getIndices(), res);
 }
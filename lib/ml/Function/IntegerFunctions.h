@@ -30,7 +30,18 @@ public:
   {
     if (!inputs[0] || !inputs[1])
       return ObjectPtr();
-    return new Integer(computeInteger(Integer::get(inputs[0]), Integer::get(inputs[1])));
+    return Integer::create(computeInteger(Integer::get(inputs[0]), Integer::get(inputs[1])));
+  }
+
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+  {
+    if (inputs[0] == DVector::missingValue || inputs[1] == DVector::missingValue)
+      return DVector::missingValue;
+    juce::int64 res = computeInteger((juce::int64)inputs[0], (juce::int64)inputs[1]);
+    return res == IVector::missingValue ? DVector::missingValue : (double)res;
   }
 };
 
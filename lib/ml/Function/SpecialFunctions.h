@@ -43,11 +43,17 @@ public:
     if (!inputs[0])
       return ObjectPtr();
     if (inputs[0].isInstanceOf<Double>())
-      return new Boolean(Double::get(inputs[0]) >= threshold);
+      return Boolean::create(Double::get(inputs[0]) >= threshold);
     else
-      return new Boolean((double)Integer::get(inputs[0]) >= threshold);
+      return Boolean::create((double)Integer::get(inputs[0]) >= threshold);
   }
 
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+    {return inputs[0] == DVector::missingValue ? DVector::missingValue : (inputs[0] >= threshold ? 1.0 : 0.0);}
+
   virtual DataVectorPtr compute(ExecutionContext& context, const std::vector<DataVectorPtr>& inputs, ClassPtr outputType) const
   {
     const DataVectorPtr& scalars = inputs[0];
@@ -147,7 +153,17 @@ public:
   {
     if (!inputs[0] || !inputs[1])
       return ObjectPtr();
-    return new Boolean(Double::get(inputs[0]) > Double::get(inputs[1]));
+    return Boolean::create(Double::get(inputs[0]) > Double::get(inputs[1]));
+  }
+
+  virtual bool hasNativeCompute() const
+    {return true;}
+
+  virtual double computeNative(const double* inputs) const
+  {
+    if (inputs[0] == DVector::missingValue || inputs[1] == DVector::missingValue)
+      return DVector::missingValue;
+    return inputs[0] > inputs[1] ? 1.0 : 0.0;
   }
 
   virtual Flags getFlags() const
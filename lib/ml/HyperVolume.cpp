@@ -0,0 +1,506 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: HyperVolume.cpp                | Exact, incremental and Monte    |
+| Author  : Francis Maes                   |  Carlo hypervolume computation  |
+| Started : 16/10/2026 14:40               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <ml/HyperVolume.h>
+#include <algorithm>
+using namespace lbcpp;
+
+namespace lbcpp
+{
+
+// sorts point indices by increasing value of one objective, ties being broken by the following objectives
+struct HyperVolumePointLess
+{
+  HyperVolumePointLess(const double* points, size_t numObjectives, size_t objective)
+    : points(points), numObjectives(numObjectives), objective(objective) {}
+
+  const double* points;
+  size_t numObjectives;
+  size_t objective;
+
+  bool operator()(size_t a, size_t b) const
+  {
+    const double* pa = points + a * numObjectives;
+    const double* pb = points + b * numObjectives;
+    for (size_t i = objective; i < numObjectives; ++i)
+      if (pa[i] != pb[i])
+        return pa[i] < pb[i];
+    return false;
+  }
+};
+
+/*
+** Two-dimensional staircase of non-dominated points, whose x values are increasing and
+** y values are decreasing, with the area they dominate within the reference box.
+*/
+struct HyperVolumeStaircase
+{
+  HyperVolumeStaircase(std::map<double, double>& points, double referenceX, double referenceY)
+    : points(points), referenceX(referenceX), referenceY(referenceY) {}
+
+  std::map<double, double>& points;
+  double referenceX;
+  double referenceY;
+
+  // returns the added area
+  double insert(double x, double y)
+  {
+    if (x >= referenceX || y >= referenceY)
+      return 0.0;
+    std::map<double, double>::iterator it = points.lower_bound(x);
+    if (it != points.end() && it->first == x && it->second <= y)
+      return 0.0; // weakly dominated by a point with the same x
+    double top = referenceY;
+    if (it != points.begin())
+    {
+      std::map<double, double>::iterator previous = it;
+      --previous;
+      if (previous->second <= y)
+        return 0.0; // weakly dominated by the previous point
+      top = previous->second;
+    }
+
+    // discard the dominated points, adding the area that was between them and the new point
+    double res = 0.0;
+    double currentX = x;
+    while (it != points.end() && it->second >= y)
+    {
+      res += (it->first - currentX) * (top - y);
+      currentX = it->first;
+      top = it->second;
+      points.erase(it++);
+    }
+    double nextX = (it == points.end() ? referenceX : it->first);
+    res += (nextX - currentX) * (top - y);
+    points.insert(it, std::make_pair(x, y));
+    return res;
+  }
+
+  // returns the removed area
+  double remove(double x, double y)
+  {
+    std::map<double, double>::iterator it = points.find(x);
+    if (it == points.end() || it->second != y)
+      return 0.0;
+    return getContribution(it, true);
+  }
+
+  double getContribution(std::map<double, double>::iterator it, bool erase)
+  {
+    std::map<double, double>::iterator next = it;
+    ++next;
+    double nextX = (next == points.end() ? referenceX : next->first);
+    double top = referenceY;
+    if (it != points.begin())
+    {
+      std::map<double, double>::iterator previous = it;
+      --previous;
+      top = previous->second;
+    }
+    double res = (nextX - it->first) * (top - it->second);
+    if (erase)
+      points.erase(it);
+    return res;
+  }
+};
+
+}; /* namespace lbcpp */
+
+static bool isInsideReferenceBox(const double* point, size_t numObjectives, const double* reference)
+{
+  for (size_t i = 0; i < numObjectives; ++i)
+    if (point[i] >= reference[i])
+      return false;
+  return true;
+}
+
+static bool weaklyDominates(const double* point1, const double* point2, size_t numObjectives)
+{
+  for (size_t i = 0; i < numObjectives; ++i)
+    if (point1[i] > point2[i])
+      return false;
+  return true;
+}
+
+static double computeBoxVolume(const double* point, size_t numObjectives, const double* reference)
+{
+  double res = 1.0;
+  for (size_t i = 0; i < numObjectives; ++i)
+    res *= reference[i] - point[i];
+  return res;
+}
+
+static double computeHyperVolume2D(const double* points, size_t numPoints, const double* reference)
+{
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), HyperVolumePointLess(points, 2, 0));
+
+  double res = 0.0;
+  double top = reference[1];
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const double* point = points + order[i] * 2;
+    if (point[1] < top)
+    {
+      res += (reference[0] - point[0]) * (top - point[1]);
+      top = point[1];
+    }
+  }
+  return res;
+}
+
+static double computeHyperVolume3D(const double* points, size_t numPoints, const double* reference)
+{
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), HyperVolumePointLess(points, 3, 2));
+
+  // sweep along the third objective, the section being the area of the staircase of the points already seen
+  std::map<double, double> staircasePoints;
+  HyperVolumeStaircase staircase(staircasePoints, reference[0], reference[1]);
+  double area = 0.0;
+  double res = 0.0;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const double* point = points + order[i] * 3;
+    if (i > 0)
+      res += area * (point[2] - points[order[i - 1] * 3 + 2]);
+    area += staircase.insert(point[0], point[1]);
+  }
+  res += area * (reference[2] - points[order[numPoints - 1] * 3 + 2]);
+  return res;
+}
+
+// the points must be inside the reference box
+static double computeHyperVolumeRec(const double* points, size_t numPoints, size_t numObjectives, const double* reference)
+{
+  if (numPoints == 0)
+    return 0.0;
+  if (numPoints == 1)
+    return computeBoxVolume(points, numObjectives, reference);
+  if (numObjectives == 1)
+  {
+    double best = points[0];
+    for (size_t i = 1; i < numPoints; ++i)
+      best = std::min(best, points[i]);
+    return reference[0] - best;
+  }
+  if (numObjectives == 2)
+    return computeHyperVolume2D(points, numPoints, reference);
+  if (numObjectives == 3)
+    return computeHyperVolume3D(points, numPoints, reference);
+
+  // WFG: the points are processed by decreasing value of their last objective, so that the
+  // following points, once limited by the current point, all have the same last objective
+  size_t last = numObjectives - 1;
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), HyperVolumePointLess(points, numObjectives, last));
+  std::reverse(order.begin(), order.end());
+
+  std::vector<double> limited;
+  std::vector<double> limitedPoint(last);
+  double res = 0.0;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const double* point = points + order[i] * numObjectives;
+
+    // non-dominated points of the following points, limited by the current point
+    limited.clear();
+    size_t numLimited = 0;
+    for (size_t j = i + 1; j < numPoints; ++j)
+    {
+      const double* other = points + order[j] * numObjectives;
+      for (size_t k = 0; k < last; ++k)
+        limitedPoint[k] = std::max(point[k], other[k]);
+      bool isDominated = false;
+      for (size_t k = 0; k < numLimited && !isDominated; ++k)
+        isDominated = weaklyDominates(&limited[k * last], &limitedPoint[0], last);
+      if (isDominated)
+        continue;
+      size_t numKept = 0;
+      for (size_t k = 0; k < numLimited; ++k)
+        if (!weaklyDominates(&limitedPoint[0], &limited[k * last], last))
+        {
+          if (numKept != k)
+            std::copy(limited.begin() + k * last, limited.begin() + (k + 1) * last, limited.begin() + numKept * last);
+          ++numKept;
+        }
+      limited.resize(numKept * last);
+      limited.insert(limited.end(), limitedPoint.begin(), limitedPoint.end());
+      numLimited = numKept + 1;
+    }
+
+    double exclusive = computeBoxVolume(point, last, reference)
+      - (numLimited ? computeHyperVolumeRec(&limited[0], numLimited, last, reference) : 0.0);
+    res += (reference[last] - point[last]) * exclusive;
+  }
+  return res;
+}
+
+static size_t selectPointsInsideReferenceBox(const double* points, size_t numPoints, size_t numObjectives, const double* reference, std::vector<double>& res)
+{
+  res.clear();
+  res.reserve(numPoints * numObjectives);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const double* point = points + i * numObjectives;
+    if (isInsideReferenceBox(point, numObjectives, reference))
+      res.insert(res.end(), point, point + numObjectives);
+  }
+  return res.size() / (numObjectives ? numObjectives : 1);
+}
+
+/*
+** HyperVolume
+*/
+double HyperVolume::compute(const double* points, size_t numPoints, size_t numObjectives, const double* reference)
+{
+  if (!numObjectives)
+    return 0.0;
+  std::vector<double> selected;
+  size_t n = selectPointsInsideReferenceBox(points, numPoints, numObjectives, reference, selected);
+  return n ? computeHyperVolumeRec(&selected[0], n, numObjectives, reference) : 0.0;
+}
+
+double HyperVolume::computeContribution(const double* point, const double* otherPoints, size_t numOtherPoints, size_t numObjectives, const double* reference)
+{
+  if (!numObjectives || !isInsideReferenceBox(point, numObjectives, reference))
+    return 0.0;
+
+  // the hypervolume of the box of the point that is not dominated by the other points
+  std::vector<double> limited;
+  limited.reserve(numOtherPoints * numObjectives);
+  for (size_t i = 0; i < numOtherPoints; ++i)
+  {
+    const double* other = otherPoints + i * numObjectives;
+    if (!isInsideReferenceBox(other, numObjectives, reference))
+      continue;
+    if (weaklyDominates(other, point, numObjectives))
+      return 0.0;
+    for (size_t j = 0; j < numObjectives; ++j)
+      limited.push_back(std::max(point[j], other[j]));
+  }
+  size_t n = limited.size() / numObjectives;
+  double res = computeBoxVolume(point, numObjectives, reference) - (n ? computeHyperVolumeRec(&limited[0], n, numObjectives, reference) : 0.0);
+  return res > 0.0 ? res : 0.0;
+}
+
+void HyperVolume::computeContributions(const double* points, size_t numPoints, size_t numObjectives, const double* reference, std::vector<double>& res)
+{
+  res.clear();
+  res.resize(numPoints, 0.0);
+  if (!numObjectives)
+    return;
+
+  if (numObjectives == 2)
+  {
+    // if the points are mutually non-dominated, the contribution of a point only depends on its neighbours
+    std::map<double, double> staircasePoints;
+    HyperVolumeStaircase staircase(staircasePoints, reference[0], reference[1]);
+    size_t numInside = 0;
+    bool isNonDominated = true;
+    for (size_t i = 0; i < numPoints && isNonDominated; ++i)
+    {
+      const double* point = points + i * 2;
+      if (isInsideReferenceBox(point, 2, reference))
+      {
+        ++numInside;
+        staircase.insert(point[0], point[1]);
+        isNonDominated = (staircasePoints.size() == numInside);
+      }
+    }
+    if (isNonDominated)
+    {
+      for (size_t i = 0; i < numPoints; ++i)
+      {
+        const double* point = points + i * 2;
+        if (isInsideReferenceBox(point, 2, reference))
+          res[i] = staircase.getContribution(staircasePoints.find(point[0]), false);
+      }
+      return;
+    }
+  }
+
+  std::vector<double> otherPoints;
+  otherPoints.reserve(numPoints * numObjectives);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    otherPoints.clear();
+    otherPoints.insert(otherPoints.end(), points, points + i * numObjectives);
+    otherPoints.insert(otherPoints.end(), points + (i + 1) * numObjectives, points + numPoints * numObjectives);
+    res[i] = computeContribution(points + i * numObjectives, otherPoints.size() ? &otherPoints[0] : NULL, numPoints - 1, numObjectives, reference);
+  }
+}
+
+double HyperVolume::estimate(const double* points, size_t numPoints, size_t numObjectives, const double* reference,
+                             const RandomGeneratorPtr& random, size_t numSamples, double& standardError)
+{
+  standardError = 0.0;
+  std::vector<double> selected;
+  size_t n = numObjectives ? selectPointsInsideReferenceBox(points, numPoints, numObjectives, reference, selected) : 0;
+  if (!n || !numSamples)
+    return 0.0;
+
+  // the samples are drawn in the box between the ideal point and the reference point
+  std::vector<double> ideal(selected.begin(), selected.begin() + numObjectives);
+  for (size_t i = 1; i < n; ++i)
+    for (size_t j = 0; j < numObjectives; ++j)
+      ideal[j] = std::min(ideal[j], selected[i * numObjectives + j]);
+  double boxVolume = computeBoxVolume(&ideal[0], numObjectives, reference);
+
+  std::vector<double> sample(numObjectives);
+  size_t numDominatedSamples = 0;
+  size_t lastDominatingPoint = 0; // neighbouring samples are often dominated by the same point
+  for (size_t i = 0; i < numSamples; ++i)
+  {
+    for (size_t j = 0; j < numObjectives; ++j)
+      sample[j] = ideal[j] + random->sampleDouble() * (reference[j] - ideal[j]);
+    for (size_t k = 0; k < n; ++k)
+    {
+      size_t index = (lastDominatingPoint + k) % n;
+      if (weaklyDominates(&selected[index * numObjectives], &sample[0], numObjectives))
+      {
+        ++numDominatedSamples;
+        lastDominatingPoint = index;
+        break;
+      }
+    }
+  }
+
+  double p = numDominatedSamples / (double)numSamples;
+  standardError = boxVolume * sqrt(p * (1.0 - p) / numSamples);
+  return boxVolume * p;
+}
+
+/*
+** IncrementalHyperVolume
+*/
+void IncrementalHyperVolume::initialize(size_t numObjectives, const std::vector<double>& reference)
+{
+  jassert(reference.size() == numObjectives);
+  this->numObjectives = numObjectives;
+  this->reference = reference;
+  clear();
+}
+
+void IncrementalHyperVolume::initialize(size_t numObjectives, const std::vector<double>& reference, const double* points, size_t numPoints)
+{
+  initialize(numObjectives, reference);
+  if (numObjectives == 2)
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+      insert(points + i * 2);
+    value = HyperVolume::compute(points, numPoints, numObjectives, &reference[0]); // avoids accumulating rounding errors
+  }
+  else
+  {
+    for (size_t i = 0; i < numPoints; ++i)
+      if (isInsideReferenceBox(points + i * numObjectives, numObjectives, &reference[0]))
+        this->points.insert(this->points.end(), points + i * numObjectives, points + (i + 1) * numObjectives);
+    size_t n = this->points.size() / numObjectives;
+    value = n ? computeHyperVolumeRec(&this->points[0], n, numObjectives, &reference[0]) : 0.0;
+  }
+}
+
+void IncrementalHyperVolume::clear()
+{
+  value = 0.0;
+  staircase.clear();
+  points.clear();
+}
+
+double IncrementalHyperVolume::insert(const double* point)
+{
+  jassert(isInitialized());
+  double res;
+  if (numObjectives == 2)
+    res = HyperVolumeStaircase(staircase, reference[0], reference[1]).insert(point[0], point[1]);
+  else
+  {
+    if (!isInsideReferenceBox(point, numObjectives, &reference[0]))
+      return 0.0;
+    size_t n = points.size() / numObjectives;
+    for (size_t i = 0; i < n; ++i)
+      if (weaklyDominates(&points[i * numObjectives], point, numObjectives))
+        return 0.0;
+    res = HyperVolume::computeContribution(point, n ? &points[0] : NULL, n, numObjectives, &reference[0]);
+
+    // discard the points that are dominated by the new point
+    size_t numKept = 0;
+    for (size_t i = 0; i < n; ++i)
+      if (!weaklyDominates(point, &points[i * numObjectives], numObjectives))
+      {
+        if (numKept != i)
+          std::copy(points.begin() + i * numObjectives, points.begin() + (i + 1) * numObjectives, points.begin() + numKept * numObjectives);
+        ++numKept;
+      }
+    points.resize(numKept * numObjectives);
+    points.insert(points.end(), point, point + numObjectives);
+  }
+  value += res;
+  return res;
+}
+
+double IncrementalHyperVolume::remove(const double* point)
+{
+  jassert(isInitialized());
+  double res;
+  if (numObjectives == 2)
+    res = HyperVolumeStaircase(staircase, reference[0], reference[1]).remove(point[0], point[1]);
+  else
+  {
+    size_t n = points.size() / numObjectives;
+    size_t index = 0;
+    while (index < n && !std::equal(point, point + numObjectives, points.begin() + index * numObjectives))
+      ++index;
+    if (index == n)
+      return 0.0;
+    points.erase(points.begin() + index * numObjectives, points.begin() + (index + 1) * numObjectives);
+    --n;
+    res = HyperVolume::computeContribution(point, n ? &points[0] : NULL, n, numObjectives, &reference[0]);
+  }
+  value -= res;
+  if (value < 0.0)
+    value = 0.0;
+  return res;
+}
+
+double IncrementalHyperVolume::computeContribution(const double* point) const
+{
+  jassert(isInitialized());
+  if (numObjectives == 2)
+  {
+    std::map<double, double>& staircasePoints = const_cast<std::map<double, double>& >(staircase);
+    std::map<double, double>::iterator it = staircasePoints.find(point[0]);
+    if (it == staircasePoints.end() || it->second != point[1])
+      return 0.0;
+    return HyperVolumeStaircase(staircasePoints, reference[0], reference[1]).getContribution(it, false);
+  }
+
+  // contribution of a point of the set with respect to the other points
+  std::vector<double> otherPoints;
+  otherPoints.reserve(points.size());
+  size_t n = points.size() / numObjectives;
+  bool found = false;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const double* other = &points[i * numObjectives];
+    if (!found && std::equal(point, point + numObjectives, other))
+      found = true;
+    else
+      otherPoints.insert(otherPoints.end(), other, other + numObjectives);
+  }
+  if (!found)
+    return 0.0;
+  return HyperVolume::computeContribution(point, otherPoints.size() ? &otherPoints[0] : NULL, n - 1, numObjectives, &reference[0]);
+}
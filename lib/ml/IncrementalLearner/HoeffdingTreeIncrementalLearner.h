@@ -25,15 +25,40 @@ typedef ReferenceCountedObjectPtr<HoeffdingTreeIncrementalLearnerStatistics> Hoe
 class HoeffdingTreeIncrementalLearnerStatistics : public IncrementalLearnerStatistics
 {
 public:
-  HoeffdingTreeIncrementalLearnerStatistics(size_t numAttributes = 0) : ebsts(std::vector<ExtendedBinarySearchTreePtr>(numAttributes)), splitRatios(new ScalarVariableMean())
+  HoeffdingTreeIncrementalLearnerStatistics(size_t numAttributes = 0) : ebsts(std::vector<ExtendedBinarySearchTreePtr>(numAttributes)), splitRatios(new ScalarVariableMean()),
+    useCompactEBSTs(false), maxEBSTNodes(0), ebstQuantisationStep(0.0)
   {
     for (size_t i = 0; i < numAttributes; ++i)
       ebsts[i] = new ExtendedBinarySearchTree();
   }
 
+  /* Store the E-BSTs in contiguous arrays, must be called before the first observation
+   * \param maxNumNodes maximum number of nodes per E-BST, 0 for no limit
+   * \param quantisationStep attribute values are rounded to multiples of this step, 0 for no rounding
+   */
+  void setCompactEBSTs(size_t maxNumNodes, double quantisationStep)
+  {
+    jassert(getExamplesSeen() == 0);
+    useCompactEBSTs = true;
+    maxEBSTNodes = maxNumNodes;
+    ebstQuantisationStep = quantisationStep;
+    ebsts.clear();
+  }
+
   void addObservation(const DenseDoubleVectorPtr& attributes, double target)
   {
     incrementExamplesSeen();
+    if (useCompactEBSTs)
+    {
+      if (compactEBSTs.size() == 0)
+        for (size_t i = 0; i < attributes->getNumValues(); ++i)
+          compactEBSTs.push_back(new CompactExtendedBinarySearchTree(maxEBSTNodes, ebstQuantisationStep));
+      jassert(attributes->getNumValues() == compactEBSTs.size());
+      compactEBSTRoots.clear();
+      for (size_t i = 0; i < compactEBSTs.size(); ++i)
+        compactEBSTs[i]->insertValue(attributes->getValue(i), attributes, target);
+      return;
+    }
     if (ebsts.size() == 0)
       for (size_t i = 0; i < attributes->getNumValues(); ++i)
         ebsts.push_back(new ExtendedBinarySearchTree());
@@ -48,11 +73,28 @@ public:
     result->ebsts = std::vector<ExtendedBinarySearchTreePtr>(ebsts.size());
     for (size_t i = 0; i < ebsts.size(); ++i)
       result->ebsts[i] = ebsts[i]->clone(context);
+    result->useCompactEBSTs = useCompactEBSTs;
+    result->maxEBSTNodes = maxEBSTNodes;
+    result->ebstQuantisationStep = ebstQuantisationStep;
+    result->compactEBSTs = std::vector<CompactExtendedBinarySearchTreePtr>(compactEBSTs.size());
+    for (size_t i = 0; i < compactEBSTs.size(); ++i)
+      result->compactEBSTs[i] = compactEBSTs[i]->clone(context);
     return result;
   }
 
+  /* With compact E-BSTs, the returned trees are views of the compact trees, valid until the next observation */
   const std::vector<ExtendedBinarySearchTreePtr>& getEBSTs() const
-    {return ebsts;}
+  {
+    if (!useCompactEBSTs)
+      return ebsts;
+    if (compactEBSTRoots.size() != compactEBSTs.size())
+    {
+      compactEBSTRoots.resize(compactEBSTs.size());
+      for (size_t i = 0; i < compactEBSTs.size(); ++i)
+        compactEBSTRoots[i] = compactEBSTs[i]->getRoot();
+    }
+    return compactEBSTRoots;
+  }
 
   ScalarVariableMeanPtr getSplitRatios() const
     {return splitRatios;}
@@ -68,8 +110,12 @@ public:
   size_t getTotalEBSTNodes() const
   {
     size_t result = 0;
-    for (size_t i = 0; i < ebsts.size(); ++i)
-      result += ebsts[i]->getSize();
+    if (useCompactEBSTs)
+      for (size_t i = 0; i < compactEBSTs.size(); ++i)
+        result += compactEBSTs[i]->getSize();
+    else
+      for (size_t i = 0; i < ebsts.size(); ++i)
+        result += ebsts[i]->getSize();
     return result;
   }
 
@@ -82,23 +128,29 @@ public:
 protected:
   friend class HoeffdingTreeIncrementalLearnerStatisticsClass;
 
-  std::vector<ExtendedBinarySearchTreePtr> ebsts;
+  std::vector<ExtendedBinarySearchTreePtr> ebsts; // empty with compact E-BSTs
   ScalarVariableMeanPtr splitRatios;
   IncrementalSplittingCriterion::Split bestSplit, secondBestSplit;
+
+  bool useCompactEBSTs;
+  size_t maxEBSTNodes;
+  double ebstQuantisationStep;
+  std::vector<CompactExtendedBinarySearchTreePtr> compactEBSTs;
+  mutable std::vector<ExtendedBinarySearchTreePtr> compactEBSTRoots;
 };
 
 class HoeffdingTreeIncrementalLearner : public IncrementalLearner
 {
 public:
-  HoeffdingTreeIncrementalLearner() {}
+  HoeffdingTreeIncrementalLearner() : pruneOnly(true), compactEBSTs(false), maxEBSTNodes(0), ebstQuantisationStep(0.0) {}
 
 	HoeffdingTreeIncrementalLearner(IncrementalSplittingCriterionPtr splittingCriterion, IncrementalLearnerPtr modelLearner) : 
-    splittingCriterion(splittingCriterion), modelLearner(modelLearner), pruneOnly(true) {}
+    splittingCriterion(splittingCriterion), modelLearner(modelLearner), pruneOnly(true), compactEBSTs(false), maxEBSTNodes(0), ebstQuantisationStep(0.0) {}
 
   ExpressionPtr createExpression(ExecutionContext& context, ClassPtr supervisionType) const 
   {
     HoeffdingTreeNodePtr result = new HoeffdingTreeNode(modelLearner->createExpression(context, doubleClass));
-    result->setLearnerStatistics(new HoeffdingTreeIncrementalLearnerStatistics());
+    result->setLearnerStatistics(createLeafStatistics());
     return result;
   }
 
@@ -124,6 +176,11 @@ public:
     {
       std::pair<MultiVariateRegressionStatisticsPtr, MultiVariateRegressionStatisticsPtr> regressionStats = leafStats->getEBSTs()[split.attribute]->getStatsForSplit(split.value);
       leaf->split(context, split.attribute, split.value);
+      if (compactEBSTs)
+      {
+        leaf->getLeft()->setLearnerStatistics(createLeafStatistics());
+        leaf->getRight()->setLearnerStatistics(createLeafStatistics());
+      }
       modelLearner->initialiseLearnerStatistics(context, leaf->getLeft().staticCast<HoeffdingTreeNode>()->getModel(), regressionStats.first);
       modelLearner->initialiseLearnerStatistics(context, leaf->getRight().staticCast<HoeffdingTreeNode>()->getModel(), regressionStats.second);
       leaf->setLearnerStatistics(HoeffdingTreeIncrementalLearnerStatisticsPtr());
@@ -154,6 +211,17 @@ protected:
   IncrementalLearnerPtr modelLearner;
   IncrementalSplittingCriterionPtr splittingCriterion;
 	bool pruneOnly; /* whether to prune only or to generate alternate trees for drift detection */
+  bool compactEBSTs; /* whether to store the E-BSTs in contiguous arrays */
+  size_t maxEBSTNodes; /* maximum number of nodes per compact E-BST, 0 for no limit */
+  double ebstQuantisationStep; /* rounding step of the attribute values in compact E-BSTs, 0 for no rounding */
+
+  HoeffdingTreeIncrementalLearnerStatisticsPtr createLeafStatistics() const
+  {
+    HoeffdingTreeIncrementalLearnerStatisticsPtr res = new HoeffdingTreeIncrementalLearnerStatistics();
+    if (compactEBSTs)
+      res->setCompactEBSTs(maxEBSTNodes, ebstQuantisationStep);
+    return res;
+  }
 };
 
 typedef ReferenceCountedObjectPtr<HoeffdingTreeIncrementalLearner> HoeffdingTreeIncrementalLearnerPtr;
@@ -15,14 +15,34 @@
 namespace lbcpp
 {
 
+/*
+** If an AggregatorExpression is given as starting solution, only a fraction warmStartRefreshRate
+** of its base models is learned again: the oldest base models are replaced by new ones and the
+** other ones are kept. The default rate of 1 learns the whole ensemble again.
+*/
 class EnsembleLearner : public Solver
 {
 public:
   EnsembleLearner(size_t ensembleSize = 0)
-    : ensembleSize(ensembleSize) {}
+    : ensembleSize(ensembleSize), warmStartRefreshRate(1.0) {}
+
+  void setWarmStartRefreshRate(double warmStartRefreshRate)
+    {jassert(warmStartRefreshRate >= 0.0 && warmStartRefreshRate <= 1.0); this->warmStartRefreshRate = warmStartRefreshRate;}
 
   virtual ExpressionPtr makeExpression(ExecutionContext& context, size_t iter) = 0;
 
+  virtual void startSolver(ExecutionContext& context, ProblemPtr problem, SolverCallbackPtr callback, ObjectPtr startingSolution)
+  {
+    Solver::startSolver(context, problem, callback, startingSolution);
+    startingEnsemble = startingSolution.dynamicCast<AggregatorExpression>();
+  }
+
+  virtual void stopSolver(ExecutionContext& context)
+  {
+    Solver::stopSolver(context);
+    startingEnsemble = AggregatorExpressionPtr();
+  }
+
   virtual void runSolver(ExecutionContext& context)
   {
     // get training and validation objectives
@@ -45,9 +65,25 @@ public:
     ObjectPtr validationData;
     if (validationObjective && verbosity >= verbosityDetailed)
       validationData = aggregator->startAggregation(validationObjective->getIndices(), inputsType, outputType);
+
+    // keep the most recent base models of the starting ensemble
+    size_t numKeptExpressions = getNumKeptExpressions();
+    if (numKeptExpressions)
+    {
+      const std::vector<ExpressionPtr>& nodes = startingEnsemble->getNodes();
+      for (size_t i = nodes.size() - numKeptExpressions; i < nodes.size(); ++i)
+      {
+        res->pushNode(nodes[i]);
+        aggregator->updateAggregation(trainingData, nodes[i]->compute(context, objective->getData(), objective->getIndices()));
+        if (validationData)
+          aggregator->updateAggregation(validationData, nodes[i]->compute(context, validationObjective->getData(), validationObjective->getIndices()));
+      }
+      if (verbosity >= verbosityDetailed)
+        context.resultCallback(T("numKeptBaseModels"), numKeptExpressions);
+    }
     
     // build ensemble
-    for (size_t i = 0; i < ensembleSize; ++i)
+    for (size_t i = numKeptExpressions; i < ensembleSize; ++i)
     {
       if (verbosity >= verbosityDetailed)
       {
@@ -91,6 +127,19 @@ protected:
   friend class EnsembleLearnerClass;
 
   size_t ensembleSize;
+  double warmStartRefreshRate;
+
+  AggregatorExpressionPtr startingEnsemble;
+
+  size_t getNumKeptExpressions() const
+  {
+    if (!startingEnsemble)
+      return 0;
+    size_t numRefreshed = (size_t)ceil(warmStartRefreshRate * (double)ensembleSize);
+    size_t res = ensembleSize - (numRefreshed < ensembleSize ? numRefreshed : ensembleSize);
+    size_t numNodes = startingEnsemble->getNumSubNodes();
+    return res < numNodes ? res : numNodes;
+  }
 };
 
 class SimpleEnsembleLearner : public EnsembleLearner
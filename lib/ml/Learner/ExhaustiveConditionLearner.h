@@ -13,7 +13,8 @@
 # include <ml/Expression.h>
 # include <ml/Sampler.h>
 # include <ml/SplittingCriterion.h>
-# include <algorithm>
+# include <oil/Execution/WorkUnit.h>
+# include "SortedValuesCache.h"
 
 namespace lbcpp
 {
@@ -22,16 +23,37 @@ class ExhaustiveConditionLearner : public Solver
 {
 public:
   ExhaustiveConditionLearner(SamplerPtr expressionsSampler)
-    : expressionsSampler(expressionsSampler) {}
-  ExhaustiveConditionLearner() {}
+    : expressionsSampler(expressionsSampler), evaluationBatchSize(0), numBins(0), sortedValuesCache(new SortedValuesCache()) {}
+  ExhaustiveConditionLearner() : evaluationBatchSize(0), numBins(0), sortedValuesCache(new SortedValuesCache()) {}
+
+  /** Number of candidate expressions scored by each work unit. Each work unit scores its candidates
+   *  with its own copy of the splitting criterion. 0 scores all the candidates sequentially.
+   */
+  void setEvaluationBatchSize(size_t evaluationBatchSize)
+    {this->evaluationBatchSize = evaluationBatchSize;}
+
+  /** Number of quantile bins of the scalar expressions. When it is non-zero, thresholds are only
+   *  searched between bins, which avoids sorting the examples within each bin. 0 searches all the
+   *  thresholds between distinct values.
+   */
+  void setNumBins(size_t numBins)
+    {this->numBins = numBins;}
 
   virtual void stopBatch(ExecutionContext& context)
-    {sortedValuesCache.clear();}
+    {sortedValuesCache->clear();}
+
+  // clones share the sorted values cache, so that the sub-trees grown in parallel by TreeLearner reuse the same sorts
+  virtual void clone(ExecutionContext& context, const ObjectPtr& target) const
+  {
+    Solver::clone(context, target);
+    target.staticCast<ExhaustiveConditionLearner>()->sortedValuesCache = sortedValuesCache;
+  }
 
   virtual void startSolver(ExecutionContext& context, ProblemPtr problem, SolverCallbackPtr callback, ObjectPtr startingSolution)
   {
     Solver::startSolver(context, problem, callback, startingSolution);
     expressionsSampler->initialize(context, vectorDomain(problem->getDomain()));
+    sortedValuesCache->setNumBins(numBins);
   }
 
   virtual void runSolver(ExecutionContext& context)
@@ -39,26 +61,70 @@ public:
     SplittingCriterionPtr splittingCriterion = problem->getObjective(0).staticCast<SplittingCriterion>();
 
     IndexSetPtr indices = splittingCriterion->getIndices();
+    sortedValuesCache->removeUnusedNodes(); // forgets the sorted values of the nodes that are finished
 
-    // counts[i] is the number of times that index i appears in indices
+    // counts[i] is 1 if index i appears in indices
     std::vector<size_t> counts(splittingCriterion->getData()->getNumRows(), 0);
     for (IndexSet::const_iterator it = indices->begin(); it != indices->end(); ++it)
       ++counts[*it] = 1;
     
     OVectorPtr expressions = expressionsSampler->sample(context).staticCast<OVector>();
-    for (size_t i = 0; i < expressions->getNumElements(); ++i)
+    size_t n = expressions->getNumElements();
+    std::vector< std::pair<double, ExpressionPtr> > results(n);
+    if (evaluationBatchSize && n > evaluationBatchSize)
     {
-      ExpressionPtr expression = expressions->getElement(i).staticCast<Expression>();
-      std::pair<double, ExpressionPtr> p = computeCriterionWithEventualStump(context, splittingCriterion, counts, expression);
-      if (p.first > -DBL_MAX)
-        addSolution(context, p.second, p.first);
+      size_t numBatches = (n + evaluationBatchSize - 1) / evaluationBatchSize;
+      CompositeWorkUnitPtr workUnits = new CompositeWorkUnit(T("Score ") + string((int)n) + T(" conditions"), numBatches);
+      for (size_t i = 0; i < numBatches; ++i)
+      {
+        size_t begin = i * evaluationBatchSize;
+        size_t end = begin + evaluationBatchSize < n ? begin + evaluationBatchSize : n;
+        workUnits->setWorkUnit(i, new ScoreConditionsWorkUnit(this, splittingCriterion->cloneAndConfigure(context), counts, expressions, begin, end, results));
+      }
+      workUnits->setProgressionUnit(T("Batches"));
+      context.run(workUnits, false);
     }
+    else
+      for (size_t i = 0; i < n; ++i)
+        results[i] = computeCriterionWithEventualStump(context, splittingCriterion, counts, expressions->getAndCast<Expression>(i));
+
+    // solutions are added in the order of the candidates, whatever the number of threads
+    for (size_t i = 0; i < n; ++i)
+      if (results[i].first > -DBL_MAX)
+        addSolution(context, results[i].second, results[i].first);
   }
 
 protected:
   friend class ExhaustiveConditionLearnerClass;
 
   SamplerPtr expressionsSampler;
+  size_t evaluationBatchSize;
+  size_t numBins;
+
+  SortedValuesCachePtr sortedValuesCache;
+
+  class ScoreConditionsWorkUnit : public WorkUnit
+  {
+  public:
+    ScoreConditionsWorkUnit(ExhaustiveConditionLearner* owner, const SplittingCriterionPtr& splittingCriterion, const std::vector<size_t>& counts,
+                            const OVectorPtr& expressions, size_t begin, size_t end, std::vector< std::pair<double, ExpressionPtr> >& results)
+      : owner(owner), splittingCriterion(splittingCriterion), counts(counts), expressions(expressions), begin(begin), end(end), results(results) {}
+
+    virtual ObjectPtr run(ExecutionContext& context)
+    {
+      for (size_t i = begin; i < end; ++i)
+        results[i] = owner->computeCriterionWithEventualStump(context, splittingCriterion, counts, expressions->getAndCast<Expression>(i));
+      return ObjectPtr();
+    }
+
+  private:
+    ExhaustiveConditionLearner* owner;
+    SplittingCriterionPtr splittingCriterion;
+    const std::vector<size_t>& counts;
+    OVectorPtr expressions;
+    size_t begin, end;
+    std::vector< std::pair<double, ExpressionPtr> >& results; // each work unit writes its own range
+  };
 
   std::pair<double, ExpressionPtr> computeCriterionWithEventualStump(ExecutionContext& context, SplittingCriterionPtr splittingCriterion, const std::vector<size_t>& counts, const ExpressionPtr& booleanOrScalar)
   {
@@ -68,13 +134,14 @@ protected:
     {
       jassert(booleanOrScalar->getType()->isConvertibleToDouble());
       double value;
-      SparseDoubleVectorPtr sortedValues = getSortedValues(context, splittingCriterion, counts, booleanOrScalar);
-      double threshold = findBestThreshold(context, splittingCriterion, booleanOrScalar, sortedValues, value);
+      SparseDoubleVectorPtr sortedValues = sortedValuesCache->getSortedValues(context, splittingCriterion->getData(), booleanOrScalar, splittingCriterion->getIndices(), counts);
+      double threshold = findBestThreshold(context, splittingCriterion, booleanOrScalar, sortedValues, sortedValuesCache->isBinned(), value);
       return std::make_pair(value, new FunctionExpression(stumpFunction(threshold), booleanOrScalar));
     }
   }
   
-  double findBestThreshold(ExecutionContext& context, SplittingCriterionPtr splittingCriterion, const ExpressionPtr& scalar, const SparseDoubleVectorPtr& sortedDoubleValues, double& bestScore)
+  // when binned is true, each value is the lower edge of its bin and thresholds are placed on these edges
+  double findBestThreshold(ExecutionContext& context, SplittingCriterionPtr splittingCriterion, const ExpressionPtr& scalar, const SparseDoubleVectorPtr& sortedDoubleValues, bool binned, double& bestScore)
   {
     splittingCriterion->setPredictions(DataVector::createConstant(splittingCriterion->getIndices(), new Boolean(false)));
     splittingCriterion->ensureIsUpToDate();
@@ -102,11 +169,12 @@ protected:
       if (threshold < previousThreshold)
       {
         double e = splittingCriterion->computeCriterion();
+        double candidateThreshold = binned ? previousThreshold : (threshold + previousThreshold) / 2.0;
 
         if (verbosity >= verbosityAll)
         {
           context.enterScope("Iteration " + string((int)i));
-          context.resultCallback("threshold", (threshold + previousThreshold) / 2.0);
+          context.resultCallback("threshold", candidateThreshold);
           context.resultCallback("splittingCriterion", e);
           context.leaveScope();
         }
@@ -118,7 +186,7 @@ protected:
             bestThresholds.clear();
             bestScore = e;
           }
-          bestThresholds.push_back((threshold + previousThreshold) / 2.0);
+          bestThresholds.push_back(candidateThreshold);
         }
         previousThreshold = threshold;
       }
@@ -130,69 +198,6 @@ protected:
 
     return bestThresholds.size() ? bestThresholds[bestThresholds.size() / 2] : 0; // median value
   }
-  
-private:
-  typedef std::map<ExpressionPtr, SparseDoubleVectorPtr> SortedValuesCacheMap;
-  SortedValuesCacheMap sortedValuesCache;
-  
-  struct SortDoubleValuesOperator
-  {
-    static double transformIntoValidNumber(double input)
-      {return input;}
-
-    bool operator()(const std::pair<size_t, double>& a, const std::pair<size_t, double>& b) const
-      {return a.second == b.second ? a.first < b.first : a.second < b.second;}
-  };
-
-  static SparseDoubleVectorPtr sortDoubleValues(const DataVectorPtr& data)
-  {
-    size_t n = data->size();
-    SparseDoubleVectorPtr res = new SparseDoubleVector(n);
-    std::vector< std::pair<size_t, double> >& v = res->getValuesVector();
-  
-    bool isDouble = (data->getElementsType() == doubleClass);
-    for (DataVector::const_iterator it = data->begin(); it != data->end(); ++it)
-    {
-      double value = isDouble ? it.getRawDouble() : it.getRawObject()->toDouble();
-      if (value != DVector::missingValue)
-        v.push_back(std::make_pair(it.getIndex(), value));
-    }
-    std::sort(v.begin(), v.end(), SortDoubleValuesOperator());
-    return res;
-  }
-
-  static SparseDoubleVectorPtr computeSortedValuesSubset(const SparseDoubleVectorPtr& allValues, const IndexSetPtr& indices, const std::vector<size_t>& counts)
-  {
-    SparseDoubleVectorPtr res = new SparseDoubleVector(indices->size());
-    std::vector<std::pair<size_t, double> >& resValues = res->getValuesVector();
-    for (size_t i = 0; i < allValues->getNumValues(); ++i)
-      for (size_t j = 0; j < counts[allValues->getValue(i).first]; ++j)
-        resValues.push_back(allValues->getValue(i));
-    jassert(resValues.size() <= indices->size()); // there may be missing values
-    return res;
-  }
-
-  SparseDoubleVectorPtr getSortedValues(ExecutionContext& context, SplittingCriterionPtr splittingCriterion, const std::vector<size_t>& counts, const ExpressionPtr& expression)
-  {
-    SparseDoubleVectorPtr allValues;
-    SortedValuesCacheMap::const_iterator it = sortedValuesCache.find(expression);
-    if (it == sortedValuesCache.end())
-    {
-      DataVectorPtr values = expression->compute(context, splittingCriterion->getData());
-      allValues = sortDoubleValues(values); 
-      sortedValuesCache[expression] = allValues;
-    }
-    else
-      allValues = it->second;
-      
-    //if (splittingCriterion->getIndices()->size() == splittingCriterion->getData()->getNumRows()) 
-    // => FIXME: this test fails in the case of bagging. To make this faster, we need to store the "allIndices" within the Table
-    // This would enable to make a direct pointer comparison to know if this test concerns the whole dataset or not
-
-    //  return allValues;
-    //else
-    return computeSortedValuesSubset(allValues, splittingCriterion->getIndices(), counts);
-  }
 };
 
 }; /* namespace lbcpp */
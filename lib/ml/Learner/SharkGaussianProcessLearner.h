@@ -23,6 +23,106 @@
 namespace lbcpp
 {
 
+/**
+ * Gaussian Process that can be trained by extending the inverse covariance matrix of a previous
+ * Gaussian Process, whose training inputs are the first rows of the new training inputs.
+ * Adding \f$m\f$ rows to \f$n\f$ costs \f$O(n^2 m + m^3)\f$ through the block inversion formula,
+ * instead of \f$O((n+m)^3)\f$ for a full inversion.
+ */
+class SharkIncrementalGaussianProcess : public GaussianProcess
+{
+public:
+  SharkIncrementalGaussianProcess(SVM* svm)
+    : GaussianProcess(svm) {}
+
+  void train(const Array<double>& input, const Array<double>& target, GaussianProcess& previous)
+  {
+    const Array2D<double>& previousC = previous.getC();
+    const Array2D<double>& previousCInv = previous.getCInv();
+    size_t n = previousC.dim(0);
+    size_t N = input.dim(0);
+    size_t m = N - n;
+    jassert(n > 0 && n < N);
+    this->target = target;
+    getSVM()->SetTrainingData(input, true);
+
+    // covariance matrix
+    C.resize(N, N, false);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < n; ++j)
+        C(i, j) = previousC(i, j);
+    for (size_t i = n; i < N; ++i)
+    {
+      C(i, i) = (*kernel)(input[i], input[i]) + parameter(0);
+      for (size_t j = 0; j < i; ++j)
+        C(i, j) = C(j, i) = (*kernel)(input[i], input[j]);
+    }
+
+    // AB = CInv_old * B, where B are the covariances between the old and the new inputs
+    Array2D<double> AB(n, m);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t k = 0; k < m; ++k)
+      {
+        double value = 0.0;
+        for (size_t j = 0; j < n; ++j)
+          value += previousCInv(i, j) * C(j, n + k);
+        AB(i, k) = value;
+      }
+
+    // Schur complement S = D - B^T AB, whose inverse is the new bottom-right block
+    Array2D<double> S(m, m);
+    for (size_t k = 0; k < m; ++k)
+      for (size_t l = 0; l < m; ++l)
+      {
+        double value = C(n + k, n + l);
+        for (size_t j = 0; j < n; ++j)
+          value -= C(j, n + k) * AB(j, l);
+        S(k, l) = value;
+      }
+    Array2D<double> SInv(m, m);
+    invertSymmPositiveDefinite(SInv, S);
+
+    // ABSInv = AB * SInv
+    Array2D<double> ABSInv(n, m);
+    for (size_t i = 0; i < n; ++i)
+      for (size_t l = 0; l < m; ++l)
+      {
+        double value = 0.0;
+        for (size_t k = 0; k < m; ++k)
+          value += AB(i, k) * SInv(k, l);
+        ABSInv(i, l) = value;
+      }
+
+    CInv.resize(N, N, false);
+    for (size_t i = 0; i < n; ++i)
+    {
+      for (size_t j = i; j < n; ++j)
+      {
+        double value = previousCInv(i, j);
+        for (size_t k = 0; k < m; ++k)
+          value += ABSInv(i, k) * AB(j, k);
+        CInv(i, j) = CInv(j, i) = value;
+      }
+      for (size_t l = 0; l < m; ++l)
+        CInv(i, n + l) = CInv(n + l, i) = -ABSInv(i, l);
+    }
+    for (size_t k = 0; k < m; ++k)
+      for (size_t l = 0; l < m; ++l)
+        CInv(n + k, n + l) = SInv(k, l);
+
+    for (size_t i = 0; i < N; ++i)
+    {
+      double value = 0.0;
+      for (size_t j = 0; j < N; ++j)
+        value += CInv(i, j) * target(j, 0);
+      if (!isNumberValid(value))
+        throw SHARKEXCEPTION("[SharkIncrementalGaussianProcess::train] numerical problems");
+      svm->setParameter(i, value);
+    }
+    svm->setParameter(N, 0.0); // zero offset
+  }
+};
+
 /**
  * Reference counted object wrapper for Shark's Gaussian Process
  */
@@ -35,10 +135,7 @@ public:
   SharkGaussianProcess(const Array<double>& train, const Array<double>& supervisions, GaussianProcess* gaussianProcess = new GaussianProcess(new SVM(new NormalizedRBFKernel())))
     : gaussianProcess(gaussianProcess) 
   {
-    double sigma = computeWidth(train) / 4;
-    gaussianProcess->setBetaInv(1.0);
-    gaussianProcess->setSigma(sigma);
-    gaussianProcess->train(train, supervisions);
+    trainFromScratch(train, supervisions);
     GaussianProcessEvidence evidence = GaussianProcessEvidence();
     Array<double> derivative;
     evidence.errorDerivative(*gaussianProcess, train, supervisions, derivative);
@@ -51,6 +148,27 @@ public:
       optimizer.optimize(*gaussianProcess, error, train, supervisions);*/
   }
 
+  /**
+   * Trains a GaussianProcess, reusing a previous one when possible.
+   * If the training inputs of the previous Gaussian Process are the first rows of the new training inputs,
+   * and if the kernel width that would be chosen for the new inputs is the same as the previous one, its
+   * inverse covariance matrix is extended incrementally. Otherwise, the Gaussian Process is trained from scratch,
+   * so that the result does not depend on the use of a previous Gaussian Process.
+   */
+  SharkGaussianProcess(const Array<double>& train, const Array<double>& supervisions, const ReferenceCountedObjectPtr<SharkGaussianProcess>& previous)
+  {
+    SharkIncrementalGaussianProcess* gp = new SharkIncrementalGaussianProcess(new SVM(new NormalizedRBFKernel()));
+    gaussianProcess = gp;
+    if (previous->isPrefixOf(train) && computeWidth(train) / 4 == previous->getSigma())
+    {
+      gaussianProcess->setBetaInv(previous->getBetaInv());
+      gaussianProcess->setSigma(previous->getSigma());
+      gp->train(train, supervisions, *previous->gaussianProcess);
+    }
+    else
+      trainFromScratch(train, supervisions);
+  }
+
   /**
    * Merely stores the given GaussianProcess
    */
@@ -80,6 +198,29 @@ public:
 protected:
   GaussianProcess* gaussianProcess;
 
+  void trainFromScratch(const Array<double>& train, const Array<double>& supervisions)
+  {
+    double sigma = computeWidth(train) / 4;
+    gaussianProcess->setBetaInv(1.0);
+    gaussianProcess->setSigma(sigma);
+    gaussianProcess->train(train, supervisions);
+  }
+
+  // returns true if the training inputs are the first rows of inputs, and if there are new rows
+  bool isPrefixOf(const Array<double>& inputs) const
+  {
+    SVM* svm = gaussianProcess->getSVM();
+    size_t n = svm->getExamples();
+    if (!n || n >= inputs.dim(0) || inputs.ndim() != 2 || svm->getDimension() != inputs.dim(1) || gaussianProcess->getC().dim(0) != n)
+      return false;
+    const Array<double>& points = svm->getPoints();
+    for (size_t i = 0; i < n; ++i)
+      for (size_t j = 0; j < inputs.dim(1); ++j)
+        if (points(i, j) != inputs(i, j))
+          return false;
+    return true;
+  }
+
   double computeWidth(const Array<double>& data)
   {
     std::vector< std::pair<double, double> > limits(data.cols());
@@ -148,15 +289,34 @@ protected:
 
 typedef ReferenceCountedObjectPtr<GaussianProcessExpression> GaussianProcessExpressionPtr;
 
+/**
+ * If a GaussianProcessExpression is given as starting solution, the learner keeps its hyper-parameters
+ * and extends its inverse covariance matrix with the new rows of the training data.
+ */
 class SharkGaussianProcessLearner : public Solver
 {
 public:
+  virtual void startSolver(ExecutionContext& context, ProblemPtr problem, SolverCallbackPtr callback, ObjectPtr startingSolution)
+  {
+    Solver::startSolver(context, problem, callback, startingSolution);
+    GaussianProcessExpressionPtr previousExpression = startingSolution.dynamicCast<GaussianProcessExpression>();
+    previousGaussianProcess = previousExpression ? previousExpression->getGaussianProcess() : SharkGaussianProcessPtr();
+  }
+
+  virtual void stopSolver(ExecutionContext& context)
+  {
+    Solver::stopSolver(context);
+    previousGaussianProcess = SharkGaussianProcessPtr();
+  }
+
   virtual void runSolver(ExecutionContext& context)
   {
     SupervisedLearningObjectivePtr objective = problem->getObjective(0).staticCast<SupervisedLearningObjective>();
     TablePtr data = objective->getData();
     std::pair<Array<double>, Array<double> > transformed = transform(data);
-    SharkGaussianProcessPtr gaussianProcess = new SharkGaussianProcess(transformed.first, transformed.second);
+    SharkGaussianProcessPtr gaussianProcess = previousGaussianProcess
+      ? new SharkGaussianProcess(transformed.first, transformed.second, previousGaussianProcess)
+      : new SharkGaussianProcess(transformed.first, transformed.second);
     GaussianProcessExpressionPtr gp = new GaussianProcessExpression(gaussianProcess);
     evaluate(context, gp);
     context.resultCallback("Regularization parameter", gaussianProcess->getBetaInv());
@@ -164,6 +324,8 @@ public:
   }
 
 protected:
+  SharkGaussianProcessPtr previousGaussianProcess;
+
   std::vector<std::pair<double, double> > computeLimits(TablePtr data)
   {
     std::vector< std::pair<double, double> > limits(data->getNumColumns());
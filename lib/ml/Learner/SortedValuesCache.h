@@ -0,0 +1,217 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: SortedValuesCache.h            | Cache of sorted feature values  |
+| Author  : Francis Maes                   |  for threshold search           |
+| Started : 16/10/2026 22:30               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_LEARNER_SORTED_VALUES_CACHE_H_
+# define ML_LEARNER_SORTED_VALUES_CACHE_H_
+
+# include <ml/Expression.h>
+# include <ml/DoubleVector.h>
+# include <algorithm>
+# include <cfloat>
+
+namespace lbcpp
+{
+
+/*
+** Sorted values of scalar expressions, for the threshold search of condition learners.
+**
+** The values of an expression on the whole table are sorted once. The sorted values of a set
+** of examples are then obtained by a stable filtering of the sorted values of its parent set
+** (see IndexSet::getParent()), which costs O(parent size) instead of O(n log n). The sorted
+** values of a set are kept as long as the set is referenced outside of the cache, that is
+** as long as the tree node it belongs to, or one of its children, is being built.
+**
+** In binned mode, the values of the table are mapped to at most numBins quantile bins, whose
+** edges are estimated on a sample of the values. Examples are then only ordered by bin, and each
+** value is replaced by the lower edge of its bin (-DBL_MAX for the first bin), so that the
+** threshold search only considers the bin edges.
+*/
+class SortedValuesCache : public ReferenceCountedObject
+{
+public:
+  SortedValuesCache() : numBins(0) {}
+
+  void setNumBins(size_t numBins)
+  {
+    ScopedLock _(lock);
+    if (numBins != this->numBins)
+    {
+      this->numBins = numBins;
+      clearImpl();
+    }
+  }
+
+  bool isBinned() const
+    {return numBins > 0;}
+
+  void clear()
+    {ScopedLock _(lock); clearImpl();}
+
+  // removes the sets that are only referenced by this cache, to be called once per tree node
+  void removeUnusedNodes()
+  {
+    ScopedLock _(lock);
+    NodeValues::iterator it = nodeValues.begin();
+    while (it != nodeValues.end())
+    {
+      if (it->first.first->getReferenceCount() == 1)
+        nodeValues.erase(it++);
+      else
+        ++it;
+    }
+  }
+
+  // counts[i] is non-zero if example i belongs to indices, each example is kept once
+  SparseDoubleVectorPtr getSortedValues(ExecutionContext& context, const TablePtr& data, const ExpressionPtr& expression, const IndexSetPtr& indices, const std::vector<size_t>& counts)
+  {
+    SparseDoubleVectorPtr source;
+    {
+      ScopedLock _(lock);
+      NodeValues::const_iterator it = nodeValues.find(std::make_pair(indices, expression));
+      if (it != nodeValues.end())
+        return it->second;
+      for (IndexSetPtr parent = indices->getParent(); parent && !source; parent = parent->getParent())
+      {
+        it = nodeValues.find(std::make_pair(parent, expression));
+        if (it != nodeValues.end())
+          source = it->second;
+      }
+      if (!source)
+      {
+        ColumnValues::const_iterator it2 = columnValues.find(std::make_pair(data, expression));
+        if (it2 != columnValues.end())
+          source = it2->second;
+      }
+    }
+
+    if (!source)
+    {
+      // two threads may compute the same column concurrently, they produce the same values
+      DataVectorPtr values = expression->compute(context, data);
+      source = numBins ? binValues(values, numBins) : sortValues(values);
+      ScopedLock _(lock);
+      columnValues[std::make_pair(data, expression)] = source;
+    }
+
+    SparseDoubleVectorPtr res = filterValues(source, indices, counts);
+    ScopedLock _(lock);
+    nodeValues[std::make_pair(indices, expression)] = res;
+    return res;
+  }
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  typedef std::map<std::pair<TablePtr, ExpressionPtr>, SparseDoubleVectorPtr> ColumnValues;
+  typedef std::map<std::pair<IndexSetPtr, ExpressionPtr>, SparseDoubleVectorPtr> NodeValues;
+
+  CriticalSection lock;
+  size_t numBins;
+  ColumnValues columnValues;
+  NodeValues nodeValues;
+
+  enum {maxNumBinningSamples = 65536};
+
+  void clearImpl()
+  {
+    columnValues.clear();
+    nodeValues.clear();
+  }
+
+  struct SortDoubleValuesOperator
+  {
+    bool operator()(const std::pair<size_t, double>& a, const std::pair<size_t, double>& b) const
+      {return a.second == b.second ? a.first < b.first : a.second < b.second;}
+  };
+
+  static void getValidValues(const DataVectorPtr& data, std::vector< std::pair<size_t, double> >& res)
+  {
+    res.reserve(data->size());
+    bool isDouble = (data->getElementsType() == doubleClass);
+    for (DataVector::const_iterator it = data->begin(); it != data->end(); ++it)
+    {
+      double value = isDouble ? it.getRawDouble() : it.getRawObject()->toDouble();
+      if (value != DVector::missingValue)
+        res.push_back(std::make_pair(it.getIndex(), value));
+    }
+  }
+
+  static SparseDoubleVectorPtr sortValues(const DataVectorPtr& data)
+  {
+    SparseDoubleVectorPtr res = new SparseDoubleVector(data->size());
+    std::vector< std::pair<size_t, double> >& v = res->getValuesVector();
+    getValidValues(data, v);
+    std::sort(v.begin(), v.end(), SortDoubleValuesOperator());
+    return res;
+  }
+
+  static SparseDoubleVectorPtr binValues(const DataVectorPtr& data, size_t numBins)
+  {
+    std::vector< std::pair<size_t, double> > values;
+    getValidValues(data, values);
+    size_t n = values.size();
+    SparseDoubleVectorPtr res = new SparseDoubleVector(n);
+    if (!n)
+      return res;
+
+    // estimate the bin edges on a regular sample of the values
+    size_t step = n > maxNumBinningSamples ? n / maxNumBinningSamples : 1;
+    std::vector<double> samples;
+    samples.reserve(n / step + 1);
+    for (size_t i = 0; i < n; i += step)
+      samples.push_back(values[i].second);
+    std::sort(samples.begin(), samples.end());
+    std::vector<double> edges;
+    for (size_t b = 1; b < numBins; ++b)
+    {
+      size_t position = b * samples.size() / numBins;
+      if (position == 0 || samples[position - 1] == samples[position])
+        continue;
+      double edge = (samples[position - 1] + samples[position]) / 2.0;
+      if (edges.empty() || edge > edges.back())
+        edges.push_back(edge);
+    }
+
+    // counting sort by bin, the bin of a value being the number of edges that are lower or equal to this value,
+    // so that the examples of a bin are exactly those for which x >= edge holds for its lower edge
+    std::vector<size_t> bins(n);
+    std::vector<size_t> binOffsets(edges.size() + 2, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+      bins[i] = std::upper_bound(edges.begin(), edges.end(), values[i].second) - edges.begin();
+      ++binOffsets[bins[i] + 1];
+    }
+    for (size_t b = 1; b < binOffsets.size(); ++b)
+      binOffsets[b] += binOffsets[b - 1];
+    std::vector< std::pair<size_t, double> >& v = res->getValuesVector();
+    v.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      size_t bin = bins[i];
+      v[binOffsets[bin]++] = std::make_pair(values[i].first, bin ? edges[bin - 1] : -DBL_MAX);
+    }
+    return res;
+  }
+
+  static SparseDoubleVectorPtr filterValues(const SparseDoubleVectorPtr& source, const IndexSetPtr& indices, const std::vector<size_t>& counts)
+  {
+    SparseDoubleVectorPtr res = new SparseDoubleVector(indices->size());
+    std::vector<std::pair<size_t, double> >& resValues = res->getValuesVector();
+    for (size_t i = 0; i < source->getNumValues(); ++i)
+      if (counts[source->getValue(i).first])
+        resValues.push_back(source->getValue(i));
+    jassert(resValues.size() <= indices->size()); // examples with missing values are not in source
+    return res;
+  }
+};
+
+typedef ReferenceCountedObjectPtr<SortedValuesCache> SortedValuesCachePtr;
+
+}; /* namespace lbcpp */
+
+#endif // !ML_LEARNER_SORTED_VALUES_CACHE_H_
@@ -13,6 +13,7 @@
 # include <ml/Expression.h>
 # include <ml/SplittingCriterion.h>
 # include <ml/Solver.h>
+# include <oil/Execution/WorkUnit.h>
 
 namespace lbcpp
 {
@@ -21,8 +22,15 @@ class TreeLearner : public Solver
 {
 public:
   TreeLearner(SplittingCriterionPtr splittingCriterion, SolverPtr conditionLearner, size_t minExamplesToSplit, size_t maxDepth)
-    : splittingCriterion(splittingCriterion), conditionLearner(conditionLearner), minExamplesToSplit(minExamplesToSplit), maxDepth(maxDepth), isInBatch(false) {}
-  TreeLearner() : isInBatch(false) {}
+    : splittingCriterion(splittingCriterion), conditionLearner(conditionLearner), minExamplesToSplit(minExamplesToSplit), maxDepth(maxDepth), minExamplesToParallelize(0), isInBatch(false) {}
+  TreeLearner() : minExamplesToParallelize(0), isInBatch(false) {}
+
+  /** Nodes with at least this number of examples grow their sub-trees in parallel, as work units
+   *  on the ExecutionContext. Each sub-tree uses its own copies of the splitting criterion and of
+   *  the condition learner, and its own random generator. 0 disables parallel growth.
+   */
+  void setMinExamplesToParallelize(size_t minExamplesToParallelize)
+    {this->minExamplesToParallelize = minExamplesToParallelize;}
 
   virtual void startBatch(ExecutionContext& context)
   {
@@ -43,7 +51,7 @@ public:
 
     if (!isInBatch)
       conditionLearner->startBatch(context);
-    ExpressionPtr res = makeTreeScope(context, objective, objective->getIndices(), 1);
+    ExpressionPtr res = makeTreeScope(context, objective, objective->getIndices(), 1, splittingCriterion, conditionLearner);
     if (!isInBatch)
       conditionLearner->stopBatch(context);
     
@@ -68,8 +76,37 @@ protected:
   SolverPtr conditionLearner;
   size_t minExamplesToSplit;
   size_t maxDepth;
+  size_t minExamplesToParallelize;
 
   bool isInBatch;
+  CriticalSection importanceLock; // importances are shared by the expressions of all the sub-trees
+
+  class MakeSubTreeWorkUnit : public WorkUnit
+  {
+  public:
+    MakeSubTreeWorkUnit(TreeLearner* owner, const SupervisedLearningObjectivePtr& objective, const IndexSetPtr& indices, size_t depth,
+                        const SplittingCriterionPtr& splittingCriterion, const SolverPtr& conditionLearner, juce::uint32 seed, ExpressionPtr& res)
+      : owner(owner), objective(objective), indices(indices), depth(depth), splittingCriterion(splittingCriterion), conditionLearner(conditionLearner), seed(seed), res(res) {}
+
+    virtual ObjectPtr run(ExecutionContext& context)
+    {
+      RandomGeneratorPtr previousRandom = context.getRandomGenerator();
+      context.setRandomGenerator(new RandomGenerator(seed));
+      res = owner->makeTreeScope(context, objective, indices, depth, splittingCriterion, conditionLearner);
+      context.setRandomGenerator(previousRandom);
+      return ObjectPtr();
+    }
+
+  private:
+    TreeLearner* owner;
+    SupervisedLearningObjectivePtr objective;
+    IndexSetPtr indices;
+    size_t depth;
+    SplittingCriterionPtr splittingCriterion;
+    SolverPtr conditionLearner;
+    juce::uint32 seed;
+    ExpressionPtr& res;
+  };
 
   bool isConstant(const VectorPtr& data, const IndexSetPtr& indices) const
   {
@@ -108,17 +145,19 @@ protected:
     return true;
   }
   
-  ExpressionPtr makeTreeScope(ExecutionContext& context, const SupervisedLearningObjectivePtr& objective, const IndexSetPtr& indices, size_t depth)
+  ExpressionPtr makeTreeScope(ExecutionContext& context, const SupervisedLearningObjectivePtr& objective, const IndexSetPtr& indices, size_t depth,
+                              const SplittingCriterionPtr& splittingCriterion, const SolverPtr& conditionLearner)
   {
     if (verbosity >= verbosityDetailed)
       context.enterScope(T("Make tree with ") + string((int)indices->size()) + " examples");
-    ExpressionPtr res = makeTree(context, objective, indices, depth);
+    ExpressionPtr res = makeTree(context, objective, indices, depth, splittingCriterion, conditionLearner);
     if (verbosity >= verbosityDetailed)
       context.leaveScope();
     return res;
   }
 
-  ExpressionPtr makeTree(ExecutionContext& context, const SupervisedLearningObjectivePtr& objective, const IndexSetPtr& indices, size_t depth)
+  ExpressionPtr makeTree(ExecutionContext& context, const SupervisedLearningObjectivePtr& objective, const IndexSetPtr& indices, size_t depth,
+                         const SplittingCriterionPtr& splittingCriterion, const SolverPtr& conditionLearner)
   {
     // configure splitting criterion
     splittingCriterion->configure(objective->getData(), objective->getSupervision(), DenseDoubleVectorPtr(), indices);
@@ -139,7 +178,10 @@ protected:
     if (!conditionNode || conditionNode.isInstanceOf<ConstantExpression>() || fabs(conditionFitness->getValue(0) - worstFitness) < 1e-9)
       return new ConstantExpression(splittingCriterion->computeVote(indices));
 
-    conditionNode->addImportance(conditionFitness->getValue(0) * indices->size() / objective->getData()->getNumRows());
+    {
+      ScopedLock _(importanceLock);
+      conditionNode->addImportance(conditionFitness->getValue(0) * indices->size() / objective->getData()->getNumRows());
+    }
     if (verbosity >= verbosityDetailed)
       context.informationCallback(conditionNode->toShortString() + T(" [") + string(conditionNode->getSubNode(0)->getImportance()) + T("]"));
 
@@ -157,9 +199,22 @@ protected:
     // ...call recursively
     if (verbosity >= verbosityDetailed)
       context.enterScope(conditionNode->toShortString());
-    ExpressionPtr failureNode = makeTreeScope(context, objective, failureExamples, depth + 1);
-    ExpressionPtr successNode = makeTreeScope(context, objective, successExamples, depth + 1);
-    ExpressionPtr missingNode = makeTreeScope(context, objective, missingExamples, depth + 1);
+    ExpressionPtr failureNode, successNode, missingNode;
+    if (minExamplesToParallelize && indices->size() >= minExamplesToParallelize)
+    {
+      CompositeWorkUnitPtr workUnits = new CompositeWorkUnit(T("Make sub-trees of ") + conditionNode->toShortString(), 3);
+      workUnits->setWorkUnit(0, makeSubTreeWorkUnit(context, objective, failureExamples, depth + 1, splittingCriterion, conditionLearner, failureNode));
+      workUnits->setWorkUnit(1, makeSubTreeWorkUnit(context, objective, successExamples, depth + 1, splittingCriterion, conditionLearner, successNode));
+      workUnits->setWorkUnit(2, makeSubTreeWorkUnit(context, objective, missingExamples, depth + 1, splittingCriterion, conditionLearner, missingNode));
+      workUnits->setProgressionUnit(T("Sub-trees"));
+      context.run(workUnits, false);
+    }
+    else
+    {
+      failureNode = makeTreeScope(context, objective, failureExamples, depth + 1, splittingCriterion, conditionLearner);
+      successNode = makeTreeScope(context, objective, successExamples, depth + 1, splittingCriterion, conditionLearner);
+      missingNode = makeTreeScope(context, objective, missingExamples, depth + 1, splittingCriterion, conditionLearner);
+    }
     if (verbosity >= verbosityDetailed)
       context.leaveScope();
 
@@ -167,6 +222,17 @@ protected:
     return new TestExpression(conditionNode, failureNode, successNode, missingNode);
   }
 
+  WorkUnitPtr makeSubTreeWorkUnit(ExecutionContext& context, const SupervisedLearningObjectivePtr& objective, const IndexSetPtr& indices, size_t depth,
+                                  const SplittingCriterionPtr& splittingCriterion, const SolverPtr& conditionLearner, ExpressionPtr& res)
+  {
+    // the splitting criterion is reconfigured at each node and the condition learner keeps the current problem, so each sub-tree needs its own copies
+    SplittingCriterionPtr subTreeSplittingCriterion = splittingCriterion->cloneAndCast<SplittingCriterion>(context);
+    SolverPtr subTreeConditionLearner = conditionLearner->deepClone(context).staticCast<Solver>();
+    subTreeConditionLearner->setVerbosity(conditionLearner->getVerbosity());
+    juce::uint32 seed = context.getRandomGenerator()->sampleUint32();
+    return new MakeSubTreeWorkUnit(this, objective, indices, depth, subTreeSplittingCriterion, subTreeConditionLearner, seed, res);
+  }
+
   size_t getNumTestNodes(const ExpressionPtr& node, size_t depth, size_t& maxDepth, ScalarVariableStatisticsPtr nodeSizeStats) const
   {
     if (depth > maxDepth)
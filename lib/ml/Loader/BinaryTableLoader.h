@@ -0,0 +1,39 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: BinaryTableLoader.h            | Binary Table Loader             |
+| Author  : Francis Maes                   |                                 |
+| Started : 16/10/2026 21:45               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_LOADER_BINARY_TABLE_H_
+# define ML_LOADER_BINARY_TABLE_H_
+
+# include <oil/Core/Loader.h>
+# include <ml/BinaryTable.h>
+
+namespace lbcpp
+{
+
+class BinaryTableLoader : public Loader
+{
+public:
+  virtual string getFileExtensions() const
+    {return "lbtable";}
+
+  virtual ClassPtr getTargetClass() const
+    {return tableClass;}
+
+  virtual bool canUnderstand(ExecutionContext& context, juce::InputStream& istr) const
+    {return BinaryTable::isBinaryTableFile(istr);}
+
+  virtual ObjectPtr loadFromFile(ExecutionContext& context, const juce::File& file) const
+  {
+    BinaryTablePtr binaryTable = BinaryTable::open(context, file);
+    return binaryTable ? binaryTable->createTable(context) : TablePtr();
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // ML_LOADER_BINARY_TABLE_H_
@@ -0,0 +1,299 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: NonDominatedSorting.cpp        | Non-dominated sorting of a      |
+| Author  : Francis Maes                   |  packed fitness matrix          |
+| Started : 16/10/2026 17:10               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <ml/NonDominatedSorting.h>
+#include <algorithm>
+#include <map>
+using namespace lbcpp;
+
+namespace lbcpp
+{
+
+struct LexicographicPointLess
+{
+  LexicographicPointLess(const double* points, size_t numObjectives)
+    : points(points), numObjectives(numObjectives) {}
+
+  const double* points;
+  size_t numObjectives;
+
+  bool operator()(size_t a, size_t b) const
+  {
+    const double* pa = points + a * numObjectives;
+    const double* pb = points + b * numObjectives;
+    for (size_t i = 0; i < numObjectives; ++i)
+      if (pa[i] != pb[i])
+        return pa[i] < pb[i];
+    return false;
+  }
+};
+
+/*
+** Points are distinct and indexed in lexicographic order, so that a point can only be
+** dominated by points with a lower index. Sets of points are index vectors kept sorted.
+**
+** helperA(S, k) computes the ranks within S, whose points are equal on objectives > k.
+** helperB(L, H, k) raises the ranks of H given the final ranks of L, when every point of L
+** is lower or equal to every point of H on objectives > k.
+*/
+class NonDominatedSortingAlgorithm
+{
+public:
+  NonDominatedSortingAlgorithm(const double* points, size_t numObjectives, std::vector<size_t>& ranks)
+    : points(points), numObjectives(numObjectives), ranks(ranks) {}
+
+  typedef std::vector<size_t> IndexVector;
+
+  void helperA(const IndexVector& s, size_t k)
+  {
+    if (s.size() < 2)
+      return;
+    if (s.size() == 2)
+    {
+      if (weaklyDominates(s[0], s[1], k))
+        raiseRank(s[1], ranks[s[0]]);
+      return;
+    }
+    if (k == 1)
+    {
+      sweepA(s);
+      return;
+    }
+
+    double minValue, maxValue;
+    getRange(s, k, minValue, maxValue);
+    if (minValue == maxValue)
+    {
+      helperA(s, k - 1);
+      return;
+    }
+
+    IndexVector low, equal, high;
+    split(s, k, getMedian(s, IndexVector(), k), low, equal, high);
+    helperA(low, k);
+    helperB(low, equal, k - 1);
+    helperA(equal, k - 1);
+    helperB(merge(low, equal), high, k - 1);
+    helperA(high, k);
+  }
+
+  void helperB(const IndexVector& l, const IndexVector& h, size_t k)
+  {
+    if (l.empty() || h.empty())
+      return;
+    if (l.size() == 1 || h.size() == 1)
+    {
+      for (size_t i = 0; i < h.size(); ++i)
+        for (size_t j = 0; j < l.size(); ++j)
+          if (weaklyDominates(l[j], h[i], k))
+            raiseRank(h[i], ranks[l[j]]);
+      return;
+    }
+    if (k == 1)
+    {
+      sweepB(l, h);
+      return;
+    }
+
+    double lMin, lMax, hMin, hMax;
+    getRange(l, k, lMin, lMax);
+    getRange(h, k, hMin, hMax);
+    if (lMax <= hMin)
+      helperB(l, h, k - 1);
+    else if (lMin <= hMax)
+    {
+      double median = getMedian(l, h, k);
+      IndexVector lLow, lEqual, lHigh, hLow, hEqual, hHigh;
+      split(l, k, median, lLow, lEqual, lHigh);
+      split(h, k, median, hLow, hEqual, hHigh);
+      helperB(lLow, hLow, k);
+      helperB(lLow, hEqual, k - 1);
+      helperB(lEqual, hEqual, k - 1);
+      helperB(merge(lLow, lEqual), hHigh, k - 1);
+      helperB(lHigh, hHigh, k);
+    }
+  }
+
+private:
+  const double* points;
+  size_t numObjectives;
+  std::vector<size_t>& ranks;
+
+  // objective 1 -> rank, both strictly increasing
+  typedef std::map<double, size_t> Staircase;
+
+  double getValue(size_t point, size_t objective) const
+    {return points[point * numObjectives + objective];}
+
+  bool weaklyDominates(size_t a, size_t b, size_t k) const
+  {
+    const double* pa = points + a * numObjectives;
+    const double* pb = points + b * numObjectives;
+    for (size_t i = 0; i <= k; ++i)
+      if (pa[i] > pb[i])
+        return false;
+    return true;
+  }
+
+  void raiseRank(size_t point, size_t dominatingRank)
+  {
+    if (ranks[point] <= dominatingRank)
+      ranks[point] = dominatingRank + 1;
+  }
+
+  // highest rank among the points whose objective 1 is lower or equal to value
+  static bool findHighestRank(const Staircase& staircase, double value, size_t& res)
+  {
+    Staircase::const_iterator it = staircase.upper_bound(value);
+    if (it == staircase.begin())
+      return false;
+    --it;
+    res = it->second;
+    return true;
+  }
+
+  static void insertIntoStaircase(Staircase& staircase, double value, size_t rank)
+  {
+    size_t highestRank;
+    if (findHighestRank(staircase, value, highestRank) && highestRank >= rank)
+      return;
+    Staircase::iterator it = staircase.lower_bound(value);
+    while (it != staircase.end() && it->second <= rank)
+      staircase.erase(it++);
+    staircase[value] = rank;
+  }
+
+  void sweepA(const IndexVector& s)
+  {
+    Staircase staircase;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+      double value = getValue(s[i], 1);
+      size_t highestRank;
+      if (findHighestRank(staircase, value, highestRank))
+        raiseRank(s[i], highestRank);
+      insertIntoStaircase(staircase, value, ranks[s[i]]);
+    }
+  }
+
+  void sweepB(const IndexVector& l, const IndexVector& h)
+  {
+    Staircase staircase;
+    size_t j = 0;
+    for (size_t i = 0; i < h.size(); ++i)
+    {
+      double x = getValue(h[i], 0);
+      double y = getValue(h[i], 1);
+      for (; j < l.size(); ++j)
+      {
+        double lx = getValue(l[j], 0);
+        if (lx > x || (lx == x && getValue(l[j], 1) > y))
+          break;
+        insertIntoStaircase(staircase, getValue(l[j], 1), ranks[l[j]]);
+      }
+      size_t highestRank;
+      if (findHighestRank(staircase, y, highestRank))
+        raiseRank(h[i], highestRank);
+    }
+  }
+
+  void getRange(const IndexVector& s, size_t k, double& minValue, double& maxValue) const
+  {
+    minValue = DBL_MAX;
+    maxValue = -DBL_MAX;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+      double value = getValue(s[i], k);
+      if (value < minValue)
+        minValue = value;
+      if (value > maxValue)
+        maxValue = value;
+    }
+  }
+
+  double getMedian(const IndexVector& s1, const IndexVector& s2, size_t k) const
+  {
+    std::vector<double> values;
+    values.reserve(s1.size() + s2.size());
+    for (size_t i = 0; i < s1.size(); ++i)
+      values.push_back(getValue(s1[i], k));
+    for (size_t i = 0; i < s2.size(); ++i)
+      values.push_back(getValue(s2[i], k));
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+  }
+
+  void split(const IndexVector& s, size_t k, double median, IndexVector& low, IndexVector& equal, IndexVector& high) const
+  {
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+      double value = getValue(s[i], k);
+      if (value < median)
+        low.push_back(s[i]);
+      else if (value == median)
+        equal.push_back(s[i]);
+      else
+        high.push_back(s[i]);
+    }
+  }
+
+  static IndexVector merge(const IndexVector& s1, const IndexVector& s2)
+  {
+    IndexVector res(s1.size() + s2.size());
+    std::merge(s1.begin(), s1.end(), s2.begin(), s2.end(), res.begin());
+    return res;
+  }
+};
+
+}; /* namespace lbcpp */
+
+void NonDominatedSorting::computeRanks(const double* points, size_t numPoints, size_t numObjectives, std::vector<size_t>& ranks)
+{
+  ranks.clear();
+  ranks.resize(numPoints, 0);
+  if (numPoints < 2 || !numObjectives)
+    return;
+
+  // sort lexicographically and merge identical points
+  std::vector<size_t> order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), LexicographicPointLess(points, numObjectives));
+
+  std::vector<double> uniquePoints;
+  uniquePoints.reserve(numPoints * numObjectives);
+  std::vector<size_t> uniqueIndices(numPoints);
+  size_t numUniquePoints = 0;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const double* point = points + order[i] * numObjectives;
+    if (!numUniquePoints || !std::equal(point, point + numObjectives, &uniquePoints[(numUniquePoints - 1) * numObjectives]))
+    {
+      uniquePoints.insert(uniquePoints.end(), point, point + numObjectives);
+      ++numUniquePoints;
+    }
+    uniqueIndices[order[i]] = numUniquePoints - 1;
+  }
+
+  std::vector<size_t> uniqueRanks(numUniquePoints, 0);
+  if (numObjectives == 1)
+  {
+    for (size_t i = 0; i < numUniquePoints; ++i)
+      uniqueRanks[i] = i;
+  }
+  else
+  {
+    std::vector<size_t> indices(numUniquePoints);
+    for (size_t i = 0; i < numUniquePoints; ++i)
+      indices[i] = i;
+    NonDominatedSortingAlgorithm(&uniquePoints[0], numObjectives, uniqueRanks).helperA(indices, numObjectives - 1);
+  }
+
+  for (size_t i = 0; i < numPoints; ++i)
+    ranks[i] = uniqueRanks[uniqueIndices[i]];
+}
@@ -74,13 +74,17 @@ bool AbYSSOptimizer::iterateSolver(ExecutionContext& context, size_t iter)
   if (iter == 0)
   {
     /* Create initial population */
+    std::vector<ObjectPtr> objects(populationSize);
     for (size_t i = 0; i < populationSize; ++i)
     {
       object = diversificationGeneration(context);
       improvementOperator->execute(context, problem, object);
-      fitness = evaluate(context, object);
-      solutionSet->insertSolution(object, fitness);
+      objects[i] = object;
     }
+    std::vector<FitnessPtr> fitnesses;
+    size_t numEvaluated = evaluatePopulation(context, objects, fitnesses);
+    for (size_t i = 0; i < numEvaluated; ++i)
+      solutionSet->insertSolution(objects[i], fitnesses[i]);
   }
   else 
   {
@@ -47,10 +47,15 @@ bool OMOPSOOptimizer::iterateSolver(ExecutionContext& context, size_t iter)
     initialVectorSampler->initialize(context, new VectorDomain(problem->getDomain()));
     OVectorPtr initialSamples = initialVectorSampler->sample(context).staticCast<OVector>();
     jassert(initialSamples->getNumElements() == populationSize);
-    for (size_t i = 0; i < initialSamples->getNumElements(); ++i)
+    std::vector<ObjectPtr> objects(initialSamples->getNumElements());
+    for (size_t i = 0; i < objects.size(); ++i)
+      objects[i] = initialSamples->getElement(i);
+    std::vector<FitnessPtr> fitnesses;
+    size_t numEvaluated = evaluatePopulation(context, objects, fitnesses);
+    for (size_t i = 0; i < numEvaluated; ++i)
     {
-      object = initialSamples->getAndCast<DenseDoubleVector>(i);
-      fitness = evaluate(context, object);
+      object = objects[i].staticCast<DenseDoubleVector>();
+      fitness = fitnesses[i];
       particles->insertSolution(cloneVector(context, object), fitness);
       leaders->insertSolution(object, fitness);
       best->insertSolution(object, fitness);
@@ -61,10 +66,15 @@ bool OMOPSOOptimizer::iterateSolver(ExecutionContext& context, size_t iter)
     computeSpeed(context, iter);
     computeNewPositions();
     mopsoMutation(context, iter);
+    std::vector<ObjectPtr> objects(populationSize);
     for (size_t i = 0; i < populationSize; ++i)
+      objects[i] = particles->getSolution(i);
+    std::vector<FitnessPtr> fitnesses;
+    size_t numEvaluated = evaluatePopulation(context, objects, fitnesses);
+    for (size_t i = 0; i < numEvaluated; ++i)
     {
-      object = particles->getSolution(i).staticCast<DenseDoubleVector>();
-      fitness = evaluate(context, object);
+      object = objects[i].staticCast<DenseDoubleVector>();
+      fitness = fitnesses[i];
       leaders->insertSolution(cloneVector(context, object), fitness);
       if (fitness->strictlyDominates(best->getFitness(i)))
         best->setSolution(i, cloneVector(context, object), new Fitness(*fitness));
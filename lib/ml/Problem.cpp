@@ -96,6 +96,23 @@ FitnessPtr Problem::evaluate(ExecutionContext& context, const ObjectPtr& object)
   return new Fitness(o, limits);
 }
 
+void Problem::evaluateBatch(ExecutionContext& context, const std::vector<ObjectPtr>& objects, std::vector<FitnessPtr>& res, double cutoff) const
+{
+  FitnessLimitsPtr limits = getFitnessLimits();
+  std::vector< std::vector<double> > values(objectives.size());
+  for (size_t i = 0; i < objectives.size(); ++i)
+    objectives[i]->evaluateBatch(context, objects, values[i], objectives.size() == 1 ? cutoff : DBL_MAX);
+
+  res.resize(objects.size());
+  for (size_t j = 0; j < objects.size(); ++j)
+  {
+    std::vector<double> o(objectives.size());
+    for (size_t i = 0; i < o.size(); ++i)
+      o[i] = values[i][j];
+    res[j] = new Fitness(o, limits);
+  }
+}
+
 void Problem::reinitialize(ExecutionContext& context)
 {
   domain = DomainPtr();
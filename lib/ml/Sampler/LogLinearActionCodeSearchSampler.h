@@ -13,6 +13,7 @@
 # include <ml/Solver.h>
 # include <ml/Problem.h>
 # include <ml/SolutionContainer.h>
+# include <ml/DoubleVectorKernels.h>
 
 namespace lbcpp
 {
@@ -23,7 +24,7 @@ public:
   struct Example
   {
     std::vector<size_t> availableActions;
-    std::map<size_t, size_t> countsPerAction;
+    std::vector< std::pair<size_t, size_t> > countsPerAction; // (action code, count)
   };
 
   LogLinearActionCodeLearningObjective(const std::vector<Example>& examples, double regularizer)
@@ -39,41 +40,52 @@ public:
   {
     jassert(!value || *value == 0.0);
 
+    size_t numParameters = parameters ? parameters->getNumValues() : 0;
+    const double* theta = numParameters ? parameters->getValuePointer(0) : NULL;
+
     DenseDoubleVectorPtr denseGradient;
+    double* gradientValues = NULL;
     if (gradient)
     {
       denseGradient = new DenseDoubleVector(parameters->getClass());
-      denseGradient->ensureSize(parameters->getNumValues());
+      denseGradient->ensureSize(numParameters);
+      gradientValues = numParameters ? denseGradient->getValuePointer(0) : NULL;
       *gradient = denseGradient;
     }
 
+    std::vector<double> probabilities; // reused for all the examples
     size_t totalNumExamples = 0;
     for (size_t i = 0; i < examples.size(); ++i)
     {
       const Example& example = examples[i];
 
       size_t totalCount = 0;
-      for (std::map<size_t, size_t>::const_iterator it = example.countsPerAction.begin(); it != example.countsPerAction.end(); ++it)
+      for (size_t j = 0; j < example.countsPerAction.size(); ++j)
       {
-        if (value)
-          *value -= getParameter(parameters, it->first) * it->second;
-        if (denseGradient)
-          denseGradient->decrementValue(it->first, it->second);
-        totalCount += it->second;
+        size_t code = example.countsPerAction[j].first;
+        size_t count = example.countsPerAction[j].second;
+        if (value && code < numParameters)
+          *value -= theta[code] * count;
+        if (gradientValues && code < numParameters)
+          gradientValues[code] -= (double)count;
+        totalCount += count;
       }
       totalNumExamples += totalCount;
 
-      DenseDoubleVectorPtr activations = new DenseDoubleVector(example.availableActions.size(), 0.0);
-      for (size_t j = 0; j < example.availableActions.size(); ++j)
-        activations->setValue(j, getParameter(parameters, example.availableActions[j]));
-      double logSumExp = activations->computeLogSumOfExponentials();
+      size_t n = example.availableActions.size();
+      if (!n)
+        continue;
+      probabilities.resize(n);
+      DoubleVectorKernels::gather(&probabilities[0], theta, numParameters, &example.availableActions[0], n);
+      double logSumExp = DoubleVectorKernels::softmax(&probabilities[0], n);
 
       if (value)
         *value += totalCount * logSumExp;
-      if (denseGradient)
+      if (gradientValues)
       {
-        for (size_t j = 0; j < example.availableActions.size(); ++j)
-          denseGradient->incrementValue(example.availableActions[j], totalCount * exp(activations->getValue(j) - logSumExp));
+        for (size_t j = 0; j < n; ++j)
+          if (example.availableActions[j] < numParameters)
+            gradientValues[example.availableActions[j]] += totalCount * probabilities[j];
       }
     }
 
@@ -93,9 +105,6 @@ public:
 protected:
   std::vector<Example> examples;
   double regularizer;
-
-  static double getParameter(const DenseDoubleVectorPtr& parameters, size_t index)
-    {return parameters && index < parameters->getNumValues() ? parameters->getValue(index) : 0.0;}
 };
 
 class LogLinearActionCodeLearningProblem : public Problem
@@ -121,6 +130,82 @@ protected:
   double regularizer;
 };
 
+/*
+** Action codes of a trajectory: for each step, the codes of the available actions and the code of the selected action.
+** They are computed once per trajectory and shared by the clones of the sampler, since nested rollout algorithms
+** reinforce the same best trajectory many times.
+*/
+class ActionCodeTrajectory : public Object
+{
+public:
+  ActionCodeTrajectory(ExecutionContext& context, const SearchActionCodeGeneratorPtr& codeGenerator, const SearchTrajectoryPtr& trajectory, const SearchStatePtr& initialState)
+    : trajectory(trajectory), highestCode(0)
+  {
+    trajectory->ensureStatesAreComputed(context, initialState);
+    size_t n = trajectory->getLength();
+    offsets.reserve(n + 1);
+    selectedCodes.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      SearchStatePtr state = trajectory->getState(i);
+      DiscreteDomainPtr actionDomain = state->getActionDomain().staticCast<DiscreteDomain>();
+      offsets.push_back(codes.size());
+      for (size_t j = 0; j < actionDomain->getNumElements(); ++j)
+        addCode(codeGenerator->getCode(state, actionDomain->getElement(j)));
+      selectedCodes.push_back(codeGenerator->getCode(state, trajectory->getAction(i)));
+      if (selectedCodes.back() > highestCode)
+        highestCode = selectedCodes.back();
+    }
+    offsets.push_back(codes.size());
+  }
+
+  const SearchTrajectoryPtr& getTrajectory() const
+    {return trajectory;}
+
+  size_t getLength() const
+    {return selectedCodes.size();}
+
+  size_t getTotalNumCodes() const
+    {return codes.size();}
+
+  size_t getHighestCode() const
+    {return highestCode;}
+
+  // the codes of step i are codes[getOffset(i)] ... codes[getOffset(i + 1) - 1]
+  size_t getOffset(size_t step) const
+    {return offsets[step];}
+
+  const size_t* getCodes() const
+    {return codes.empty() ? NULL : &codes[0];}
+
+  size_t getSelectedCode(size_t step) const
+    {return selectedCodes[step];}
+
+private:
+  SearchTrajectoryPtr trajectory;
+  std::vector<size_t> codes;
+  std::vector<size_t> offsets;
+  std::vector<size_t> selectedCodes;
+  size_t highestCode;
+
+  void addCode(size_t code)
+  {
+    codes.push_back(code);
+    if (code > highestCode)
+      highestCode = code;
+  }
+};
+
+typedef ReferenceCountedObjectPtr<ActionCodeTrajectory> ActionCodeTrajectoryPtr;
+
+/*
+** The parameters form a contiguous array indexed by action code. Sampling and reinforcement work on preallocated
+** buffers, so that they do not allocate memory once the buffers have reached their largest size. Hence, a sampler
+** must not be used by several threads at the same time.
+**
+** sampleAction() still goes through SearchState::getActionDomain(), which allocates whenever the state builds its
+** domain on demand (e.g. MorpionState, once per visited state). The expression states return cached domains.
+*/
 class LogLinearActionCodeSearchSampler : public SearchSampler
 {
 public:
@@ -128,6 +213,14 @@ public:
     : codeGenerator(codeGenerator), regularizer(regularizer), learningRate(learningRate) {}
   LogLinearActionCodeSearchSampler() {}
 
+  virtual void initialize(ExecutionContext& context, const DomainPtr& domain)
+  {
+    SearchSampler::initialize(context, domain);
+    size_t numCodes = codeGenerator->getNumCodes(this->domain->getInitialState());
+    if (numCodes)
+      ensureNumParameters(numCodes);
+  }
+
   virtual bool isDeterministic() const // returns true if the sampler has became deterministic
     {return false;}
 
@@ -139,23 +232,17 @@ public:
     DiscreteDomainPtr actionDomain = state->getActionDomain().staticCast<DiscreteDomain>();
     size_t n = actionDomain->getNumElements();
     
-    std::vector<double> probabilities(n, 0.0);
-    double Z = 0.0;
-    double highestProbability = 0.0;
-
+    codesBuffer.resize(n);
     for (size_t i = 0; i < n; ++i)
+      codesBuffer[i] = codeGenerator->getCode(state, actionDomain->getElement(i));
+
+    probabilitiesBuffer.resize(n);
+    if (n)
     {
-      size_t code = codeGenerator->getCode(state, actionDomain->getElement(i));
-      double p = exp(getParameter(code));
-      probabilities[i] = p;
-      highestProbability = juce::jmax(p, highestProbability);
-      Z += p;
+      DoubleVectorKernels::gather(&probabilitiesBuffer[0], getParameters(), getNumParameters(), &codesBuffer[0], n);
+      DoubleVectorKernels::softmax(&probabilitiesBuffer[0], n);
     }
-
-    //if (highestProbability < Z * (1 - 1e-9))
-    //  isDeterministic = false;
-
-    size_t index = context.getRandomGenerator()->sampleWithProbabilities(probabilities, Z);
+    size_t index = context.getRandomGenerator()->sampleWithProbabilities(probabilitiesBuffer, 1.0);
     return actionDomain->getElement(index);
   }
   
@@ -172,10 +259,7 @@ public:
     size_t highestActionCode = 0;
     makeDatasetRecursively(*(const std::vector<SearchTrajectoryPtr>* )&objects, indices, 0, dataset, highestActionCode);
 
-    if (!parameters)
-      parameters = new DenseDoubleVector(highestActionCode + 1, 0.0);
-    else
-      parameters->ensureSize(highestActionCode + 1);
+    ensureNumParameters(highestActionCode + 1);
 
     ProblemPtr learningProblem = new LogLinearActionCodeLearningProblem(highestActionCode + 1, dataset, regularizer);
     learningProblem->setInitialGuess(parameters);
@@ -196,42 +280,37 @@ public:
       parameters = front->getSolution(0).staticCast<DenseDoubleVector>();
   }
 
+  // parameters += learningRate * weight * gradient of sum_steps log P(selected action), the gradient being computed before any update
   virtual void reinforce(ExecutionContext& context, const ObjectPtr& object, double weight)
   {
     jassert(object);
 
-    SearchTrajectoryPtr trajectory = object.staticCast<SearchTrajectory>();
-    trajectory->ensureStatesAreComputed(context, domain->getInitialState());
-    //std::cout << "Reinforce "  << trajectory->toShortString() << std::endl;
-
-    SparseDoubleVectorPtr gradient = new SparseDoubleVector();
+    const ActionCodeTrajectoryPtr& trajectory = getActionCodeTrajectory(context, object.staticCast<SearchTrajectory>());
+    ensureNumParameters(trajectory->getHighestCode() + 1);
+    double* theta = parameters->getValuePointer(0);
+    size_t numParameters = parameters->getNumValues();
+    const size_t* codes = trajectory->getCodes();
     size_t n = trajectory->getLength();
+
+    // probabilities of all the available actions of all the steps
+    probabilitiesBuffer.resize(trajectory->getTotalNumCodes());
+    if (probabilitiesBuffer.empty())
+      return;
+    double* probabilities = &probabilitiesBuffer[0];
+    DoubleVectorKernels::gather(probabilities, theta, numParameters, codes, probabilitiesBuffer.size());
     for (size_t i = 0; i < n; ++i)
     {
-      SearchStatePtr state = trajectory->getState(i);
-      ObjectPtr action = trajectory->getAction(i);
-      DiscreteDomainPtr actionDomain = state->getActionDomain();
-
-      size_t code = codeGenerator->getCode(state, action);
-      gradient->incrementValue(code, 1.0);
-
-      size_t numActions = actionDomain->getNumElements();
-      std::vector< std::pair<size_t, double> > codesAndProbabilities(numActions);
-      double Z = 0.0;
-      for (size_t j = 0; j < numActions; ++j)
-      {
-        size_t code = codeGenerator->getCode(state, actionDomain->getElement(j));
-        double probability = exp(getParameter(code));
-        codesAndProbabilities[j] = std::make_pair(code, probability);
-        Z += probability;
-      }
-      for (size_t j = 0; j < numActions; ++j)
-        gradient->incrementValue(codesAndProbabilities[j].first, -codesAndProbabilities[j].second / Z);
+      size_t begin = trajectory->getOffset(i);
+      DoubleVectorKernels::softmax(probabilities + begin, trajectory->getOffset(i + 1) - begin);
     }
 
-    if (!parameters)
-      parameters = new DenseDoubleVector(0, 0.0);
-    gradient->addWeightedTo(parameters, 0, learningRate * weight);
+    double stepSize = learningRate * weight;
+    for (size_t i = 0; i < n; ++i)
+    {
+      theta[trajectory->getSelectedCode(i)] += stepSize;
+      for (size_t j = trajectory->getOffset(i); j < trajectory->getOffset(i + 1); ++j)
+        theta[codes[j]] -= stepSize * probabilities[j];
+    }
   }
   
   virtual void clone(ExecutionContext& context, const ObjectPtr& t) const
@@ -239,8 +318,10 @@ public:
     const ReferenceCountedObjectPtr<LogLinearActionCodeSearchSampler>& target = t.staticCast<LogLinearActionCodeSearchSampler>();
     target->domain = domain;
     target->codeGenerator = codeGenerator;
+    target->regularizer = regularizer;
     target->learningRate = learningRate;
     target->parameters = parameters ? parameters->cloneAndCast<DenseDoubleVector>() : DenseDoubleVectorPtr();
+    target->lastTrajectory = lastTrajectory;
   }
 
 protected:
@@ -252,8 +333,30 @@ protected:
 
   DenseDoubleVectorPtr parameters;
 
-  double getParameter(size_t index) const
-    {return parameters && parameters->getNumValues() > index ? parameters->getValue(index) : 0.0;}
+  ActionCodeTrajectoryPtr lastTrajectory; // action codes of the last reinforced trajectory
+  mutable std::vector<size_t> codesBuffer;
+  mutable std::vector<double> probabilitiesBuffer;
+
+  const double* getParameters() const
+    {return parameters && parameters->getNumValues() ? parameters->getValuePointer(0) : NULL;}
+
+  size_t getNumParameters() const
+    {return parameters ? parameters->getNumValues() : 0;}
+
+  void ensureNumParameters(size_t numParameters)
+  {
+    if (!parameters)
+      parameters = new DenseDoubleVector(numParameters, 0.0);
+    else if (parameters->getNumValues() < numParameters)
+      parameters->ensureSize(numParameters);
+  }
+
+  const ActionCodeTrajectoryPtr& getActionCodeTrajectory(ExecutionContext& context, const SearchTrajectoryPtr& trajectory)
+  {
+    if (!lastTrajectory || lastTrajectory->getTrajectory() != trajectory)
+      lastTrajectory = new ActionCodeTrajectory(context, codeGenerator, trajectory, domain->getInitialState());
+    return lastTrajectory;
+  }
 
   void makeDatasetRecursively(const std::vector<SearchTrajectoryPtr>& trajectories, const std::vector<size_t>& indices, size_t step, std::vector<Example>& res, size_t& highestActionCode)
   {
@@ -283,9 +386,10 @@ protected:
       size_t actionCode = codeGenerator->getCode(state, action);
       m[actionCode].push_back(indices[i]);
     }
+    example.countsPerAction.reserve(m.size());
     for (DispatchMap::const_iterator it = m.begin(); it != m.end(); ++it)
     {
-      example.countsPerAction[it->first] = it->second.size();
+      example.countsPerAction.push_back(std::make_pair(it->first, it->second.size()));
       makeDatasetRecursively(trajectories, it->second, step + 1, res, highestActionCode);
     }
     res.push_back(example);
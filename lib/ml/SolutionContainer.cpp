@@ -8,7 +8,8 @@
 #include "precompiled.h"
 #include <ml/SolutionContainer.h>
 #include <ml/SolutionComparator.h>
-#include <MOO-EALib/Hypervolume.h>
+#include <ml/NonDominatedSorting.h>
+#include <ml/DensityEstimation.h>
 #include <algorithm>
 #include <iostream>
 #include <fstream>
@@ -42,6 +43,26 @@ FitnessLimitsPtr SolutionContainer::getEmpiricalFitnessLimits() const
   return new FitnessLimits(res);
 }
 
+void SolutionContainer::getPointsToBeMinimized(std::vector<double>& res) const
+{
+  size_t n = getNumSolutions();
+  size_t numObjectives = getNumObjectives();
+  FitnessLimitsPtr limits = getFitnessLimits();
+  std::vector<double> signs(numObjectives);
+  for (size_t j = 0; j < numObjectives; ++j)
+    signs[j] = -limits->getObjectiveSign(j);
+
+  res.resize(n * numObjectives);
+  double* ptr = res.empty() ? NULL : &res[0];
+  for (size_t i = 0; i < n; ++i)
+  {
+    const std::vector<double>& values = getFitness(i)->getValues();
+    jassert(values.size() == numObjectives);
+    for (size_t j = 0; j < numObjectives; ++j)
+      *ptr++ = signs[j] * values[j];
+  }
+}
+
 void SolutionContainer::insertSolutions(SolutionContainerPtr solutions)
 {
   size_t n = solutions->getNumSolutions();
@@ -185,11 +206,39 @@ bool SolutionVector::strictlyDominates(const FitnessPtr& fitness) const
   return false;
 }
 
+// fitnesses to be minimized, one row per solution
+static size_t packPointsToBeMinimized(const std::vector<SolutionContainer::SolutionAndFitness>& solutions, std::vector<double>& res)
+{
+  if (solutions.empty())
+    return 0;
+  FitnessLimitsPtr limits = solutions[0].second->getLimits();
+  size_t numObjectives = solutions[0].second->getNumValues();
+  std::vector<double> signs(numObjectives);
+  for (size_t j = 0; j < numObjectives; ++j)
+    signs[j] = -limits->getObjectiveSign(j);
+
+  res.resize(solutions.size() * numObjectives);
+  double* ptr = res.empty() ? NULL : &res[0];
+  for (size_t i = 0; i < solutions.size(); ++i)
+  {
+    const std::vector<double>& values = solutions[i].second->getValues();
+    jassert(values.size() == numObjectives);
+    for (size_t j = 0; j < numObjectives; ++j)
+      *ptr++ = signs[j] * values[j];
+  }
+  return numObjectives;
+}
+
 ParetoFrontPtr SolutionVector::getParetoFront() const
 {
+  std::vector<double> points;
+  size_t numObjectives = packPointsToBeMinimized(solutions, points);
+  std::vector<size_t> ranks;
+  NonDominatedSorting::computeRanks(points.size() ? &points[0] : NULL, solutions.size(), numObjectives, ranks);
+
   std::vector<SolutionAndFitness> res;
   for (size_t i = 0; i < solutions.size(); ++i)
-    if (!strictlyDominates(solutions[i].second))
+    if (ranks[i] == 0)
       res.push_back(solutions[i]);
   return new ParetoFront(limits, res, comparator);
 }
@@ -201,67 +250,20 @@ void SolutionVector::computeParetoRanks(std::vector< std::pair<size_t, size_t> >
   if (!n)
     return;
 
-  std::vector<size_t> dominationCounter(n, 0); // by how many others am I dominated?
-  std::vector< std::vector<size_t> > dominationIndices(n); // who do I dominate?
+  std::vector<double> points;
+  size_t numObjectives = packPointsToBeMinimized(solutions, points);
+  std::vector<size_t> ranks;
+  NonDominatedSorting::computeRanks(points.size() ? &points[0] : NULL, n, numObjectives, ranks);
 
+  // solutions are placed in their front by increasing position, as in nonDominatedSort()
   mapping.resize(n);
-
-  std::vector<size_t> currentFrontIndices;
-  SolutionComparatorPtr dom = dominanceComparator();
-  dom->initialize(refCountedPointerFromThis(this));
   for (size_t i = 0; i < n; ++i)
   {
-    for (size_t j = 0; j < n; ++j)
-    {
-      int c = dom->compareSolutions(i, j);
-      if (c == -1)
-        dominationIndices[i].push_back(j);
-      else if (c == 1)
-        dominationCounter[i]++;
-    }
-    if (dominationCounter[i] == 0)
-    {
-      mapping[i] = std::make_pair(0, currentFrontIndices.size());
-      currentFrontIndices.push_back(i);
-    }
+    size_t rank = ranks[i];
+    if (rank >= countPerRank.size())
+      countPerRank.resize(rank + 1, 0);
+    mapping[i] = std::make_pair(rank, countPerRank[rank]++);
   }
-
-  jassert(currentFrontIndices.size() > 0);
-  countPerRank.push_back(currentFrontIndices.size());
-  
-  for (size_t currentRank = 1; true; ++currentRank)
-  {
-    std::vector<size_t> nextFrontIndices;
-    for (size_t i = 0; i < currentFrontIndices.size(); ++i)
-    {
-      const std::vector<size_t>& indices = dominationIndices[currentFrontIndices[i]];
-      for (size_t j = 0; j < indices.size(); ++j)
-      {
-        size_t index = indices[j];
-        size_t& counter = dominationCounter[index];
-        jassert(counter > 0);
-        --counter;
-        if (counter == 0)
-        {
-          mapping[index] = std::make_pair(currentRank, nextFrontIndices.size());
-          nextFrontIndices.push_back(index);
-        }
-      }
-    }
-    currentFrontIndices.swap(nextFrontIndices);
-
-    if (currentFrontIndices.size())
-      countPerRank.push_back(currentFrontIndices.size());
-    else
-      break;
-  }
-
-#ifdef JUCE_DEBUG
-  size_t totalSize = 0;
-  for (size_t i = 0; i < countPerRank.size(); ++i)
-    totalSize += countPerRank[i];
-  jassert(totalSize == n);
-#endif // JUCE_DEBUG
 }
 
 std::vector<ParetoFrontPtr> SolutionVector::nonDominatedSort(std::vector< std::pair<size_t, size_t> >* mapping) const
@@ -288,32 +290,9 @@ std::vector<ParetoFrontPtr> SolutionVector::nonDominatedSort(std::vector< std::p
 
 void SolutionVector::computeCrowdingDistances(std::vector<double>& res) const
 {
-  size_t n = solutions.size();
-
-  res.resize(n, 0.0);
-  if (n <= 2)
-  {
-    for (size_t i = 0; i < n; ++i)
-      res[i] = DBL_MAX;
-    return;
-  }
-  
-  std::vector<size_t> order(n);
-  for (size_t i = 0; i < n; ++i)
-    order[i] = i;
-
-  for (size_t i = 0; i < limits->getNumObjectives(); ++i)
-  {
-    std::vector<size_t> mapping;
-    SolutionVectorPtr ordered = sort(objectiveComparator(i), &mapping);
-    double bestValue = ordered->getFitness(0)->getValue(i);
-    double worstValue = ordered->getFitness(n - 1)->getValue(i);
-    double invRange = 1.0 / (worstValue - bestValue);
-    res[mapping[0]] = DBL_MAX;
-    res[mapping[n-1]] = DBL_MAX;
-    for (size_t j = 1; j < n - 1; ++j)
-      res[mapping[j]] += (ordered->getFitness(j+1)->getValue(i) - ordered->getFitness(j-1)->getValue(i)) * invRange;
-  }
+  std::vector<double> points;
+  getPointsToBeMinimized(points);
+  DensityEstimation::computeCrowdingDistances(points.size() ? &points[0] : NULL, solutions.size(), limits->getNumObjectives(), res);
 }
 
 void SolutionVector::clone(ExecutionContext& context, const ObjectPtr& t) const
@@ -365,6 +344,7 @@ ParetoFront::ParetoFront(FitnessLimitsPtr limits, const string& path) : Solution
 
 void ParetoFront::insertSolution(ObjectPtr solution, FitnessPtr fitness)
 {
+  bool wasHyperVolumeUpToDate = isHyperVolumeUpToDate();
   std::vector<SolutionAndFitness> newSolutions;
   newSolutions.reserve(solutions.size());
   std::vector<SolutionAndFitness>::iterator insertPos = newSolutions.begin();
@@ -390,6 +370,7 @@ void ParetoFront::insertSolution(ObjectPtr solution, FitnessPtr fitness)
   if (!found)
     newSolutions.push_back(SolutionAndFitness(solution, fitness));
   solutions.swap(newSolutions);
+  updateHyperVolume(wasHyperVolumeUpToDate, fitness, true);
 }
 
 void ParetoFront::insertSolutions(SolutionContainerPtr solutions)
@@ -397,6 +378,35 @@ void ParetoFront::insertSolutions(SolutionContainerPtr solutions)
   SolutionContainer::insertSolutions(solutions);
 }
 
+void ParetoFront::removeSolution(size_t index)
+{
+  bool wasHyperVolumeUpToDate = isHyperVolumeUpToDate();
+  FitnessPtr fitness = getFitness(index);
+  SolutionVector::removeSolution(index);
+  updateHyperVolume(wasHyperVolumeUpToDate, fitness, false);
+}
+
+void ParetoFront::updateHyperVolume(bool wasUpToDate, const FitnessPtr& fitness, bool isInsertion)
+{
+  if (!wasUpToDate)
+    return; // the hypervolume will be computed from scratch
+  std::vector<double> point = fitness->getValuesToBeMinimized();
+  if (isInsertion)
+    hyperVolume.insert(&point[0]); // also discards the points of the removed dominated solutions
+  else
+    hyperVolume.remove(&point[0]);
+  hyperVolumeNumSolutions = solutions.size();
+}
+
+void ParetoFront::clone(ExecutionContext& context, const ObjectPtr& t) const
+{
+  SolutionVector::clone(context, t);
+  const ParetoFrontPtr& target = t.staticCast<ParetoFront>();
+  ScopedLock _(hyperVolumeLock);
+  target->hyperVolume = hyperVolume;
+  target->hyperVolumeNumSolutions = hyperVolumeNumSolutions;
+}
+
 double ParetoFront::computeHyperVolume(FitnessPtr referenceFitness) const
 {
   if (isEmpty())
@@ -412,30 +422,52 @@ double ParetoFront::computeHyperVolume(FitnessPtr referenceFitness) const
     double res = limits->getObjectiveSign(0) * (bestValue - referenceFitness->getValue(0));
     return res > 0.0 ? res : 0.0;
   }
-  else
+
+  std::vector<double> reference = referenceFitness->getValuesToBeMinimized();
+  ScopedLock _(hyperVolumeLock);
+  if (!isHyperVolumeUpToDate() || hyperVolume.getReference() != reference)
   {
-    // remove points that fall outside the hypervolume and convert to minimization problem
-    std::vector<double> points(solutions.size() * numObjectives);
-    size_t numPoints = 0;
-    for (size_t i = 0; i < solutions.size(); ++i)
-    {
-      FitnessPtr fitness = solutions[i].second;
-      if (!referenceFitness->isBetterForAtLeastOneObjectiveThan(fitness))
-      {
-        std::vector<double> val = fitness->getValuesToBeMinimized();
-        memcpy(&points[numPoints * numObjectives], &val[0], sizeof (double) * numObjectives);
-        ++numPoints;
-      }
-    }
+    std::vector<double> points;
+    getPointsToBeMinimized(points);
+    hyperVolume.initialize(numObjectives, reference, &points[0], solutions.size());
+    hyperVolumeNumSolutions = solutions.size();
+  }
+  return hyperVolume.getValue();
+}
 
-    if (!numPoints)
-      return 0.0;
+double ParetoFront::estimateHyperVolume(const RandomGeneratorPtr& random, size_t numSamples, FitnessPtr referenceFitness, double* confidenceHalfWidth) const
+{
+  if (confidenceHalfWidth)
+    *confidenceHalfWidth = 0.0;
+  if (isEmpty())
+    return 0.0;
 
-    std::vector<double> ref = referenceFitness->getValuesToBeMinimized();
+  if (!referenceFitness)
+    referenceFitness = limits->getWorstPossibleFitness();
+  std::vector<double> reference = referenceFitness->getValuesToBeMinimized();
+  std::vector<double> points;
+  getPointsToBeMinimized(points);
+  double standardError;
+  double res = HyperVolume::estimate(&points[0], solutions.size(), limits->getNumObjectives(), &reference[0], random, numSamples, standardError);
+  if (confidenceHalfWidth)
+    *confidenceHalfWidth = 1.96 * standardError;
+  return res;
+}
 
-    // shark implementation
-    return hypervolume(&points[0], &ref[0], (unsigned int)numObjectives, (unsigned int)numPoints);
+void ParetoFront::computeHyperVolumeContributions(std::vector<double>& res, FitnessPtr referenceFitness) const
+{
+  if (isEmpty())
+  {
+    res.clear();
+    return;
   }
+
+  if (!referenceFitness)
+    referenceFitness = limits->getWorstPossibleFitness();
+  std::vector<double> reference = referenceFitness->getValuesToBeMinimized();
+  std::vector<double> points;
+  getPointsToBeMinimized(points);
+  HyperVolume::computeContributions(&points[0], solutions.size(), limits->getNumObjectives(), &reference[0], res);
 }
 
 double ParetoFront::computeMultiplicativeEpsilonIndicator(ParetoFrontPtr referenceFront) const
@@ -478,25 +510,483 @@ double ParetoFront::computeAdditiveEpsilonIndicator(ParetoFrontPtr referenceFron
   return result;
 }
 
+/*
+** NDTreeParetoFront
+*/
+NDTreeParetoFront::NDTreeParetoFront(FitnessLimitsPtr limits, size_t maxLeafSize, size_t numChildren)
+  : ParetoFront(limits), maxLeafSize(maxLeafSize), numChildren(numChildren), root(NULL), numObjectives(0), numIndexedSolutions(0)
+{
+  jassert(maxLeafSize > 0);
+}
+
+NDTreeParetoFront::NDTreeParetoFront()
+  : maxLeafSize(20), numChildren(0), root(NULL), numObjectives(0), numIndexedSolutions(0)
+{
+}
+
+NDTreeParetoFront::~NDTreeParetoFront()
+  {delete root;}
+
+NDTreeParetoFront::Node::~Node()
+{
+  for (size_t i = 0; i < children.size(); ++i)
+    delete children[i];
+}
+
+static bool weaklyDominatesPoint(const double* point1, const double* point2, size_t numObjectives)
+{
+  for (size_t i = 0; i < numObjectives; ++i)
+    if (point1[i] > point2[i])
+      return false;
+  return true;
+}
+
+static bool strictlyDominatesPoint(const double* point1, const double* point2, size_t numObjectives)
+{
+  bool isBetterForOneObjective = false;
+  for (size_t i = 0; i < numObjectives; ++i)
+  {
+    if (point1[i] > point2[i])
+      return false;
+    if (point1[i] < point2[i])
+      isBetterForOneObjective = true;
+  }
+  return isBetterForOneObjective;
+}
+
+static double squaredDistanceBetweenPoints(const double* point1, const double* point2, size_t numObjectives)
+{
+  double res = 0.0;
+  for (size_t i = 0; i < numObjectives; ++i)
+    res += (point1[i] - point2[i]) * (point1[i] - point2[i]);
+  return res;
+}
+
+void NDTreeParetoFront::insertSolution(ObjectPtr solution, FitnessPtr fitness)
+{
+  bool wasHyperVolumeUpToDate = isHyperVolumeUpToDate();
+  if (numIndexedSolutions != solutions.size())
+    rebuildIndex();
+  std::vector<double> point = fitness->getValuesToBeMinimized();
+  if (!numObjectives)
+    numObjectives = point.size();
+  jassert(point.size() == numObjectives);
+
+  if (root)
+  {
+    // a point that is weakly dominated by the front cannot dominate a solution of the front,
+    // so no solution has been removed when updateNode() rejects the point
+    std::vector<size_t> dominatedSolutions;
+    if (!updateNode(root, &point[0], dominatedSolutions))
+      return;
+    if (root->isEmpty())
+    {
+      delete root;
+      root = NULL;
+    }
+    if (dominatedSolutions.size())
+    {
+      std::sort(dominatedSolutions.begin(), dominatedSolutions.end());
+      removeSolutionsFromVectors(dominatedSolutions);
+    }
+  }
+
+  // same position as in ParetoFront: before the first solution whose fitness is lexicographically greater
+  const std::vector<double>& values = fitness->getValues();
+  size_t index = 0;
+  for (size_t count = solutions.size(); count > 0; )
+  {
+    size_t half = count / 2;
+    if (solutions[index + half].second->getValues() < values)
+    {
+      index += half + 1;
+      count -= half + 1;
+    }
+    else
+      count = half;
+  }
+
+  solutions.insert(solutions.begin() + index, SolutionAndFitness(solution, fitness));
+  points.insert(points.begin() + index * numObjectives, point.begin(), point.end());
+  leaves.insert(leaves.begin() + index, (Node* )NULL);
+  ++numIndexedSolutions;
+  if (root)
+    shiftIndices(root, index);
+  else
+    root = new Node(NULL);
+  insertIntoNode(root, index);
+  updateHyperVolume(wasHyperVolumeUpToDate, fitness, true);
+}
+
+void NDTreeParetoFront::removeSolution(size_t index)
+{
+  bool wasHyperVolumeUpToDate = isHyperVolumeUpToDate();
+  if (numIndexedSolutions != solutions.size())
+    rebuildIndex();
+  jassert(index < solutions.size());
+  FitnessPtr fitness = solutions[index].second;
+  Node* leaf = leaves[index];
+  std::vector<size_t>& indices = leaf->solutionIndices;
+  indices.erase(std::find(indices.begin(), indices.end(), index));
+  removeEmptyNodes(leaf);
+  removeSolutionsFromVectors(std::vector<size_t>(1, index));
+  updateHyperVolume(wasHyperVolumeUpToDate, fitness, false);
+}
+
+void NDTreeParetoFront::clone(ExecutionContext& context, const ObjectPtr& t) const
+{
+  const NDTreeParetoFrontPtr& target = t.staticCast<NDTreeParetoFront>();
+  ParetoFront::clone(context, target);
+  target->maxLeafSize = maxLeafSize;
+  target->numChildren = numChildren;
+  target->rebuildIndex();
+}
+
+void NDTreeParetoFront::rebuildIndex()
+{
+  delete root;
+  root = NULL;
+  size_t n = solutions.size();
+  numObjectives = n ? solutions[0].second->getNumValues() : 0;
+  points.resize(n * numObjectives);
+  leaves.clear();
+  leaves.resize(n, NULL);
+  for (size_t i = 0; i < n; ++i)
+  {
+    std::vector<double> point = solutions[i].second->getValuesToBeMinimized();
+    std::copy(point.begin(), point.end(), points.begin() + i * numObjectives);
+  }
+  numIndexedSolutions = n;
+  if (n)
+  {
+    root = new Node(NULL);
+    for (size_t i = 0; i < n; ++i)
+      insertIntoNode(root, i);
+  }
+}
+
+// returns false if the point is weakly dominated by a solution of the node
+bool NDTreeParetoFront::updateNode(Node* node, const double* point, std::vector<size_t>& dominatedSolutions)
+{
+  if (weaklyDominatesPoint(&node->nadir[0], point, numObjectives))
+    return false; // all the solutions of the node weakly dominate the point
+  if (strictlyDominatesPoint(point, &node->ideal[0], numObjectives))
+  {
+    // the point dominates all the solutions of the node
+    collectSolutions(node, dominatedSolutions);
+    for (size_t i = 0; i < node->children.size(); ++i)
+      delete node->children[i];
+    node->children.clear();
+    node->solutionIndices.clear();
+    return true;
+  }
+  if (!weaklyDominatesPoint(&node->ideal[0], point, numObjectives) && !weaklyDominatesPoint(point, &node->nadir[0], numObjectives))
+    return true; // the point is incomparable with all the solutions of the node
+
+  if (node->isLeaf())
+  {
+    std::vector<size_t>& indices = node->solutionIndices;
+    for (size_t i = 0; i < indices.size(); )
+    {
+      const double* solutionPoint = &points[indices[i] * numObjectives];
+      if (weaklyDominatesPoint(solutionPoint, point, numObjectives))
+        return false;
+      if (strictlyDominatesPoint(point, solutionPoint, numObjectives))
+      {
+        dominatedSolutions.push_back(indices[i]);
+        indices[i] = indices.back();
+        indices.pop_back();
+      }
+      else
+        ++i;
+    }
+  }
+  else
+  {
+    std::vector<Node*>& children = node->children;
+    for (size_t i = 0; i < children.size(); )
+    {
+      if (!updateNode(children[i], point, dominatedSolutions))
+        return false;
+      if (children[i]->isEmpty())
+      {
+        delete children[i];
+        children[i] = children.back();
+        children.pop_back();
+      }
+      else
+        ++i;
+    }
+
+    if (children.size() == 1)
+    {
+      // replace the node by its only child, keeping the bounds of the node which contain those of the child
+      Node* child = children[0];
+      children.swap(child->children);
+      child->children.clear();
+      node->solutionIndices.swap(child->solutionIndices);
+      delete child;
+      for (size_t i = 0; i < children.size(); ++i)
+        children[i]->parent = node;
+      for (size_t i = 0; i < node->solutionIndices.size(); ++i)
+        leaves[node->solutionIndices[i]] = node;
+    }
+  }
+  return true;
+}
+
+void NDTreeParetoFront::insertIntoNode(Node* node, size_t index)
+{
+  const double* point = &points[index * numObjectives];
+  updateBounds(node, point);
+  while (!node->isLeaf())
+  {
+    node = findClosestChild(node, point);
+    updateBounds(node, point);
+  }
+  node->solutionIndices.push_back(index);
+  leaves[index] = node;
+  if (node->solutionIndices.size() > maxLeafSize)
+    splitLeaf(node);
+}
+
+void NDTreeParetoFront::splitLeaf(Node* node)
+{
+  std::vector<size_t> indices;
+  indices.swap(node->solutionIndices);
+  size_t n = indices.size();
+  size_t numSeeds = numChildren ? numChildren : numObjectives + 1;
+  if (numSeeds > n)
+    numSeeds = n;
+
+  std::vector<double> distances(n * n);
+  for (size_t i = 0; i < n; ++i)
+    for (size_t j = 0; j < n; ++j)
+      distances[i * n + j] = sqrt(squaredDistanceBetweenPoints(&points[indices[i] * numObjectives], &points[indices[j] * numObjectives], numObjectives));
+
+  // the first seed is the solution which is the farthest from the others on average,
+  // each next seed is the solution which is the farthest from the previous seeds on average
+  std::vector<bool> isSeed(n, false);
+  std::vector<size_t> seeds;
+  while (seeds.size() < numSeeds)
+  {
+    size_t bestIndex = n;
+    double bestDistance = -DBL_MAX;
+    for (size_t i = 0; i < n; ++i)
+      if (!isSeed[i])
+      {
+        double distance = 0.0;
+        if (seeds.empty())
+          for (size_t j = 0; j < n; ++j)
+            distance += distances[i * n + j];
+        else
+          for (size_t j = 0; j < seeds.size(); ++j)
+            distance += distances[i * n + seeds[j]];
+        if (distance > bestDistance)
+        {
+          bestIndex = i;
+          bestDistance = distance;
+        }
+      }
+    isSeed[bestIndex] = true;
+    seeds.push_back(bestIndex);
+  }
+
+  for (size_t i = 0; i < seeds.size(); ++i)
+  {
+    Node* child = new Node(node);
+    size_t index = indices[seeds[i]];
+    updateBounds(child, &points[index * numObjectives]);
+    child->solutionIndices.push_back(index);
+    leaves[index] = child;
+    node->children.push_back(child);
+  }
+  for (size_t i = 0; i < n; ++i)
+    if (!isSeed[i])
+    {
+      size_t index = indices[i];
+      const double* point = &points[index * numObjectives];
+      Node* child = findClosestChild(node, point);
+      updateBounds(child, point);
+      child->solutionIndices.push_back(index);
+      leaves[index] = child;
+    }
+}
+
+NDTreeParetoFront::Node* NDTreeParetoFront::findClosestChild(Node* node, const double* point) const
+{
+  Node* res = NULL;
+  double bestDistance = DBL_MAX;
+  std::vector<double> middle(numObjectives);
+  for (size_t i = 0; i < node->children.size(); ++i)
+  {
+    Node* child = node->children[i];
+    for (size_t j = 0; j < numObjectives; ++j)
+      middle[j] = (child->ideal[j] + child->nadir[j]) / 2.0;
+    double distance = squaredDistanceBetweenPoints(&middle[0], point, numObjectives);
+    if (distance < bestDistance)
+    {
+      res = child;
+      bestDistance = distance;
+    }
+  }
+  jassert(res);
+  return res;
+}
+
+void NDTreeParetoFront::updateBounds(Node* node, const double* point) const
+{
+  if (node->ideal.empty())
+  {
+    node->ideal.assign(point, point + numObjectives);
+    node->nadir.assign(point, point + numObjectives);
+  }
+  else
+    for (size_t i = 0; i < numObjectives; ++i)
+    {
+      if (point[i] < node->ideal[i])
+        node->ideal[i] = point[i];
+      if (point[i] > node->nadir[i])
+        node->nadir[i] = point[i];
+    }
+}
+
+void NDTreeParetoFront::collectSolutions(Node* node, std::vector<size_t>& res) const
+{
+  res.insert(res.end(), node->solutionIndices.begin(), node->solutionIndices.end());
+  for (size_t i = 0; i < node->children.size(); ++i)
+    collectSolutions(node->children[i], res);
+}
+
+void NDTreeParetoFront::removeEmptyNodes(Node* node)
+{
+  while (node && node->isEmpty())
+  {
+    Node* parent = node->parent;
+    if (parent)
+      parent->children.erase(std::find(parent->children.begin(), parent->children.end(), node));
+    else
+      root = NULL;
+    delete node;
+    node = parent;
+  }
+}
+
+// increments the indices of the solutions that follow an inserted solution
+void NDTreeParetoFront::shiftIndices(Node* node, size_t firstIndex)
+{
+  std::vector<size_t>& indices = node->solutionIndices;
+  for (size_t i = 0; i < indices.size(); ++i)
+    if (indices[i] >= firstIndex)
+      ++indices[i];
+  for (size_t i = 0; i < node->children.size(); ++i)
+    shiftIndices(node->children[i], firstIndex);
+}
+
+// renumbers the indices of the solutions after some of them have been removed
+void NDTreeParetoFront::remapIndices(Node* node, const std::vector<size_t>& newIndices)
+{
+  std::vector<size_t>& indices = node->solutionIndices;
+  for (size_t i = 0; i < indices.size(); ++i)
+    indices[i] = newIndices[indices[i]];
+  for (size_t i = 0; i < node->children.size(); ++i)
+    remapIndices(node->children[i], newIndices);
+}
+
+// removes the solutions at the given sorted indices, that are no longer in the tree, and keeps the order of the others
+void NDTreeParetoFront::removeSolutionsFromVectors(const std::vector<size_t>& sortedIndices)
+{
+  size_t n = solutions.size();
+  std::vector<size_t> newIndices(n, (size_t)-1);
+  size_t numRemoved = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (numRemoved < sortedIndices.size() && sortedIndices[numRemoved] == i)
+    {
+      ++numRemoved;
+      continue;
+    }
+    if (count != i)
+    {
+      solutions[count] = solutions[i];
+      std::copy(points.begin() + i * numObjectives, points.begin() + (i + 1) * numObjectives, points.begin() + count * numObjectives);
+      leaves[count] = leaves[i];
+    }
+    newIndices[i] = count++;
+  }
+  solutions.erase(solutions.begin() + count, solutions.end());
+  points.resize(count * numObjectives);
+  leaves.resize(count);
+  numIndexedSolutions = count;
+  if (root && count < n)
+    remapIndices(root, newIndices);
+}
+
 void CrowdingArchive::insertSolution(ObjectPtr solution, FitnessPtr fitness)
 {
   ParetoFront::insertSolution(solution, fitness);
-  if (getNumSolutions() > maxSize)
+  size_t n = getNumSolutions();
+  if (n > maxSize)
+  {
+    // remove the most crowded solution, the distances being normalised by the fitness limits
+    // or by the range of the archive for the objectives that are not bounded
+    size_t numObjectives = limits->getNumObjectives();
+    std::vector<double> points;
+    getPointsToBeMinimized(points);
+    std::vector<double> ranges(numObjectives);
+    for (size_t i = 0; i < numObjectives; ++i)
+    {
+      ranges[i] = limits->getUpperLimit(i) - limits->getLowerLimit(i);
+      if (!isNumberValid(ranges[i]))
+      {
+        double minValue = DBL_MAX, maxValue = -DBL_MAX;
+        for (size_t j = 0; j < n; ++j)
+        {
+          minValue = juce::jmin(minValue, points[j * numObjectives + i]);
+          maxValue = juce::jmax(maxValue, points[j * numObjectives + i]);
+        }
+        ranges[i] = maxValue - minValue;
+      }
+    }
+    std::vector<double> distances;
+    DensityEstimation::computeCrowdingDistances(&points[0], n, numObjectives, distances, &ranges[0]);
+    removeSolution(std::min_element(distances.begin(), distances.end()) - distances.begin());
+  }
+}
+
+void ClusteringArchive::insertSolution(ObjectPtr solution, FitnessPtr fitness)
+{
+  ParetoFront::insertSolution(solution, fitness);
+  size_t n = getNumSolutions();
+  if (n > maxSize)
   {
-    /* now we remove the worst solution */
-    int worst = 0;
-    double worstDistance = DBL_MAX;
-    for (size_t i = 1; i < getNumSolutions()-1; ++i)
+    // normalise the objectives by the fitness limits, when they are bounded
+    size_t numObjectives = limits->getNumObjectives();
+    std::vector<double> points;
+    getPointsToBeMinimized(points);
+    for (size_t j = 0; j < numObjectives; ++j)
+    {
+      double range = limits->getUpperLimit(j) - limits->getLowerLimit(j);
+      if (range != 0.0 && isNumberValid(range))
+        for (size_t i = 0; i < n; ++i)
+          points[i * numObjectives + j] /= fabs(range);
+    }
+
+    // SPEA2 truncation: remove the solution that is the closest to its nearest neighbours
+    PointKDTree tree(&points[0], n, numObjectives);
+    size_t numNeighbours = std::min(n - 1, (size_t)3);
+    std::vector<double> distances, worstDistances;
+    size_t worst = 0;
+    for (size_t i = 0; i < n; ++i)
     {
-      double d = 0.0;
-      for (size_t j = 0; j < fitness->getNumValues(); ++j)
-        d += fabs((getFitness(i+1)->getValue(j) - getFitness(i-1)->getValue(j)) / (limits->getUpperLimit(j) - limits->getLowerLimit(j)));
-      if (d < worstDistance)
+      tree.findNearestNeighbourDistances(i, numNeighbours, distances);
+      if (i == 0 || std::lexicographical_compare(distances.begin(), distances.end(), worstDistances.begin(), worstDistances.end()))
       {
         worst = i;
-        worstDistance = d;
+        worstDistances.swap(distances);
       }
     }
-    solutions.erase(solutions.begin() + worst);
+    removeSolution(worst);
   }
 }
@@ -18,18 +18,30 @@ namespace lbcpp
 class BeamNRPASolver : public NRPASolver
 {
 public:
-  BeamNRPASolver(SamplerPtr sampler, size_t level, size_t numIterationsPerLevel, size_t beamSizeAtFirstLevel, size_t beamSizeAtHigherLevels)
-    : NRPASolver(sampler, level, numIterationsPerLevel), beamSizeAtFirstLevel(beamSizeAtFirstLevel), beamSizeAtHigherLevels(beamSizeAtHigherLevels) {}
-  BeamNRPASolver() : beamSizeAtFirstLevel(0), beamSizeAtHigherLevels(0) {}
+  /** If parallelSubSearches is true, the sub-searches started from the elements of the top-level beam run in parallel, as work units
+   *  of the context. Their solutions are sent to the callback in the order of the beam, so that the search does not depend on the number of threads.
+   */
+  BeamNRPASolver(SamplerPtr sampler, size_t level, size_t numIterationsPerLevel, size_t beamSizeAtFirstLevel, size_t beamSizeAtHigherLevels, bool parallelSubSearches = false)
+    : NRPASolver(sampler, level, numIterationsPerLevel), beamSizeAtFirstLevel(beamSizeAtFirstLevel), beamSizeAtHigherLevels(beamSizeAtHigherLevels), parallelSubSearches(parallelSubSearches) {}
+  BeamNRPASolver() : beamSizeAtFirstLevel(0), beamSizeAtHigherLevels(0), parallelSubSearches(false) {}
   
   virtual void runSolver(ExecutionContext& context)
     {solveRecursively(context, sampler, level);}
 
+  virtual void stopSolver(ExecutionContext& context)
+  {
+    currentBeam.clear();
+    subBeams.clear();
+    subBeamEvaluations.clear();
+    NRPASolver::stopSolver(context);
+  }
+
 protected:
   friend class BeamNRPASolverClass;
 
   size_t beamSizeAtFirstLevel;
   size_t beamSizeAtHigherLevels;
+  bool parallelSubSearches;
   
   struct Element
   {
@@ -53,30 +65,43 @@ protected:
 
   typedef std::vector<Element> Beam;
 
-  Beam solveRecursively(ExecutionContext& context, SamplerPtr sampler, size_t level)
+  // workers of the parallel sub-searches
+  Beam currentBeam;
+  std::vector<Beam> subBeams;
+  std::vector<SolutionAndFitnessVector> subBeamEvaluations;
+
+  virtual void runWorker(ExecutionContext& context, size_t index)
+    {subBeams[index] = solveRecursively(context, currentBeam[index].sampler, level - 1, &subBeamEvaluations[index]);}
+
+  // see NRPASolver::solveRecursively() for the evaluations argument
+  Beam solveRecursively(ExecutionContext& context, SamplerPtr sampler, size_t level, SolutionAndFitnessVector* evaluations = NULL)
   {
-    if (callback->shouldStop())
+    if (!evaluations && callback->shouldStop())
       return Beam();
       
     if (level == 0)
     {
       ObjectPtr solution = sampler->sample(context);
-      FitnessPtr fitness = evaluate(context, solution);
+      FitnessPtr fitness = evaluateRollout(context, solution, evaluations);
       return Beam(1, Element(solution, fitness, sampler));
     }
     else
     {
       Beam beam(1, Element(ObjectPtr(), problem->getFitnessLimits()->getWorstPossibleFitness(true), sampler));
       size_t beamSize = level > 1 ? beamSizeAtHigherLevels : beamSizeAtFirstLevel;
+      bool parallel = parallelSubSearches && !evaluations && level == this->level;
 
       for (size_t i = 0; i < numIterationsPerLevel; ++i)
       {
+        if (parallel && !runParallelSubSearches(context, beam))
+          break;
+
         Beam newBeam;
         for (size_t j = 0; j < beam.size(); ++j)
         {
           Element& element = beam[j];
           newBeam.push_back(element);
-          Beam beam1 = solveRecursively(context, element.sampler, level - 1);
+          Beam beam1 = parallel ? subBeams[j] : solveRecursively(context, element.sampler, level - 1, evaluations);
           for (size_t k = 0; k < beam1.size(); ++k)
             if (beam1[k].solution) // may be null if "callback->shouldStop()"
             {
@@ -87,13 +112,29 @@ protected:
         }
         
         beam = beamSize < newBeam.size() ? selectNBests(newBeam, beamSize) : newBeam;
-        if (callback->shouldStop())
+        if (!evaluations && callback->shouldStop())
           break;
       }
       return beam;
     }
   }
 
+  // runs the sub-searches of the elements of the beam in parallel and sends their solutions to the callback
+  // returns false if the callback asked to stop
+  bool runParallelSubSearches(ExecutionContext& context, const Beam& beam)
+  {
+    currentBeam = beam;
+    subBeams.clear();
+    subBeams.resize(beam.size());
+    subBeamEvaluations.clear();
+    subBeamEvaluations.resize(beam.size());
+    runWorkers(context, beam.size(), T("Beam NRPA sub-searches"));
+    for (size_t i = 0; i < subBeamEvaluations.size(); ++i)
+      if (!addEvaluations(context, subBeamEvaluations[i]))
+        return false;
+    return true;
+  }
+
   Beam selectNBests(const Beam& beam, size_t count) const
   {
     jassert(count <= beam.size());
@@ -11,10 +11,27 @@
 
 # include <ml/Solver.h>
 # include <ml/Sampler.h>
+# include <oil/Execution/WorkUnit.h>
 
 namespace lbcpp
 {
 
+class NRPASolver;
+
+class NRPAWorkerWorkUnit : public WorkUnit
+{
+public:
+  NRPAWorkerWorkUnit(NRPASolver* solver, size_t index, juce::uint32 seed)
+    : solver(solver), index(index), seed(seed) {}
+
+  virtual ObjectPtr run(ExecutionContext& context);
+
+private:
+  NRPASolver* solver;
+  size_t index;
+  juce::uint32 seed;
+};
+
 class NRPASolver : public Solver
 {
 public:
@@ -33,20 +50,25 @@ public:
 
 protected:
   friend class NRPASolverClass;
+  friend class NRPAWorkerWorkUnit;
 
   SamplerPtr sampler;
   size_t level;
   size_t numIterationsPerLevel;
 
-  SolutionAndFitnessPair solveRecursively(ExecutionContext& context, SamplerPtr sampler, size_t level)
+  typedef std::vector<SolutionAndFitnessPair> SolutionAndFitnessVector;
+
+  // if evaluations is not null, the search is made by a worker: the rollouts are not sent to the callback
+  // but recorded into evaluations, and the stopping criterion is not checked
+  SolutionAndFitnessPair solveRecursively(ExecutionContext& context, SamplerPtr sampler, size_t level, SolutionAndFitnessVector* evaluations = NULL)
   {
-    if (callback->shouldStop())
+    if (!evaluations && callback->shouldStop())
       return SolutionAndFitnessPair();
       
     if (level == 0)
     {
       ObjectPtr solution = sampler->sample(context);
-      return SolutionAndFitnessPair(solution, evaluate(context, solution));
+      return SolutionAndFitnessPair(solution, evaluateRollout(context, solution, evaluations));
     }
     else
     {
@@ -57,7 +79,7 @@ protected:
       bool isTopLevel = (this->level == level);
       for (size_t i = 0; isTopLevel || i < numIterationsPerLevel; ++i)
       {
-        SolutionAndFitnessPair subResult = solveRecursively(context, currentSampler, level - 1);
+        SolutionAndFitnessPair subResult = solveRecursively(context, currentSampler, level - 1, evaluations);
         if (subResult.second && subResult.second->dominates(bestFitness))
         {
           bestSolution = subResult.first;
@@ -77,8 +99,57 @@ protected:
       return std::make_pair(bestSolution, bestFitness);
     }
   }
+
+  FitnessPtr evaluateRollout(ExecutionContext& context, const ObjectPtr& solution, SolutionAndFitnessVector* evaluations)
+  {
+    if (!evaluations)
+      return evaluate(context, solution);
+    FitnessPtr res = problem->evaluate(context, solution);
+    evaluations->push_back(std::make_pair(solution, res));
+    return res;
+  }
+
+  /*
+  ** Parallel searches
+  */
+  virtual void runWorker(ExecutionContext& context, size_t index)
+    {jassertfalse;}
+
+  // runs runWorker() for each index as work units of the context. Each worker has its own random generator, seeded
+  // from the random generator of the context and the index of the worker, so that the results do not depend on the number of threads
+  void runWorkers(ExecutionContext& context, size_t numWorkers, const string& description)
+  {
+    juce::uint32 baseSeed = context.getRandomGenerator()->sampleUint32();
+    CompositeWorkUnitPtr workUnits = new CompositeWorkUnit(description, numWorkers);
+    for (size_t i = 0; i < numWorkers; ++i)
+      workUnits->setWorkUnit(i, new NRPAWorkerWorkUnit(this, i, baseSeed ^ (juce::uint32)((i + 1) * 2654435761u)));
+    workUnits->setProgressionUnit(T("Workers"));
+    context.run(workUnits, false);
+  }
+
+  // sends the evaluations recorded by a worker to the callback, in order, until it asks to stop
+  // returns false if the callback asked to stop
+  bool addEvaluations(ExecutionContext& context, const SolutionAndFitnessVector& evaluations)
+  {
+    for (size_t i = 0; i < evaluations.size(); ++i)
+    {
+      if (callback->shouldStop())
+        return false;
+      addSolution(context, evaluations[i].first, evaluations[i].second);
+    }
+    return !callback->shouldStop();
+  }
 };
 
+inline ObjectPtr NRPAWorkerWorkUnit::run(ExecutionContext& context)
+{
+  RandomGeneratorPtr previousRandom = context.getRandomGenerator();
+  context.setRandomGenerator(new RandomGenerator(seed));
+  solver->runWorker(context, index);
+  context.setRandomGenerator(previousRandom);
+  return ObjectPtr();
+}
+
 }; /* namespace lbcpp */
 
 #endif // !ML_SOLVER_NRPA_H_
@@ -0,0 +1,175 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ParallelNRPASolver.h           | Parallel Nested Rollout Policy  |
+| Author  : Francis Maes                   | Adaptation Solver               |
+| Started : 16/10/2026 10:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef ML_SOLVER_PARALLEL_NRPA_H_
+# define ML_SOLVER_PARALLEL_NRPA_H_
+
+# include "NRPASolver.h"
+
+namespace lbcpp
+{
+
+/*
+** Runs the top level of NRPA with numWorkers workers, as work units of the execution context.
+**
+** Root parallelism: each worker runs its own top-level search, with its own policy. Every
+** synchronisationPeriod top-level iterations, the workers stop, and those whose best sequence is
+** dominated by the best sequence found so far take this sequence and the policy of its worker.
+**
+** Leaf parallelism: there is a single top-level search, each of its iterations runs numWorkers
+** level-1 sub-searches in parallel and adapts the policy towards the best sequence found so far.
+**
+** The solutions evaluated by the workers are sent to the callback when they stop, in the order of
+** the workers, so that the search does not depend on the number of threads. The workers do not
+** check the stopping criterion, hence the evaluations made after it is met are lost.
+*/
+class ParallelNRPASolver : public NRPASolver
+{
+public:
+  ParallelNRPASolver(SamplerPtr sampler, size_t level, size_t numIterationsPerLevel, size_t numWorkers, size_t synchronisationPeriod, bool leafParallelism)
+    : NRPASolver(sampler, level, numIterationsPerLevel), numWorkers(numWorkers), synchronisationPeriod(synchronisationPeriod), leafParallelism(leafParallelism) {}
+  ParallelNRPASolver() : numWorkers(0), synchronisationPeriod(1), leafParallelism(false) {}
+
+  virtual void runSolver(ExecutionContext& context)
+  {
+    if (level == 0)
+      NRPASolver::runSolver(context);
+    else if (leafParallelism)
+      runLeafParallelSearch(context);
+    else
+      runRootParallelSearch(context);
+  }
+
+  virtual void stopSolver(ExecutionContext& context)
+  {
+    workers.clear();
+    currentSampler = SamplerPtr();
+    NRPASolver::stopSolver(context);
+  }
+
+protected:
+  friend class ParallelNRPASolverClass;
+
+  size_t numWorkers;
+  size_t synchronisationPeriod;
+  bool leafParallelism;
+
+  struct Worker
+  {
+    SamplerPtr sampler;
+    ObjectPtr bestSolution;
+    FitnessPtr bestFitness;
+    SolutionAndFitnessVector evaluations;
+  };
+  std::vector<Worker> workers;
+  SamplerPtr currentSampler; // policy of the top-level search in leaf parallelism
+
+  virtual void runWorker(ExecutionContext& context, size_t index)
+  {
+    Worker& worker = workers[index];
+    if (leafParallelism)
+    {
+      SolutionAndFitnessPair subResult = solveRecursively(context, worker.sampler, level - 1, &worker.evaluations);
+      worker.bestSolution = subResult.first;
+      worker.bestFitness = subResult.second;
+      return;
+    }
+
+    for (size_t i = 0; i < synchronisationPeriod && !worker.sampler->isDeterministic(); ++i)
+    {
+      SolutionAndFitnessPair subResult = solveRecursively(context, worker.sampler, level - 1, &worker.evaluations);
+      if (subResult.second && subResult.second->dominates(worker.bestFitness))
+      {
+        worker.bestSolution = subResult.first;
+        worker.bestFitness = subResult.second;
+      }
+      if (worker.bestSolution)
+        worker.sampler->reinforce(context, worker.bestSolution, 1.0);
+    }
+  }
+
+  void runRootParallelSearch(ExecutionContext& context)
+  {
+    workers.clear();
+    workers.resize(numWorkers ? numWorkers : 1);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+      workers[i].sampler = sampler->cloneAndCast<Sampler>();
+      workers[i].bestFitness = problem->getFitnessLimits()->getWorstPossibleFitness(true);
+    }
+
+    while (!callback->shouldStop())
+    {
+      runWorkers(context, workers.size(), T("NRPA workers"));
+
+      size_t numEvaluations = 0;
+      size_t bestWorker = 0;
+      for (size_t i = 0; i < workers.size(); ++i)
+      {
+        numEvaluations += workers[i].evaluations.size();
+        if (!addEvaluations(context, workers[i].evaluations))
+          return;
+        workers[i].evaluations.clear();
+        if (workers[i].bestFitness->strictlyDominates(workers[bestWorker].bestFitness))
+          bestWorker = i;
+      }
+      if (!numEvaluations)
+        break; // all the policies have converged
+
+      // synchronisation
+      const Worker& best = workers[bestWorker];
+      for (size_t i = 0; i < workers.size(); ++i)
+        if (i != bestWorker && best.bestFitness->strictlyDominates(workers[i].bestFitness))
+        {
+          workers[i].bestSolution = best.bestSolution;
+          workers[i].bestFitness = best.bestFitness;
+          workers[i].sampler = best.sampler->cloneAndCast<Sampler>();
+        }
+    }
+  }
+
+  void runLeafParallelSearch(ExecutionContext& context)
+  {
+    workers.clear();
+    workers.resize(numWorkers ? numWorkers : 1);
+    currentSampler = sampler->cloneAndCast<Sampler>();
+    ObjectPtr bestSolution;
+    FitnessPtr bestFitness = problem->getFitnessLimits()->getWorstPossibleFitness(true);
+
+    while (!callback->shouldStop())
+    {
+      for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].sampler = currentSampler->cloneAndCast<Sampler>(); // samplers may not be used by several threads at the same time
+      runWorkers(context, workers.size(), T("NRPA sub-searches"));
+
+      for (size_t i = 0; i < workers.size(); ++i)
+      {
+        Worker& worker = workers[i];
+        if (!addEvaluations(context, worker.evaluations))
+          return;
+        worker.evaluations.clear();
+        if (worker.bestFitness && worker.bestFitness->dominates(bestFitness))
+        {
+          bestSolution = worker.bestSolution;
+          bestFitness = worker.bestFitness;
+        }
+      }
+
+      if (bestSolution)
+      {
+        currentSampler->reinforce(context, bestSolution, 1.0);
+        if (currentSampler->isDeterministic())
+          break;
+      }
+    }
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !ML_SOLVER_PARALLEL_NRPA_H_
@@ -9,8 +9,45 @@
 #include <ml/Solver.h>
 #include <ml/SolutionContainer.h>
 #include <ml/Sampler.h>
+#include <oil/Execution/WorkUnit.h>
 using namespace lbcpp;
 
+namespace lbcpp
+{
+
+class EvaluateSolutionBatchWorkUnit : public WorkUnit
+{
+public:
+  EvaluateSolutionBatchWorkUnit(const ProblemPtr& problem, const std::vector<ObjectPtr>& objects, size_t begin, size_t end, juce::uint32 seed, double cutoff, std::vector<FitnessPtr>& fitnesses)
+    : problem(problem), objects(objects), begin(begin), end(end), seed(seed), cutoff(cutoff), fitnesses(fitnesses) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr previousRandom = context.getRandomGenerator();
+    context.setRandomGenerator(new RandomGenerator(seed));
+
+    std::vector<ObjectPtr> batch(objects.begin() + begin, objects.begin() + end);
+    std::vector<FitnessPtr> res;
+    problem->evaluateBatch(context, batch, res, cutoff);
+    jassert(res.size() == batch.size());
+    for (size_t i = 0; i < res.size(); ++i)
+      fitnesses[begin + i] = res[i]; // each work unit writes its own range
+
+    context.setRandomGenerator(previousRandom);
+    return ObjectPtr();
+  }
+
+private:
+  ProblemPtr problem;
+  const std::vector<ObjectPtr>& objects;
+  size_t begin, end;
+  juce::uint32 seed;
+  double cutoff;
+  std::vector<FitnessPtr>& fitnesses;
+};
+
+}; /* namespace lbcpp */
+
 /*
 ** Solver
 */
@@ -45,7 +82,7 @@ void Solver::addSolution(ExecutionContext& context, const ObjectPtr& object, con
   for (size_t i = 0; i < fitness->getNumValues(); ++i)
     jassert(isNumberValid(fitness->getValue(i)));
   jassert(fitness->getNumValues() == problem->getFitnessLimits()->getNumDimensions());
-  callback->solutionEvaluated(context, refCountedPointerFromThis(this), object, fitness);
+  callback->solutionEvaluated(context, borrowedPointerFromThis(this), object, fitness);
 }
 
 FitnessPtr Solver::evaluate(ExecutionContext& context, const ObjectPtr& object)
@@ -56,6 +93,56 @@ FitnessPtr Solver::evaluate(ExecutionContext& context, const ObjectPtr& object)
   return fitness;
 }
 
+size_t Solver::evaluateSolutions(ExecutionContext& context, const std::vector<ObjectPtr>& objects, std::vector<FitnessPtr>& fitnesses, size_t batchSize, double cutoff)
+{
+  jassert(problem && callback);
+  fitnesses.clear();
+  fitnesses.resize(objects.size());
+  if (objects.empty() || callback->shouldStop())
+    return 0;
+
+  // do not launch the evaluation of solutions that the callback would refuse
+  size_t n = std::min((size_t)objects.size(), callback->getNumRemainingEvaluations());
+  if (!n)
+    return 0;
+  if (!batchSize)
+    batchSize = defaultEvaluationBatchSize;
+  size_t numBatches = (n + batchSize - 1) / batchSize;
+  if (numBatches == 1)
+  {
+    // a single batch is evaluated in place and keeps drawing from the context random generator
+    std::vector<FitnessPtr> res;
+    if (n == objects.size())
+      problem->evaluateBatch(context, objects, res, cutoff);
+    else
+      problem->evaluateBatch(context, std::vector<ObjectPtr>(objects.begin(), objects.begin() + n), res, cutoff);
+    jassert(res.size() == n);
+    std::copy(res.begin(), res.end(), fitnesses.begin());
+  }
+  else
+  {
+    juce::uint32 baseSeed = context.getRandomGenerator()->sampleUint32();
+    CompositeWorkUnitPtr workUnits = new CompositeWorkUnit(T("Evaluate ") + string((int)n) + T(" solutions"), numBatches);
+    for (size_t i = 0; i < numBatches; ++i)
+    {
+      size_t begin = i * batchSize;
+      size_t end = begin + batchSize < n ? begin + batchSize : n;
+      juce::uint32 seed = baseSeed ^ (juce::uint32)((begin + 1) * 2654435761u); // decorrelate the streams of neighbouring batches
+      workUnits->setWorkUnit(i, new EvaluateSolutionBatchWorkUnit(problem, objects, begin, end, seed, cutoff, fitnesses));
+    }
+    workUnits->setProgressionUnit(T("Batches"));
+    context.run(workUnits, false);
+  }
+
+  // notify the callback sequentially, so that stopping criteria see the same sequence of solutions whatever the number of threads
+  size_t res = 0;
+  for (; res < n && !callback->shouldStop(); ++res)
+    addSolution(context, objects[res], fitnesses[res]);
+  for (size_t i = res; i < n; ++i)
+    fitnesses[i] = FitnessPtr();
+  return res;
+}
+
 /*
 ** IterativeSolver
 */
@@ -119,25 +206,42 @@ void IterativeSolver::runSolver(ExecutionContext& context)
 /*
 ** PopulationBasedSolver
 */
+
 SolutionVectorPtr PopulationBasedSolver::sampleAndEvaluatePopulation(ExecutionContext& context, SamplerPtr sampler, size_t populationSize)
 {
   SolutionVectorPtr res = new SolutionVector(problem->getFitnessLimits());
-  for (size_t i = 0; i < populationSize && !callback->shouldStop(); ++i)
-  {
-    ObjectPtr solution = problem->getDomain()->projectIntoDomain(sampler->sample(context));
-    FitnessPtr fitness = evaluate(context, solution);
-    res->insertSolution(solution, fitness);
-  }
+  if (callback->shouldStop())
+    return res;
+
+  std::vector<ObjectPtr> solutions(populationSize);
+  for (size_t i = 0; i < populationSize; ++i)
+    solutions[i] = problem->getDomain()->projectIntoDomain(sampler->sample(context));
+
+  std::vector<FitnessPtr> fitnesses;
+  size_t numEvaluated = evaluatePopulation(context, solutions, fitnesses);
+  res->reserve(numEvaluated);
+  for (size_t i = 0; i < numEvaluated; ++i)
+    res->insertSolution(solutions[i], fitnesses[i]);
   jassert(res->getNumSolutions() <= populationSize);
   return res;
 }
 
-void PopulationBasedSolver::computeMissingFitnesses(ExecutionContext& context, const SolutionVectorPtr& population)
+void PopulationBasedSolver::computeMissingFitnesses(ExecutionContext& context, const SolutionVectorPtr& population, double cutoff)
 {
   size_t n = population->getNumSolutions();
-  for (size_t i = 0; i < n && !callback->shouldStop(); ++i)
+  std::vector<size_t> indices;
+  std::vector<ObjectPtr> solutions;
+  for (size_t i = 0; i < n; ++i)
     if (!population->getFitness(i))
-      population->setFitness(i, evaluate(context, population->getSolution(i)));
+    {
+      indices.push_back(i);
+      solutions.push_back(population->getSolution(i));
+    }
+
+  std::vector<FitnessPtr> fitnesses;
+  size_t numEvaluated = evaluatePopulation(context, solutions, fitnesses, cutoff);
+  for (size_t i = 0; i < numEvaluated; ++i)
+    population->setFitness(indices[i], fitnesses[i]);
 }
 
 void PopulationBasedSolver::learnSampler(ExecutionContext& context, SolutionVectorPtr solutions, SamplerPtr sampler)
@@ -31,7 +31,7 @@ public:
       callbacks[i]->solverStarted(context, solver);
   }
 
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     for (size_t i = 0; i < callbacks.size(); ++i)
       callbacks[i]->solutionEvaluated(context, solver, object, fitness);
@@ -51,6 +51,14 @@ public:
     return false;
   }
 
+  virtual size_t getNumRemainingEvaluations()
+  {
+    size_t res = (size_t)-1;
+    for (size_t i = 0; i < callbacks.size(); ++i)
+      res = std::min(res, callbacks[i]->getNumRemainingEvaluations());
+    return res;
+  }
+
 protected:
   friend class CompositeSolverCallbackClass;
 
@@ -63,7 +71,7 @@ public:
   StoreBestFitnessSolverCallback(FitnessPtr& bestFitness) : res(bestFitness) {}
   StoreBestFitnessSolverCallback() : res(*(FitnessPtr* )0) {}
 
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     if (!res || fitness->strictlyDominates(res))
       res = fitness;
@@ -79,7 +87,7 @@ public:
   StoreBestSolutionSolverCallback(ObjectPtr& bestSolution) : res(bestSolution) {}
   StoreBestSolutionSolverCallback() : res(*(ObjectPtr* )0) {}
 
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     if (!bestFitness || fitness->strictlyDominates(bestFitness))
     {
@@ -99,7 +107,7 @@ public:
   StoreBestSolverCallback(ObjectPtr& bestSolution, FitnessPtr& bestFitness) : bestSolution(bestSolution), bestFitness(bestFitness) {}
   StoreBestSolverCallback() : bestSolution(*(ObjectPtr* )0), bestFitness(*(FitnessPtr* )0) {}
 
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     if (!bestFitness || fitness->strictlyDominates(bestFitness))
     {
@@ -119,7 +127,7 @@ public:
   FillParetoFrontSolverCallback(ParetoFrontPtr front = ParetoFrontPtr())
     : front(front) {}
 
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
     {front->insertSolution(object, fitness);}
   
   virtual void solverStopped(ExecutionContext& context, SolverPtr solver)
@@ -143,12 +151,15 @@ public:
   virtual void solverStarted(ExecutionContext& context, SolverPtr solver)
     {numEvaluations = 0;}
 
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
     {++numEvaluations;}
 
   virtual bool shouldStop()
     {return numEvaluations >= maxEvaluations;}
 
+  virtual size_t getNumRemainingEvaluations()
+    {return numEvaluations < maxEvaluations ? maxEvaluations - numEvaluations : 0;}
+
 protected:
   friend class MaxEvaluationsSolverCallbackClass;
 
@@ -166,7 +177,7 @@ public:
   virtual void solverStarted(ExecutionContext& context, SolverPtr solver)
     {startTime = Time::getHighResolutionCounter(); numEvaluations = 0;}
   
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness) = 0;
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness) = 0;
 
 protected:
   friend class EvaluatorSolverCallbackClass;
@@ -199,7 +210,7 @@ public:
     : EvaluatorSolverCallback(solverEvaluator, evaluations, cpuTimes, scores), evaluationPeriod(evaluationPeriod) {}
   EvaluationPeriodEvaluatorSolverCallback() : EvaluatorSolverCallback(), evaluationPeriod(0) {}
   
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     ++numEvaluations;
     if (numEvaluations % evaluationPeriod == 0)
@@ -226,7 +237,7 @@ public:
     EvaluatorSolverCallback::solverStarted(context, solver);
   }
   
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     ++numEvaluations;
     double curTime = Time::getHighResolutionCounter();
@@ -260,7 +271,7 @@ public:
   AggregatorEvaluatorSolverCallback() : evaluators(std::vector<SolverEvaluatorPtr>()), data(0), evaluationPeriod(1) {}
   virtual void solverStarted(ExecutionContext& context, SolverPtr solver)
     { i = 0; numEvaluations = 0;}
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     ++numEvaluations;
     if (numEvaluations % evaluationPeriod == 0)
@@ -291,7 +302,7 @@ public:
     : TimePeriodEvaluatorSolverCallback(solverEvaluator, evaluations, cpuTimes, scores, evaluationPeriod), factor(factor) {}
   LogTimePeriodEvaluatorSolverCallback() : TimePeriodEvaluatorSolverCallback(), factor(0.0) {}
   
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     ++numEvaluations;
     double curTime = Time::getHighResolutionCounter();
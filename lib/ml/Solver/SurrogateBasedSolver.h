@@ -22,6 +22,17 @@
 namespace lbcpp
 {
 
+/** Fitness assumed for the pending candidates of a batch, see SurrogateBasedSolver::setNumCandidatesPerIteration().
+ *  krigingBelieverLiar uses the prediction of the surrogate model, the constant liars
+ *  use the best or the worst fitness observed so far.
+ */
+enum SurrogateLiarStrategy
+{
+  krigingBelieverLiar = 0,
+  optimisticConstantLiar,
+  pessimisticConstantLiar
+};
+
 /** Class for surrogate-based optimization.
  *  In this class, the initial sampler should return an OVector with all \f$N\f$ initial samples
  *  as a result of its sample() function. The initial sample will be retrieved upon calling
@@ -33,8 +44,16 @@ public:
   SurrogateBasedSolver(SamplerPtr initialVectorSampler, SolverPtr surrogateSolver,
                        VariableEncoderPtr variableEncoder, SelectionCriterionPtr selectionCriterion, size_t numIterations)
     : IterativeSolver(numIterations), initialVectorSampler(initialVectorSampler), surrogateSolver(surrogateSolver),
-      variableEncoder(variableEncoder), selectionCriterion(selectionCriterion) {}
-  SurrogateBasedSolver() {}
+      variableEncoder(variableEncoder), selectionCriterion(selectionCriterion), numCandidatesPerIteration(1), liarStrategy(krigingBelieverLiar) {}
+  SurrogateBasedSolver() : numCandidatesPerIteration(1), liarStrategy(krigingBelieverLiar) {}
+
+  /** Number of candidates proposed after the initial samples at each iteration.
+   *  The candidates are selected one after the other: each selected candidate is added to the surrogate data
+   *  with a fitness given by the liar strategy and the surrogate model is learned again before selecting the
+   *  next one. The candidates are then evaluated in parallel and their true fitnesses replace the lies.
+   */
+  void setNumCandidatesPerIteration(size_t numCandidatesPerIteration, SurrogateLiarStrategy liarStrategy = krigingBelieverLiar)
+    {jassert(numCandidatesPerIteration > 0); this->numCandidatesPerIteration = numCandidatesPerIteration; this->liarStrategy = liarStrategy;}
 
   virtual void startSolver(ExecutionContext& context, ProblemPtr problem, SolverCallbackPtr callback, ObjectPtr startingSolution)
   {
@@ -57,10 +76,14 @@ public:
 
     // information
     lastInformation = SurrogateBasedSolverInformationPtr();
+    observedFitnesses.clear();
   }
 
   virtual bool iterateSolver(ExecutionContext& context, size_t iter)
   {
+    if (numCandidatesPerIteration > 1 && iter >= initialSamples->getNumElements())
+      return iterateSolverWithCandidatesBatch(context, iter);
+
     ObjectPtr object;
     FitnessPtr fitness;
     ExpressionPtr surrogateModel;
@@ -129,7 +152,7 @@ public:
       context.resultCallback("trainTime", trainTime);
       context.resultCallback("optimizerTime", optimizerTime);
     }
-    addFitnessSample(context, object, fitness);
+    addObservedFitnessSample(context, object, fitness);
     return true;
   }
 
@@ -137,18 +160,148 @@ protected:
   virtual ExpressionPtr getSurrogateModel(ExecutionContext& context) = 0;
   virtual void addFitnessSample(ExecutionContext& context, ObjectPtr object, FitnessPtr fitness) = 0;
 
+  // the fitness samples added between these two calls are removed by restoreSurrogateState()
+  virtual void saveSurrogateState(ExecutionContext& context) = 0;
+  virtual void restoreSurrogateState(ExecutionContext& context) = 0;
+
   friend class SurrogateBasedSolverClass;
 
   SamplerPtr initialVectorSampler;
   SolverPtr surrogateSolver;
   VariableEncoderPtr variableEncoder;
   SelectionCriterionPtr selectionCriterion;
+  size_t numCandidatesPerIteration;
+  SurrogateLiarStrategy liarStrategy;
   
   OVectorPtr initialSamples;
   ClassPtr fitnessClass;
 
   SurrogateBasedSolverInformationPtr lastInformation;
   TablePtr surrogateData;
+  std::vector<FitnessPtr> observedFitnesses;
+
+  void addObservedFitnessSample(ExecutionContext& context, ObjectPtr object, FitnessPtr fitness)
+  {
+    observedFitnesses.push_back(fitness);
+    addFitnessSample(context, object, fitness);
+  }
+
+  bool iterateSolverWithCandidatesBatch(ExecutionContext& context, size_t iter)
+  {
+    // select the candidates, pretending that the previous ones have been evaluated
+    std::vector<ObjectPtr> candidates;
+    ExpressionPtr surrogateModel;
+    size_t retryCounter = 0;
+    double trainTime = 0.0, optimizerTime = 0.0;
+    saveSurrogateState(context);
+    for (size_t i = 0; i < numCandidatesPerIteration; ++i)
+    {
+      if (verbosity >= verbosityDetailed)
+        context.enterScope("Select candidate " + string((int)i + 1));
+      double time = Time::getHighResolutionCounter();
+      surrogateModel = getSurrogateModel(context);
+      trainTime += Time::getHighResolutionCounter() - time;
+
+      time = Time::getHighResolutionCounter();
+      ObjectPtr object;
+      size_t counter = 0;
+      do
+      {
+        if (counter < 10)
+          object = optimizeSurrogate(context, surrogateModel);
+        else
+          object = initialVectorSampler->sample(context).staticCast<OVector>()->get(context.getRandomGenerator()->sampleSize(initialSamples->getNumElements()));
+        ++counter;
+      } while (objectExists(object.staticCast<DenseDoubleVector>()));
+      optimizerTime += Time::getHighResolutionCounter() - time;
+      retryCounter += counter;
+      candidates.push_back(object);
+
+      if (i < numCandidatesPerIteration - 1)
+        addFitnessSample(context, object, makeLie(context, surrogateModel, object));
+      if (verbosity >= verbosityDetailed)
+      {
+        context.resultCallback("object", object);
+        context.leaveScope();
+      }
+    }
+    restoreSurrogateState(context);
+
+    // evaluate the candidates in parallel and add them all to the surrogate data
+    std::vector<FitnessPtr> fitnesses;
+    size_t numEvaluated = evaluateSolutions(context, candidates, fitnesses);
+
+    if (verbosity == verbosityAll)
+    {
+      SurrogateBasedSolverInformationPtr information(new SurrogateBasedSolverInformation(iter + 1));
+      information->setProblem(problem);
+      if (lastInformation)
+        information->setSolutions(lastInformation->getSolutions());
+      else
+        information->setSolutions(new SolutionVector(problem->getFitnessLimits()));
+      for (size_t i = 0; i < numEvaluated; ++i)
+        information->getSolutions()->insertSolution(candidates[i], fitnesses[i]);
+      information->setSurrogateModel(surrogateModel ? surrogateModel->cloneAndCast<Expression>() : ExpressionPtr());
+      context.resultCallback("information", information);
+      lastInformation = information;
+    }
+
+    if (verbosity >= verbosityDetailed)
+    {
+      context.resultCallback("inner optimizer runs", retryCounter);
+      context.resultCallback("numEvaluated", numEvaluated);
+      context.resultCallback("trainTime", trainTime);
+      context.resultCallback("optimizerTime", optimizerTime);
+    }
+    for (size_t i = 0; i < numEvaluated; ++i)
+      addObservedFitnessSample(context, candidates[i], fitnesses[i]);
+    return true;
+  }
+
+  FitnessPtr makeLie(ExecutionContext& context, ExpressionPtr surrogateModel, ObjectPtr object) const
+  {
+    FitnessLimitsPtr limits = problem->getFitnessLimits();
+    size_t numObjectives = problem->getNumObjectives();
+    std::vector<double> values(numObjectives);
+    if (liarStrategy == krigingBelieverLiar)
+    {
+      ObjectPtr prediction;
+      if (surrogateModel)
+      {
+        std::vector<ObjectPtr> row;
+        variableEncoder->encodeIntoVariables(context, object, row);
+        prediction = surrogateModel->compute(context, row);
+      }
+      if (prediction)
+      {
+        if (numObjectives == 1)
+          values[0] = prediction->toDouble();
+        else
+        {
+          DenseDoubleVectorPtr predictions = prediction.staticCast<DenseDoubleVector>();
+          for (size_t i = 0; i < numObjectives; ++i)
+            values[i] = predictions->getValue(i);
+        }
+        return new Fitness(values, limits);
+      }
+      // no prediction (e.g. the model could not be learned yet): fall back to the pessimistic constant liar
+    }
+    if (observedFitnesses.empty())
+      return limits->getWorstPossibleFitness();
+    for (size_t i = 0; i < numObjectives; ++i)
+    {
+      bool takeMax = (liarStrategy == optimisticConstantLiar) == limits->shouldObjectiveBeMaximised(i);
+      double value = observedFitnesses[0]->getValue(i);
+      for (size_t j = 1; j < observedFitnesses.size(); ++j)
+      {
+        double v = observedFitnesses[j]->getValue(i);
+        if (takeMax ? v > value : v < value)
+          value = v;
+      }
+      values[i] = value;
+    }
+    return new Fitness(values, limits);
+  }
   
   struct SurrogateBasedSelectionObjective : public Objective
   {
@@ -251,22 +404,36 @@ public:
   virtual void addFitnessSample(ExecutionContext& context, ObjectPtr object, FitnessPtr fitness)
     {surrogateLearner->addTrainingSample(context, makeTrainingSample(context, object, fitness), surrogateModel);}
 
+  virtual void saveSurrogateState(ExecutionContext& context)
+    {savedSurrogateModel = surrogateModel; surrogateModel = surrogateModel->deepClone(context).staticCast<Expression>();}
+
+  virtual void restoreSurrogateState(ExecutionContext& context)
+    {surrogateModel = savedSurrogateModel; savedSurrogateModel = ExpressionPtr();}
+
 protected:
   friend class IncrementalSurrogateBasedSolverClass;
 
   IncrementalLearnerPtr surrogateLearner;
   ExpressionPtr surrogateModel;
+  ExpressionPtr savedSurrogateModel;
 };
 
+/** Surrogate-based solver that learns the surrogate model on all the samples at each iteration.
+ *  With warm start, the previous surrogate model is given as starting solution to the surrogate learner,
+ *  which may update it instead of learning from scratch (see EnsembleLearner and SharkGaussianProcessLearner).
+ */
 class BatchSurrogateBasedSolver : public SurrogateBasedSolver
 {
 public:
   BatchSurrogateBasedSolver(SamplerPtr initialVectorSampler, SolverPtr surrogateLearner, SolverPtr surrogateSolver,
                        VariableEncoderPtr variableEncoder, SelectionCriterionPtr selectionCriterion, size_t numIterations)
-    : SurrogateBasedSolver(initialVectorSampler, surrogateSolver, variableEncoder, selectionCriterion, numIterations), surrogateLearner(surrogateLearner)
+    : SurrogateBasedSolver(initialVectorSampler, surrogateSolver, variableEncoder, selectionCriterion, numIterations), surrogateLearner(surrogateLearner), warmStart(false), savedNumRows(0)
   {
   }
-  BatchSurrogateBasedSolver() {}
+  BatchSurrogateBasedSolver() : warmStart(false), savedNumRows(0) {}
+
+  void setWarmStart(bool warmStart)
+    {this->warmStart = warmStart;}
 
   virtual void startSolver(ExecutionContext& context, ProblemPtr problem, SolverCallbackPtr callback, ObjectPtr startingSolution)
   {
@@ -274,13 +441,31 @@ public:
     std::pair<ProblemPtr, TablePtr> p = createSurrogateLearningProblem(context, problem);
     surrogateLearningProblem = p.first;
     surrogateData = p.second;
+    previousSurrogateModel = ExpressionPtr();
+
+    // the number of samples is known in advance when the number of iterations is bounded
+    if (numIterations)
+    {
+      size_t numSamples = initialSamples->getNumElements() + numIterations * numCandidatesPerIteration;
+      surrogateData->reserve(numSamples);
+      surrogateLearningProblem->getObjective(0).staticCast<LearningObjective>()->getIndices()->reserve(numSamples);
+    }
+  }
+
+  virtual void stopSolver(ExecutionContext& context)
+  {
+    SurrogateBasedSolver::stopSolver(context);
+    previousSurrogateModel = ExpressionPtr();
+    savedPreviousSurrogateModel = ExpressionPtr();
   }
 
   // SurrogateBasedSolver
   virtual ExpressionPtr getSurrogateModel(ExecutionContext& context)
   {
     ExpressionPtr res;
-    surrogateLearner->solve(context, surrogateLearningProblem, storeBestSolutionSolverCallback(*(ObjectPtr* )&res));
+    surrogateLearner->solve(context, surrogateLearningProblem, storeBestSolutionSolverCallback(*(ObjectPtr* )&res), warmStart ? previousSurrogateModel : ExpressionPtr());
+    if (warmStart)
+      previousSurrogateModel = res;
     return res;
   }
 
@@ -291,11 +476,29 @@ public:
     surrogateData->addRow(row);
   }
 
+  virtual void saveSurrogateState(ExecutionContext& context)
+  {
+    savedNumRows = surrogateData->getNumRows();
+    savedPreviousSurrogateModel = previousSurrogateModel;
+  }
+
+  virtual void restoreSurrogateState(ExecutionContext& context)
+  {
+    surrogateLearningProblem->getObjective(0).staticCast<LearningObjective>()->getIndices()->resize(savedNumRows);
+    surrogateData->resize(savedNumRows);
+    previousSurrogateModel = savedPreviousSurrogateModel; // the models learned on the removed samples must not be warm started
+    savedPreviousSurrogateModel = ExpressionPtr();
+  }
+
 protected:
   friend class BatchSurrogateBasedSolverClass;
 
   SolverPtr surrogateLearner;
+  bool warmStart;
   ProblemPtr surrogateLearningProblem;
+  ExpressionPtr previousSurrogateModel;
+  size_t savedNumRows;
+  ExpressionPtr savedPreviousSurrogateModel;
 
   ExpressionDomainPtr createSurrogateDomain(ExecutionContext& context, ProblemPtr problem)
   {
@@ -22,6 +22,13 @@ void SplittingCriterion::configure(const TablePtr& data, const VariableExpressio
 void SplittingCriterion::setPredictions(const DataVectorPtr& predictions)
   {this->predictions = predictions; invalidate();}
 
+SplittingCriterionPtr SplittingCriterion::cloneAndConfigure(ExecutionContext& context) const
+{
+  SplittingCriterionPtr res = cloneAndCast<SplittingCriterion>(context);
+  res->configure(data, supervision, weights, indices);
+  return res;
+}
+
 void SplittingCriterion::ensureIsUpToDate()
 {
   if (!upToDate)
@@ -0,0 +1,435 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: BinarySerialisation.cpp        | Binary Import/Export            |
+| Author  : Francis Maes                   |                                 |
+| Started : 17/10/2026 10:10               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <oil/Core/BinarySerialisation.h>
+#include <oil/Core/Class.h>
+#include <oil/Core/TemplateClass.h>
+#include <oil/Core/ClassManager.h>
+#include <oil/Execution/ExecutionContext.h>
+using namespace lbcpp;
+
+static const char binaryArchiveMagic[8] = {'L', 'B', 'C', 'P', 'P', 'B', 'I', 'N'};
+static const int binaryArchiveVersion = 1;
+static const juce::uint32 binaryArchiveByteOrderMark = 0x01020304;
+
+enum
+{
+  nullObjectTag = 0,
+  sharedObjectTag,
+  typeObjectTag,
+  objectTag,           // object whose type is the expected type
+  objectWithTypeTag    // object followed by its type
+};
+
+enum
+{
+  namedTypeTag = 0,
+  templateTypeTag,
+  numTypeTags          // values >= numTypeTags refer to an already written type
+};
+
+/*
+** BinaryExporter
+*/
+const char* BinaryExporter::fileExtension = "lbbin";
+
+BinaryExporter::BinaryExporter(ExecutionContext& context, juce::OutputStream& ostr)
+  : context(context), ostr(ostr), ok(true) {}
+
+bool BinaryExporter::isBinaryFileName(const juce::File& file)
+  {return file.getFileExtension() == T(".") + string(fileExtension);}
+
+bool BinaryExporter::saveToFile(ExecutionContext& context, const ObjectPtr& object, const juce::File& file)
+{
+  if (file.exists())
+  {
+    if (file.existsAsFile())
+    {
+      if (!file.deleteFile())
+      {
+        context.errorCallback(T("BinaryExporter::saveToFile"), T("Could not delete file ") + file.getFullPathName());
+        return false;
+      }
+    }
+    else
+    {
+      context.errorCallback(T("BinaryExporter::saveToFile"), file.getFullPathName() + T(" is a directory"));
+      return false;
+    }
+  }
+
+  juce::FileOutputStream* ostr = file.createOutputStream();
+  if (!ostr)
+  {
+    context.errorCallback(T("BinaryExporter::saveToFile"), T("Could not open file ") + file.getFullPathName());
+    return false;
+  }
+
+  BinaryExporter exporter(context, *ostr);
+  exporter.writeHeader();
+  exporter.writeObject(object, ClassPtr());
+  ostr->flush();
+  delete ostr;
+
+  if (!exporter.isOk())
+    context.errorCallback(T("BinaryExporter::saveToFile"), T("Could not write file ") + file.getFullPathName());
+  return exporter.isOk();
+}
+
+void BinaryExporter::writeHeader()
+{
+  writeBlock(binaryArchiveMagic, sizeof (binaryArchiveMagic));
+  ostr.writeCompressedInt(binaryArchiveVersion);
+  writeBlock(&binaryArchiveByteOrderMark, sizeof (binaryArchiveByteOrderMark));
+}
+
+void BinaryExporter::writeName(const string& name)
+{
+  std::map<string, size_t>::const_iterator it = nameIdentifiers.find(name);
+  if (it == nameIdentifiers.end())
+  {
+    ostr.writeCompressedInt(0);
+    ostr.writeString(name);
+    size_t identifier = nameIdentifiers.size();
+    nameIdentifiers[name] = identifier;
+  }
+  else
+    ostr.writeCompressedInt((int)it->second + 1);
+}
+
+void BinaryExporter::writeType(ClassPtr type)
+{
+  jassert(type);
+  std::map<ClassPtr, size_t>::const_iterator it = typeIdentifiers.find(type);
+  if (it != typeIdentifiers.end())
+  {
+    ostr.writeCompressedInt((int)it->second + numTypeTags);
+    return;
+  }
+
+  TemplateClassPtr templateType = type->getTemplate();
+  if (!type->isNamedType() && templateType)
+  {
+    ostr.writeCompressedInt(templateTypeTag);
+    writeName(templateType->getName());
+    size_t n = type->getNumTemplateArguments();
+    ostr.writeCompressedInt((int)n);
+    for (size_t i = 0; i < n; ++i)
+      writeType(type->getTemplateArgument(i));
+  }
+  else
+  {
+    ostr.writeCompressedInt(namedTypeTag);
+    writeName(type->getName());
+  }
+  size_t identifier = typeIdentifiers.size();
+  typeIdentifiers[type] = identifier;
+}
+
+void BinaryExporter::writeObject(const ObjectPtr& object, ClassPtr expectedType)
+{
+  if (!object)
+  {
+    ostr.writeByte(nullObjectTag);
+    return;
+  }
+
+  ClassPtr typeValue = object.dynamicCast<Class>();
+  if (typeValue)
+  {
+    ostr.writeByte(typeObjectTag);
+    writeType(typeValue);
+    return;
+  }
+
+  ObjectIdentifiersMap::const_iterator it = objectIdentifiers.find(object);
+  if (it != objectIdentifiers.end())
+  {
+    ostr.writeByte(sharedObjectTag);
+    ostr.writeCompressedInt((int)it->second);
+    return;
+  }
+
+  ClassPtr type = object->getClass();
+  if (type == expectedType)
+    ostr.writeByte(objectTag);
+  else
+  {
+    ostr.writeByte(objectWithTypeTag);
+    writeType(type);
+  }
+  size_t identifier = objectIdentifiers.size();
+  objectIdentifiers[object] = identifier;
+  object->saveToBinary(*this);
+}
+
+void BinaryExporter::writeGeneratedObject(const ObjectPtr& object)
+{
+  bool registerObject = object && objectIdentifiers.find(object) == objectIdentifiers.end();
+  ostr.writeBool(registerObject);
+  if (registerObject)
+  {
+    size_t identifier = objectIdentifiers.size();
+    objectIdentifiers[object] = identifier;
+  }
+}
+
+void BinaryExporter::writeBlock(const void* data, size_t size)
+{
+  static const size_t maxChunkSize = 0x40000000;
+  const char* ptr = (const char* )data;
+  while (size)
+  {
+    size_t chunkSize = size > maxChunkSize ? maxChunkSize : size;
+    ok &= ostr.write(ptr, (int)chunkSize);
+    ptr += chunkSize;
+    size -= chunkSize;
+  }
+}
+
+/*
+** BinaryImporter
+*/
+BinaryImporter::BinaryImporter(ExecutionContext& context, juce::InputStream& istr)
+  : context(context), istr(istr), ok(true) {}
+
+bool BinaryImporter::isBinaryFile(juce::InputStream& istr)
+{
+  char magic[sizeof (binaryArchiveMagic)];
+  return istr.read(magic, sizeof (magic)) == (int)sizeof (magic) && !memcmp(magic, binaryArchiveMagic, sizeof (magic));
+}
+
+ObjectPtr BinaryImporter::loadFromFile(ExecutionContext& context, const juce::File& file)
+{
+  if (!file.existsAsFile())
+  {
+    context.errorCallback(T("BinaryImporter::loadFromFile"), file.getFullPathName() + T(" does not exists"));
+    return ObjectPtr();
+  }
+  juce::FileInputStream* fileStream = file.createInputStream();
+  if (!fileStream)
+  {
+    context.errorCallback(T("BinaryImporter::loadFromFile"), T("Could not open file ") + file.getFullPathName());
+    return ObjectPtr();
+  }
+  juce::BufferedInputStream istr(fileStream, 0x10000, true);
+  BinaryImporter importer(context, istr);
+  return importer.readHeader() ? importer.load() : ObjectPtr();
+}
+
+bool BinaryImporter::readHeader()
+{
+  if (!isBinaryFile(istr))
+  {
+    errorMessage(T("BinaryImporter::readHeader"), T("Not a binary archive"));
+    return false;
+  }
+  int version = istr.readCompressedInt();
+  if (version != binaryArchiveVersion)
+  {
+    errorMessage(T("BinaryImporter::readHeader"), T("Unsupported version: ") + string(version));
+    return false;
+  }
+  juce::uint32 byteOrderMark = 0;
+  if (!readBlock(&byteOrderMark, sizeof (byteOrderMark)))
+    return false;
+  if (byteOrderMark != binaryArchiveByteOrderMark)
+  {
+    errorMessage(T("BinaryImporter::readHeader"), T("This archive was written on a machine with another byte order"));
+    return false;
+  }
+  return true;
+}
+
+ObjectPtr BinaryImporter::load()
+{
+  ObjectPtr res = readObject(ClassPtr());
+  return ok ? res : ObjectPtr();
+}
+
+void BinaryImporter::errorMessage(const string& where, const string& what)
+{
+  context.errorCallback(where, what);
+  ok = false;
+}
+
+void BinaryImporter::warningMessage(const string& where, const string& what) const
+  {context.warningCallback(where, what);}
+
+void BinaryImporter::unknownVariableWarning(ClassPtr type, const string& variableName)
+{
+  std::pair<ClassPtr, string> key = std::make_pair(type, variableName);
+  if (unknownVariables.find(key) == unknownVariables.end())
+  {
+    warningMessage(T("Load from binary"), T("Unknown variable ") + type->getName() + T("::") + variableName);
+    unknownVariables.insert(key);
+  }
+}
+
+bool BinaryImporter::readIdentifier(size_t numIdentifiers, const string& what, size_t& res)
+{
+  int identifier = istr.readCompressedInt();
+  if (identifier < 0 || (size_t)identifier >= numIdentifiers)
+  {
+    errorMessage(T("BinaryImporter::readIdentifier"), T("Invalid ") + what + T(" identifier: ") + string(identifier));
+    return false;
+  }
+  res = (size_t)identifier;
+  return true;
+}
+
+string BinaryImporter::readName()
+{
+  size_t identifier;
+  if (!readIdentifier(names.size() + 1, T("name"), identifier))
+    return string::empty;
+  if (identifier > 0)
+    return names[identifier - 1];
+  names.push_back(istr.readString());
+  return names.back();
+}
+
+ClassPtr BinaryImporter::readType()
+{
+  size_t tag;
+  if (!readIdentifier(types.size() + numTypeTags, T("type"), tag))
+    return ClassPtr();
+  if (tag >= numTypeTags)
+    return types[tag - numTypeTags];
+
+  ClassPtr res;
+  if (tag == templateTypeTag)
+  {
+    string templateName = readName();
+    int n = istr.readCompressedInt();
+    if (!ok || n < 0)
+    {
+      errorMessage(T("BinaryImporter::readType"), T("Invalid template arguments"));
+      return ClassPtr();
+    }
+    std::vector<ClassPtr> templateArguments(n);
+    for (int i = 0; i < n; ++i)
+    {
+      templateArguments[i] = readType();
+      if (!templateArguments[i])
+        return ClassPtr();
+    }
+    res = typeManager().getType(context, templateName, templateArguments);
+  }
+  else
+  {
+    string name = readName();
+    if (!ok)
+      return ClassPtr();
+    res = typeManager().getType(context, name);
+  }
+
+  if (!res)
+  {
+    ok = false;
+    return ClassPtr();
+  }
+  types.push_back(res);
+  return res;
+}
+
+ObjectPtr BinaryImporter::readObject(ClassPtr expectedType)
+{
+  if (!ok)
+    return ObjectPtr();
+  if (istr.isExhausted())
+  {
+    errorMessage(T("BinaryImporter::readObject"), T("Unexpected end of stream"));
+    return ObjectPtr();
+  }
+
+  char tag = istr.readByte();
+  switch (tag)
+  {
+  case nullObjectTag:
+    return ObjectPtr();
+
+  case sharedObjectTag:
+    {
+      size_t identifier;
+      return readIdentifier(objects.size(), T("object"), identifier) ? objects[identifier] : ObjectPtr();
+    }
+
+  case typeObjectTag:
+    return readType();
+
+  case objectTag:
+  case objectWithTypeTag:
+    {
+      ClassPtr type = (tag == objectTag ? expectedType : readType());
+      if (!type)
+      {
+        errorMessage(T("BinaryImporter::readObject"), T("Could not find type"));
+        return ObjectPtr();
+      }
+      ObjectPtr res = type->createObject(context);
+      if (!res)
+      {
+        errorMessage(T("BinaryImporter::readObject"), T("Could not create instance of ") + type->getName().quoted());
+        return ObjectPtr();
+      }
+      objects.push_back(res);
+      if (!res->loadFromBinary(*this) || !ok)
+      {
+        ok = false;
+        return ObjectPtr();
+      }
+      return res;
+    }
+
+  default:
+    errorMessage(T("BinaryImporter::readObject"), T("Invalid object tag: ") + string((int)tag));
+    return ObjectPtr();
+  };
+}
+
+void BinaryImporter::readGeneratedObject(const ObjectPtr& object)
+{
+  // keeps object identifiers synchronised with the exporter, even if the object could not be generated
+  if (istr.readBool())
+    objects.push_back(object);
+}
+
+bool BinaryImporter::readNumElements(size_t& res, size_t minElementSize)
+{
+  static const juce::int64 maxUnknownStreamLength = 0x40000000; // when the stream can not tell its length
+  juce::int64 n = istr.readInt64();
+  juce::int64 totalLength = istr.getTotalLength();
+  juce::int64 remainingLength = totalLength >= 0 ? totalLength - istr.getPosition() : maxUnknownStreamLength;
+  if (n < 0 || n > remainingLength / (juce::int64)(minElementSize ? minElementSize : 1))
+  {
+    errorMessage(T("BinaryImporter::readNumElements"), T("Invalid number of elements: ") + string(n));
+    res = 0;
+    return false;
+  }
+  res = (size_t)n;
+  return true;
+}
+
+bool BinaryImporter::readBlock(void* data, size_t size)
+{
+  static const size_t maxChunkSize = 0x40000000;
+  char* ptr = (char* )data;
+  while (size)
+  {
+    size_t chunkSize = size > maxChunkSize ? maxChunkSize : size;
+    if (istr.read(ptr, (int)chunkSize) != (int)chunkSize)
+    {
+      errorMessage(T("BinaryImporter::readBlock"), T("Unexpected end of stream"));
+      return false;
+    }
+    ptr += chunkSize;
+    size -= chunkSize;
+  }
+  return true;
+}
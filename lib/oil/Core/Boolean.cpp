@@ -8,10 +8,47 @@
 #include "precompiled.h"
 #include <oil/Core/Boolean.h>
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Execution/ExecutionContext.h>
 
 namespace lbcpp { // compilation problem under macosx, since there is a name conflict with "Boolean" in mactypes.h
 
+/*
+** Shared instances of true and false, that have a static allocation flag so that their reference
+** counts are never updated. They are created once and are never deleted, since they may still be
+** referenced by static objects at exit.
+*/
+static Boolean* sharedBooleans[2] = {NULL, NULL};
+
+void cacheSharedBooleans()
+{
+  for (size_t i = 0; i < 2; ++i)
+  {
+    if (!sharedBooleans[i])
+    {
+      sharedBooleans[i] = new Boolean(i == 1);
+      sharedBooleans[i]->setStaticAllocationFlag();
+    }
+    sharedBooleans[i]->setThisClass(booleanClass);
+  }
+}
+
+void uncacheSharedBooleans()
+{
+  for (size_t i = 0; i < 2; ++i)
+    if (sharedBooleans[i])
+      sharedBooleans[i]->setThisClass(ClassPtr());
+}
+
+BooleanPtr Boolean::create(bool value)
+{
+  Boolean* res = sharedBooleans[value ? 1 : 0];
+  return res ? BooleanPtr(res) : BooleanPtr(new Boolean(value));
+}
+
+BooleanPtr Boolean::create(ClassPtr type, bool value)
+  {return type == booleanClass ? create(value) : BooleanPtr(new Boolean(type, value));}
+
 string Boolean::toShortString() const
   {return value ? "true" : "false";}
 
@@ -58,5 +95,11 @@ bool Boolean::loadFromXml(XmlImporter& importer)
 
 void Boolean::saveToXml(XmlExporter& exporter) const
   {exporter.addTextElement(toString());}
+
+bool Boolean::loadFromBinary(BinaryImporter& importer)
+  {value = importer.readBool(); return true;}
+
+void Boolean::saveToBinary(BinaryExporter& exporter) const
+  {exporter.writeBool(value);}
   
 }; /* namespace lbcpp */
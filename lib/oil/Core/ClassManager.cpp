@@ -15,47 +15,248 @@
 using namespace lbcpp;
 
 /*
-** TemplateClassCache
+** ReadMostlyHashTable
 */
 namespace lbcpp
 {
 
-struct TemplateClassCache
+template<class T>
+inline T* loadPointerAcquire(T* const volatile& pointer)
+{
+#if defined(__ATOMIC_ACQUIRE)
+  return __atomic_load_n(const_cast<T** >(&pointer), __ATOMIC_ACQUIRE);
+#elif JUCE_MSVC
+  T* res = pointer; // volatile reads have acquire semantics with msvc
+  _ReadWriteBarrier();
+  return res;
+#else
+  T* res = pointer;
+  __sync_synchronize();
+  return res;
+#endif
+}
+
+template<class T>
+inline void storePointerRelease(T* volatile& pointer, T* value)
+{
+#if defined(__ATOMIC_RELEASE)
+  __atomic_store_n(const_cast<T** >(&pointer), value, __ATOMIC_RELEASE);
+#elif JUCE_MSVC
+  _ReadWriteBarrier();
+  pointer = value; // volatile writes have release semantics with msvc
+#else
+  __sync_synchronize();
+  pointer = value;
+#endif
+}
+
+struct StringHash
+{
+  size_t operator()(const string& str) const
+    {return (size_t)(juce::uint32)str.hashCode();}
+};
+
+struct ClassVectorHash
 {
-  TemplateClassCache() {}
-  TemplateClassCache(const TemplateClassCache& other) : definition(other.definition)
+  size_t operator()(const std::vector<ClassPtr>& classes) const
+  {
+    size_t res = classes.size();
+    for (size_t i = 0; i < classes.size(); ++i)
+      res = res * 31 + ((size_t)classes[i].get() >> 4);
+    return res;
+  }
+};
+
+/*
+** Hash table in which find() can be called concurrently with insert() and set(), without lock.
+** insert() and set() must be serialized by the caller. An inserted node is fully constructed before
+** being published at the head of its bucket, and nodes are never modified afterwards: set() publishes
+** a modified copy of the whole bucket, and keeps the previous nodes alive until clear().
+** When the table grows, the nodes are copied into a new bucket array, that is published in
+** turn, and the previous one is kept alive (with its nodes) until clear(), since readers may
+** still be traversing it. Growing is geometric, so that this costs at most twice the memory.
+*/
+template<class KeyType, class ValueType, class HashFunction>
+class ReadMostlyHashTable
+{
+public:
+  ReadMostlyHashTable() : buckets(NULL), numElements(0) {}
+  ~ReadMostlyHashTable()
+    {clear();}
+
+  const ValueType* find(const KeyType& key) const
+  {
+    Buckets* b = loadPointerAcquire(buckets);
+    if (!b)
+      return NULL;
+    size_t hash = HashFunction()(key);
+    for (Node* node = loadPointerAcquire(b->heads[hash & b->mask]); node; node = node->next)
+      if (node->hash == hash && node->key == key)
+        return &node->value;
+    return NULL;
+  }
+
+  void insert(const KeyType& key, const ValueType& value)
+  {
+    jassert(!find(key));
+    if (!buckets || numElements >= buckets->mask + 1)
+      grow();
+    size_t hash = HashFunction()(key);
+    Node* volatile& head = buckets->heads[hash & buckets->mask];
+    storePointerRelease(head, new Node(key, value, hash, head));
+    ++numElements;
+  }
+
+  // inserts the key or replaces its value
+  void set(const KeyType& key, const ValueType& value)
+  {
+    if (!find(key))
+    {
+      insert(key, value);
+      return;
+    }
+    size_t hash = HashFunction()(key);
+    Node* volatile& head = buckets->heads[hash & buckets->mask];
+    Node* previousHead = head;
+    Node* res = NULL;
+    Node** tail = &res;
+    for (Node* node = previousHead; node; node = node->next)
+    {
+      bool isReplaced = node->hash == hash && node->key == key;
+      *tail = new Node(node->key, isReplaced ? value : node->value, node->hash, NULL);
+      tail = &(*tail)->next;
+    }
+    storePointerRelease(head, res);
+    retiredNodes.push_back(previousHead);
+  }
+
+  void getValues(std::vector<ValueType>& res) const
+  {
+    if (!buckets)
+      return;
+    res.reserve(res.size() + numElements);
+    for (size_t i = 0; i <= buckets->mask; ++i)
+      for (Node* node = buckets->heads[i]; node; node = node->next)
+        res.push_back(node->value);
+  }
+
+  size_t size() const
+    {return numElements;}
+
+  // not thread-safe
+  void clear()
+  {
+    for (size_t i = 0; i < retiredBuckets.size(); ++i)
+      deleteBuckets(retiredBuckets[i]);
+    retiredBuckets.clear();
+    for (size_t i = 0; i < retiredNodes.size(); ++i)
+      deleteNodes(retiredNodes[i]);
+    retiredNodes.clear();
+    if (buckets)
+    {
+      deleteBuckets((Buckets* )buckets);
+      buckets = NULL;
+    }
+    numElements = 0;
+  }
+
+private:
+  struct Node
+  {
+    Node(const KeyType& key, const ValueType& value, size_t hash, Node* next)
+      : key(key), value(value), hash(hash), next(next) {}
+
+    KeyType key;
+    ValueType value;
+    size_t hash;
+    Node* next;
+  };
+
+  struct Buckets
   {
-    ScopedLock _(other.instancesLock);
-    instances = other.instances;
+    size_t mask;
+    Node* volatile* heads;
+  };
+
+  Buckets* volatile buckets;
+  size_t numElements;
+  std::vector<Buckets* > retiredBuckets;
+  std::vector<Node* > retiredNodes; // bucket lists replaced by set()
+
+  void grow()
+  {
+    Buckets* res = new Buckets();
+    size_t numBuckets = buckets ? 2 * (buckets->mask + 1) : 64;
+    res->mask = numBuckets - 1;
+    res->heads = new Node* volatile[numBuckets];
+    for (size_t i = 0; i < numBuckets; ++i)
+      res->heads[i] = NULL;
+    if (buckets)
+    {
+      for (size_t i = 0; i <= buckets->mask; ++i)
+        for (Node* node = buckets->heads[i]; node; node = node->next)
+        {
+          Node* volatile& head = res->heads[node->hash & res->mask];
+          head = new Node(node->key, node->value, node->hash, head);
+        }
+      retiredBuckets.push_back((Buckets* )buckets);
+    }
+    storePointerRelease(buckets, res);
+  }
+
+  static void deleteBuckets(Buckets* b)
+  {
+    for (size_t i = 0; i <= b->mask; ++i)
+      deleteNodes(b->heads[i]);
+    delete [] b->heads;
+    delete b;
+  }
+
+  static void deleteNodes(Node* node)
+  {
+    while (node)
+    {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
   }
+};
+
+/*
+** TemplateClassCache
+*/
+struct TemplateClassCache
+{
   TemplateClassPtr definition;
 
-  ClassPtr getInstanceCached(ExecutionContext& context, const std::vector<ClassPtr>& arguments)
+  // lock is the ClassManager lock, that serializes all the instantiations
+  ClassPtr getInstanceCached(ExecutionContext& context, const std::vector<ClassPtr>& arguments, const CriticalSection& lock)
   {
-    ScopedLock _(instancesLock);
-    TemplateClassCache::InstanceMap::iterator it = instances.find(arguments);
-    if (it != instances.end())
-      return it->second;
-    else
-      return instantiate(context, arguments);
+    const ClassPtr* res = instances.find(arguments);
+    if (res)
+      return *res;
+
+    ScopedLock _(lock);
+    res = instances.find(arguments);
+    return res ? *res : instantiate(context, arguments);
   }
 
   void clear(std::vector<Class* >& toDelete)
   {
-    ScopedLock _(instancesLock);
-    toDelete.reserve(toDelete.size() + instances.size());
-    for (InstanceMap::iterator it = instances.begin(); it != instances.end(); ++it)
+    std::vector<ClassPtr> classes;
+    instances.getValues(classes);
+    toDelete.reserve(toDelete.size() + classes.size());
+    for (size_t i = 0; i < classes.size(); ++i)
     {
-      it->second->deinitialize();
-      toDelete.push_back(it->second.get());
+      classes[i]->deinitialize();
+      toDelete.push_back(classes[i].get());
     }
     instances.clear();
   }
 
 private:
-  CriticalSection instancesLock;
-  typedef std::map< std::vector<ClassPtr>, ClassPtr > InstanceMap;
-  InstanceMap instances;
+  ReadMostlyHashTable<std::vector<ClassPtr>, ClassPtr, ClassVectorHash> instances;
 
   ClassPtr instantiate(ExecutionContext& context, const std::vector<ClassPtr>& arguments)
   {
@@ -63,24 +264,46 @@ private:
     if (!res || !res->initialize(context))
       return ClassPtr();
     res->setStaticAllocationFlag();
-    instances[arguments] = res;
     bool isNamedType = true;
     for (size_t i = 0; i < arguments.size(); ++i)
       isNamedType &= arguments[i]->isNamedType();
     res->namedType = isNamedType;
+    instances.insert(arguments, res);
     return res;
   }
 };
 
+/*
+** ClassManagerIndex
+*/
+struct ClassManagerIndex
+{
+  ReadMostlyHashTable<string, ClassPtr, StringHash> types;
+  ReadMostlyHashTable<string, ClassPtr, StringHash> typesByShortName;
+  ReadMostlyHashTable<string, TemplateClassCache*, StringHash> templateTypes;
+  ReadMostlyHashTable<string, ClassPtr, StringHash> templateInstancesByName; // e.g. "DenseDoubleVector[EnumValue,Double]"
+
+  void clear()
+  {
+    types.clear();
+    typesByShortName.clear();
+    templateTypes.clear();
+    templateInstancesByName.clear();
+  }
+};
+
 }; /* namespace lbcpp */
 
 /*
 ** ClassManager
 */
-ClassManager::ClassManager() {}
+ClassManager::ClassManager() : index(new ClassManagerIndex()) {}
 
 ClassManager::~ClassManager()
-  {shutdown();}
+{
+  shutdown();
+  delete index;
+}
 
 bool ClassManager::declare(ExecutionContext& context, ClassPtr type)
 {
@@ -98,10 +321,15 @@ bool ClassManager::declare(ExecutionContext& context, ClassPtr type)
     return false;
   }
   type->setStaticAllocationFlag();
-  types[typeName] = type;
-  if (type->getShortName().isNotEmpty())
-    typesByShortName[type->getShortName()] = type;
   type->namedType = true;
+  types[typeName] = type;
+  index->types.insert(typeName, type);
+  string shortName = type->getShortName();
+  if (shortName.isNotEmpty())
+  {
+    typesByShortName[shortName] = type; // the last declared class wins
+    index->typesByShortName.set(shortName, type);
+  }
   return true;
 }
 
@@ -118,7 +346,10 @@ bool ClassManager::declare(ExecutionContext& context, TemplateClassPtr templateT
     context.errorCallback(T("ClassManager::declare"), T("Template type '") + typeName + T("' has already been declared"));
     return false;
   }
-  templateTypes[typeName].definition = templateType;
+  TemplateClassCache* cache = new TemplateClassCache();
+  cache->definition = templateType;
+  templateTypes[typeName] = cache;
+  index->templateTypes.insert(typeName, cache);
   return true;
 }
 
@@ -136,7 +367,7 @@ void ClassManager::finishDeclarations(ExecutionContext& context)
   for (TemplateClassMap::const_iterator it = templateTypes.begin(); it != templateTypes.end(); ++it)
   {
     string name = it->first;
-    TemplateClassPtr templateType = it->second.definition;
+    TemplateClassPtr templateType = it->second->definition;
     if (!templateType->isInitialized() && !templateType->initialize(context))
       context.errorCallback(T("ClassManager::finishDeclarations()"), T("Could not initialize template type ") + templateType->getName());
   }
@@ -158,18 +389,14 @@ ClassPtr ClassManager::getType(ExecutionContext& context, const string& typeName
   }
   jassert(!TemplateClass::isInstanciatedTypeName(typeName));
 
-  ScopedLock _(typesLock);
   TemplateClassCache* templateType = getTemplateClass(context, typeName);
-  return templateType ? templateType->getInstanceCached(context, arguments) : ClassPtr();
+  return templateType ? templateType->getInstanceCached(context, arguments, typesLock) : ClassPtr();
 }
 
 ClassPtr ClassManager::getTypeByShortName(ExecutionContext& context, const string& shortName) const
 {
-  TypeMap::const_iterator it = typesByShortName.find(shortName);
-  if (it == typesByShortName.end())
-    return ClassPtr();
-  else
-    return it->second;
+  const ClassPtr* res = index->typesByShortName.find(shortName);
+  return res ? *res : ClassPtr();
 }
 
 ClassPtr ClassManager::getType(ExecutionContext& context, const string& name) const
@@ -181,19 +408,30 @@ ClassPtr ClassManager::getType(ExecutionContext& context, const string& name) co
     return ClassPtr();
   }
 
-  ScopedLock _(typesLock);
-  ClassPtr type = findType(typeName);
+  const ClassPtr* type = index->types.find(typeName);
   if (type)
-    return type;
+    return *type;
 
   if (TemplateClass::isInstanciatedTypeName(typeName))
   {
+    type = index->templateInstancesByName.find(typeName);
+    if (type)
+      return *type;
+
     // this is a template type, parse, instantiate and retrieve it
     string templateName;
     std::vector<ClassPtr> templateArguments;
     if (!TemplateClass::parseInstanciatedTypeName(context, typeName, templateName, templateArguments))
       return ClassPtr();
-    return getType(context, templateName, templateArguments);
+    ClassPtr res = getType(context, templateName, templateArguments);
+    if (res)
+    {
+      // remember the name, so that it is not parsed again
+      ScopedLock _(typesLock);
+      if (!index->templateInstancesByName.find(typeName))
+        index->templateInstancesByName.insert(typeName, res);
+    }
+    return res;
   }
   else
   {
@@ -234,9 +472,8 @@ string ClassManager::removeAllSpaces(const string& str)
 
 ClassPtr ClassManager::findType(const string& name) const
 {
-  ScopedLock _(typesLock);
-  TypeMap::const_iterator it = types.find(removeAllSpaces(name));
-  return it == types.end() ? ClassPtr() : it->second;
+  const ClassPtr* res = index->types.find(removeAllSpaces(name));
+  return res ? *res : ClassPtr();
 }
 
 bool ClassManager::doTypeExists(const string& type) const
@@ -247,8 +484,12 @@ void ClassManager::shutdown()
   ScopedLock _(typesLock);
   std::vector<Class* > toDelete; // we keep traditional pointers, remove the remaining shared ptr and then perform deletion
   for (TemplateClassMap::iterator it = templateTypes.begin(); it != templateTypes.end(); ++it)
-    it->second.clear(toDelete);
+  {
+    it->second->clear(toDelete);
+    delete it->second;
+  }
   templateTypes.clear();
+  index->clear();
 
   toDelete.reserve(toDelete.size() + types.size());
   for (TypeMap::iterator it = types.begin(); it != types.end(); ++it)
@@ -266,21 +507,18 @@ void ClassManager::shutdown()
 
 bool ClassManager::hasTemplateClass(const string& templateTypeName) const
 {
-  ScopedLock _(typesLock);
-  TemplateClassMap::iterator it = const_cast<ClassManager* >(this)->templateTypes.find(templateTypeName);
-  return it != templateTypes.end();
+  return index->templateTypes.find(templateTypeName) != NULL;
 }
 
 TemplateClassCache* ClassManager::getTemplateClass(ExecutionContext& context, const string& templateTypeName) const
 {
-  ScopedLock _(typesLock);
-  TemplateClassMap::iterator it = const_cast<ClassManager* >(this)->templateTypes.find(templateTypeName);
-  if (it == templateTypes.end())
+  TemplateClassCache* const* res = index->templateTypes.find(templateTypeName);
+  if (!res)
   {
     context.errorCallback(T("ClassManager::getTemplateClass()"), T("Could not find template type ") + templateTypeName);
     return NULL;
   }
-  return &it->second;
+  return *res;
 }
 
 /*
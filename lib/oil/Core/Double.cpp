@@ -10,6 +10,7 @@
 #include <oil/Core/DefaultClass.h>
 #include <oil/Core/Vector.h>
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Execution/ExecutionContext.h>
 using namespace lbcpp;
 
@@ -97,6 +98,12 @@ bool Double::loadFromXml(XmlImporter& importer)
 void Double::saveToXml(XmlExporter& exporter) const
   {exporter.addTextElement(toString());}
 
+bool Double::loadFromBinary(BinaryImporter& importer)
+  {value = importer.readDouble(); return true;}
+
+void Double::saveToBinary(BinaryExporter& exporter) const
+  {exporter.writeDouble(value);}
+
 /*
 ** Probability
 */
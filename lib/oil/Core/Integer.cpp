@@ -8,18 +8,79 @@
 #include "precompiled.h"
 #include <oil/Core/Integer.h>
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Execution/ExecutionContext.h>
 using namespace lbcpp;
 
 /*
 ** Integer
 */
+/*
+** Shared instances of the small integers and positive integers, that have a static allocation flag so
+** that their reference counts are never updated. As for booleans, they are never deleted.
+*/
+enum {minSharedInteger = -128, maxSharedInteger = 1024};
+static Integer* sharedIntegers[maxSharedInteger - minSharedInteger];
+static PositiveInteger* sharedPositiveIntegers[maxSharedInteger];
+
+namespace lbcpp
+{
+
+void cacheSharedIntegers()
+{
+  for (int i = minSharedInteger; i < maxSharedInteger; ++i)
+  {
+    Integer*& res = sharedIntegers[i - minSharedInteger];
+    if (!res)
+    {
+      res = new Integer(i);
+      res->setStaticAllocationFlag();
+    }
+    res->setThisClass(integerClass);
+  }
+  for (int i = 0; i < maxSharedInteger; ++i)
+  {
+    PositiveInteger*& res = sharedPositiveIntegers[i];
+    if (!res)
+    {
+      res = new PositiveInteger((size_t)i);
+      res->setStaticAllocationFlag();
+    }
+    res->setThisClass(positiveIntegerClass);
+  }
+}
+
+void uncacheSharedIntegers()
+{
+  for (int i = 0; i < maxSharedInteger - minSharedInteger; ++i)
+    if (sharedIntegers[i])
+      sharedIntegers[i]->setThisClass(ClassPtr());
+  for (int i = 0; i < maxSharedInteger; ++i)
+    if (sharedPositiveIntegers[i])
+      sharedPositiveIntegers[i]->setThisClass(ClassPtr());
+}
+
+}; /* namespace lbcpp */
+
+IntegerPtr Integer::create(juce::int64 value)
+  {return create(integerClass, value);}
+
 IntegerPtr Integer::create(ClassPtr type, juce::int64 value)
 {
-  if (type.isInstanceOf<Enumeration>())
-    return new EnumValue(type.staticCast<Enumeration>(), (size_t)value);
+  if (type == integerClass)
+  {
+    if (value >= minSharedInteger && value < maxSharedInteger && sharedIntegers[value - minSharedInteger])
+      return sharedIntegers[value - minSharedInteger];
+    return new Integer(type, value);
+  }
   else if (type == positiveIntegerClass)
+  {
+    if (value >= 0 && value < maxSharedInteger && sharedPositiveIntegers[value])
+      return sharedPositiveIntegers[value];
     return new PositiveInteger(type, (size_t)value);
+  }
+  else if (type.isInstanceOf<Enumeration>())
+    return new EnumValue(type.staticCast<Enumeration>(), (size_t)value);
   else if (type == memorySizeClass)
     return new MemorySize(type, (size_t)value);
   else
@@ -61,6 +122,12 @@ bool Integer::loadFromXml(XmlImporter& importer)
 void Integer::saveToXml(XmlExporter& exporter) const
   {exporter.addTextElement(toString());}
 
+bool Integer::loadFromBinary(BinaryImporter& importer)
+  {value = importer.readInteger(); return true;}
+
+void Integer::saveToBinary(BinaryExporter& exporter) const
+  {exporter.writeInteger(value);}
+
 /*
 ** MemorySize
 */
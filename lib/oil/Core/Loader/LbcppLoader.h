@@ -10,7 +10,8 @@
 # define OIL_CORE_LOADER_LBCPP_H_
 
 # include <oil/Core/Loader.h>
-# include <oil/Execution/ExecutionTrace.h>
+# include <oil/Core/BinarySerialisation.h>
+# include <oil/Execution/ExecutionTraceLog.h>
 
 namespace lbcpp
 {
@@ -48,6 +49,38 @@ public:
     {return executionTraceClass;}
 };
 
+class LbcppBinaryLoader : public Loader
+{
+public:
+  virtual string getFileExtensions() const
+    {return BinaryExporter::fileExtension;}
+
+  virtual ClassPtr getTargetClass() const
+    {return objectClass;}
+
+  virtual bool canUnderstand(ExecutionContext& context, juce::InputStream& istr) const
+    {return BinaryImporter::isBinaryFile(istr);}
+
+  virtual ObjectPtr loadFromFile(ExecutionContext& context, const juce::File& file) const
+    {return BinaryImporter::loadFromFile(context, file);}
+};
+
+class TraceLogLoader : public Loader
+{
+public:
+  virtual string getFileExtensions() const
+    {return ExecutionTraceLogWriter::fileExtension;}
+
+  virtual ClassPtr getTargetClass() const
+    {return executionTraceClass;}
+
+  virtual bool canUnderstand(ExecutionContext& context, juce::InputStream& istr) const
+    {return ExecutionTraceLogReader::isExecutionTraceLog(istr);}
+
+  virtual ObjectPtr loadFromFile(ExecutionContext& context, const juce::File& file) const
+    {return ExecutionTraceLogReader::loadFromFile(context, file);}
+};
+
 }; /* namespace lbcpp */
 
 #endif // OIL_CORE_LOADER_LBCPP_H_
@@ -219,6 +219,9 @@ ObjectPtr Object::createFromFile(ExecutionContext& context, const juce::File& fi
 
 bool Object::saveToFile(ExecutionContext& context, const juce::File& file) const
 {
+  if (BinaryExporter::isBinaryFileName(file))
+    return BinaryExporter::saveToFile(context, refCountedPointerFromThis(this), file);
+
   XmlExporter exporter(context);
   exporter.saveObject(string::empty, refCountedPointerFromThis(this), ClassPtr());
   return exporter.saveToFile(file);
@@ -503,6 +506,73 @@ bool Object::loadFromXml(XmlImporter& importer)
   return ok;
 }
 
+/*
+** Binary Serialisation
+*/
+void Object::saveToBinary(BinaryExporter& exporter) const
+{
+  ClassPtr type = getClass();
+  DefaultClassPtr defaultClass = type.dynamicCast<DefaultClass>();
+
+  size_t n = type->getNumMemberVariables();
+  exporter.writeSize(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    exporter.writeName(getVariableName(i));
+    bool isGenerated = defaultClass && defaultClass->isMemberVariableGenerated(i);
+    exporter.writeBool(isGenerated);
+    if (isGenerated)
+      exporter.writeGeneratedObject(getVariable(i));
+    else
+      exporter.writeObject(getVariable(i), getVariableType(i));
+  }
+}
+
+bool Object::loadFromBinary(BinaryImporter& importer)
+{
+  ClassPtr thisClass = getClass();
+  size_t n;
+  if (!importer.readNumElements(n, 2)) // name identifier and generated flag
+    return false;
+  for (size_t i = 0; i < n && importer.isOk(); ++i)
+  {
+    string name = importer.readName();
+    bool isGenerated = importer.readBool();
+    int variableNumber = thisClass->findMemberVariable(name);
+    if (variableNumber < 0)
+    {
+      // the value of an unknown variable can be skipped, as long as its type was written
+      importer.unknownVariableWarning(thisClass, name);
+      if (isGenerated)
+        importer.readGeneratedObject(ObjectPtr());
+      else
+        importer.readObject(ClassPtr());
+      continue;
+    }
+    ClassPtr expectedType = thisClass->getMemberVariableType((size_t)variableNumber);
+    jassert(expectedType);
+
+    ObjectPtr value;
+    if (isGenerated)
+    {
+      value = computeGeneratedObject(importer.getContext(), name);
+      importer.readGeneratedObject(value);
+      if (!value)
+        return false;
+    }
+    else
+      value = importer.readObject(expectedType);
+
+    if (value)
+    {
+      if (!importer.getContext().checkInheritance((ClassPtr)value->getClass(), expectedType))
+        return false;
+      setVariable((size_t)variableNumber, value);
+    }
+  }
+  return importer.isOk();
+}
+
 void Object::saveVariablesToXmlAttributes(XmlExporter& exporter) const
 {
   size_t n = getNumVariables();
@@ -0,0 +1,148 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: SmallObjectAllocator.cpp       | Per-thread pool allocator for   |
+| Author  : Francis Maes                   |  small objects                  |
+| Started : 16/10/2026 10:15               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+using namespace lbcpp;
+
+#ifndef JUCE_DEBUG
+
+/*
+** Blocks are grouped by size classes of 16 bytes, up to 64 bytes. Each thread owns a free list
+** per size class, so that allocating and releasing a block takes no lock in the common case.
+** When a thread free list gets empty, it takes a batch of blocks from the global free list or
+** carves a new slab. When it gets too long, it gives a batch back to the global free list, so
+** that blocks that are allocated by one thread and released by another are recycled.
+**
+** Slabs are never returned to the system, and the blocks that are cached by a thread when it
+** terminates are lost (at most 2 * batchSize blocks per size class).
+**
+** All the state is POD and is zero-initialized before any static constructor runs, so that
+** objects can be allocated during the static initialization.
+*/
+namespace lbcpp
+{
+
+struct SmallObjectBlock
+{
+  SmallObjectBlock* next;      // next block in the free list or in the batch
+  SmallObjectBlock* nextBatch; // next batch in the global free list (first block of a batch only)
+};
+
+enum
+{
+  smallObjectGranularity = 16,
+  smallObjectMaxSize = 64,
+  smallObjectNumSizeClasses = smallObjectMaxSize / smallObjectGranularity,
+  smallObjectBatchSize = 256,
+  smallObjectSlabSize = 16384
+};
+
+static juce_ThreadLocal SmallObjectBlock* threadFreeLists[smallObjectNumSizeClasses];
+static juce_ThreadLocal size_t threadFreeListSizes[smallObjectNumSizeClasses];
+
+static SmallObjectBlock* globalFreeLists[smallObjectNumSizeClasses]; // lists of batches
+static int globalFreeListsLock;
+
+// the lock is taken when the counter goes from 0 to 1
+struct SmallObjectScopedSpinLock
+{
+  SmallObjectScopedSpinLock()
+  {
+    while (juce::atomicIncrementAndReturn(globalFreeListsLock) != 1)
+    {
+      juce::atomicDecrement(globalFreeListsLock);
+      juce::Thread::yield();
+    }
+  }
+
+  ~SmallObjectScopedSpinLock()
+    {juce::atomicDecrement(globalFreeListsLock);}
+};
+
+static void refillThreadFreeList(size_t sizeClass)
+{
+  SmallObjectBlock* batch;
+  {
+    SmallObjectScopedSpinLock _;
+    batch = globalFreeLists[sizeClass];
+    if (batch)
+      globalFreeLists[sizeClass] = batch->nextBatch;
+  }
+  if (batch)
+  {
+    threadFreeLists[sizeClass] = batch;
+    threadFreeListSizes[sizeClass] = smallObjectBatchSize;
+    return;
+  }
+
+  size_t blockSize = (sizeClass + 1) * smallObjectGranularity;
+  size_t numBlocks = smallObjectSlabSize / blockSize;
+  char* slab = (char* )malloc(numBlocks * blockSize);
+  if (!slab)
+    throw std::bad_alloc();
+  SmallObjectBlock* head = NULL;
+  for (size_t i = numBlocks; i > 0; --i)
+  {
+    SmallObjectBlock* block = (SmallObjectBlock* )(slab + (i - 1) * blockSize);
+    block->next = head;
+    head = block;
+  }
+  threadFreeLists[sizeClass] = head;
+  threadFreeListSizes[sizeClass] = numBlocks;
+}
+
+static void releaseThreadFreeListBatch(size_t sizeClass)
+{
+  SmallObjectBlock* batch = threadFreeLists[sizeClass];
+  SmallObjectBlock* last = batch;
+  for (size_t i = 1; i < smallObjectBatchSize; ++i)
+    last = last->next;
+  threadFreeLists[sizeClass] = last->next;
+  threadFreeListSizes[sizeClass] -= smallObjectBatchSize;
+  last->next = NULL;
+
+  SmallObjectScopedSpinLock _;
+  batch->nextBatch = globalFreeLists[sizeClass];
+  globalFreeLists[sizeClass] = batch;
+}
+
+void* smallObjectAllocate(size_t size)
+{
+  if (!size || size > smallObjectMaxSize)
+    return ::operator new(size);
+  size_t sizeClass = (size - 1) / smallObjectGranularity;
+  SmallObjectBlock* res = threadFreeLists[sizeClass];
+  if (!res)
+  {
+    refillThreadFreeList(sizeClass);
+    res = threadFreeLists[sizeClass];
+  }
+  threadFreeLists[sizeClass] = res->next;
+  --threadFreeListSizes[sizeClass];
+  return res;
+}
+
+void smallObjectFree(void* block, size_t size)
+{
+  if (!block)
+    return;
+  if (!size || size > smallObjectMaxSize)
+  {
+    ::operator delete(block);
+    return;
+  }
+  size_t sizeClass = (size - 1) / smallObjectGranularity;
+  SmallObjectBlock* b = (SmallObjectBlock* )block;
+  b->next = threadFreeLists[sizeClass];
+  threadFreeLists[sizeClass] = b;
+  if (++threadFreeListSizes[sizeClass] >= 2 * smallObjectBatchSize)
+    releaseThreadFreeListBatch(sizeClass);
+}
+
+}; /* namespace lbcpp */
+
+#endif // !JUCE_DEBUG
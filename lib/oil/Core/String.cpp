@@ -9,6 +9,7 @@
 #include <oil/Core/Class.h>
 #include <oil/Core/String.h>
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Execution/ExecutionContext.h>
 using namespace lbcpp;
 
@@ -57,6 +58,12 @@ bool String::loadFromXml(XmlImporter& importer)
 void String::saveToXml(XmlExporter& exporter) const
   {exporter.addTextElement(toString());}
 
+bool String::loadFromBinary(BinaryImporter& importer)
+  {value = importer.readString(); return true;}
+
+void String::saveToBinary(BinaryExporter& exporter) const
+  {exporter.writeString(value);}
+
 /*
 ** File
 */
@@ -77,6 +84,13 @@ string File::toString() const
 void File::saveToXml(XmlExporter& exporter) const
   {exporter.addTextElement(toString());}
 
+// files are saved relatively to the project directory, as in xml
+bool File::loadFromBinary(BinaryImporter& importer)
+  {return loadFromString(importer.getContext(), importer.readString());}
+
+void File::saveToBinary(BinaryExporter& exporter) const
+  {exporter.writeString(toString());}
+
 bool File::loadFromString(ExecutionContext& context, const string& str)
 {
   juce::File file = context.getFile(str);
@@ -52,6 +52,12 @@ void Table::resize(size_t numRows)
   this->numRows = numRows;
 }
 
+void Table::reserve(size_t numRows)
+{
+  for (size_t i = 0; i < columns.size(); ++i)
+    columns[i].data->reserve(numRows);
+}
+
 string Table::getDescription(size_t index) const
 {
   jassert(index < columns.size());
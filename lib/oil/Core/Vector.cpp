@@ -8,6 +8,7 @@
 #include "precompiled.h"
 #include <oil/Core/Vector.h>
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Execution/ExecutionContext.h>
 #include <oil/Lua/Lua.h>
 using namespace lbcpp;
@@ -187,6 +188,31 @@ void Vector::saveToXml(XmlExporter& exporter) const
   }
 }
 
+bool Vector::loadFromBinary(BinaryImporter& importer)
+{
+  if (!Object::loadFromBinary(importer))
+    return false;
+  size_t n;
+  if (!importer.readNumElements(n))
+    return false;
+  ClassPtr elementsType = getElementsType();
+  clear();
+  resize(n);
+  for (size_t i = 0; i < n && importer.isOk(); ++i)
+    setElement(i, importer.readObject(elementsType));
+  return importer.isOk();
+}
+
+void Vector::saveToBinary(BinaryExporter& exporter) const
+{
+  Object::saveToBinary(exporter);
+  size_t n = getNumElements();
+  exporter.writeSize(n);
+  ClassPtr elementsType = getElementsType();
+  for (size_t i = 0; i < n; ++i)
+    exporter.writeObject(getElement(i), elementsType);
+}
+
 bool Vector::loadFromString(ExecutionContext& context, const string& stringValue)
 {
   ClassPtr elementsType = getElementsType();
@@ -311,6 +337,30 @@ string BVector::toString() const
 size_t BVector::getSizeInBytes(bool recursively) const
   {return Object::getSizeInBytes(recursively) + sizeof (v) + v.size() * sizeof (unsigned char);}
 
+template<class NativeType>
+static bool loadRawValuesFromBinary(BinaryImporter& importer, std::vector<NativeType>& v)
+{
+  size_t n;
+  if (!importer.readNumElements(n, sizeof (NativeType)))
+    return false;
+  v.resize(n);
+  return !n || importer.readBlock(&v[0], n * sizeof (NativeType));
+}
+
+template<class NativeType>
+static void saveRawValuesToBinary(BinaryExporter& exporter, const std::vector<NativeType>& v)
+{
+  exporter.writeSize(v.size());
+  if (v.size())
+    exporter.writeBlock(&v[0], v.size() * sizeof (NativeType));
+}
+
+bool BVector::loadFromBinary(BinaryImporter& importer)
+  {return Object::loadFromBinary(importer) && loadRawValuesFromBinary(importer, v);}
+
+void BVector::saveToBinary(BinaryExporter& exporter) const
+  {Object::saveToBinary(exporter); saveRawValuesToBinary(exporter, v);}
+
 /*
 ** IVector / DVector / SVector
 */
@@ -318,6 +368,39 @@ juce::int64 IVector::missingValue = 0x0FEEFEEEFEEEFEEELL;
 double DVector::missingValue = *(const double* )&IVector::missingValue;
 string SVector::missingValue = T("<missing string>");
 
+bool IVector::loadFromBinary(BinaryImporter& importer)
+  {return Object::loadFromBinary(importer) && loadRawValuesFromBinary(importer, v);}
+
+void IVector::saveToBinary(BinaryExporter& exporter) const
+  {Object::saveToBinary(exporter); saveRawValuesToBinary(exporter, v);}
+
+bool DVector::loadFromBinary(BinaryImporter& importer)
+  {return Object::loadFromBinary(importer) && loadRawValuesFromBinary(importer, v);}
+
+void DVector::saveToBinary(BinaryExporter& exporter) const
+  {Object::saveToBinary(exporter); saveRawValuesToBinary(exporter, v);}
+
+bool SVector::loadFromBinary(BinaryImporter& importer)
+{
+  if (!Object::loadFromBinary(importer))
+    return false;
+  size_t n;
+  if (!importer.readNumElements(n))
+    return false;
+  v.resize(n);
+  for (size_t i = 0; i < n && importer.isOk(); ++i)
+    v[i] = importer.readString();
+  return importer.isOk();
+}
+
+void SVector::saveToBinary(BinaryExporter& exporter) const
+{
+  Object::saveToBinary(exporter);
+  exporter.writeSize(v.size());
+  for (size_t i = 0; i < v.size(); ++i)
+    exporter.writeString(v[i]);
+}
+
 /*
 ** OVector
 */
@@ -7,7 +7,12 @@
                                `--------------------------------------------*/
 #include "precompiled.h"
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Core/Object.h>
+#include <oil/Core/Boolean.h>
+#include <oil/Core/Integer.h>
+#include <oil/Core/Double.h>
+#include <oil/Core/String.h>
 #include <oil/Core/DefaultClass.h>
 #include <oil/Core/ClassManager.h>
 #include <oil/Execution/ExecutionContext.h>
@@ -147,6 +152,46 @@ string XmlElement::toShortString() const
 void XmlElement::saveToXml(XmlExporter& exporter) const
   {exporter.addChildElement(refCountedPointerFromThis(this));}
 
+void XmlElement::saveToBinary(BinaryExporter& exporter) const
+{
+  exporter.writeName(tagName);
+  exporter.writeString(text);
+  exporter.writeSize(attributes.size());
+  for (size_t i = 0; i < attributes.size(); ++i)
+  {
+    exporter.writeName(attributes[i].first);
+    exporter.writeString(attributes[i].second);
+  }
+  exporter.writeSize(childElements.size());
+  for (size_t i = 0; i < childElements.size(); ++i)
+    childElements[i]->saveToBinary(exporter);
+}
+
+bool XmlElement::loadFromBinary(BinaryImporter& importer)
+{
+  tagName = importer.readName();
+  text = importer.readString();
+  size_t n;
+  if (!importer.readNumElements(n, 2))
+    return false;
+  attributes.resize(n);
+  for (size_t i = 0; i < attributes.size() && importer.isOk(); ++i)
+  {
+    attributes[i].first = importer.readName();
+    attributes[i].second = importer.readString();
+  }
+  if (!importer.readNumElements(n))
+    return false;
+  childElements.resize(n);
+  for (size_t i = 0; i < childElements.size() && importer.isOk(); ++i)
+  {
+    childElements[i] = new XmlElement();
+    if (!childElements[i]->loadFromBinary(importer))
+      return false;
+  }
+  return importer.isOk();
+}
+
 
 /*
 ** XmlExporter
@@ -290,6 +335,15 @@ void XmlExporter::writeObject(const ObjectPtr& object, ClassPtr expectedType)
   }
 }
 
+// atomic values and the shared instances of Boolean::create() and Integer::create() are written
+// in place each time, so that sharing them does not add "id" and "ref" attributes to the files
+static bool isSharedObjectTrackingNeeded(const ObjectPtr& object)
+{
+  return !object->hasStaticAllocationFlag() &&
+    !object.isInstanceOf<Boolean>() && !object.isInstanceOf<Integer>() &&
+    !object.isInstanceOf<Double>() && !object.isInstanceOf<String>();
+}
+
 void XmlExporter::writeObjectImpl(const ObjectPtr& object, ClassPtr expectedType)
 {
   jassert(object->getReferenceCount());
@@ -301,7 +355,8 @@ void XmlExporter::writeObjectImpl(const ObjectPtr& object, ClassPtr expectedType
     if (expectedType != object->getClass())
       writeType(object->getClass());
 
-    linkObjectToCurrentElement(object);
+    if (isSharedObjectTrackingNeeded(object))
+      linkObjectToCurrentElement(object);
   }
   else
   {
@@ -14,51 +14,118 @@
 namespace lbcpp
 {
 
+/*
+** Makes a trace and saves it incrementally, without blocking the worker threads.
+**
+** Each thread callback appends records to its own bounded buffer. A background thread
+** periodically moves the buffered records at the end of an append-only log (see ExecutionTraceLog.h),
+** whose name is the trace file name with the "tracelog" extension.
+*/
 class MakeAndAutoSaveTraceExecutionCallback : public MakeTraceExecutionCallback
 {
 public:
-  MakeAndAutoSaveTraceExecutionCallback(ExecutionTracePtr trace, double autoSaveIntervalInSeconds, const juce::File& file)
-    : MakeTraceExecutionCallback(trace), saveInterval((juce::int64)(autoSaveIntervalInSeconds * 1000.0)), file(file)
-  {
-    lastSaveTime = juce::Time::currentTimeMillis() - 9 * saveInterval / 10; // the first time, we save after saveInterval/10 ms.
-  }
-  MakeAndAutoSaveTraceExecutionCallback() : saveInterval(0), lastSaveTime(0) {}
+  MakeAndAutoSaveTraceExecutionCallback(ExecutionTracePtr trace, double autoSaveIntervalInSeconds, const juce::File& file, size_t recordBufferSize = 65536)
+    : MakeTraceExecutionCallback(trace), saveInterval((juce::int64)(autoSaveIntervalInSeconds * 1000.0)), file(file), recordBufferSize(recordBufferSize), saveThread(NULL) {}
+  MakeAndAutoSaveTraceExecutionCallback() : saveInterval(0), recordBufferSize(65536), saveThread(NULL) {}
 
-  virtual ExecutionCallbackPtr createCallbackForThread(const ExecutionStackPtr& stack, Thread::ThreadID threadId)
+  virtual ~MakeAndAutoSaveTraceExecutionCallback()
+    {stopSaveThread();}
+
+  virtual void initialize(ExecutionContext& context)
   {
-    ExecutionTraceNodePtr traceNode = trace->findNode(stack);
-    jassert(traceNode);
-    return new MakeTraceThreadExecutionCallback(traceNode, trace->getStartTime());
+    MakeTraceExecutionCallback::initialize(context);
+    stopSaveThread();
+    if (saveInterval > 0)
+    {
+      saveThread = new SaveThread(this);
+      saveThread->startThread();
+    }
   }
 
-  virtual void notificationCallback(const NotificationPtr& notification)
+  virtual ExecutionCallbackPtr createCallbackForThread(const ExecutionStackPtr& stack, Thread::ThreadID threadId)
   {
-    MakeTraceExecutionCallback::notificationCallback(notification);
+    MakeTraceThreadExecutionCallbackPtr res = createThreadCallback(stack);
+    if (saveThread)
     {
-      ScopedLock _(autoSaveLock);
-      juce::int64 time = juce::Time::currentTimeMillis();
-      if (saveInterval > 0.0 && (time - lastSaveTime > saveInterval))
-      {
-        lastSaveTime = time;
-        autoSave();
-      }
+      ExecutionTraceRecordBufferPtr buffer = new ExecutionTraceRecordBuffer(recordBufferSize);
+      res->setRecordBuffer(buffer);
+      ScopedLock _(buffersLock);
+      buffers.push_back(buffer);
     }
+    return res;
   }
- 
+
+  juce::File getLogFile() const
+    {return file.withFileExtension(ExecutionTraceLogWriter::fileExtension);}
+
 protected:
   friend class MakeAndAutoSaveTraceExecutionCallbackClass;
 
-  CriticalSection autoSaveLock;
   juce::int64 saveInterval;
   juce::File file;
+  size_t recordBufferSize;
+
+  CriticalSection buffersLock;
+  std::vector<ExecutionTraceRecordBufferPtr> buffers;
+
+  struct SaveThread : public juce::Thread
+  {
+    SaveThread(MakeAndAutoSaveTraceExecutionCallback* owner)
+      : juce::Thread(T("TraceAutoSave")), owner(owner), writer(owner->getContext(), owner->getLogFile()) {}
+
+    virtual void run()
+    {
+      if (!writer.open(owner->trace))
+        return;
+      while (!threadShouldExit())
+      {
+        wait((int)owner->saveInterval);
+        owner->flushRecords(writer);
+      }
+    }
 
-  juce::int64 lastSaveTime;
+    MakeAndAutoSaveTraceExecutionCallback* owner;
+    ExecutionTraceLogWriter writer;
+  };
 
-  void autoSave()
+  SaveThread* saveThread;
+
+  void flushRecords(ExecutionTraceLogWriter& writer)
   {
-    ExecutionContext& context = getContext();
-    std::cerr << "Saving execution trace into " << file.getFullPathName() << std::endl;
-    trace->saveToFile(context, file);
+    std::vector<ExecutionTraceRecord> records;
+    size_t numDroppedRecords = 0;
+    {
+      ScopedLock _(buffersLock);
+      for (size_t i = 0; i < buffers.size(); ++i)
+        numDroppedRecords += buffers[i]->flush(records);
+
+      // remove the buffers of the threads that are finished
+      size_t n = 0;
+      for (size_t i = 0; i < buffers.size(); ++i)
+        if (buffers[i]->getReferenceCount() > 1)
+          buffers[n++] = buffers[i];
+      buffers.resize(n);
+    }
+    if (records.size())
+      writer.write(records);
+    if (numDroppedRecords)
+      getContext().warningCallback(string((int)numDroppedRecords) + T(" trace records were dropped, the record buffers are full"));
+  }
+
+  void stopSaveThread()
+  {
+    if (saveThread)
+    {
+      saveThread->stopThread(-1);
+      // records produced since the last iteration of the thread
+      if (saveThread->writer.isOpened())
+      {
+        flushRecords(saveThread->writer);
+        saveThread->writer.close();
+      }
+      delete saveThread;
+      saveThread = NULL;
+    }
   }
 };
 
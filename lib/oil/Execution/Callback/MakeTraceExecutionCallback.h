@@ -11,17 +11,43 @@
 
 # include <oil/Execution/ExecutionCallback.h>
 # include <oil/Execution/ExecutionStack.h>
-# include <oil/Execution/ExecutionTrace.h>
+# include <oil/Execution/ExecutionTraceLog.h>
 
 namespace lbcpp
 {
 
+/*
+** Builds the trace of one thread.
+**
+** Retention limits cap the memory used by the trace: nodes deeper than maxDepth are not
+** created (the warnings and errors they produce go to their deepest retained ancestor),
+** a node keeps at most maxResultsPerNode distinct results and only one resultCallback()
+** out of resultsSamplingInterval is kept for each result name of a node.
+**
+** If a record buffer is given, each change made to the trace is also described by an
+** ExecutionTraceRecord, see ExecutionTraceLog.h.
+*/
 class MakeTraceThreadExecutionCallback : public ExecutionCallback
 {
 public:
   MakeTraceThreadExecutionCallback(ExecutionTraceNodePtr parentItem, const juce::Time& startTime)
-    : stack(1, parentItem), startTime(startTime), currentNotificationTime(0.0) {}
-  MakeTraceThreadExecutionCallback() : currentNotificationTime(0.0) {}
+    : stack(1, parentItem), resultCounts(1), startTime(startTime), currentNotificationTime(0.0),
+      baseDepth(0), numSkippedLevels(0), maxDepth(0), maxResultsPerNode(0), resultsSamplingInterval(1) {}
+  MakeTraceThreadExecutionCallback()
+    : currentNotificationTime(0.0), baseDepth(0), numSkippedLevels(0), maxDepth(0), maxResultsPerNode(0), resultsSamplingInterval(1) {}
+
+  // baseDepth is the depth of parentItem, numSkippedLevels the number of levels of the execution stack that are not retained below it
+  void setRetentionLimits(size_t maxDepth, size_t maxResultsPerNode, size_t resultsSamplingInterval, size_t baseDepth, size_t numSkippedLevels)
+  {
+    this->maxDepth = maxDepth;
+    this->maxResultsPerNode = maxResultsPerNode;
+    this->resultsSamplingInterval = resultsSamplingInterval ? resultsSamplingInterval : 1;
+    this->baseDepth = baseDepth;
+    this->numSkippedLevels = numSkippedLevels;
+  }
+
+  void setRecordBuffer(const ExecutionTraceRecordBufferPtr& recordBuffer)
+    {this->recordBuffer = recordBuffer;}
 
   virtual void notificationCallback(const NotificationPtr& notification)
   {
@@ -33,75 +59,170 @@ public:
   }
 
   virtual void informationCallback(const string& where, const string& what)
-    {appendTraceItem(new MessageExecutionTraceItem(currentNotificationTime, informationMessageType, what, where));}
+  {
+    if (!numSkippedLevels)
+      appendMessage(informationMessageType, what, where);
+  }
 
   virtual void warningCallback(const string& where, const string& what)
-    {appendTraceItem(new MessageExecutionTraceItem(currentNotificationTime, warningMessageType, what, where));}
+    {appendMessage(warningMessageType, what, where);}
 
   virtual void errorCallback(const string& where, const string& what)
-    {appendTraceItem(new MessageExecutionTraceItem(currentNotificationTime, errorMessageType, what, where));}
+    {appendMessage(errorMessageType, what, where);}
 
   virtual void progressCallback(const ProgressionStatePtr& progression)
   {
+    if (numSkippedLevels)
+      return;
     ExecutionTraceNodePtr node = getCurrentNode();
     node->setProgression(progression);
     node->setEndTime(currentNotificationTime);
+    if (recordBuffer)
+    {
+      ExecutionTraceRecord record(ExecutionTraceRecord::progressRecord, node, currentNotificationTime);
+      record.setValue(getContext(), progression);
+      recordBuffer->push(record);
+    }
   }
 
   virtual void resultCallback(const string& name, const ObjectPtr& value)
-    {getCurrentNode()->setResult(name, value);}
+  {
+    if (numSkippedLevels)
+      return;
+    if (resultsSamplingInterval > 1 && (resultCounts.back()[name]++ % resultsSamplingInterval) != 0)
+      return;
+    ExecutionTraceNodePtr node = getCurrentNode();
+    if (node->setResult(name, value, maxResultsPerNode) && recordBuffer)
+    {
+      ExecutionTraceRecord record(ExecutionTraceRecord::resultRecord, node, currentNotificationTime);
+      record.name = name;
+      record.setValue(getContext(), value);
+      recordBuffer->push(record);
+    }
+  }
 
   virtual void preExecutionCallback(const ExecutionStackPtr& , const string& description, const WorkUnitPtr& workUnit)
   {
     jassert(stack.size());
+    if (numSkippedLevels || (maxDepth && baseDepth + stack.size() > maxDepth))
+    {
+      ++numSkippedLevels;
+      return;
+    }
     ExecutionTraceNodePtr newNode(new ExecutionTraceNode(description, workUnit, currentNotificationTime));
+    if (recordBuffer)
+    {
+      ExecutionTraceRecord record(ExecutionTraceRecord::enterRecord, getCurrentNode(), currentNotificationTime);
+      record.child = ExecutionTraceRecord::getNodeIdentifier(newNode);
+      record.name = description;
+      recordBuffer->push(record);
+    }
     appendTraceItem(newNode);
     stack.push_back(newNode);
+    resultCounts.push_back(std::map<string, size_t>());
   }
 
   virtual void postExecutionCallback(const ExecutionStackPtr& , const string& description, const WorkUnitPtr& workUnit, const ObjectPtr& result)
   {
+    if (numSkippedLevels)
+    {
+      --numSkippedLevels;
+      return;
+    }
     ExecutionTraceNodePtr finishedNode = getCurrentNode();
     finishedNode->setEndTime(currentNotificationTime);
     finishedNode->removeWorkUnit();
     finishedNode->setReturnValue(result);
+    if (recordBuffer)
+    {
+      ExecutionTraceRecord record(ExecutionTraceRecord::leaveRecord, finishedNode, currentNotificationTime);
+      record.setValue(getContext(), result);
+      recordBuffer->push(record);
+    }
     jassert(stack.size());
     stack.pop_back();
+    resultCounts.pop_back();
     jassert(stack.size());
   }
 
 protected:
   std::vector<ExecutionTraceNodePtr> stack;
+  std::vector< std::map<string, size_t> > resultCounts; // number of resultCallback() per result name, for each node of the stack
   juce::Time startTime;
 
   double currentNotificationTime;
 
+  size_t baseDepth;
+  size_t numSkippedLevels;
+  size_t maxDepth;
+  size_t maxResultsPerNode;
+  size_t resultsSamplingInterval;
+  ExecutionTraceRecordBufferPtr recordBuffer;
+
   ExecutionTraceNodePtr getCurrentNode() const
     {jassert(stack.size()); return stack.back();}
 
+  void appendMessage(ExecutionMessageType messageType, const string& what, const string& where)
+  {
+    if (recordBuffer)
+    {
+      ExecutionTraceRecord record(ExecutionTraceRecord::messageRecord, getCurrentNode(), currentNotificationTime);
+      record.messageType = messageType;
+      record.name = what;
+      record.where = where;
+      recordBuffer->push(record);
+    }
+    appendTraceItem(new MessageExecutionTraceItem(currentNotificationTime, messageType, what, where));
+  }
+
   virtual void appendTraceItem(ExecutionTraceItemPtr item)
     {getCurrentNode()->appendSubItem(item);}
 };
 
+typedef ReferenceCountedObjectPtr<MakeTraceThreadExecutionCallback> MakeTraceThreadExecutionCallbackPtr;
+
 class MakeTraceExecutionCallback : public DispatchByThreadExecutionCallback
 {
 public:
   MakeTraceExecutionCallback(ExecutionTracePtr trace = ExecutionTracePtr())
-    : trace(trace) {}
+    : trace(trace), maxDepth(0), maxResultsPerNode(0), resultsSamplingInterval(1) {}
 
-  virtual ExecutionCallbackPtr createCallbackForThread(const ExecutionStackPtr& stack, Thread::ThreadID threadId)
+  // zero means unlimited
+  void setRetentionLimits(size_t maxDepth, size_t maxResultsPerNode = 0, size_t resultsSamplingInterval = 1)
   {
-    ExecutionTraceNodePtr traceNode = trace->findNode(stack);
-    if (!traceNode)
-      traceNode = trace->getRootNode();
-    jassert(traceNode);
-    return new MakeTraceThreadExecutionCallback(traceNode, trace->getStartTime());
+    this->maxDepth = maxDepth;
+    this->maxResultsPerNode = maxResultsPerNode;
+    this->resultsSamplingInterval = resultsSamplingInterval;
   }
 
+  virtual ExecutionCallbackPtr createCallbackForThread(const ExecutionStackPtr& stack, Thread::ThreadID threadId)
+    {return createThreadCallback(stack);}
+
 protected:
   friend class MakeTraceExecutionCallbackClass;
 
   ExecutionTracePtr trace;
+  size_t maxDepth;
+  size_t maxResultsPerNode;
+  size_t resultsSamplingInterval;
+
+  MakeTraceThreadExecutionCallbackPtr createThreadCallback(const ExecutionStackPtr& stack)
+  {
+    size_t depth = stack->getDepth();
+    ExecutionTraceNodePtr traceNode;
+    if (maxDepth)
+      traceNode = trace->findDeepestNode(stack, depth); // the nodes of the stack may have been skipped
+    else
+    {
+      traceNode = trace->findNode(stack);
+      if (!traceNode)
+        traceNode = trace->getRootNode();
+    }
+    jassert(traceNode);
+    MakeTraceThreadExecutionCallbackPtr res = new MakeTraceThreadExecutionCallback(traceNode, trace->getStartTime());
+    res->setRetentionLimits(maxDepth, maxResultsPerNode, resultsSamplingInterval, depth, stack->getDepth() - depth);
+    return res;
+  }
 };
 
 }; /* namespace lbcpp */
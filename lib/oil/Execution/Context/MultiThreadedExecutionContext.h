@@ -490,6 +490,9 @@ public:
   virtual bool isMultiThread() const
     {return threadPool->getNumThreads() > 1;}
 
+  virtual size_t getNumThreads() const
+    {return threadPool->getNumThreads();}
+
   virtual bool isCanceled() const
     {return false;}
 
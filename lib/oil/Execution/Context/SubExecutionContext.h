@@ -32,6 +32,9 @@ public:
     ExecutionContext::notificationCallback(notification);
   }
 
+  virtual size_t getNumThreads() const
+    {return parent ? parent->getNumThreads() : 1;}
+
   virtual void waitUntilAllWorkUnitsAreDone(size_t timeOutInMilliseconds = 0)
     {if (parent) parent->waitUntilAllWorkUnitsAreDone(timeOutInMilliseconds);}
 
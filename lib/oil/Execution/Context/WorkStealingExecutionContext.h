@@ -0,0 +1,714 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: WorkStealingExecutionContext.h | Multi-Threaded Execution        |
+| Author  : Francis Maes                   | Context with Work Stealing      |
+| Started : 16/10/2026 10:12               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef OIL_EXECUTION_CONTEXT_WORK_STEALING_H_
+# define OIL_EXECUTION_CONTEXT_WORK_STEALING_H_
+
+# include "MultiThreadedExecutionContext.h"
+# include <deque>
+
+namespace lbcpp
+{
+
+/*
+** WorkStealingEntry
+*/
+struct WorkStealingEntry
+{
+  WorkStealingEntry(const WorkUnitPtr& workUnit, const ExecutionStackPtr& stack, bool pushIntoStack,
+                    int* counterToDecrementWhenDone, const juce::WaitableEvent* eventToSignalWhenDone,
+                    ObjectPtr* result, const ExecutionContextCallbackPtr& callback = ExecutionContextCallbackPtr())
+    : workUnit(workUnit), stack(stack), pushIntoStack(pushIntoStack), counterToDecrementWhenDone(counterToDecrementWhenDone),
+      eventToSignalWhenDone(eventToSignalWhenDone), hasPrivateDoneEvent(false), result(result), callback(callback) {}
+  WorkStealingEntry() : pushIntoStack(true), counterToDecrementWhenDone(NULL), eventToSignalWhenDone(NULL), hasPrivateDoneEvent(false), result(NULL) {}
+
+  WorkUnitPtr workUnit;
+  ExecutionStackPtr stack;
+  bool pushIntoStack;
+  int* counterToDecrementWhenDone;
+  const juce::WaitableEvent* eventToSignalWhenDone;
+  bool hasPrivateDoneEvent; // the event belongs to the waiter, see WorkStealingScheduler::waitForCounter()
+  ObjectPtr* result;
+  ExecutionContextCallbackPtr callback;
+
+  bool exists() const
+    {return workUnit;}
+};
+
+/*
+** WorkStealingDeque
+**
+** Each worker thread owns one deque. Entries are bucketed by stack depth so that,
+** as in WaitingWorkUnitQueue, the deepest work units are always executed first.
+** The owner pops from the front of the deepest bucket while thieves take from its back.
+** All the buckets share a single lock, so the owner and the thieves of a given deque are
+** serialized; contention stays low because thieves pick their victim with the lock-free
+** hints below, and each thread mostly works on its own deque.
+*/
+class WorkStealingDeque : public Object
+{
+public:
+  WorkStealingDeque() : numEntries(0), topPriority(-1) {}
+
+  void push(const WorkStealingEntry& entry, size_t priority)
+  {
+    ScopedLock _(lock);
+    getBucket(priority).push_back(entry);
+    juce::atomicIncrement(numEntries);
+  }
+
+  void push(const std::vector<WorkStealingEntry>& newEntries, size_t priority)
+  {
+    ScopedLock _(lock);
+    EntryDeque& bucket = getBucket(priority);
+    bucket.insert(bucket.end(), newEntries.begin(), newEntries.end());
+    for (size_t i = 0; i < newEntries.size(); ++i)
+      juce::atomicIncrement(numEntries);
+  }
+
+  bool popFront(WorkStealingEntry& res)
+    {return pop(res, true);}
+
+  bool popBack(WorkStealingEntry& res)
+    {return pop(res, false);}
+
+  // these two accessors are lock-free hints, they may be slightly out of date
+  bool isEmpty() const
+    {return numEntries == 0;}
+
+  int getTopPriority() const
+    {return topPriority;}
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  typedef std::deque<WorkStealingEntry> EntryDeque;
+
+  CriticalSection lock;
+  std::vector<EntryDeque> entries;
+  int numEntries;
+  volatile int topPriority;
+
+  EntryDeque& getBucket(size_t priority)
+  {
+    if (entries.size() <= priority)
+      entries.resize(priority + 1);
+    if ((int)priority > topPriority)
+      topPriority = (int)priority;
+    return entries[priority];
+  }
+
+  bool pop(WorkStealingEntry& res, bool fromFront)
+  {
+    ScopedLock _(lock);
+    for (int i = topPriority; i >= 0; --i)
+    {
+      EntryDeque& bucket = entries[i];
+      if (bucket.size())
+      {
+        if (fromFront)
+        {
+          res = bucket.front();
+          bucket.pop_front();
+        }
+        else
+        {
+          res = bucket.back();
+          bucket.pop_back();
+        }
+        juce::atomicDecrement(numEntries);
+        while (i >= 0 && entries[i].empty())
+          --i;
+        topPriority = i;
+        return true;
+      }
+    }
+    topPriority = -1;
+    return false;
+  }
+};
+
+typedef ReferenceCountedObjectPtr<WorkStealingDeque> WorkStealingDequePtr;
+
+/*
+** WorkStealingScheduler
+**
+** Owns one deque and one wake-up event per worker thread. Work units pushed from a
+** worker go to its own deque, work units pushed from the outside are spread among all
+** deques. Idle threads block on their wake-up event, which is signalled either when new
+** work is pushed or when one of the work units they are waiting for is finished.
+** Non-worker threads waiting for their own work units block on a private event instead,
+** so that no signal can be consumed by another waiter.
+*/
+class WorkStealingScheduler : public Object
+{
+public:
+  WorkStealingScheduler(size_t numThreads = 0)
+    : deques(numThreads), idleFlags(numThreads, 0), nextExternalDeque(0), numPendingWorkUnits(0)
+  {
+    for (size_t i = 0; i < numThreads; ++i)
+      deques[i] = new WorkStealingDeque();
+    wakeUpEvents.resize(numThreads + 1); // the last event is shared by non-worker threads
+    for (size_t i = 0; i < wakeUpEvents.size(); ++i)
+      wakeUpEvents[i] = new juce::WaitableEvent();
+  }
+
+  virtual ~WorkStealingScheduler()
+  {
+    for (size_t i = 0; i < wakeUpEvents.size(); ++i)
+      delete wakeUpEvents[i];
+  }
+
+  enum {externalThreadIndex = -1};
+
+  size_t getNumThreads() const
+    {return deques.size();}
+
+  const juce::WaitableEvent* getWakeUpEvent(int threadIndex) const
+    {return wakeUpEvents[threadIndex == externalThreadIndex ? deques.size() : (size_t)threadIndex];}
+
+  /*
+  ** Push
+  */
+  // if doneEvent is given, the caller must wait for the counter with waitForCounter()
+  void push(const WorkUnitPtr& workUnit, const ExecutionStackPtr& stack, int threadIndex, bool pushIntoStack,
+            int* counterToDecrementWhenDone = NULL, ObjectPtr* result = NULL, const ExecutionContextCallbackPtr& callback = ExecutionContextCallbackPtr(),
+            const juce::WaitableEvent* doneEvent = NULL)
+  {
+    bool hasPrivateDoneEvent = (doneEvent != NULL);
+    if (counterToDecrementWhenDone && !doneEvent)
+      doneEvent = getWakeUpEvent(threadIndex);
+    WorkStealingEntry entry(workUnit, stack->cloneAndCast<ExecutionStack>(), pushIntoStack, counterToDecrementWhenDone, doneEvent, result, callback);
+    entry.hasPrivateDoneEvent = hasPrivateDoneEvent;
+    juce::atomicIncrement(numPendingWorkUnits);
+    getTargetDeque(threadIndex)->push(entry, stack->getDepth());
+    wakeUpIdleThreads(1);
+  }
+
+  void push(const CompositeWorkUnitPtr& workUnits, const ExecutionStackPtr& s, int threadIndex, int* numRemainingWorkUnitsCounter, OVectorPtr results = OVectorPtr(),
+            const juce::WaitableEvent* privateDoneEvent = NULL)
+  {
+    ExecutionStackPtr stack = s->cloneAndCast<ExecutionStack>();
+    size_t priority = stack->getDepth();
+    size_t n = workUnits->getNumWorkUnits();
+    bool pushIntoStack = workUnits->hasPushChildrenIntoStackFlag();
+    const juce::WaitableEvent* doneEvent = privateDoneEvent ? privateDoneEvent : getWakeUpEvent(threadIndex);
+
+    *numRemainingWorkUnitsCounter = (int)n;
+    for (size_t i = 0; i < n; ++i)
+      juce::atomicIncrement(numPendingWorkUnits);
+
+    if (threadIndex == externalThreadIndex)
+    {
+      // spread the work units among all deques, so that each thread can start without stealing
+      size_t numDeques = deques.size();
+      std::vector< std::vector<WorkStealingEntry> > entries(numDeques);
+      for (size_t i = 0; i < n; ++i)
+      {
+        entries[i % numDeques].push_back(WorkStealingEntry(workUnits->getWorkUnit(i), stack, pushIntoStack,
+          numRemainingWorkUnitsCounter, doneEvent, results ? results->getDataPointer() + i : NULL));
+        entries[i % numDeques].back().hasPrivateDoneEvent = (privateDoneEvent != NULL);
+      }
+      for (size_t i = 0; i < numDeques; ++i)
+        if (entries[i].size())
+          deques[i]->push(entries[i], priority);
+    }
+    else
+    {
+      std::vector<WorkStealingEntry> entries;
+      entries.reserve(n);
+      for (size_t i = 0; i < n; ++i)
+      {
+        entries.push_back(WorkStealingEntry(workUnits->getWorkUnit(i), stack, pushIntoStack,
+          numRemainingWorkUnitsCounter, doneEvent, results ? results->getDataPointer() + i : NULL));
+        entries.back().hasPrivateDoneEvent = (privateDoneEvent != NULL);
+      }
+      deques[threadIndex]->push(entries, priority);
+    }
+    wakeUpIdleThreads(n);
+  }
+
+  /*
+  ** Pop
+  */
+  bool pop(size_t threadIndex, WorkStealingEntry& res)
+  {
+    const WorkStealingDequePtr& ownDeque = deques[threadIndex];
+
+    // find the victim having the deepest work units
+    int bestPriority = ownDeque->getTopPriority();
+    size_t bestVictim = threadIndex;
+    size_t n = deques.size();
+    for (size_t i = 1; i < n; ++i)
+    {
+      size_t victim = (threadIndex + i) % n;
+      int priority = deques[victim]->getTopPriority();
+      if (priority > bestPriority)
+        bestPriority = priority, bestVictim = victim;
+    }
+
+    if (bestVictim != threadIndex && deques[bestVictim]->popBack(res))
+      return true;
+    if (ownDeque->popFront(res))
+      return true;
+
+    // the hints were out of date: steal from anyone
+    for (size_t i = 1; i < n; ++i)
+      if (deques[(threadIndex + i) % n]->popBack(res))
+        return true;
+    return false;
+  }
+
+  bool hasWaitingWorkUnits() const
+  {
+    for (size_t i = 0; i < deques.size(); ++i)
+      if (!deques[i]->isEmpty())
+        return true;
+    return false;
+  }
+
+  bool isIdle() const
+    {return numPendingWorkUnits == 0;}
+
+  /*
+  ** Idle threads
+  */
+  void setThreadIdleFlag(size_t threadIndex, bool isIdle)
+  {
+    if (isIdle)
+      juce::atomicIncrement(idleFlags[threadIndex]);
+    else
+      juce::atomicDecrement(idleFlags[threadIndex]);
+  }
+
+  void wakeUpIdleThreads(size_t maxCount)
+  {
+    for (size_t i = 0; i < idleFlags.size() && maxCount > 0; ++i)
+      if (idleFlags[i])
+      {
+        wakeUpEvents[i]->signal();
+        --maxCount;
+      }
+  }
+
+  void wakeUpAllThreads()
+  {
+    for (size_t i = 0; i < wakeUpEvents.size(); ++i)
+      wakeUpEvents[i]->signal();
+  }
+
+  /*
+  ** Completion
+  */
+  void workUnitFinished(const WorkStealingEntry& entry, const ObjectPtr& result)
+  {
+    if (entry.result)
+      *entry.result = result;
+    if (entry.callback)
+      pushCallbackCall(entry.callback, entry.workUnit, result);
+    if (entry.counterToDecrementWhenDone)
+    {
+      if (entry.hasPrivateDoneEvent)
+      {
+        // the waiter destroys its event as soon as it sees the counter reach zero
+        ScopedLock _(privateDoneEventsLock);
+        juce::atomicDecrement(*entry.counterToDecrementWhenDone);
+        entry.eventToSignalWhenDone->signal();
+      }
+      else
+      {
+        juce::atomicDecrement(*entry.counterToDecrementWhenDone);
+        if (entry.eventToSignalWhenDone)
+          entry.eventToSignalWhenDone->signal();
+      }
+    }
+    if (juce::atomicDecrementAndReturn(numPendingWorkUnits) == 0)
+      getWakeUpEvent(externalThreadIndex)->signal();
+  }
+
+  // blocks until the counter reaches zero, doneEvent being the private event given to push()
+  void waitForCounter(const int& counter, const juce::WaitableEvent& doneEvent) const
+  {
+    while (true)
+    {
+      {
+        ScopedLock _(privateDoneEventsLock);
+        if (!counter)
+          return;
+      }
+      doneEvent.wait();
+    }
+  }
+
+  void pushCallbackCall(ExecutionContextCallbackPtr callback, const WorkUnitPtr& workUnit, const ObjectPtr& result)
+  {
+    CallbackInfo info;
+    info.callback = callback;
+    info.workUnit = workUnit;
+    info.result = result;
+    {
+      ScopedLock _(callbacksLock);
+      callbacks.push_back(info);
+    }
+    getWakeUpEvent(externalThreadIndex)->signal();
+  }
+
+  void flushCallbacks()
+  {
+    std::list<CallbackInfo> callbacks;
+    {
+      ScopedLock _(callbacksLock);
+      this->callbacks.swap(callbacks);
+    }
+    for (std::list<CallbackInfo>::iterator it = callbacks.begin(); it != callbacks.end(); ++it)
+      it->callback->workUnitFinished(it->workUnit, it->result, ExecutionTracePtr());
+  }
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  std::vector<WorkStealingDequePtr> deques;
+  std::vector<juce::WaitableEvent* > wakeUpEvents;
+  std::vector<int> idleFlags;
+  int nextExternalDeque;
+  int numPendingWorkUnits;
+  CriticalSection privateDoneEventsLock;
+
+  CriticalSection callbacksLock;
+  struct CallbackInfo
+  {
+    ExecutionContextCallbackPtr callback;
+    WorkUnitPtr workUnit;
+    ObjectPtr result;
+  };
+  std::list<CallbackInfo> callbacks;
+
+  const WorkStealingDequePtr& getTargetDeque(int threadIndex)
+  {
+    if (threadIndex != externalThreadIndex)
+      return deques[threadIndex];
+    int index = juce::atomicIncrementAndReturn(nextExternalDeque) & 0x7FFFFFFF;
+    return deques[index % deques.size()];
+  }
+};
+
+typedef ReferenceCountedObjectPtr<WorkStealingScheduler> WorkStealingSchedulerPtr;
+
+class WorkStealingThread;
+extern ExecutionContextPtr workStealingThreadOwnedExecutionContext(ExecutionContext& parentContext, WorkStealingThread* thread);
+
+/*
+** WorkStealingThread
+*/
+class WorkStealingThread : public Thread
+{
+public:
+  WorkStealingThread(ExecutionContext& parentContext, size_t index, WorkStealingSchedulerPtr scheduler)
+    : Thread(T("WorkStealingThread ") + string((int)index + 1)), index(index), scheduler(scheduler)
+  {
+    context = workStealingThreadOwnedExecutionContext(parentContext, this);
+    context->setProjectDirectory(parentContext.getProjectDirectory());
+  }
+
+  virtual ~WorkStealingThread()
+  {
+    signalThreadShouldExit();
+    scheduler->getWakeUpEvent((int)index)->signal();
+    stopThread(100);
+    context = ExecutionContextPtr();
+    scheduler = WorkStealingSchedulerPtr();
+  }
+
+  virtual void run()
+  {
+    while (!threadShouldExit())
+      if (!processOneWorkUnit())
+        waitForWork(NULL);
+  }
+
+  // while waiting for its children, the thread helps executing other work units
+  void workUntilWorkUnitsAreDone(const CompositeWorkUnitPtr& workUnits, int& counter)
+  {
+    size_t n = workUnits->getNumWorkUnits();
+    while (!threadShouldExit() && counter)
+    {
+      context->progressCallback(workUnits->getProgression(n - counter));
+      if (!processOneWorkUnit())
+        waitForWork(&counter);
+    }
+    context->progressCallback(workUnits->getProgression(n));
+  }
+
+  size_t getIndex() const
+    {return index;}
+
+  const WorkStealingSchedulerPtr& getScheduler() const
+    {return scheduler;}
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  size_t index;
+  ExecutionContextPtr context;
+  WorkStealingSchedulerPtr scheduler;
+
+  void waitForWork(int* counter)
+  {
+    scheduler->setThreadIdleFlag(index, true);
+    // check again once we are flagged as idle, so that no wake-up signal can be missed
+    if (!threadShouldExit() && !scheduler->hasWaitingWorkUnits() && (!counter || *counter))
+      scheduler->getWakeUpEvent((int)index)->wait();
+    scheduler->setThreadIdleFlag(index, false);
+  }
+
+  bool processOneWorkUnit()
+  {
+    WorkStealingEntry entry;
+    if (!scheduler->pop(index, entry))
+      return false;
+
+    // set new stack into context
+    ExecutionStackPtr previousStack = context->getStack();
+    ExecutionStackPtr entryStack = entry.stack->cloneAndCast<ExecutionStack>();
+    context->setStack(entryStack);
+
+    // thread begin callback
+    context->threadBeginCallback(entryStack);
+
+    // execute work unit
+    ObjectPtr result = context->run(entry.workUnit, entry.pushIntoStack);
+
+    // thread end callback and restore previous stack
+    context->threadEndCallback(entryStack);
+    context->setStack(previousStack);
+
+    // update result, counterToDecrement and callbacks
+    scheduler->workUnitFinished(entry, result);
+    return true;
+  }
+};
+
+/*
+** WorkStealingThreadVector
+*/
+class WorkStealingThreadVector : public Object
+{
+public:
+  WorkStealingThreadVector(size_t count)
+    : threads(count, NULL) {}
+  ~WorkStealingThreadVector()
+    {stopAndDestroyAllThreads();}
+
+  void startThread(size_t index, WorkStealingThread* newThread)
+    {jassert(!threads[index]); threads[index] = newThread; newThread->startThread();}
+
+  void stopAndDestroyAllThreads()
+  {
+    for (size_t i = 0; i < threads.size(); ++i)
+      if (threads[i])
+        threads[i]->signalThreadShouldExit();
+    if (threads.size() && threads[0])
+      threads[0]->getScheduler()->wakeUpAllThreads();
+    for (size_t i = 0; i < threads.size(); ++i)
+      if (threads[i])
+      {
+        delete threads[i];
+        threads[i] = NULL;
+      }
+    threads.clear();
+  }
+
+  size_t getNumThreads() const
+    {return threads.size();}
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  std::vector<WorkStealingThread* > threads;
+};
+
+typedef ReferenceCountedObjectPtr<WorkStealingThreadVector> WorkStealingThreadVectorPtr;
+
+/*
+** WorkStealingThreadOwnedExecutionContext
+*/
+class WorkStealingThreadOwnedExecutionContext : public SubExecutionContext
+{
+public:
+  WorkStealingThreadOwnedExecutionContext(ExecutionContext& parentContext, WorkStealingThread* thread)
+    : SubExecutionContext(parentContext), thread(thread) {}
+  WorkStealingThreadOwnedExecutionContext() : thread(NULL) {}
+
+  virtual bool isMultiThread() const
+    {return true;}
+
+  virtual bool isCanceled() const
+    {return thread->threadShouldExit();}
+
+  virtual bool isPaused() const
+    {return false;}
+
+  virtual ObjectPtr run(const WorkUnitPtr& workUnit, bool pushIntoStack = true)
+    {return ExecutionContext::run(workUnit, pushIntoStack);}
+
+  static void startParallelRun(ExecutionContext& context, CompositeWorkUnitPtr& workUnits, const WorkStealingSchedulerPtr& scheduler, int threadIndex, int& numRemainingWorkUnits, ObjectPtr& result,
+                               const juce::WaitableEvent* privateDoneEvent = NULL)
+  {
+    size_t numWorkUnits = workUnits->getNumWorkUnits();
+    // entries are cheap in a work stealing scheduler, so that we can afford finer batches than in MultiThreadedExecutionContext
+    size_t maxInParallel = scheduler->getNumThreads() * 16;
+
+    VectorPtr results = new OVector(objectClass, numWorkUnits);
+    result = results;
+    if (numWorkUnits > maxInParallel)
+    {
+      // in this case, the GroupedCompositeWorkUnit is responsible for directly filling the results vector
+      workUnits = new GroupedCompositeWorkUnit(workUnits, maxInParallel, results);
+      scheduler->push(workUnits, context.getStack(), threadIndex, &numRemainingWorkUnits, OVectorPtr(), privateDoneEvent);
+    }
+    else
+    {
+      // here, it is the execution context that is responsible for filling the results vector
+      scheduler->push(workUnits, context.getStack(), threadIndex, &numRemainingWorkUnits, results, privateDoneEvent);
+    }
+  }
+
+  virtual ObjectPtr run(const CompositeWorkUnitPtr& workUnits, bool pushIntoStack)
+  {
+    ObjectPtr result;
+    int numRemainingWorkUnits;
+    if (pushIntoStack)
+      enterScope(workUnits);
+    CompositeWorkUnitPtr wus = workUnits;
+    startParallelRun(*this, wus, thread->getScheduler(), (int)thread->getIndex(), numRemainingWorkUnits, result);
+    thread->workUntilWorkUnitsAreDone(wus, numRemainingWorkUnits);
+    if (pushIntoStack)
+      leaveScope(result);
+    return result;
+  }
+
+  virtual void pushWorkUnit(const WorkUnitPtr& workUnit, ExecutionContextCallbackPtr callback = NULL, bool pushIntoStack = true)
+    {thread->getScheduler()->push(workUnit, stack, (int)thread->getIndex(), pushIntoStack, NULL, NULL, callback);}
+
+  virtual void pushWorkUnit(const WorkUnitPtr& workUnit, int* counterToDecrementWhenDone = NULL, bool pushIntoStack = true)
+    {thread->getScheduler()->push(workUnit, stack, (int)thread->getIndex(), pushIntoStack, counterToDecrementWhenDone);}
+
+  lbcpp_UseDebuggingNewOperator
+
+protected:
+  WorkStealingThread* thread;
+};
+
+ExecutionContextPtr workStealingThreadOwnedExecutionContext(ExecutionContext& parentContext, WorkStealingThread* thread)
+  {return ExecutionContextPtr(new WorkStealingThreadOwnedExecutionContext(parentContext, thread));}
+
+/*
+** WorkStealingExecutionContext
+*/
+class WorkStealingExecutionContext : public ExecutionContext
+{
+public:
+  WorkStealingExecutionContext(size_t numThreads, const juce::File& projectDirectory)
+    : ExecutionContext(projectDirectory), scheduler(new WorkStealingScheduler(numThreads)), threads(new WorkStealingThreadVector(numThreads))
+  {
+    for (size_t i = 0; i < numThreads; ++i)
+      threads->startThread(i, new WorkStealingThread(*this, i, scheduler));
+  }
+  WorkStealingExecutionContext() {}
+
+  virtual ~WorkStealingExecutionContext()
+  {
+    if (threads)
+      threads->stopAndDestroyAllThreads();
+    threads = WorkStealingThreadVectorPtr();
+    scheduler = WorkStealingSchedulerPtr();
+  }
+
+  virtual string toString() const
+    {return T("WorkStealing(") + string((int)threads->getNumThreads()) + T(")");}
+
+  virtual bool isMultiThread() const
+    {return threads->getNumThreads() > 1;}
+
+  virtual size_t getNumThreads() const
+    {return threads->getNumThreads();}
+
+  virtual bool isCanceled() const
+    {return false;}
+
+  virtual bool isPaused() const
+    {return false;}
+
+  virtual void pushWorkUnit(const WorkUnitPtr& workUnit, ExecutionContextCallbackPtr callback = NULL, bool pushIntoStack = true)
+    {scheduler->push(workUnit, stack, WorkStealingScheduler::externalThreadIndex, pushIntoStack, NULL, NULL, callback);}
+
+  virtual void pushWorkUnit(const WorkUnitPtr& workUnit, int* counterToDecrementWhenDone = NULL, bool pushIntoStack = true)
+    {scheduler->push(workUnit, stack, WorkStealingScheduler::externalThreadIndex, pushIntoStack, counterToDecrementWhenDone);}
+
+  virtual void waitUntilAllWorkUnitsAreDone(size_t timeOutInMilliseconds)
+  {
+    // the scheduler signals this event whenever a callback is queued or the last work unit finishes
+    const juce::WaitableEvent* event = scheduler->getWakeUpEvent(WorkStealingScheduler::externalThreadIndex);
+    double startTime = juce::Time::getMillisecondCounterHiRes();
+    while (true)
+    {
+      scheduler->flushCallbacks();
+      if (scheduler->isIdle())
+        break;
+      int timeOut = -1;
+      if (timeOutInMilliseconds)
+      {
+        double remainingTime = startTime + timeOutInMilliseconds - juce::Time::getMillisecondCounterHiRes();
+        if (remainingTime <= 0.0)
+          break;
+        timeOut = (int)remainingTime + 1;
+      }
+      event->wait(timeOut);
+    }
+    // the event may be shared by several waiting threads: pass the signal on
+    event->signal();
+  }
+
+  virtual void flushCallbacks()
+    {scheduler->flushCallbacks();}
+
+  virtual ObjectPtr run(const WorkUnitPtr& workUnit, bool pushIntoStack)
+  {
+    int remainingWorkUnits = 1;
+    ObjectPtr result;
+    juce::WaitableEvent doneEvent;
+    scheduler->push(workUnit, stack, WorkStealingScheduler::externalThreadIndex, pushIntoStack, &remainingWorkUnits, &result, ExecutionContextCallbackPtr(), &doneEvent);
+    scheduler->waitForCounter(remainingWorkUnits, doneEvent);
+    return result;
+  }
+
+  virtual ObjectPtr run(const CompositeWorkUnitPtr& workUnits, bool pushIntoStack)
+  {
+    int numRemainingWorkUnits;
+    ObjectPtr result;
+    if (pushIntoStack)
+      enterScope(workUnits->toShortString(), workUnits);
+    CompositeWorkUnitPtr wus = workUnits;
+    juce::WaitableEvent doneEvent;
+    WorkStealingThreadOwnedExecutionContext::startParallelRun(*this, wus, scheduler, WorkStealingScheduler::externalThreadIndex, numRemainingWorkUnits, result, &doneEvent);
+    scheduler->waitForCounter(numRemainingWorkUnits, doneEvent);
+    if (pushIntoStack)
+      leaveScope(result);
+    return result;
+  }
+
+  lbcpp_UseDebuggingNewOperator
+
+private:
+  WorkStealingSchedulerPtr scheduler;
+  WorkStealingThreadVectorPtr threads;
+};
+
+}; /* namespace lbcpp */
+
+#endif //!OIL_EXECUTION_CONTEXT_WORK_STEALING_H_
@@ -112,13 +112,13 @@ void CompositeExecutionCallback::resultCallback(const string& name, const Object
   {notificationCallback(new ExecutionResultNotification(name, value));}
 
 void CompositeExecutionCallback::resultCallback(const string& name, bool value)
-  {resultCallback(name, ObjectPtr(new Boolean(value)));}
+  {resultCallback(name, ObjectPtr(Boolean::create(value)));}
 
 void CompositeExecutionCallback::resultCallback(const string& name, juce::int64 value)
-  {resultCallback(name, ObjectPtr(new Integer(value)));}
+  {resultCallback(name, ObjectPtr(Integer::create(value)));}
 
 void CompositeExecutionCallback::resultCallback(const string& name, size_t value)
-  {resultCallback(name, ObjectPtr(new PositiveInteger(value)));}
+  {resultCallback(name, ObjectPtr(Integer::create(positiveIntegerClass, value)));}
 
 void CompositeExecutionCallback::resultCallback(const string& name, double value)
   {resultCallback(name, ObjectPtr(new Double(value)));}
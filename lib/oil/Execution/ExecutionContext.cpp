@@ -8,6 +8,7 @@
 #include "precompiled.h"
 #include <oil/Execution/ExecutionContext.h>
 #include <oil/Execution/ExecutionStack.h>
+#include <oil/Execution/Profiler.h>
 #include <oil/Core.h>
 #include <oil/Core/RandomGenerator.h>
 #include <oil/Lua/Lua.h>
@@ -29,6 +30,8 @@ void ExecutionContext::enterScope(const string& description, const WorkUnitPtr&
 {
   preExecutionCallback(stack, description, workUnit);
   stack->push(description, workUnit);
+  if (Profiler::isEnabled())
+    Profiler::enter(workUnit ? workUnit->getClassName() : description);
 }
 
 void ExecutionContext::enterScope(const WorkUnitPtr& workUnit)
@@ -36,15 +39,16 @@ void ExecutionContext::enterScope(const WorkUnitPtr& workUnit)
 
 void ExecutionContext::leaveScope(const ObjectPtr& result)
 {
+  Profiler::leave();
   std::pair<string, WorkUnitPtr> entry = stack->pop();
   postExecutionCallback(stack, entry.first, entry.second, result);
 }
 
 void ExecutionContext::leaveScope(bool result)
-  {leaveScope(ObjectPtr(new Boolean(result)));}
+  {leaveScope(ObjectPtr(Boolean::create(result)));}
 
 void ExecutionContext::leaveScope(size_t result)
-  {leaveScope(ObjectPtr(new PositiveInteger(result)));}
+  {leaveScope(ObjectPtr(Integer::create(positiveIntegerClass, result)));}
 
 void ExecutionContext::leaveScope(double result)
   {leaveScope(ObjectPtr(new Double(result)));}
@@ -10,6 +10,7 @@
 #include <oil/Execution/ExecutionStack.h>
 #include <oil/Execution/WorkUnit.h>
 #include <oil/Core/XmlSerialisation.h>
+#include <oil/Core/BinarySerialisation.h>
 #include <oil/Core/String.h>
 #include <oil/Core/NativeToObject.h>
 #include <oil/Core/Table.h>
@@ -34,6 +35,12 @@ bool ExecutionTraceItem::loadFromXml(XmlImporter& importer)
   return true;
 }
 
+void ExecutionTraceItem::saveToBinary(BinaryExporter& exporter) const
+  {exporter.writeDouble(time);}
+
+bool ExecutionTraceItem::loadFromBinary(BinaryImporter& importer)
+  {time = importer.readDouble(); return importer.isOk();}
+
 /*
 ** MessageExecutionTraceItem
 */
@@ -101,6 +108,30 @@ bool MessageExecutionTraceItem::loadFromXml(XmlImporter& importer)
   return true;
 }
 
+void MessageExecutionTraceItem::saveToBinary(BinaryExporter& exporter) const
+{
+  ExecutionTraceItem::saveToBinary(exporter);
+  exporter.writeSize((size_t)messageType);
+  exporter.writeString(what);
+  exporter.writeString(where);
+}
+
+bool MessageExecutionTraceItem::loadFromBinary(BinaryImporter& importer)
+{
+  if (!ExecutionTraceItem::loadFromBinary(importer))
+    return false;
+  size_t type = importer.readSize();
+  if (type > errorMessageType)
+  {
+    importer.errorMessage(T("MessageExecutionTraceItem::loadFromBinary"), T("Unrecognized message type: ") + string((int)type));
+    return false;
+  }
+  messageType = (ExecutionMessageType)type;
+  what = importer.readString();
+  where = importer.readString();
+  return importer.isOk();
+}
+
 /*
 ** ExecutionTraceNode
 */
@@ -276,16 +307,72 @@ bool ExecutionTraceNode::loadFromXml(XmlImporter& importer)
   return loadSubItemsFromXml(importer);
 }
 
-void ExecutionTraceNode::setResult(const string& name, const ObjectPtr& value)
+void ExecutionTraceNode::saveToBinary(BinaryExporter& exporter) const
+{
+  ScopedLock _1(resultsLock);
+  ScopedLock _2(subItemsLock);
+
+  ExecutionTraceItem::saveToBinary(exporter);
+  exporter.writeString(description);
+  exporter.writeDouble(timeLength);
+  exporter.writeObject(progression, progressionStateClass);
+  exporter.writeObject(returnValue, objectClass);
+
+  exporter.writeSize(results.size());
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    exporter.writeName(results[i].first);
+    exporter.writeObject(results[i].second, objectClass);
+  }
+
+  exporter.writeSize(subItems.size());
+  for (size_t i = 0; i < subItems.size(); ++i)
+    exporter.writeObject(subItems[i], executionTraceNodeClass);
+}
+
+bool ExecutionTraceNode::loadFromBinary(BinaryImporter& importer)
+{
+  ScopedLock _1(resultsLock);
+  ScopedLock _2(subItemsLock);
+
+  if (!ExecutionTraceItem::loadFromBinary(importer))
+    return false;
+  description = importer.readString();
+  timeLength = importer.readDouble();
+  progression = importer.readObject(progressionStateClass).staticCast<ProgressionState>();
+  returnValue = importer.readObject(objectClass);
+
+  size_t n;
+  if (!importer.readNumElements(n, 2))
+    return false;
+  results.resize(n);
+  for (size_t i = 0; i < results.size() && importer.isOk(); ++i)
+  {
+    results[i].first = importer.readName();
+    results[i].second = importer.readObject(objectClass);
+  }
+
+  if (!importer.readNumElements(n))
+    return false;
+  subItems.resize(n);
+  for (size_t i = 0; i < subItems.size() && importer.isOk(); ++i)
+    subItems[i] = importer.readObject(executionTraceNodeClass).staticCast<ExecutionTraceItem>();
+  return importer.isOk();
+}
+
+bool ExecutionTraceNode::setResult(const string& name, const ObjectPtr& value, size_t maxNumResults)
 {
   ScopedLock _(resultsLock);
   for (size_t i = 0; i < results.size(); ++i)
     if (results[i].first == name)
     {
       results[i].second = value;
-      return;
+      return true;
     }
+  if (maxNumResults && results.size() >= maxNumResults)
+    return false;
   results.push_back(std::make_pair(name, value));
+  return true;
 }
 
 std::vector< std::pair<string, ObjectPtr> > ExecutionTraceNode::getResults() const
@@ -414,6 +501,24 @@ ExecutionTraceNodePtr ExecutionTrace::findNode(const ExecutionStackPtr& stack) c
   return res;
 }
 
+ExecutionTraceNodePtr ExecutionTrace::findDeepestNode(const ExecutionStackPtr& stack, size_t& depth) const
+{
+  ScopedLock _(lock);
+
+  jassert(root);
+  ExecutionTraceNodePtr res = root;
+  size_t d = stack->getDepth();
+  for (depth = 0; depth < d; ++depth)
+  {
+    const std::pair<string, WorkUnitPtr>& entry = stack->getEntry(depth);
+    ExecutionTraceNodePtr node = res->findSubNode(entry.first, entry.second);
+    if (!node)
+      break;
+    res = node;
+  }
+  return res;
+}
+
 void ExecutionTrace::saveToXml(XmlExporter& exporter) const
 {
   ScopedLock _(lock);
@@ -446,3 +551,35 @@ bool ExecutionTrace::loadFromXml(XmlImporter& importer)
   root = new ExecutionTraceNode(T("root"), WorkUnitPtr(), 0.0);
   return root->loadSubItemsFromXml(importer);
 }
+
+void ExecutionTrace::saveToBinary(BinaryExporter& exporter) const
+{
+  ScopedLock _(lock);
+
+  const_cast<ExecutionTrace* >(this)->saveTime = juce::Time::getCurrentTime();
+  exporter.writeString(operatingSystem);
+  exporter.writeBool(is64BitOs);
+  exporter.writeSize(numCpus);
+  exporter.writeInteger(cpuSpeedInMegaherz);
+  exporter.writeInteger(memoryInMegabytes);
+  exporter.writeString(context);
+  exporter.writeInteger(startTime.toMilliseconds());
+  exporter.writeInteger(saveTime.toMilliseconds());
+  exporter.writeObject(root, executionTraceNodeClass);
+}
+
+bool ExecutionTrace::loadFromBinary(BinaryImporter& importer)
+{
+  ScopedLock _(lock);
+
+  operatingSystem = importer.readString();
+  is64BitOs = importer.readBool();
+  numCpus = importer.readSize();
+  cpuSpeedInMegaherz = (int)importer.readInteger();
+  memoryInMegabytes = (int)importer.readInteger();
+  context = importer.readString();
+  startTime = juce::Time(importer.readInteger());
+  saveTime = juce::Time(importer.readInteger());
+  root = importer.readObject(executionTraceNodeClass).staticCast<ExecutionTraceNode>();
+  return importer.isOk() && root.exists();
+}
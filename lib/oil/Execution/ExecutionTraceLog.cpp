@@ -0,0 +1,271 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ExecutionTraceLog.cpp          | Append-only Execution Trace Log |
+| Author  : Francis Maes                   |                                 |
+| Started : 17/10/2026 14:40               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <oil/Execution/ExecutionTraceLog.h>
+#include <oil/Execution/ExecutionContext.h>
+#include <oil/Core/BinarySerialisation.h>
+using namespace lbcpp;
+
+static const char traceLogMagic[8] = {'L', 'B', 'C', 'P', 'P', 'L', 'O', 'G'};
+static const int traceLogVersion = 1;
+
+/*
+** ExecutionTraceRecord
+*/
+void ExecutionTraceRecord::setValue(ExecutionContext& context, const ObjectPtr& value)
+{
+  juce::MemoryOutputStream valueStream;
+  BinaryExporter exporter(context, valueStream);
+  exporter.writeObject(value, ClassPtr());
+  valueData = juce::MemoryBlock(valueStream.getData(), valueStream.getDataSize());
+}
+
+/*
+** ExecutionTraceLogWriter
+*/
+const char* ExecutionTraceLogWriter::fileExtension = "tracelog";
+
+ExecutionTraceLogWriter::ExecutionTraceLogWriter(ExecutionContext& context, const juce::File& file)
+  : context(context), file(file), ostr(NULL) {}
+
+ExecutionTraceLogWriter::~ExecutionTraceLogWriter()
+  {close();}
+
+bool ExecutionTraceLogWriter::open(const ExecutionTracePtr& trace)
+{
+  close();
+  if (file.existsAsFile() && !file.deleteFile())
+  {
+    context.errorCallback(T("ExecutionTraceLogWriter::open"), T("Could not delete file ") + file.getFullPathName());
+    return false;
+  }
+  ostr = file.createOutputStream();
+  if (!ostr)
+  {
+    context.errorCallback(T("ExecutionTraceLogWriter::open"), T("Could not open file ") + file.getFullPathName());
+    return false;
+  }
+  ostr->write(traceLogMagic, sizeof (traceLogMagic));
+  ostr->writeCompressedInt(traceLogVersion);
+  ostr->writeString(trace->getContextDescription());
+  ostr->writeInt64(ExecutionTraceRecord::getNodeIdentifier(trace->getRootNode()));
+  ostr->writeDouble(trace->getStartTime().toMilliseconds() / 1000.0);
+  ostr->flush();
+  return true;
+}
+
+bool ExecutionTraceLogWriter::write(const std::vector<ExecutionTraceRecord>& records)
+{
+  if (!ostr)
+    return false;
+
+  // each record is prefixed by its size, so that a truncated record can be detected when reading
+  juce::MemoryOutputStream recordStream;
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    const ExecutionTraceRecord& record = records[i];
+    recordStream.reset();
+    recordStream.writeByte((char)record.type);
+    recordStream.writeInt64(record.node);
+    recordStream.writeDouble(record.time);
+    switch (record.type)
+    {
+    case ExecutionTraceRecord::enterRecord:
+      recordStream.writeInt64(record.child);
+      recordStream.writeString(record.name);
+      break;
+    case ExecutionTraceRecord::messageRecord:
+      recordStream.writeCompressedInt((int)record.messageType);
+      recordStream.writeString(record.name);
+      recordStream.writeString(record.where);
+      break;
+    case ExecutionTraceRecord::resultRecord:
+      recordStream.writeString(record.name);
+      break;
+    default:
+      break;
+    };
+    if (record.type == ExecutionTraceRecord::leaveRecord || record.type == ExecutionTraceRecord::progressRecord || record.type == ExecutionTraceRecord::resultRecord)
+    {
+      jassert(record.valueData.getSize()); // see ExecutionTraceRecord::setValue()
+      recordStream.write(record.valueData.getData(), (int)record.valueData.getSize());
+    }
+    ostr->writeInt(recordStream.getDataSize());
+    ostr->write(recordStream.getData(), recordStream.getDataSize());
+  }
+  ostr->flush();
+  return true;
+}
+
+void ExecutionTraceLogWriter::close()
+{
+  if (ostr)
+  {
+    ostr->flush();
+    delete ostr;
+    ostr = NULL;
+  }
+}
+
+/*
+** ExecutionTraceLogReader
+*/
+ExecutionTraceLogReader::ExecutionTraceLogReader(ExecutionContext& context, juce::InputStream& istr)
+  : context(context), istr(istr) {}
+
+bool ExecutionTraceLogReader::isExecutionTraceLog(juce::InputStream& istr)
+{
+  char magic[sizeof (traceLogMagic)];
+  return istr.read(magic, sizeof (magic)) == (int)sizeof (magic) && !memcmp(magic, traceLogMagic, sizeof (magic));
+}
+
+ExecutionTracePtr ExecutionTraceLogReader::loadFromFile(ExecutionContext& context, const juce::File& file)
+{
+  if (!file.existsAsFile())
+  {
+    context.errorCallback(T("ExecutionTraceLogReader::loadFromFile"), file.getFullPathName() + T(" does not exists"));
+    return ExecutionTracePtr();
+  }
+  juce::FileInputStream* fileStream = file.createInputStream();
+  if (!fileStream)
+  {
+    context.errorCallback(T("ExecutionTraceLogReader::loadFromFile"), T("Could not open file ") + file.getFullPathName());
+    return ExecutionTracePtr();
+  }
+  juce::BufferedInputStream istr(fileStream, 0x10000, true);
+  ExecutionTraceLogReader reader(context, istr);
+  return reader.load();
+}
+
+ExecutionTracePtr ExecutionTraceLogReader::load()
+{
+  if (!isExecutionTraceLog(istr))
+  {
+    context.errorCallback(T("ExecutionTraceLogReader::load"), T("Not an execution trace log"));
+    return ExecutionTracePtr();
+  }
+  int version = istr.readCompressedInt();
+  if (version != traceLogVersion)
+  {
+    context.errorCallback(T("ExecutionTraceLogReader::load"), T("Unsupported version: ") + string(version));
+    return ExecutionTracePtr();
+  }
+  ExecutionTracePtr res = new ExecutionTrace(istr.readString());
+  nodes[istr.readInt64()] = res->getRootNode();
+  istr.readDouble(); // start time, the trace is time-stamped at loading
+
+  ExecutionTraceRecord record;
+  while (!istr.isExhausted() && readRecord(record))
+    applyRecord(record);
+
+  size_t numPendingRecords = 0;
+  for (PendingRecordsMap::const_iterator it = pendingRecords.begin(); it != pendingRecords.end(); ++it)
+    numPendingRecords += it->second.size();
+  if (numPendingRecords)
+    context.warningCallback(T("ExecutionTraceLogReader::load"), string((int)numPendingRecords) + T(" records refer to unknown nodes"));
+  return res;
+}
+
+bool ExecutionTraceLogReader::readRecord(ExecutionTraceRecord& res)
+{
+  int size = istr.readInt();
+  if (size <= 0)
+    return false;
+  juce::MemoryBlock block(size);
+  if (istr.read(block.getData(), size) != size)
+  {
+    context.warningCallback(T("ExecutionTraceLogReader::readRecord"), T("The log ends with an incomplete record"));
+    return false;
+  }
+
+  juce::MemoryInputStream recordStream(block.getData(), size, false);
+  res = ExecutionTraceRecord();
+  res.type = (ExecutionTraceRecord::Type)recordStream.readByte();
+  res.node = recordStream.readInt64();
+  res.time = recordStream.readDouble();
+  switch (res.type)
+  {
+  case ExecutionTraceRecord::enterRecord:
+    res.child = recordStream.readInt64();
+    res.name = recordStream.readString();
+    break;
+  case ExecutionTraceRecord::messageRecord:
+    res.messageType = (ExecutionMessageType)recordStream.readCompressedInt();
+    res.name = recordStream.readString();
+    res.where = recordStream.readString();
+    break;
+  case ExecutionTraceRecord::resultRecord:
+    res.name = recordStream.readString();
+    break;
+  case ExecutionTraceRecord::leaveRecord:
+  case ExecutionTraceRecord::progressRecord:
+    break;
+  default:
+    context.errorCallback(T("ExecutionTraceLogReader::readRecord"), T("Unknown record type: ") + string((int)res.type));
+    return false;
+  };
+  if (res.type == ExecutionTraceRecord::leaveRecord || res.type == ExecutionTraceRecord::progressRecord || res.type == ExecutionTraceRecord::resultRecord)
+  {
+    BinaryImporter importer(context, recordStream);
+    res.value = importer.readObject(ClassPtr());
+    if (!importer.isOk())
+      return false;
+  }
+  return true;
+}
+
+void ExecutionTraceLogReader::applyRecord(const ExecutionTraceRecord& record)
+{
+  // records written by different threads may refer to a node whose creation has not been read yet
+  NodeMap::const_iterator it = nodes.find(record.node);
+  if (it == nodes.end())
+  {
+    pendingRecords[record.node].push_back(record);
+    return;
+  }
+  const ExecutionTraceNodePtr& node = it->second;
+
+  switch (record.type)
+  {
+  case ExecutionTraceRecord::enterRecord:
+    {
+      ExecutionTraceNodePtr child = new ExecutionTraceNode(record.name, WorkUnitPtr(), record.time);
+      node->appendSubItem(child);
+      nodes[record.child] = child;
+
+      PendingRecordsMap::iterator it2 = pendingRecords.find(record.child);
+      if (it2 != pendingRecords.end())
+      {
+        std::vector<ExecutionTraceRecord> records;
+        records.swap(it2->second);
+        pendingRecords.erase(it2);
+        for (size_t i = 0; i < records.size(); ++i)
+          applyRecord(records[i]);
+      }
+    }
+    break;
+
+  case ExecutionTraceRecord::leaveRecord:
+    node->setEndTime(record.time);
+    node->setReturnValue(record.value);
+    break;
+
+  case ExecutionTraceRecord::messageRecord:
+    node->appendSubItem(new MessageExecutionTraceItem(record.time, record.messageType, record.name, record.where));
+    break;
+
+  case ExecutionTraceRecord::progressRecord:
+    node->setProgression(record.value.staticCast<ProgressionState>());
+    node->setEndTime(record.time);
+    break;
+
+  case ExecutionTraceRecord::resultRecord:
+    node->setResult(record.name, record.value);
+    break;
+  };
+}
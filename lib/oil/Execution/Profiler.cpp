@@ -0,0 +1,333 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: Profiler.cpp                   | Hot-path Profiler               |
+| Author  : Francis Maes                   |                                 |
+| Started : 17/10/2026 16:30               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+#include "precompiled.h"
+#include <oil/Execution/Profiler.h>
+#include <oil/Execution/ExecutionContext.h>
+#include <algorithm>
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif // _MSC_VER
+using namespace lbcpp;
+
+namespace lbcpp
+{
+
+struct ProfilerNode
+{
+  ProfilerNode(const string& name, ProfilerNode* parent)
+    : name(name), parent(parent), lastChild(NULL), numCalls(0), totalCycles(0), childCycles(0), numAllocations(0), numSamples(0), startCycles(0) {}
+  ~ProfilerNode()
+  {
+    for (size_t i = 0; i < children.size(); ++i)
+      delete children[i];
+  }
+
+  string name;
+  ProfilerNode* parent;
+  std::vector<ProfilerNode*> children;
+  ProfilerNode* lastChild; // consecutive calls to the same scope are frequent
+
+  size_t numCalls;
+  juce::int64 totalCycles;
+  juce::int64 childCycles;
+  size_t numAllocations;
+  volatile size_t numSamples; // incremented by the sampling thread
+
+  juce::int64 startCycles; // start of the current call
+
+  ProfilerNode* getChild(const string& name)
+  {
+    if (lastChild && lastChild->name == name)
+      return lastChild;
+    for (size_t i = 0; i < children.size(); ++i)
+      if (children[i]->name == name)
+        return lastChild = children[i];
+    ProfilerNode* res = new ProfilerNode(name, this);
+    children.push_back(res);
+    return lastChild = res;
+  }
+};
+
+struct ProfilerThreadState
+{
+  ProfilerThreadState() : root(T("root"), NULL), current(&root) {}
+
+  ProfilerNode root;
+  ProfilerNode* volatile current;
+
+  void clear()
+  {
+    for (size_t i = 0; i < root.children.size(); ++i)
+      delete root.children[i];
+    root.children.clear();
+    root.lastChild = NULL;
+    root.numAllocations = 0;
+    root.numSamples = 0;
+    current = &root;
+  }
+};
+
+class ProfilerSamplingThread : public juce::Thread
+{
+public:
+  ProfilerSamplingThread(size_t intervalInMilliseconds)
+    : juce::Thread(T("ProfilerSampling")), interval((int)intervalInMilliseconds) {}
+
+  virtual void run();
+
+private:
+  int interval;
+};
+
+}; /* namespace lbcpp */
+
+/*
+** Profiler state
+*/
+volatile bool Profiler::enabled = false;
+
+static juce_ThreadLocal ProfilerThreadState* profilerThreadState = NULL;
+
+static CriticalSection profilerLock;
+static std::vector<ProfilerThreadState*> profilerThreadStates; // never deleted, since threads keep a pointer to their state
+static ProfilerSamplingThread* profilerSamplingThread = NULL;
+
+// calibration of the cycle counter
+static juce::int64 profilerStartCycles = 0;
+static double profilerStartTime = 0.0;
+static double profilerCyclesPerSecond = 0.0;
+
+static ProfilerThreadState* getProfilerThreadState()
+{
+  if (!profilerThreadState)
+  {
+    ProfilerThreadState* state = new ProfilerThreadState();
+    ScopedLock _(profilerLock);
+    profilerThreadStates.push_back(state);
+    profilerThreadState = state;
+  }
+  return profilerThreadState;
+}
+
+void ProfilerSamplingThread::run()
+{
+  while (!threadShouldExit())
+  {
+    wait(interval);
+    ScopedLock _(profilerLock);
+    for (size_t i = 0; i < profilerThreadStates.size(); ++i)
+      ++profilerThreadStates[i]->current->numSamples;
+  }
+}
+
+juce::int64 Profiler::getCycleCount()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+  juce::uint32 low, high;
+  __asm__ __volatile__ ("rdtsc" : "=a" (low), "=d" (high));
+  return ((juce::int64)high << 32) | low;
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  return (juce::int64)__rdtsc();
+#else
+  return juce::Time::getHighResolutionTicks();
+#endif
+}
+
+static double getProfilerCyclesPerSecond()
+{
+  if (!Profiler::isEnabled() && profilerCyclesPerSecond > 0.0)
+    return profilerCyclesPerSecond;
+  double elapsedTime = (juce::Time::getMillisecondCounterHiRes() - profilerStartTime) / 1000.0;
+  juce::int64 elapsedCycles = Profiler::getCycleCount() - profilerStartCycles;
+  return elapsedTime > 0.0 && elapsedCycles > 0 ? elapsedCycles / elapsedTime : 1.0;
+}
+
+void Profiler::start(size_t samplingIntervalInMilliseconds)
+{
+  ScopedLock _(profilerLock);
+  if (enabled)
+    return;
+  // scopes that were opened while profiling was stopped will never be closed
+  for (size_t i = 0; i < profilerThreadStates.size(); ++i)
+    profilerThreadStates[i]->current = &profilerThreadStates[i]->root;
+  profilerStartCycles = getCycleCount();
+  profilerStartTime = juce::Time::getMillisecondCounterHiRes();
+  enabled = true;
+  if (samplingIntervalInMilliseconds)
+  {
+    profilerSamplingThread = new ProfilerSamplingThread(samplingIntervalInMilliseconds);
+    profilerSamplingThread->startThread();
+  }
+}
+
+void Profiler::stop()
+{
+  ProfilerSamplingThread* samplingThread;
+  {
+    ScopedLock _(profilerLock);
+    if (!enabled)
+      return;
+    profilerCyclesPerSecond = getProfilerCyclesPerSecond();
+    enabled = false;
+    samplingThread = profilerSamplingThread;
+    profilerSamplingThread = NULL;
+  }
+  if (samplingThread)
+  {
+    samplingThread->stopThread(-1);
+    delete samplingThread;
+  }
+}
+
+void Profiler::reset()
+{
+  ScopedLock _(profilerLock);
+  jassert(!enabled);
+  for (size_t i = 0; i < profilerThreadStates.size(); ++i)
+    profilerThreadStates[i]->clear();
+}
+
+void Profiler::enterImpl(const string& name)
+{
+  ProfilerThreadState* state = getProfilerThreadState();
+  ProfilerNode* node = state->current->getChild(name);
+  ++node->numCalls;
+  state->current = node;
+  node->startCycles = getCycleCount();
+}
+
+void Profiler::leaveImpl()
+{
+  juce::int64 cycles = getCycleCount();
+  ProfilerThreadState* state = getProfilerThreadState();
+  ProfilerNode* node = state->current;
+  if (!node->parent)
+    return; // this scope was entered before profiling started
+  juce::int64 length = cycles - node->startCycles;
+  node->totalCycles += length;
+  node->parent->childCycles += length;
+  state->current = node->parent;
+}
+
+void Profiler::countAllocationImpl()
+  {++getProfilerThreadState()->current->numAllocations;}
+
+/*
+** Reports
+*/
+namespace lbcpp
+{
+
+struct ProfilerScopeSummary
+{
+  ProfilerScopeSummary() : numCalls(0), totalCycles(0), selfCycles(0), numAllocations(0), numSamples(0) {}
+
+  string name;
+  size_t numCalls;
+  juce::int64 totalCycles;
+  juce::int64 selfCycles;
+  size_t numAllocations;
+  size_t numSamples;
+
+  bool operator <(const ProfilerScopeSummary& other) const
+    {return selfCycles > other.selfCycles;}
+};
+
+}; /* namespace lbcpp */
+
+static bool hasAncestorNamed(const ProfilerNode* node, const string& name)
+{
+  for (node = node->parent; node && node->parent; node = node->parent)
+    if (node->name == name)
+      return true;
+  return false;
+}
+
+static void summarizeProfilerNode(const ProfilerNode* node, std::map<string, ProfilerScopeSummary>& res)
+{
+  ProfilerScopeSummary& summary = res[node->name];
+  summary.name = node->name;
+  summary.numCalls += node->numCalls;
+  if (!hasAncestorNamed(node, node->name)) // recursive calls are already included in the total time of the outer call
+    summary.totalCycles += node->totalCycles;
+  summary.selfCycles += node->totalCycles - node->childCycles;
+  summary.numAllocations += node->numAllocations;
+  summary.numSamples += node->numSamples;
+  for (size_t i = 0; i < node->children.size(); ++i)
+    summarizeProfilerNode(node->children[i], res);
+}
+
+string Profiler::getSummary()
+{
+  jassert(!enabled);
+  ScopedLock _(profilerLock);
+  std::map<string, ProfilerScopeSummary> summaries;
+  for (size_t i = 0; i < profilerThreadStates.size(); ++i)
+  {
+    const ProfilerNode& root = profilerThreadStates[i]->root;
+    for (size_t j = 0; j < root.children.size(); ++j)
+      summarizeProfilerNode(root.children[j], summaries);
+  }
+
+  std::vector<ProfilerScopeSummary> sortedSummaries;
+  sortedSummaries.reserve(summaries.size());
+  for (std::map<string, ProfilerScopeSummary>::const_iterator it = summaries.begin(); it != summaries.end(); ++it)
+    sortedSummaries.push_back(it->second);
+  std::sort(sortedSummaries.begin(), sortedSummaries.end());
+
+  double millisecondsPerCycle = 1000.0 / getProfilerCyclesPerSecond();
+  string res = T("calls\ttotal (ms)\tself (ms)\tallocations\tsamples\tscope\n");
+  for (size_t i = 0; i < sortedSummaries.size(); ++i)
+  {
+    const ProfilerScopeSummary& summary = sortedSummaries[i];
+    res += string((juce::int64)summary.numCalls) + T("\t")
+      + string(summary.totalCycles * millisecondsPerCycle, 3) + T("\t")
+      + string(summary.selfCycles * millisecondsPerCycle, 3) + T("\t")
+      + string((juce::int64)summary.numAllocations) + T("\t")
+      + string((juce::int64)summary.numSamples) + T("\t")
+      + summary.name + T("\n");
+  }
+  return res;
+}
+
+static void makeFoldedStacks(const ProfilerNode* node, const string& path, double microsecondsPerCycle, std::map<string, juce::int64>& res)
+{
+  string name = node->name.replaceCharacter(';', ',');
+  string nodePath = path.isEmpty() ? name : path + T(";") + name;
+  juce::int64 selfTime = (juce::int64)((node->totalCycles - node->childCycles) * microsecondsPerCycle);
+  if (selfTime > 0)
+    res[nodePath] += selfTime;
+  for (size_t i = 0; i < node->children.size(); ++i)
+    makeFoldedStacks(node->children[i], nodePath, microsecondsPerCycle, res);
+}
+
+bool Profiler::saveFlameGraph(ExecutionContext& context, const juce::File& file)
+{
+  jassert(!enabled);
+  std::map<string, juce::int64> stacks;
+  {
+    ScopedLock _(profilerLock);
+    double microsecondsPerCycle = 1000000.0 / getProfilerCyclesPerSecond();
+    for (size_t i = 0; i < profilerThreadStates.size(); ++i)
+    {
+      const ProfilerNode& root = profilerThreadStates[i]->root;
+      for (size_t j = 0; j < root.children.size(); ++j)
+        makeFoldedStacks(root.children[j], string::empty, microsecondsPerCycle, stacks);
+    }
+  }
+
+  string text;
+  for (std::map<string, juce::int64>::const_iterator it = stacks.begin(); it != stacks.end(); ++it)
+    text += it->first + T(" ") + string(it->second) + T("\n");
+  if (!file.replaceWithText(text))
+  {
+    context.errorCallback(T("Profiler::saveFlameGraph"), T("Could not write file ") + file.getFullPathName());
+    return false;
+  }
+  return true;
+}
@@ -29,6 +29,7 @@
 #include <oil/Core/Library.h>
 #include <oil/Core/RandomGenerator.h>
 #include <oil/Core/DefaultClass.h>
+#include <oil/Execution/Profiler.h>
 
 #ifdef LBCPP_USER_INTERFACE
 # include <oil/UserInterface/UserInterfaceManager.h>
@@ -48,6 +49,10 @@ extern void coreLibraryCacheTypes(ExecutionContext& context);
 extern void coreLibraryUnCacheTypes();
 extern void lbCppLibraryCacheTypes(ExecutionContext& context);
 extern void lbCppLibraryUnCacheTypes();
+extern void cacheSharedBooleans();
+extern void uncacheSharedBooleans();
+extern void cacheSharedIntegers();
+extern void uncacheSharedIntegers();
 
 class TopLevelLibrary : public Library
 {
@@ -313,6 +318,8 @@ void lbcpp::initialize(const char* executableName)
   // types
   importLibrary(coreLibrary());
   importLibrary(lbCppLibrary());
+  cacheSharedBooleans();
+  cacheSharedIntegers();
 }
 
 void lbcpp::deinitialize()
@@ -327,6 +334,8 @@ void lbcpp::deinitialize()
 
     // pre shutdown types
     applicationContext->topLevelLibrary->preShutdown();
+    uncacheSharedBooleans();
+    uncacheSharedIntegers();
     coreLibraryUnCacheTypes();
     lbCppLibraryUnCacheTypes();
 
@@ -467,6 +476,7 @@ Object::Object(ClassPtr thisClass)
   : thisClass(thisClass)
 {
   lbcpp::applicationContext->memoryLeakDetector->newObject(this);
+  Profiler::countAllocation();
 }
 
 Object::~Object()
@@ -484,7 +494,8 @@ void Object::displayObjectAllocationInfo(std::ostream& ostr)
 #else
 
 Object::Object(ClassPtr thisClass)
-  : thisClass(thisClass) {}
+  : thisClass(thisClass)
+  {Profiler::countAllocation();}
 
 Object::~Object()
 {
@@ -8,24 +8,28 @@
 
 #include <oil/Execution/WorkUnit.h>
 #include <oil/Execution/ExecutionTrace.h>
+#include <oil/Execution/Profiler.h>
 #include <oil/library.h>
 using namespace lbcpp;
 
 void usage()
 {
-  std::cerr << "Usage: RunWorkUnit [--numThreads n --library lib --trace file.trace --traceAutoSave 60 --projectDirectory path] WorkUnitFile.xml" << std::endl;
-  std::cerr << "Usage: RunWorkUnit [--numThreads n --library lib --trace file.trace --traceAutoSave 60 --projectDirectory path] WorkUnitName WorkUnitArguments" << std::endl;
+  std::cerr << "Usage: RunWorkUnit [--numThreads n --workStealing --library lib --trace file.trace --traceAutoSave 60 --profile file.folded --projectDirectory path] WorkUnitFile.xml" << std::endl;
+  std::cerr << "Usage: RunWorkUnit [--numThreads n --workStealing --library lib --trace file.trace --traceAutoSave 60 --profile file.folded --projectDirectory path] WorkUnitName WorkUnitArguments" << std::endl;
   std::cerr << "  --numThreads : the number of threads to use. Default value: n = the number of cpus." << std::endl;
+  std::cerr << "  --workStealing : use per-thread work stealing queues instead of a single shared queue." << std::endl;
   std::cerr << "  --library : add a dynamic library to load." << std::endl;
   std::cerr << "  --trace : output file to save the execution trace." << std::endl;
   std::cerr << "  --traceAutoSave : the interval in seconds between two execution trace auto-saves." << std::endl;
+  std::cerr << "  --profile : output file to save the profile, in the folded stacks format of flamegraph.pl." << std::endl;
   std::cerr << "  --projectDirectory : project directory where find files." << std::endl;
 }
 
 bool parseTopLevelArguments(ExecutionContext& context, int argc, char** argv, std::vector<string>& remainingArguments,
-                            size_t& numThreads, juce::File& traceOutputFile, double& traceAutoSave, juce::File& projectDirectory)
+                            size_t& numThreads, bool& workStealing, juce::File& traceOutputFile, double& traceAutoSave, juce::File& profileOutputFile, juce::File& projectDirectory)
 {
   numThreads = 1;//(size_t)juce::SystemStats::getNumCpus();
+  workStealing = false;
   traceAutoSave = 0.0; // no auto save
   
   remainingArguments.reserve(argc - 1);
@@ -48,6 +52,8 @@ bool parseTopLevelArguments(ExecutionContext& context, int argc, char** argv, st
       }
       numThreads = (size_t)n;
     }
+    else if (argument == T("--workStealing"))
+      workStealing = true;
     else if (argument == T("--library"))
     {
       ++i;
@@ -82,6 +88,16 @@ bool parseTopLevelArguments(ExecutionContext& context, int argc, char** argv, st
       }
       traceAutoSave = string(argv[i]).getIntValue();
     }
+    else if (argument == T("--profile"))
+    {
+      ++i;
+      if (i == argc)
+      {
+        context.errorCallback(T("Invalid Syntax"));
+        return false;
+      }
+      profileOutputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[i]);
+    }
     else if (argument == T("--projectDirectory"))
     {
       ++i;
@@ -176,10 +192,12 @@ int mainImpl(int argc, char** argv)
   // parse top level arguments
   std::vector<string> arguments;
   size_t numThreads;
+  bool workStealing;
   juce::File traceOutputFile;
   double traceAutoSave;
+  juce::File profileOutputFile;
   juce::File projectDirectory;
-  if (!parseTopLevelArguments(defaultExecutionContext(), argc, argv, arguments, numThreads, traceOutputFile, traceAutoSave, projectDirectory))
+  if (!parseTopLevelArguments(defaultExecutionContext(), argc, argv, arguments, numThreads, workStealing, traceOutputFile, traceAutoSave, profileOutputFile, projectDirectory))
   {
     std::cerr << "Could not parse top level arguments." << std::endl;
     usage();
@@ -189,7 +207,13 @@ int mainImpl(int argc, char** argv)
   // replace default context
   if (projectDirectory == juce::File::nonexistent)
     projectDirectory = juce::File::getCurrentWorkingDirectory();
-  ExecutionContextPtr context = (numThreads == 1 ? singleThreadedExecutionContext(projectDirectory) : multiThreadedExecutionContext(numThreads, projectDirectory));
+  ExecutionContextPtr context;
+  if (numThreads == 1)
+    context = singleThreadedExecutionContext(projectDirectory);
+  else if (workStealing)
+    context = workStealingExecutionContext(numThreads, projectDirectory);
+  else
+    context = multiThreadedExecutionContext(numThreads, projectDirectory);
   setDefaultExecutionContext(context);
   context->appendCallback(consoleExecutionCallback());
   // add "make trace" callback
@@ -205,6 +229,9 @@ int mainImpl(int argc, char** argv)
     context->appendCallback(makeTraceCallback);
   }
 
+  if (profileOutputFile != juce::File::nonexistent)
+    Profiler::start();
+
   // run work unit either from file or from arguments
   int result = 0;
   jassert(arguments.size());
@@ -218,6 +245,15 @@ int mainImpl(int argc, char** argv)
     result = runWorkUnitFromArguments(*context, workUnitClassName, arguments) ? 0 : 1;
   }
 
+  // save profile
+  if (profileOutputFile != juce::File::nonexistent)
+  {
+    Profiler::stop();
+    context->informationCallback(T("Profile:\n") + Profiler::getSummary());
+    context->informationCallback(T("Saving profile into ") + profileOutputFile.getFullPathName());
+    Profiler::saveFlameGraph(*context, profileOutputFile);
+  }
+
   // save trace
   if (makeTraceCallback)
   {
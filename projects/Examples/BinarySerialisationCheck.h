@@ -0,0 +1,115 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: BinarySerialisationCheck.h     | Save/load round-trips through   |
+| Author  : Francis Maes                   |  the binary archives            |
+| Started : 16/10/2026 18:05               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_BINARY_SERIALISATION_CHECK_H_
+# define EXAMPLES_BINARY_SERIALISATION_CHECK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <oil/Core/BinarySerialisation.h>
+# include <oil/Core/Vector.h>
+# include <ml/DoubleVector.h>
+
+namespace lbcpp
+{
+
+/*
+** Saves a few objects to binary archives in memory, loads them back and checks that saving
+** the loaded objects produces the same archives. Truncated archives must be rejected with
+** an error instead of allocating the sizes they announce.
+*/
+class BinarySerialisationCheck : public WorkUnit
+{
+public:
+  BinarySerialisationCheck(size_t size = 1000) : size(size) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+
+    DenseDoubleVectorPtr dense = new DenseDoubleVector(size, 0.0);
+    SparseDoubleVectorPtr sparse = new SparseDoubleVector();
+    DVectorPtr dvector = new DVector(size);
+    SVectorPtr svector = new SVector(size / 10);
+    OVectorPtr ovector = new OVector(size / 10);
+    for (size_t i = 0; i < size; ++i)
+    {
+      dense->setValue(i, random->sampleDoubleFromGaussian());
+      dvector->set(i, random->sampleDouble());
+      if (random->sampleBool(0.1))
+        sparse->appendValue(i, random->sampleDoubleFromGaussian());
+    }
+    for (size_t i = 0; i < svector->getNumElements(); ++i)
+    {
+      svector->set(i, T("element ") + string((int)i));
+      ovector->set(i, i % 2 ? ObjectPtr(dense) : ObjectPtr(new Double(random->sampleDouble()))); // shared references
+    }
+
+    std::vector<ObjectPtr> objects;
+    objects.push_back(dense);
+    objects.push_back(sparse);
+    objects.push_back(dvector);
+    objects.push_back(svector);
+    objects.push_back(ovector);
+    objects.push_back(refCountedPointerFromThis(this));
+
+    size_t numErrors = 0;
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+      const ObjectPtr& object = objects[i];
+      juce::MemoryBlock archive;
+      save(context, object, archive);
+
+      ObjectPtr loaded = load(context, archive.getData(), archive.getSize());
+      juce::MemoryBlock reloadedArchive;
+      if (loaded)
+        save(context, loaded, reloadedArchive);
+      bool roundTripOk = loaded && loaded->getClass() == object->getClass() && reloadedArchive == archive;
+
+      // a truncated archive announces more elements than it contains
+      context.enterScope(T("Truncated ") + object->getClassName());
+      ObjectPtr truncated = load(context, archive.getData(), archive.getSize() / 2);
+      context.leaveScope(!truncated);
+
+      context.resultCallback(object->getClassName(), roundTripOk && !truncated);
+      if (!roundTripOk || truncated)
+        ++numErrors;
+    }
+
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" failed round-trips"));
+    else
+      context.informationCallback(T("All round-trips succeeded"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class BinarySerialisationCheckClass;
+
+  size_t size;
+
+  static void save(ExecutionContext& context, const ObjectPtr& object, juce::MemoryBlock& res)
+  {
+    juce::MemoryOutputStream ostr;
+    BinaryExporter exporter(context, ostr);
+    exporter.writeHeader();
+    exporter.writeObject(object, ClassPtr());
+    res = juce::MemoryBlock(ostr.getData(), ostr.getDataSize());
+  }
+
+  static ObjectPtr load(ExecutionContext& context, const void* data, size_t size)
+  {
+    juce::MemoryInputStream istr(data, size, false);
+    BinaryImporter importer(context, istr);
+    return importer.readHeader() ? importer.load() : ObjectPtr();
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_BINARY_SERIALISATION_CHECK_H_
@@ -0,0 +1,62 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: BinaryTableConversion.h        | Converts a Table file to the    |
+| Author  : Francis Maes                   |  binary columnar format         |
+| Started : 16/10/2026 21:50               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_BINARY_TABLE_CONVERSION_H_
+# define EXAMPLES_BINARY_TABLE_CONVERSION_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <ml/BinaryTable.h>
+
+namespace lbcpp
+{
+
+/*
+** Loads a table with any registered loader (e.g. an ARFF file), saves it in the binary
+** format and reopens the result to compare the loading times.
+*/
+class BinaryTableConversion : public WorkUnit
+{
+public:
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    if (outputFile == juce::File::nonexistent)
+      outputFile = inputFile.withFileExtension(T("lbtable"));
+
+    double startTime = juce::Time::getMillisecondCounterHiRes();
+    TablePtr table = Object::createFromFile(context, inputFile).dynamicCast<Table>();
+    if (!table)
+    {
+      context.errorCallback(T("Could not load table from ") + inputFile.getFullPathName());
+      return ObjectPtr();
+    }
+    context.resultCallback(T("inputLoadingTime"), (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0);
+    context.informationCallback(string((int)table->getNumRows()) + T(" rows, ") + string((int)table->getNumColumns()) + T(" columns"));
+
+    if (!BinaryTable::save(context, table, outputFile))
+      return ObjectPtr();
+
+    startTime = juce::Time::getMillisecondCounterHiRes();
+    BinaryTablePtr binaryTable = BinaryTable::open(context, outputFile);
+    if (!binaryTable)
+      return ObjectPtr();
+    context.resultCallback(T("mappingTime"), (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0);
+    TablePtr res = binaryTable->createTable(context);
+    context.resultCallback(T("binaryLoadingTime"), (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0);
+    return res;
+  }
+
+protected:
+  friend class BinaryTableConversionClass;
+
+  juce::File inputFile;
+  juce::File outputFile;
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_BINARY_TABLE_CONVERSION_H_
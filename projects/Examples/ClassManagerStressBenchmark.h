@@ -0,0 +1,158 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ClassManagerStressBenchmark.h  | Concurrent lookups and          |
+| Author  : Francis Maes                   |  declarations of classes        |
+| Started : 16/10/2026 23:10               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_CLASS_MANAGER_STRESS_BENCHMARK_H_
+# define EXAMPLES_CLASS_MANAGER_STRESS_BENCHMARK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/ClassManager.h>
+# include <oil/Core/DefaultClass.h>
+# include <oil/Core/Pair.h>
+# include <oil/Core/Vector.h>
+
+namespace lbcpp
+{
+
+class ClassManagerStressWorkUnit : public WorkUnit
+{
+public:
+  ClassManagerStressWorkUnit(const std::vector<ClassPtr>& classes, const string& declarationPrefix, size_t numLookups, size_t declarationPeriod,
+                             std::vector<ClassPtr>& pairClasses, size_t& numErrors)
+    : classes(classes), declarationPrefix(declarationPrefix), numLookups(numLookups), declarationPeriod(declarationPeriod), pairClasses(pairClasses), numErrors(numErrors) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    ClassManager& manager = typeManager();
+    size_t n = classes.size();
+    size_t numDeclarations = 0;
+    numErrors = 0;
+    for (size_t i = 0; i < numLookups; ++i)
+    {
+      const ClassPtr& expected = classes[i % n];
+      if (manager.getType(context, expected->getName()) != expected)
+        ++numErrors;
+
+      if (declarationPeriod && (i % declarationPeriod) == 0)
+      {
+        // instantiates or finds a template instance, and declares a new class
+        size_t pairIndex = (i / declarationPeriod) % pairClasses.size();
+        ClassPtr pair = pairClass(classes[pairIndex / n], classes[pairIndex % n]);
+        if (!pair || (pairClasses[pairIndex] && pairClasses[pairIndex] != pair))
+          ++numErrors;
+        pairClasses[pairIndex] = pair;
+
+        string name = declarationPrefix + string((int)numDeclarations++);
+        ClassPtr declared = new DefaultClass(name, objectClass);
+        if (!manager.declare(context, declared) || manager.findType(name) != declared)
+          ++numErrors;
+      }
+    }
+    return ObjectPtr();
+  }
+
+private:
+  const std::vector<ClassPtr>& classes;
+  string declarationPrefix;
+  size_t numLookups;
+  size_t declarationPeriod;
+  std::vector<ClassPtr>& pairClasses; // each work unit writes its own vector
+  size_t& numErrors;
+};
+
+/*
+** Measures how the class lookups scale with the number of threads (1, 2, 4, ..., maxNumWorkers),
+** while some of the threads instantiate template classes and declare new classes. Each worker
+** makes numLookups lookups by name, and every declarationPeriod lookups, it gets a Pair class and
+** declares a class whose name is unique. All the workers must find the same classes and the same
+** Pair instances. The declared classes stay in the class manager until shutdown.
+*/
+class ClassManagerStressBenchmark : public WorkUnit
+{
+public:
+  ClassManagerStressBenchmark(size_t numLookups = 1000000, size_t declarationPeriod = 1000, size_t maxNumWorkers = 8)
+    : numLookups(numLookups), declarationPeriod(declarationPeriod), maxNumWorkers(maxNumWorkers) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    std::vector<ClassPtr> classes;
+    classes.push_back(objectClass);
+    classes.push_back(booleanClass);
+    classes.push_back(integerClass);
+    classes.push_back(doubleClass);
+    classes.push_back(stringClass);
+    classes.push_back(workUnitClass);
+    classes.push_back(vectorClass(doubleClass)); // template instances are looked up by their full name
+    classes.push_back(pairClass(doubleClass, integerClass));
+
+    static int runCounter = 0;
+    int runIndex = juce::atomicIncrementAndReturn(runCounter);
+
+    std::vector<size_t> numWorkers;
+    for (size_t n = 1; n < maxNumWorkers; n *= 2)
+      numWorkers.push_back(n);
+    numWorkers.push_back(juce::jmax(1, (int)maxNumWorkers));
+
+    size_t totalErrors = 0;
+    double referenceThroughput = 0.0;
+    for (size_t c = 0; c < numWorkers.size(); ++c)
+    {
+      size_t n = numWorkers[c];
+      std::vector< std::vector<ClassPtr> > pairClasses(n, std::vector<ClassPtr>(classes.size() * classes.size()));
+      std::vector<size_t> numErrors(n, 0);
+      CompositeWorkUnitPtr workUnits = new CompositeWorkUnit(string((int)n) + T(" workers"), n);
+      for (size_t i = 0; i < n; ++i)
+      {
+        string prefix = T("ClassManagerStress") + string(runIndex) + T("_") + string((int)c) + T("_") + string((int)i) + T("_");
+        workUnits->setWorkUnit(i, new ClassManagerStressWorkUnit(classes, prefix, numLookups, declarationPeriod, pairClasses[i], numErrors[i]));
+      }
+
+      double startTime = juce::Time::getMillisecondCounterHiRes();
+      context.run(workUnits, false);
+      double time = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+      // all the workers must have found the same template instances
+      size_t errors = 0;
+      for (size_t i = 0; i < n; ++i)
+      {
+        errors += numErrors[i];
+        for (size_t j = 0; j < pairClasses[i].size(); ++j)
+          if (pairClasses[i][j] && pairClasses[i][j] != pairClass(classes[j / classes.size()], classes[j % classes.size()]))
+            ++errors;
+      }
+      totalErrors += errors;
+
+      double throughput = time > 0.0 ? n * numLookups / time : 0.0;
+      if (c == 0)
+        referenceThroughput = throughput;
+      context.enterScope(string((int)n) + T(" workers"));
+      context.resultCallback(T("numWorkers"), n);
+      context.resultCallback(T("time"), time);
+      context.resultCallback(T("lookupsPerSecond"), throughput);
+      context.resultCallback(T("speedUp"), referenceThroughput > 0.0 ? throughput / referenceThroughput : 0.0);
+      context.resultCallback(T("numErrors"), errors);
+      context.leaveScope(throughput);
+    }
+
+    if (totalErrors)
+      context.errorCallback(string((int)totalErrors) + T(" wrong lookups or declarations"));
+    else
+      context.informationCallback(T("All lookups and declarations succeeded"));
+    return Boolean::create(totalErrors == 0);
+  }
+
+protected:
+  friend class ClassManagerStressBenchmarkClass;
+
+  size_t numLookups;
+  size_t declarationPeriod;
+  size_t maxNumWorkers;
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_CLASS_MANAGER_STRESS_BENCHMARK_H_
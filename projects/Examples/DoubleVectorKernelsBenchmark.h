@@ -0,0 +1,193 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: DoubleVectorKernelsBenchmark.h | Micro-benchmark of the Double   |
+| Author  : Francis Maes                   |  Vector kernels                 |
+| Started : 16/10/2026 15:05               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_DOUBLE_VECTOR_KERNELS_BENCHMARK_H_
+# define EXAMPLES_DOUBLE_VECTOR_KERNELS_BENCHMARK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <ml/DoubleVector.h>
+# include <ml/DoubleVectorKernels.h>
+
+namespace lbcpp
+{
+
+/*
+** Compares the DenseDoubleVector / SparseDoubleVector operations, which go through
+** DoubleVectorKernels, with the plain scalar loops they used before.
+*/
+class DoubleVectorKernelsBenchmark : public WorkUnit
+{
+public:
+  DoubleVectorKernelsBenchmark(size_t size = 1000, size_t numIterations = 100000, double sparsity = 0.1)
+    : size(size), numIterations(numIterations), sparsity(sparsity) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    DenseDoubleVectorPtr a = new DenseDoubleVector(size, 0.0);
+    DenseDoubleVectorPtr b = new DenseDoubleVector(size, 0.0);
+    SparseDoubleVectorPtr s = new SparseDoubleVector();
+    for (size_t i = 0; i < size; ++i)
+    {
+      a->setValue(i, random->sampleDoubleFromGaussian());
+      b->setValue(i, random->sampleDoubleFromGaussian());
+      if (random->sampleBool(sparsity))
+        s->appendValue(i, random->sampleDoubleFromGaussian());
+    }
+    const double* pa = a->getValuePointer(0);
+    const double* pb = b->getValuePointer(0);
+    const std::pair<size_t, double>* ps = s->getValues();
+    size_t ns = s->getNumValues();
+
+    context.informationCallback(T("Instruction set: ") + string(DoubleVectorKernels::getInstructionSetName()));
+    context.informationCallback(T("Size: ") + string((int)size) + T(", ") + string((int)ns) + T(" sparse values, ") + string((int)numIterations) + T(" iterations"));
+
+    double time, checksum;
+
+    // dotProduct
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      double res = 0.0;
+      for (size_t i = 0; i < size; ++i)
+        res += pa[i] * pb[i];
+      checksum += res;
+    }
+    double scalarTime = stopTimer(time);
+    double scalarChecksum = checksum;
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      checksum += a->dotProduct(b, 0);
+    reportResult(context, T("dotProduct"), scalarTime, stopTimer(time), scalarChecksum, checksum);
+
+    // addWeightedTo
+    DenseDoubleVectorPtr target = new DenseDoubleVector(size, 0.0);
+    double* pt = target->getValuePointer(0);
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      for (size_t i = 0; i < size; ++i)
+        pt[i] += 1e-6 * pa[i];
+    scalarTime = stopTimer(time);
+    scalarChecksum = target->l1norm();
+    target = new DenseDoubleVector(size, 0.0);
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      a->addWeightedTo(target, 0, 1e-6);
+    reportResult(context, T("addWeightedTo"), scalarTime, stopTimer(time), scalarChecksum, target->l1norm());
+
+    // sumOfSquares
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      double res = 0.0;
+      for (size_t i = 0; i < size; ++i)
+        res += pa[i] * pa[i];
+      checksum += res;
+    }
+    scalarTime = stopTimer(time);
+    scalarChecksum = checksum;
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      checksum += a->sumOfSquares();
+    reportResult(context, T("sumOfSquares"), scalarTime, stopTimer(time), scalarChecksum, checksum);
+
+    // l2norm
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      double res = 0.0;
+      for (size_t i = 0; i < size; ++i)
+        res += (pa[i] - pb[i]) * (pa[i] - pb[i]);
+      checksum += sqrt(res);
+    }
+    scalarTime = stopTimer(time);
+    scalarChecksum = checksum;
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      checksum += a->l2norm(b);
+    reportResult(context, T("l2norm"), scalarTime, stopTimer(time), scalarChecksum, checksum);
+
+    // computeLogSumOfExponentials
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      double highestValue = a->getMaximumValue();
+      double res = 0.0;
+      for (size_t i = 0; i < size; ++i)
+        res += exp(pa[i] - highestValue);
+      checksum += log(res) + highestValue;
+    }
+    scalarTime = stopTimer(time);
+    scalarChecksum = checksum;
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      checksum += a->computeLogSumOfExponentials();
+    reportResult(context, T("computeLogSumOfExponentials"), scalarTime, stopTimer(time), scalarChecksum, checksum);
+
+    // sparse dotProduct
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      double res = 0.0;
+      for (size_t i = 0; i < ns; ++i)
+        res += pb[ps[i].first] * ps[i].second;
+      checksum += res;
+    }
+    scalarTime = stopTimer(time);
+    scalarChecksum = checksum;
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      checksum += s->dotProduct(b, 0);
+    reportResult(context, T("sparse dotProduct"), scalarTime, stopTimer(time), scalarChecksum, checksum);
+
+    // sparse addWeightedTo
+    target = new DenseDoubleVector(size, 0.0);
+    pt = target->getValuePointer(0);
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      for (size_t i = 0; i < ns; ++i)
+        pt[ps[i].first] += ps[i].second * 1e-6;
+    scalarTime = stopTimer(time);
+    scalarChecksum = target->l1norm();
+    target = new DenseDoubleVector(size, 0.0);
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      s->addWeightedTo(target, 0, 1e-6);
+    reportResult(context, T("sparse addWeightedTo"), scalarTime, stopTimer(time), scalarChecksum, target->l1norm());
+
+    return ObjectPtr();
+  }
+
+protected:
+  friend class DoubleVectorKernelsBenchmarkClass;
+
+  size_t size;
+  size_t numIterations;
+  double sparsity;
+
+  static double startTimer(double& checksum)
+    {checksum = 0.0; return juce::Time::getMillisecondCounterHiRes();}
+
+  static double stopTimer(double startTime)
+    {return (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;}
+
+  void reportResult(ExecutionContext& context, const string& name, double scalarTime, double kernelTime, double scalarChecksum, double kernelChecksum)
+  {
+    context.enterScope(name);
+    context.resultCallback(T("scalarTime"), scalarTime);
+    context.resultCallback(T("kernelTime"), kernelTime);
+    context.resultCallback(T("speedUp"), kernelTime > 0.0 ? scalarTime / kernelTime : 0.0);
+    context.resultCallback(T("relativeError"), fabs(kernelChecksum - scalarChecksum) / juce::jmax(fabs(scalarChecksum), 1e-12));
+    context.leaveScope(kernelTime > 0.0 ? scalarTime / kernelTime : 0.0);
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_DOUBLE_VECTOR_KERNELS_BENCHMARK_H_
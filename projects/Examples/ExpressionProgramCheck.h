@@ -0,0 +1,93 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ExpressionProgramCheck.h       | Checks the block-wise evaluation|
+| Author  : Francis Maes                   |  of expressions                 |
+| Started : 16/10/2026 17:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_EXPRESSION_PROGRAM_CHECK_H_
+# define EXAMPLES_EXPRESSION_PROGRAM_CHECK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <oil/Core/Table.h>
+# include <ml/Expression.h>
+# include <ml/ExpressionDomain.h>
+# include <ml/Function.h>
+# include <ml/IndexSet.h>
+
+namespace lbcpp
+{
+
+/*
+** Compares the block-wise evaluation of an expression on a set of rows (see
+** FunctionExpression::computeSamples()) with its row by row evaluation, on
+** contiguous row sets and on bootstrap samples, which are sorted but contain duplicates.
+*/
+class ExpressionProgramCheck : public WorkUnit
+{
+public:
+  ExpressionProgramCheck(size_t numSamples = 1000, size_t numBootstraps = 10)
+    : numSamples(numSamples), numBootstraps(numBootstraps) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    ExpressionDomainPtr domain = new ExpressionDomain();
+    VariableExpressionPtr x = domain->addInput(doubleClass, "x");
+    VariableExpressionPtr y = domain->addInput(doubleClass, "y");
+
+    TablePtr data = new Table(numSamples);
+    data->addColumn(x, doubleClass);
+    data->addColumn(y, doubleClass);
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+      data->setElement(i, 0, new Double(random->sampleDoubleFromGaussian()));
+      data->setElement(i, 1, new Double(random->sampleDoubleFromGaussian()));
+    }
+
+    // x * y + sin(x)
+    ExpressionPtr expression = new FunctionExpression(addDoubleFunction(),
+      new FunctionExpression(mulDoubleFunction(), x, y),
+      new FunctionExpression(sinDoubleFunction(), x));
+
+    size_t numErrors = 0;
+    IndexSetPtr all = new IndexSet(numSamples);
+    numErrors += checkIndices(context, expression, data, all, T("all rows"));
+    numErrors += checkIndices(context, expression, data, new IndexSet(numSamples / 3, numSamples / 2), T("interval"));
+    for (size_t i = 0; i < numBootstraps; ++i)
+      numErrors += checkIndices(context, expression, data, all->sampleBootStrap(random), T("bootstrap ") + string((int)i + 1));
+
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" mismatching predictions"));
+    else
+      context.informationCallback(T("All predictions match"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class ExpressionProgramCheckClass;
+
+  size_t numSamples;
+  size_t numBootstraps;
+
+  size_t checkIndices(ExecutionContext& context, const ExpressionPtr& expression, const TablePtr& data, const IndexSetPtr& indices, const string& name) const
+  {
+    DataVectorPtr predictions = expression->compute(context, data, indices);
+    size_t numErrors = 0;
+    IndexSet::const_iterator index = indices->begin();
+    for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it, ++index)
+    {
+      double expected = Double::get(expression->compute(context, data->getRow(*index)));
+      if (fabs(it.getRawDouble() - expected) > 1e-12)
+        ++numErrors;
+    }
+    context.resultCallback(name, numErrors);
+    return numErrors;
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_EXPRESSION_PROGRAM_CHECK_H_
@@ -0,0 +1,140 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: HyperVolumeCheck.h             | Checks the incremental          |
+| Author  : Francis Maes                   |  hypervolume of Pareto fronts   |
+| Started : 16/10/2026 19:10               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_HYPER_VOLUME_CHECK_H_
+# define EXAMPLES_HYPER_VOLUME_CHECK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <ml/Fitness.h>
+# include <ml/HyperVolume.h>
+# include <ml/SolutionContainer.h>
+
+namespace lbcpp
+{
+
+/*
+** Inserts random points into Pareto fronts with two to four objectives, removes some of them,
+** and compares the cached hypervolume of the front (see ParetoFront::computeHyperVolume()) with
+** the hypervolume computed from scratch after each modification. At the end, the exclusive
+** contributions and the Monte Carlo estimate are checked against the exact hypervolume.
+*/
+class HyperVolumeCheck : public WorkUnit
+{
+public:
+  HyperVolumeCheck(size_t numPoints = 200, size_t numSamples = 100000)
+    : numPoints(numPoints), numSamples(numSamples) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    size_t numErrors = 0;
+    for (size_t numObjectives = 2; numObjectives <= 4; ++numObjectives)
+    {
+      context.enterScope(string((int)numObjectives) + T(" objectives"));
+      size_t errors = checkFront(context, numObjectives);
+      context.leaveScope(errors);
+      numErrors += errors;
+    }
+
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" wrong hypervolumes"));
+    else
+      context.informationCallback(T("All hypervolumes match"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class HyperVolumeCheckClass;
+
+  size_t numPoints;
+  size_t numSamples;
+
+  size_t checkFront(ExecutionContext& context, size_t numObjectives) const
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    FitnessLimitsPtr limits = new FitnessLimits();
+    for (size_t i = 0; i < numObjectives; ++i)
+      limits->addObjective(1.0, 0.0); // minimisation in [0, 1], the reference point is (1, ..., 1)
+    std::vector<double> reference(numObjectives, 1.0);
+
+    ParetoFrontPtr front = new ParetoFront(limits);
+    size_t numErrors = 0;
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+      // half of the points lie on a sphere, so that many of them are mutually non-dominated
+      std::vector<double> values(numObjectives);
+      double norm = 0.0;
+      for (size_t j = 0; j < numObjectives; ++j)
+      {
+        values[j] = random->sampleDouble();
+        norm += values[j] * values[j];
+      }
+      if (random->sampleBool())
+        for (size_t j = 0; j < numObjectives; ++j)
+          values[j] *= 0.9 / sqrt(norm);
+      front->insertSolution(new Double((double)i), new Fitness(values, limits));
+      if (front->getNumSolutions() > 1 && random->sampleBool(0.1))
+        front->removeSolution(random->sampleSize(front->getNumSolutions()));
+
+      if (!isClose(front->computeHyperVolume(), computeFromScratch(front, reference)))
+        ++numErrors;
+    }
+
+    // exclusive contributions
+    std::vector<double> points;
+    getPoints(front, points);
+    size_t n = front->getNumSolutions();
+    double hyperVolume = HyperVolume::compute(&points[0], n, numObjectives, &reference[0]);
+    std::vector<double> contributions;
+    front->computeHyperVolumeContributions(contributions);
+    for (size_t i = 0; i < n; ++i)
+    {
+      std::vector<double> otherPoints(points);
+      otherPoints.erase(otherPoints.begin() + i * numObjectives, otherPoints.begin() + (i + 1) * numObjectives);
+      double expected = hyperVolume - (n > 1 ? HyperVolume::compute(&otherPoints[0], n - 1, numObjectives, &reference[0]) : 0.0);
+      if (!isClose(contributions[i], expected))
+        ++numErrors;
+    }
+
+    // Monte Carlo estimate, with a large margin to keep false alarms rare
+    double halfWidth;
+    double estimate = front->estimateHyperVolume(random, numSamples, FitnessPtr(), &halfWidth);
+    if (fabs(estimate - hyperVolume) > 2.0 * halfWidth + 1e-9)
+      ++numErrors;
+
+    context.resultCallback(T("numSolutions"), n);
+    context.resultCallback(T("hyperVolume"), hyperVolume);
+    context.resultCallback(T("estimate"), estimate);
+    context.resultCallback(T("numErrors"), numErrors);
+    return numErrors;
+  }
+
+  static void getPoints(const ParetoFrontPtr& front, std::vector<double>& res)
+  {
+    res.clear();
+    for (size_t i = 0; i < front->getNumSolutions(); ++i)
+    {
+      std::vector<double> point = front->getFitness(i)->getValuesToBeMinimized();
+      res.insert(res.end(), point.begin(), point.end());
+    }
+  }
+
+  static double computeFromScratch(const ParetoFrontPtr& front, const std::vector<double>& reference)
+  {
+    std::vector<double> points;
+    getPoints(front, points);
+    return points.empty() ? 0.0 : HyperVolume::compute(&points[0], front->getNumSolutions(), reference.size(), &reference[0]);
+  }
+
+  static bool isClose(double a, double b)
+    {return fabs(a - b) <= 1e-9 * juce::jmax(1.0, fabs(b));}
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_HYPER_VOLUME_CHECK_H_
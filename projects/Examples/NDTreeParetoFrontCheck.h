@@ -0,0 +1,115 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: NDTreeParetoFrontCheck.h       | Compares the ND-Tree Pareto     |
+| Author  : Francis Maes                   |  front with ParetoFront         |
+| Started : 16/10/2026 22:10               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_ND_TREE_PARETO_FRONT_CHECK_H_
+# define EXAMPLES_ND_TREE_PARETO_FRONT_CHECK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <ml/Fitness.h>
+# include <ml/SolutionContainer.h>
+
+namespace lbcpp
+{
+
+/*
+** Inserts the same random points into a ParetoFront and an NDTreeParetoFront with two to four
+** objectives, and removes the same solutions from both. After each modification, the two fronts
+** must contain the same fitnesses in the same order and have the same spread indicator. Small
+** leaves are used so that the tree is split and pruned many times.
+*/
+class NDTreeParetoFrontCheck : public WorkUnit
+{
+public:
+  NDTreeParetoFrontCheck(size_t numPoints = 500, size_t maxLeafSize = 4)
+    : numPoints(numPoints), maxLeafSize(maxLeafSize) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    size_t numErrors = 0;
+    for (size_t numObjectives = 2; numObjectives <= 4; ++numObjectives)
+    {
+      context.enterScope(string((int)numObjectives) + T(" objectives"));
+      size_t errors = checkFronts(context, numObjectives);
+      context.leaveScope(errors);
+      numErrors += errors;
+    }
+
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" mismatching fronts"));
+    else
+      context.informationCallback(T("All fronts match"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class NDTreeParetoFrontCheckClass;
+
+  size_t numPoints;
+  size_t maxLeafSize;
+
+  size_t checkFronts(ExecutionContext& context, size_t numObjectives) const
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    FitnessLimitsPtr limits = new FitnessLimits();
+    for (size_t i = 0; i < numObjectives; ++i)
+      limits->addObjective(i % 2 ? 0.0 : 1.0, i % 2 ? 1.0 : 0.0); // mixes minimisation and maximisation
+
+    ParetoFrontPtr reference = new ParetoFront(limits);
+    ParetoFrontPtr front = new NDTreeParetoFront(limits, maxLeafSize);
+    size_t numErrors = 0;
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+      // half of the points lie on a sphere, so that many of them are mutually non-dominated
+      std::vector<double> values(numObjectives);
+      double norm = 0.0;
+      for (size_t j = 0; j < numObjectives; ++j)
+      {
+        values[j] = random->sampleDouble();
+        norm += values[j] * values[j];
+      }
+      if (random->sampleBool())
+        for (size_t j = 0; j < numObjectives; ++j)
+          values[j] *= 0.9 / sqrt(norm);
+      ObjectPtr solution = new Double((double)i);
+      FitnessPtr fitness = new Fitness(values, limits);
+      reference->insertSolution(solution, fitness);
+      front->insertSolution(solution, fitness);
+      if (reference->getNumSolutions() > 1 && random->sampleBool(0.1))
+      {
+        size_t index = random->sampleSize(reference->getNumSolutions());
+        reference->removeSolution(index);
+        front->removeSolution(index);
+      }
+
+      if (!areEqual(reference, front))
+        ++numErrors;
+    }
+
+    context.resultCallback(T("numSolutions"), front->getNumSolutions());
+    context.resultCallback(T("spread"), front->computeSpreadIndicator());
+    context.resultCallback(T("numErrors"), numErrors);
+    return numErrors;
+  }
+
+  static bool areEqual(const ParetoFrontPtr& reference, const ParetoFrontPtr& front)
+  {
+    size_t n = reference->getNumSolutions();
+    if (front->getNumSolutions() != n)
+      return false;
+    for (size_t i = 0; i < n; ++i)
+      if (front->getFitness(i)->getValues() != reference->getFitness(i)->getValues())
+        return false;
+    double expected = reference->computeSpreadIndicator();
+    return fabs(front->computeSpreadIndicator() - expected) <= 1e-9 * juce::jmax(1.0, fabs(expected));
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_ND_TREE_PARETO_FRONT_CHECK_H_
@@ -0,0 +1,149 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: NativeExpressionCheck.h        | Checks the native evaluation    |
+| Author  : Francis Maes                   |  of expressions                 |
+| Started : 16/10/2026 21:20               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_NATIVE_EXPRESSION_CHECK_H_
+# define EXAMPLES_NATIVE_EXPRESSION_CHECK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <oil/Core/Table.h>
+# include <ml/Expression.h>
+# include <ml/ExpressionDomain.h>
+# include <ml/Function.h>
+# include <ml/IndexSet.h>
+# include <ml/RandomVariable.h>
+
+namespace lbcpp
+{
+
+/*
+** Compares the native evaluation of expressions (see NativeExpressionEvaluator) with their
+** boxed evaluation through Expression::compute(), row by row and on a table. The expressions
+** are a function expression, a test expression, a linear model, a Hoeffding tree with linear
+** leaves and a regression tree. The native value of a Hoeffding tree prediction is its mean.
+*/
+class NativeExpressionCheck : public WorkUnit
+{
+public:
+  NativeExpressionCheck(size_t numSamples = 1000)
+    : numSamples(numSamples) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    ExpressionDomainPtr domain = new ExpressionDomain();
+    VariableExpressionPtr x = domain->addInput(doubleClass, "x");
+    VariableExpressionPtr y = domain->addInput(doubleClass, "y");
+
+    TablePtr data = new Table(numSamples);
+    data->addColumn(x, doubleClass);
+    data->addColumn(y, doubleClass);
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+      data->setElement(i, 0, new Double(random->sampleDoubleFromGaussian()));
+      data->setElement(i, 1, new Double(random->sampleDoubleFromGaussian()));
+    }
+
+    size_t numErrors = 0;
+
+    // x * y + sin(x)
+    numErrors += checkExpression(context, new FunctionExpression(addDoubleFunction(),
+      new FunctionExpression(mulDoubleFunction(), x, y),
+      new FunctionExpression(sinDoubleFunction(), x)), data, T("function"));
+
+    // x >= 0.5 ? y * y : x
+    numErrors += checkExpression(context, new TestExpression(new FunctionExpression(stumpFunction(0.5), x),
+      x, new FunctionExpression(mulDoubleFunction(), y, y), new ConstantExpression(new Double(0.0))), data, T("test"));
+
+    // 0.5 + 2x - y
+    std::vector<double> weights(3);
+    weights[0] = 0.5; weights[1] = 2.0; weights[2] = -1.0;
+    LinearModelExpressionPtr linearModel = new LinearModelExpression(weights);
+    numErrors += checkExpression(context, linearModel, data, T("linear model"));
+
+    // Hoeffding tree split on x, with different linear models in its leaves
+    HoeffdingTreeNodePtr hoeffdingTree = new HoeffdingTreeNode(linearModel->cloneAndCast<Expression>(context));
+    hoeffdingTree->split(context, 0, 0.0);
+    hoeffdingTree->getLeft().staticCast<HoeffdingTreeNode>()->getModel().staticCast<LinearModelExpression>()->getWeights()->setValue(1, -3.0);
+    hoeffdingTree->getRight().staticCast<HoeffdingTreeNode>()->getModel().staticCast<LinearModelExpression>()->getWeights()->setValue(2, 4.0);
+    numErrors += checkExpression(context, hoeffdingTree, data, T("Hoeffding tree"));
+
+    // regression tree split on y
+    TreeNodePtr regressionTree;
+    for (size_t i = 0; i < 20; ++i)
+    {
+      DenseDoubleVectorPtr input = new DenseDoubleVector(2, 0.0);
+      input->setValue(0, random->sampleDoubleFromGaussian());
+      input->setValue(1, i % 2 ? -1.0 - random->sampleDouble() : 1.0 + random->sampleDouble());
+      DenseDoubleVectorPtr output = new DenseDoubleVector(1, input->getValue(0) + input->getValue(1));
+      if (regressionTree)
+        regressionTree->addSample(input, output);
+      else
+        regressionTree = scalarVectorTreeNode(input, output);
+    }
+    regressionTree->split(context, 1, 0.0);
+    numErrors += checkExpression(context, regressionTree, data, T("regression tree"));
+
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" mismatching predictions"));
+    else
+      context.informationCallback(T("All predictions match"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class NativeExpressionCheckClass;
+
+  size_t numSamples;
+
+  size_t checkExpression(ExecutionContext& context, const ExpressionPtr& expression, const TablePtr& data, const string& name) const
+  {
+    NativeExpressionEvaluator evaluator(expression);
+    if (!evaluator.isSupported())
+    {
+      context.errorCallback(name + T(" does not support native evaluation"));
+      return 1;
+    }
+
+    size_t numErrors = 0;
+    std::vector<double> inputs(data->getNumColumns());
+    for (size_t i = 0; i < data->getNumRows(); ++i)
+    {
+      std::vector<ObjectPtr> row = data->getRow(i);
+      for (size_t j = 0; j < row.size(); ++j)
+        inputs[j] = Expression::toNativeValue(row[j]);
+      if (!isClose(evaluator.compute(inputs), getExpectedValue(context, expression, row)))
+        ++numErrors;
+    }
+
+    IndexSetPtr indices = new IndexSet(data->getNumRows());
+    DataVectorPtr predictions = evaluator.computeSamples(data, indices, doubleClass);
+    IndexSet::const_iterator index = indices->begin();
+    for (DataVector::const_iterator it = predictions->begin(); it != predictions->end(); ++it, ++index)
+      if (!isClose(it.getRawDouble(), getExpectedValue(context, expression, data->getRow(*index))))
+        ++numErrors;
+
+    context.resultCallback(name, numErrors);
+    return numErrors;
+  }
+
+  static double getExpectedValue(ExecutionContext& context, const ExpressionPtr& expression, const std::vector<ObjectPtr>& row)
+  {
+    ObjectPtr prediction = expression->compute(context, row);
+    if (prediction.isInstanceOf<ScalarVariableMeanAndVariance>())
+      return prediction.staticCast<ScalarVariableMeanAndVariance>()->getMean();
+    return Expression::toNativeValue(prediction);
+  }
+
+  static bool isClose(double a, double b)
+    {return a == b || fabs(a - b) <= 1e-12 * juce::jmax(1.0, fabs(b));}
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_NATIVE_EXPRESSION_CHECK_H_
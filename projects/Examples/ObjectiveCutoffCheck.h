@@ -0,0 +1,167 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ObjectiveCutoffCheck.h         | Checks the early termination of |
+| Author  : Francis Maes                   |  the learning objectives        |
+| Started : 16/10/2026 23:35               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_OBJECTIVE_CUTOFF_CHECK_H_
+# define EXAMPLES_OBJECTIVE_CUTOFF_CHECK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <oil/Core/Table.h>
+# include <ml/Expression.h>
+# include <ml/ExpressionDomain.h>
+# include <ml/Function.h>
+# include <ml/Objective.h>
+
+namespace lbcpp
+{
+
+/*
+** Evaluates random candidate expressions in sequence, once without cutoff and once with the
+** best value found so far as cutoff, as a genetic programming solver does. Both evaluations must
+** select the same best candidate with the same value, and the values that differ because of the
+** cutoff must not be better than it. The regression objectives are checked on x * y + sin(x)
+** with noise and the binary accuracy on a noisy boolean function of three inputs.
+*/
+class ObjectiveCutoffCheck : public WorkUnit
+{
+public:
+  ObjectiveCutoffCheck(size_t numSamples = 1000, size_t numCandidates = 200)
+    : numSamples(numSamples), numCandidates(numCandidates) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    size_t numErrors = 0;
+
+    // regression
+    {
+      ExpressionDomainPtr domain = new ExpressionDomain();
+      VariableExpressionPtr x = domain->addInput(doubleClass, "x");
+      VariableExpressionPtr y = domain->addInput(doubleClass, "y");
+      VariableExpressionPtr z = domain->createSupervision(doubleClass, "z");
+      TablePtr data = domain->createTable(numSamples);
+      for (size_t i = 0; i < numSamples; ++i)
+      {
+        double xValue = random->sampleDoubleFromGaussian();
+        double yValue = random->sampleDoubleFromGaussian();
+        data->setElement(i, 0, new Double(xValue));
+        data->setElement(i, 1, new Double(yValue));
+        data->setElement(i, 2, new Double(xValue * yValue + sin(xValue) + 0.1 * random->sampleDoubleFromGaussian()));
+      }
+
+      // c1 * x * y + c2 * sin(x) + c3 * y, with coefficients around the ones of the target
+      std::vector<ExpressionPtr> candidates(numCandidates);
+      for (size_t i = 0; i < numCandidates; ++i)
+        candidates[i] = new FunctionExpression(addDoubleFunction(),
+          new FunctionExpression(addDoubleFunction(),
+            multiply(random->sampleDoubleFromGaussian(1.0, 0.5), new FunctionExpression(mulDoubleFunction(), x, y)),
+            multiply(random->sampleDoubleFromGaussian(1.0, 0.5), new FunctionExpression(sinDoubleFunction(), x))),
+          multiply(random->sampleDoubleFromGaussian(0.0, 0.5), y));
+
+      numErrors += checkObjective(context, mseRegressionObjective(data, z), candidates, T("MSE"));
+      numErrors += checkObjective(context, rmseRegressionObjective(data, z), candidates, T("RMSE"));
+      numErrors += checkObjective(context, normalizedRMSERegressionObjective(data, z), candidates, T("normalized RMSE"));
+      numErrors += checkObjective(context, rrseRegressionObjective(data, data, z), candidates, T("RRSE"));
+    }
+
+    // binary classification
+    {
+      ExpressionDomainPtr domain = new ExpressionDomain();
+      std::vector<VariableExpressionPtr> inputs(3);
+      for (size_t i = 0; i < inputs.size(); ++i)
+        inputs[i] = domain->addInput(booleanClass, "b" + string((int)i));
+      VariableExpressionPtr supervision = domain->createSupervision(booleanClass, "y");
+      TablePtr data = domain->createTable(numSamples);
+      for (size_t i = 0; i < numSamples; ++i)
+      {
+        bool b0 = random->sampleBool(), b1 = random->sampleBool(), b2 = random->sampleBool();
+        data->setElement(i, 0, new Boolean(b0));
+        data->setElement(i, 1, new Boolean(b1));
+        data->setElement(i, 2, new Boolean(b2));
+        data->setElement(i, 3, new Boolean((b0 != (b1 && b2)) != random->sampleBool(0.1)));
+      }
+
+      std::vector<FunctionPtr> functions;
+      functions.push_back(andBooleanFunction());
+      functions.push_back(orBooleanFunction());
+      functions.push_back(nandBooleanFunction());
+      functions.push_back(norBooleanFunction());
+      functions.push_back(equalBooleanFunction());
+      std::vector<ExpressionPtr> candidates(numCandidates);
+      for (size_t i = 0; i < numCandidates; ++i)
+        candidates[i] = sampleBooleanExpression(random, functions, inputs, 3);
+
+      numErrors += checkObjective(context, binaryAccuracyObjective(data, supervision), candidates, T("binary accuracy"));
+    }
+
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" errors"));
+    else
+      context.informationCallback(T("Pruned and full evaluations select the same expressions"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class ObjectiveCutoffCheckClass;
+
+  size_t numSamples;
+  size_t numCandidates;
+
+  size_t checkObjective(ExecutionContext& context, const LearningObjectivePtr& objective, const std::vector<ExpressionPtr>& candidates, const string& name) const
+  {
+    double sign = objective->isMinimization() ? -1.0 : 1.0; // values are compared on sign * value, the greater the better
+    size_t numErrors = 0;
+    size_t numPruned = 0;
+    size_t fullBest = 0, prunedBest = 0;
+    double fullBestValue = 0.0, prunedBestValue = 0.0;
+    double cutoff = DBL_MAX;
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+      double value = objective->evaluate(context, candidates[i]);
+      double prunedValue = objective->evaluateWithCutoff(context, candidates[i], cutoff);
+      if (prunedValue != value)
+      {
+        ++numPruned;
+        if (cutoff == DBL_MAX || prunedValue * sign > cutoff * sign || value * sign > cutoff * sign)
+          ++numErrors; // only the candidates that are worse than the cutoff may be pruned
+      }
+      if (i == 0 || value * sign > fullBestValue * sign)
+        fullBest = i, fullBestValue = value;
+      if (i == 0 || prunedValue * sign > prunedBestValue * sign)
+        prunedBest = i, prunedBestValue = cutoff = prunedValue;
+    }
+    if (prunedBest != fullBest || prunedBestValue != fullBestValue)
+    {
+      context.errorCallback(name + T(": the pruned evaluation selects candidate ") + string((int)prunedBest) + T(" instead of ") + string((int)fullBest));
+      ++numErrors;
+    }
+
+    context.enterScope(name);
+    context.resultCallback(T("bestValue"), fullBestValue);
+    context.resultCallback(T("numPruned"), numPruned);
+    context.resultCallback(T("numErrors"), numErrors);
+    context.leaveScope(numErrors);
+    return numErrors;
+  }
+
+  static ExpressionPtr multiply(double coefficient, const ExpressionPtr& expression)
+    {return new FunctionExpression(mulDoubleFunction(), new ConstantExpression(new Double(coefficient)), expression);}
+
+  static ExpressionPtr sampleBooleanExpression(const RandomGeneratorPtr& random, const std::vector<FunctionPtr>& functions, const std::vector<VariableExpressionPtr>& inputs, size_t maxDepth)
+  {
+    if (maxDepth == 0 || random->sampleBool(0.3))
+      return inputs[random->sampleSize(inputs.size())];
+    ExpressionPtr left = sampleBooleanExpression(random, functions, inputs, maxDepth - 1);
+    ExpressionPtr right = sampleBooleanExpression(random, functions, inputs, maxDepth - 1);
+    return new FunctionExpression(functions[random->sampleSize(functions.size())], left, right);
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_OBJECTIVE_CUTOFF_CHECK_H_
@@ -0,0 +1,98 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ProfilerOverheadBenchmark.h    | Measures the overhead of        |
+| Author  : Francis Maes                   |  profiled scopes                |
+| Started : 16/10/2026 22:40               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_PROFILER_OVERHEAD_BENCHMARK_H_
+# define EXAMPLES_PROFILER_OVERHEAD_BENCHMARK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Execution/Profiler.h>
+# include <oil/Core/Double.h>
+
+namespace lbcpp
+{
+
+/*
+** Runs numIterations times a small computation, without profiled scope, inside a ProfiledScope
+** while profiling is stopped, and inside two nested ProfiledScopes while profiling is running.
+** The overheads are given in nanoseconds per scope. Since the profiles are reset, this work
+** unit refuses to run while the profiler is in use.
+*/
+class ProfilerOverheadBenchmark : public WorkUnit
+{
+public:
+  ProfilerOverheadBenchmark(size_t numIterations = 10000000)
+    : numIterations(numIterations) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    if (Profiler::isEnabled())
+    {
+      context.errorCallback(T("The profiler is already running"));
+      return ObjectPtr();
+    }
+    Profiler::reset();
+
+    double checksum = 0.0;
+    double baseTime = runLoop(0, checksum);
+    double disabledTime = runLoop(1, checksum);
+    Profiler::start();
+    double enabledTime = runLoop(2, checksum);
+    Profiler::stop();
+    Profiler::reset();
+
+    double nanosecondsPerIteration = 1000000000.0 / (double)numIterations;
+    double disabledOverhead = (disabledTime - baseTime) * nanosecondsPerIteration;
+    double enabledOverhead = (enabledTime - baseTime) * nanosecondsPerIteration / 2.0;
+    context.resultCallback(T("baseTime"), baseTime);
+    context.resultCallback(T("disabledTime"), disabledTime);
+    context.resultCallback(T("enabledTime"), enabledTime);
+    context.resultCallback(T("disabledOverheadPerScope"), disabledOverhead);
+    context.resultCallback(T("enabledOverheadPerScope"), enabledOverhead);
+    context.resultCallback(T("checksum"), checksum);
+    return new Double(enabledOverhead);
+  }
+
+protected:
+  friend class ProfilerOverheadBenchmarkClass;
+
+  size_t numIterations;
+
+  // returns the time in seconds, numScopes is 0, 1 or 2
+  double runLoop(size_t numScopes, double& checksum) const
+  {
+    static const string outerName(T("ProfilerOverheadBenchmark outer"));
+    static const string innerName(T("ProfilerOverheadBenchmark inner"));
+    double value = 1.0;
+    double startTime = juce::Time::getMillisecondCounterHiRes();
+    for (size_t i = 0; i < numIterations; ++i)
+    {
+      if (numScopes == 0)
+        value = step(value, i);
+      else if (numScopes == 1)
+      {
+        ProfiledScope _(outerName);
+        value = step(value, i);
+      }
+      else
+      {
+        ProfiledScope _(outerName);
+        ProfiledScope __(innerName);
+        value = step(value, i);
+      }
+    }
+    checksum += value;
+    return (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+  }
+
+  static double step(double value, size_t i)
+    {return value * 0.999999 + (double)(i & 7);}
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_PROFILER_OVERHEAD_BENCHMARK_H_
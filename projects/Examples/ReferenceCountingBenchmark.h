@@ -0,0 +1,145 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: ReferenceCountingBenchmark.h   | Micro-benchmark of the reference|
+| Author  : Francis Maes                   |  counting fast paths            |
+| Started : 16/10/2026 11:40               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_REFERENCE_COUNTING_BENCHMARK_H_
+# define EXAMPLES_REFERENCE_COUNTING_BENCHMARK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <oil/Core/Double.h>
+
+namespace lbcpp
+{
+
+/*
+** Compares, on numObjects boxed doubles, the owning copies of ReferenceCountedObjectPtr, that
+** update the reference count with atomic operations, with the ways to avoid them: passing by
+** const reference, BorrowedObjectPtr and ReferenceCountedObjectPtr::swap().
+*/
+class ReferenceCountingBenchmark : public WorkUnit
+{
+public:
+  ReferenceCountingBenchmark(size_t numObjects = 1000, size_t numIterations = 10000)
+    : numObjects(numObjects), numIterations(numIterations) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    std::vector<ObjectPtr> objects(numObjects);
+    for (size_t i = 0; i < numObjects; ++i)
+      objects[i] = new Double(random->sampleDoubleFromGaussian());
+    const ObjectPtr* source = numObjects ? &objects[0] : NULL;
+
+    context.informationCallback(string((int)numObjects) + T(" objects, ") + string((int)numIterations) + T(" iterations"));
+
+    double time, checksum;
+
+    // gathering the inputs of a function, as in Function::compute() on DataVectors
+    std::vector<ObjectPtr> owned(numObjects);
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      for (size_t i = 0; i < numObjects; ++i)
+        owned[i] = source[(i + it) % numObjects];
+      checksum += sumValues(numObjects ? &owned[0] : NULL, numObjects);
+    }
+    double ownedTime = stopTimer(time);
+    double ownedChecksum = checksum;
+
+    std::vector< BorrowedObjectPtr<Object> > borrowed(numObjects);
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      for (size_t i = 0; i < numObjects; ++i)
+        borrowed[i] = source[(i + it) % numObjects];
+      checksum += sumValues(numObjects ? BorrowedObjectPtr<Object>::toPointerArray(&borrowed[0]) : NULL, numObjects);
+    }
+    reportResult(context, T("gather"), ownedTime, stopTimer(time), ownedChecksum, checksum);
+
+    // parameters passed by value or by const reference
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      for (size_t i = 0; i < numObjects; ++i)
+        checksum += getValueByCopy(source[i]);
+    ownedTime = stopTimer(time);
+    ownedChecksum = checksum;
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+      for (size_t i = 0; i < numObjects; ++i)
+        checksum += getValueByReference(source[i]);
+    reportResult(context, T("parameters"), ownedTime, stopTimer(time), ownedChecksum, checksum);
+
+    // storing temporaries, as in FunctionExpression::compute()
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      for (size_t i = 0; i < numObjects; ++i)
+        owned[i] = getElement(source, (i + it) % numObjects);
+      checksum += sumValues(numObjects ? &owned[0] : NULL, numObjects);
+    }
+    ownedTime = stopTimer(time);
+    ownedChecksum = checksum;
+    time = startTimer(checksum);
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      for (size_t i = 0; i < numObjects; ++i)
+      {
+        ObjectPtr value = getElement(source, (i + it) % numObjects);
+        owned[i].swap(value);
+      }
+      checksum += sumValues(numObjects ? &owned[0] : NULL, numObjects);
+    }
+    reportResult(context, T("temporaries"), ownedTime, stopTimer(time), ownedChecksum, checksum);
+
+    return ObjectPtr();
+  }
+
+protected:
+  friend class ReferenceCountingBenchmarkClass;
+
+  size_t numObjects;
+  size_t numIterations;
+
+  // these functions are virtual, so that the compiler cannot remove the copies by inlining them
+  virtual double sumValues(const ObjectPtr* values, size_t n) const
+  {
+    double res = 0.0;
+    for (size_t i = 0; i < n; ++i)
+      res += values[i].staticCast<Double>()->get();
+    return res;
+  }
+
+  virtual double getValueByCopy(ObjectPtr value) const
+    {return value.staticCast<Double>()->get();}
+
+  virtual double getValueByReference(const ObjectPtr& value) const
+    {return value.staticCast<Double>()->get();}
+
+  virtual ObjectPtr getElement(const ObjectPtr* values, size_t index) const
+    {return values[index];}
+
+  static double startTimer(double& checksum)
+    {checksum = 0.0; return juce::Time::getMillisecondCounterHiRes();}
+
+  static double stopTimer(double startTime)
+    {return (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;}
+
+  void reportResult(ExecutionContext& context, const string& name, double ownedTime, double borrowedTime, double ownedChecksum, double borrowedChecksum)
+  {
+    context.enterScope(name);
+    context.resultCallback(T("ownedTime"), ownedTime);
+    context.resultCallback(T("borrowedTime"), borrowedTime);
+    context.resultCallback(T("speedUp"), borrowedTime > 0.0 ? ownedTime / borrowedTime : 0.0);
+    context.resultCallback(T("checksumsMatch"), ownedChecksum == borrowedChecksum);
+    context.leaveScope(borrowedTime > 0.0 ? ownedTime / borrowedTime : 0.0);
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_REFERENCE_COUNTING_BENCHMARK_H_
@@ -0,0 +1,142 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: SmallObjectAllocatorBenchmark.h| Micro-benchmark of the small    |
+| Author  : Francis Maes                   |  object allocator               |
+| Started : 16/10/2026 19:40               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_SMALL_OBJECT_ALLOCATOR_BENCHMARK_H_
+# define EXAMPLES_SMALL_OBJECT_ALLOCATOR_BENCHMARK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/RandomGenerator.h>
+# include <oil/Core/Double.h>
+
+namespace lbcpp
+{
+
+/*
+** Compares the small object allocator (see lbcpp_UseSmallObjectAllocator) with malloc() on
+** bursts of numObjects blocks of objectSize bytes, released in reverse order or in a random
+** order, and measures the creation and destruction of boxed doubles, that use the allocator.
+** The allocator is disabled in debug builds, where only the boxed doubles are measured.
+*/
+class SmallObjectAllocatorBenchmark : public WorkUnit
+{
+public:
+  SmallObjectAllocatorBenchmark(size_t objectSize = 32, size_t numObjects = 1000, size_t numIterations = 1000)
+    : objectSize(objectSize), numObjects(numObjects), numIterations(numIterations) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    std::vector<size_t> reverseOrder(numObjects);
+    for (size_t i = 0; i < numObjects; ++i)
+      reverseOrder[i] = numObjects - 1 - i;
+    std::vector<size_t> randomOrder;
+    random->sampleOrder(numObjects, randomOrder);
+
+    context.informationCallback(string((int)numObjects) + T(" objects of ") + string((int)objectSize) + T(" bytes, ") + string((int)numIterations) + T(" iterations"));
+
+#ifdef JUCE_DEBUG
+    context.informationCallback(T("The small object allocator is disabled in debug builds"));
+#else
+    if (objectSize < sizeof (size_t))
+    {
+      context.errorCallback(T("The objects must be large enough to hold a size_t"));
+      return ObjectPtr();
+    }
+    runBursts(context, T("reverse order"), reverseOrder);
+    runBursts(context, T("random order"), randomOrder);
+#endif // JUCE_DEBUG
+
+    // boxed doubles, as in the functions that return scalars
+    std::vector<ObjectPtr> objects(numObjects);
+    double checksum = 0.0;
+    double time = juce::Time::getMillisecondCounterHiRes();
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      for (size_t i = 0; i < numObjects; ++i)
+        objects[i] = new Double((double)i);
+      for (size_t i = 0; i < numObjects; ++i)
+      {
+        const ObjectPtr& object = objects[randomOrder[i]];
+        checksum += object.staticCast<Double>()->get();
+        objects[randomOrder[i]] = ObjectPtr();
+      }
+    }
+    time = (juce::Time::getMillisecondCounterHiRes() - time) / 1000.0;
+    context.resultCallback(T("boxedDoublesTime"), time);
+    context.resultCallback(T("boxedDoublesChecksum"), checksum);
+    return new Double(time);
+  }
+
+protected:
+  friend class SmallObjectAllocatorBenchmarkClass;
+
+  size_t objectSize;
+  size_t numObjects;
+  size_t numIterations;
+
+#ifndef JUCE_DEBUG
+  struct PoolAllocator
+  {
+    static void* allocate(size_t size)
+      {return smallObjectAllocate(size);}
+    static void free(void* block, size_t size)
+      {smallObjectFree(block, size);}
+  };
+
+  struct MallocAllocator
+  {
+    static void* allocate(size_t size)
+      {return malloc(size);}
+    static void free(void* block, size_t size)
+      {::free(block);}
+  };
+
+  // allocates numObjects blocks, writes into them and releases them in the given order
+  template<class Allocator>
+  double runBurst(std::vector<void* >& blocks, const std::vector<size_t>& releaseOrder, size_t& checksum) const
+  {
+    checksum = 0;
+    double startTime = juce::Time::getMillisecondCounterHiRes();
+    for (size_t it = 0; it < numIterations; ++it)
+    {
+      for (size_t i = 0; i < numObjects; ++i)
+      {
+        blocks[i] = Allocator::allocate(objectSize);
+        *(size_t* )blocks[i] = i;
+      }
+      for (size_t i = 0; i < numObjects; ++i)
+      {
+        void* block = blocks[releaseOrder[i]];
+        checksum += *(size_t* )block;
+        Allocator::free(block, objectSize);
+      }
+    }
+    return (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+  }
+
+  void runBursts(ExecutionContext& context, const string& name, const std::vector<size_t>& releaseOrder) const
+  {
+    std::vector<void* > blocks(numObjects);
+    size_t mallocChecksum, poolChecksum;
+    double mallocTime = runBurst<MallocAllocator>(blocks, releaseOrder, mallocChecksum);
+    double poolTime = runBurst<PoolAllocator>(blocks, releaseOrder, poolChecksum);
+    double speedUp = poolTime > 0.0 ? mallocTime / poolTime : 0.0;
+
+    context.enterScope(name);
+    context.resultCallback(T("mallocTime"), mallocTime);
+    context.resultCallback(T("poolTime"), poolTime);
+    context.resultCallback(T("speedUp"), speedUp);
+    context.resultCallback(T("checksumsMatch"), mallocChecksum == poolChecksum);
+    context.leaveScope(speedUp);
+  }
+#endif // !JUCE_DEBUG
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_SMALL_OBJECT_ALLOCATOR_BENCHMARK_H_
@@ -0,0 +1,113 @@
+/*-----------------------------------------.---------------------------------.
+| Filename: XmlSerialisationCheck.h        | Save/load round-trips through   |
+| Author  : Francis Maes                   |  the XML format                 |
+| Started : 16/10/2026 22:55               |                                 |
+`------------------------------------------/                                 |
+                               |                                             |
+                               `--------------------------------------------*/
+
+#ifndef EXAMPLES_XML_SERIALISATION_CHECK_H_
+# define EXAMPLES_XML_SERIALISATION_CHECK_H_
+
+# include <oil/Execution/WorkUnit.h>
+# include <oil/Core/XmlSerialisation.h>
+# include <oil/Core/Vector.h>
+# include <ml/DoubleVector.h>
+
+namespace lbcpp
+{
+
+/*
+** Saves a vector of objects to XML, loads it back and checks that saving the loaded vector
+** produces the same text. The vector repeats the shared instances of Boolean::create() and
+** Integer::create(), that must be written in place, and a dense vector, that must be written
+** once and then referred to by its identifier.
+*/
+class XmlSerialisationCheck : public WorkUnit
+{
+public:
+  XmlSerialisationCheck(size_t size = 20) : size(size) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    DenseDoubleVectorPtr dense = new DenseDoubleVector(3, 1.0);
+    OVectorPtr objects = new OVector(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (i % 3 == 0)
+        objects->set(i, Boolean::create(i % 2 == 0));
+      else if (i % 3 == 1)
+        objects->set(i, Integer::create((juce::int64)(i % 5)));
+      else
+        objects->set(i, dense);
+    }
+    size_t numDenseReferences = size / 3;
+
+    size_t numErrors = 0;
+    string xml = save(context, objects);
+
+    // only the dense vector is shared
+    size_t numReferences = countOccurrences(xml, T(" ref=\""));
+    size_t numIdentifiers = countOccurrences(xml, T(" id=\""));
+    size_t expectedReferences = numDenseReferences > 1 ? numDenseReferences - 1 : 0;
+    context.resultCallback(T("numReferences"), numReferences);
+    context.resultCallback(T("numIdentifiers"), numIdentifiers);
+    if (numReferences != expectedReferences || numIdentifiers != (expectedReferences ? 1 : 0))
+    {
+      context.errorCallback(T("Unexpected shared objects: ") + string((int)numIdentifiers) + T(" identifiers and ") + string((int)numReferences) + T(" references"));
+      ++numErrors;
+    }
+
+    // round-trip
+    juce::XmlDocument document(xml);
+    XmlImporter importer(context, document);
+    OVectorPtr loaded = importer.isOpened() ? importer.load().dynamicCast<OVector>() : OVectorPtr();
+    if (!loaded || loaded->getNumElements() != size)
+    {
+      context.errorCallback(T("Could not load the saved vector"));
+      return Boolean::create(false);
+    }
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (loaded->get(i)->compare(objects->get(i)) != 0)
+        ++numErrors;
+      if (i % 3 == 2 && loaded->get(i) != loaded->get(2))
+        ++numErrors; // the references must be resolved to the same object
+    }
+    if (save(context, loaded) != xml)
+    {
+      context.errorCallback(T("The loaded vector is not saved as the original one"));
+      ++numErrors;
+    }
+
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" errors"));
+    else
+      context.informationCallback(T("The round-trip succeeded"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class XmlSerialisationCheckClass;
+
+  size_t size;
+
+  static string save(ExecutionContext& context, const ObjectPtr& object)
+  {
+    XmlExporter exporter(context);
+    exporter.saveObject(string::empty, object, ClassPtr());
+    return exporter.toString();
+  }
+
+  static size_t countOccurrences(const string& text, const string& pattern)
+  {
+    size_t res = 0;
+    for (int index = text.indexOf(pattern); index >= 0; index = text.indexOf(index + 1, pattern))
+      ++res;
+    return res;
+  }
+};
+
+}; /* namespace lbcpp */
+
+#endif // !EXAMPLES_XML_SERIALISATION_CHECK_H_
@@ -564,7 +564,7 @@ public:
     bestFitness = FitnessPtr();
   }
 
-  virtual void solutionEvaluated(ExecutionContext& context, SolverPtr solver, ObjectPtr object, FitnessPtr fitness)
+  virtual void solutionEvaluated(ExecutionContext& context, const SolverPtr& solver, const ObjectPtr& object, const FitnessPtr& fitness)
   {
     ++numEvaluations;
 
@@ -905,6 +905,93 @@ protected:
   }
 };
 
+/*
+** Measures how the parallel NRPA solvers scale with the number of workers (1, 2, 4, ..., maxNumWorkers)
+** on an expression problem, with postfix expressions and bigram action codes.
+** Each configuration makes the same numRuns runs of numEvaluations evaluations, and reports its mean
+** score, its evaluations per second and its speed-up with respect to one worker.
+*/
+class MCGPNRPAScalingBenchmark : public WorkUnit
+{
+public:
+  MCGPNRPAScalingBenchmark() : numEvaluations(10000), numRuns(3), maxExpressionSize(10), level(2), synchronisationPeriod(1), maxNumWorkers(8) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    if (!problem)
+    {
+      context.errorCallback(T("Missing problem"));
+      return ObjectPtr();
+    }
+    SamplerPtr sampler = logLinearActionCodeSearchSampler(new NGramExpressionSearchActionCodeGenerator(2), 0.1, 1.0);
+    size_t numIterationsPerLevel = (size_t)pow((double)numEvaluations, 1.0 / juce::jmax(1, (int)level));
+
+    std::vector<size_t> numWorkers;
+    for (size_t n = 1; n < maxNumWorkers; n *= 2)
+      numWorkers.push_back(n);
+    numWorkers.push_back(juce::jmax(1, (int)maxNumWorkers));
+
+    for (size_t leafParallelism = 0; leafParallelism <= 1; ++leafParallelism)
+    {
+      context.enterScope(leafParallelism ? "Leaf parallel NRPA" : "Root parallel NRPA");
+      double referenceTime = 0.0;
+      for (size_t i = 0; i < numWorkers.size(); ++i)
+      {
+        SolverPtr solver = parallelNRPASolver(sampler, level, numIterationsPerLevel, numWorkers[i], synchronisationPeriod, leafParallelism != 0);
+        double time = runSolver(context, string((int)numWorkers[i]) + " workers", solver, numWorkers[i], referenceTime);
+        if (i == 0)
+          referenceTime = time;
+      }
+      context.leaveScope();
+    }
+    return ObjectPtr();
+  }
+
+protected:
+  friend class MCGPNRPAScalingBenchmarkClass;
+
+  ProblemPtr problem;
+  size_t numEvaluations;
+  size_t numRuns;
+  size_t maxExpressionSize;
+  size_t level;
+  size_t synchronisationPeriod;
+  size_t maxNumWorkers;
+
+  // returns the mean time of a run
+  double runSolver(ExecutionContext& context, const string& name, SolverPtr solver, size_t numWorkers, double referenceTime)
+  {
+    context.enterScope(name);
+    RandomGeneratorPtr previousRandom = context.getRandomGenerator();
+    ScalarVariableStatisticsPtr scores = new ScalarVariableStatistics("score");
+    double time = 0.0;
+    for (size_t run = 0; run < numRuns; ++run)
+    {
+      context.setRandomGenerator(new RandomGenerator((juce::uint32)run + 1)); // the same runs for all the configurations
+      problem->reinitialize(context);
+      ProblemPtr searchProblem = new ExpressionToSearchProblem(problem, maxExpressionSize, true);
+      FitnessPtr bestFitness;
+      SolverCallbackPtr callback = compositeSolverCallback(storeBestFitnessSolverCallback(bestFitness), maxEvaluationsSolverCallback(numEvaluations));
+      double startTime = juce::Time::getMillisecondCounterHiRes();
+      solver->solve(context, searchProblem, callback);
+      time += (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+      if (bestFitness)
+        scores->push(bestFitness->getValue(0));
+    }
+    context.setRandomGenerator(previousRandom);
+    time /= numRuns ? numRuns : 1;
+
+    context.resultCallback("numWorkers", numWorkers);
+    context.resultCallback("score", scores->getMean());
+    context.resultCallback("time", time);
+    context.resultCallback("evaluationsPerSecond", time > 0.0 ? numEvaluations / time : 0.0);
+    if (referenceTime > 0.0)
+      context.resultCallback("speedUp", time > 0.0 ? referenceTime / time : 0.0);
+    context.leaveScope(scores);
+    return time;
+  }
+};
+
 }; /* namespace lbcpp */
 
 #endif // !MCGP_SANDBOX_H_
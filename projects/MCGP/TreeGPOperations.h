@@ -225,8 +225,8 @@ class TreeGPOperationsSolver : public PopulationBasedSolver
 {
 public:
   TreeGPOperationsSolver(SamplerPtr initialSampler, SolutionsOperatorPtr solutionOperator, size_t populationSize = 100, size_t numGenerations = 0)
-    : PopulationBasedSolver(populationSize, numGenerations), initialSampler(initialSampler), solutionOperator(solutionOperator) {}
-  TreeGPOperationsSolver() {}
+    : PopulationBasedSolver(populationSize, numGenerations), initialSampler(initialSampler), solutionOperator(solutionOperator), bestValue(DBL_MAX) {}
+  TreeGPOperationsSolver() : bestValue(DBL_MAX) {}
 
   static SolverPtr createDefault(size_t populationSize, size_t maxGenerations, size_t tournamentSize,
                                 double crossOverProbability,
@@ -258,6 +258,7 @@ public:
   {
     IterativeSolver::startSolver(context, problem, callback, startingSolution);
     initialSampler->initialize(context, problem->getDomain());
+    bestValue = DBL_MAX;
   }
 
   virtual bool iterateSolver(ExecutionContext& context, size_t iter)
@@ -268,9 +269,11 @@ public:
     }
     else
     {
+      // the evaluation of an offspring stops as soon as it is known to be worse than the best solution so far
       population = solutionOperator->compute(context, problem, population);
-      computeMissingFitnesses(context, population);
+      computeMissingFitnesses(context, population, bestValue);
     }
+    updateBestValue();
 
     if (verbosity >= verbosityDetailed)
     {
@@ -299,6 +302,23 @@ protected:
   SamplerPtr initialSampler;
   SolutionsOperatorPtr solutionOperator;
 
+  double bestValue; // best value of the single objective, DBL_MAX if unknown or if there are several objectives
+
+  // the values that are worse than the cutoff may be bounds, but they never replace bestValue
+  void updateBestValue()
+  {
+    FitnessLimitsPtr limits = problem->getFitnessLimits();
+    if (limits->getNumObjectives() != 1)
+      return;
+    double sign = limits->getObjectiveSign(0);
+    for (size_t i = 0; i < population->getNumSolutions(); ++i)
+    {
+      FitnessPtr fitness = population->getFitness(i);
+      if (fitness && (bestValue == DBL_MAX || fitness->getValue(0) * sign > bestValue * sign))
+        bestValue = fitness->getValue(0);
+    }
+  }
+
   SolutionVectorPtr population;
 };
 
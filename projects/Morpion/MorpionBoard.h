@@ -102,10 +102,65 @@ private:
   int x, y;
 };
 
+/*
+** Move: a new point and the line that goes through it
+*/
+class MorpionMove
+{
+public:
+  MorpionMove(const MorpionPoint& position, const MorpionDirection& direction, size_t indexInLine)
+    : position(position), direction(direction), indexInLine(indexInLine) {}
+  MorpionMove() : indexInLine(0) {}
+
+  const MorpionPoint& getPosition() const
+    {return position;}
+
+  const MorpionDirection& getDirection() const
+    {return direction;}
+
+  size_t getIndexInLine() const
+    {return indexInLine;}
+
+  MorpionPoint getStartPosition() const
+    {return position.moveIntoDirection(direction, -(int)indexInLine);}
+
+  MorpionPoint getEndPosition(size_t crossLength) const
+    {return position.moveIntoDirection(direction, (int)(crossLength - 1 - indexInLine));}
+
+  string toString() const
+    {return position.toString() + ", " + direction.toString() + ", " + string((int)indexInLine);}
+
+  bool operator ==(const MorpionMove& other) const
+    {return position == other.position && direction == other.direction && indexInLine == other.indexInLine;}
+
+  int compare(const MorpionMove& other) const
+  {
+    if (position.getX() != other.position.getX())
+      return position.getX() - other.position.getX();
+    if (position.getY() != other.position.getY())
+      return position.getY() - other.position.getY();
+    if (direction != other.direction)
+      return (int)(MorpionDirection::Direction)direction - (int)(MorpionDirection::Direction)other.direction;
+    return (int)indexInLine - (int)other.indexInLine;
+  }
+
+private:
+  MorpionPoint position;
+  MorpionDirection direction;
+  size_t indexInLine; // in range [0, crossLength[
+};
+
+/*
+** Board
+**
+** The board is made of five bit planes: one for the occupied points and one for the segments
+** of each direction (a segment is stored on its first point). Each row of a plane is packed
+** into 64-bits words. Points outside the board are never occupied and never have segments.
+*/
 class MorpionBoard
 {
 public:
-  MorpionBoard() : width(0), height(0) {}
+  MorpionBoard() : width(0), height(0), numWordsPerRow(0) {}
 
   enum
   {
@@ -118,7 +173,7 @@ public:
   };
 
   void clear()
-    {board.clear();}
+    {planes.clear(); width = height = numWordsPerRow = 0;}
 
   void initialize(size_t crossLength)
   {
@@ -159,123 +214,125 @@ public:
   size_t getHeight() const
     {return height;}
 
-  char getState(const MorpionPoint& point) const
-    {return board[point.getY() * width + point.getX()];}
+  bool isInside(int x, int y) const
+    {return (unsigned int)x < (unsigned int)width && (unsigned int)y < (unsigned int)height;}
 
   char getState(int x, int y) const
-    {return board[y * width + x];}
-  
-  char& getState(const MorpionPoint& point)
-    {return board[point.getY() * width + point.getX()];}
+  {
+    char res = 0;
+    if (isOccupied(x, y)) res |= flagOccupied;
+    if (getBit(planeNE, x, y)) res |= flagNE;
+    if (getBit(planeE, x, y)) res |= flagE;
+    if (getBit(planeSE, x, y)) res |= flagSE;
+    if (getBit(planeS, x, y)) res |= flagS;
+    if (isNeighbor(x, y)) res |= flagNeighbor;
+    return res;
+  }
 
-  char& getState(int x, int y)
-    {return board[y * width + x];}
+  char getState(const MorpionPoint& point) const
+    {return getState(point.getX(), point.getY());}
 
   bool isOccupied(int x, int y) const
-    {return (getState(x, y) & flagOccupied) == flagOccupied;}
+    {return getBit(planeOccupied, x, y);}
 
   bool isOccupied(const MorpionPoint& point) const
     {return isOccupied(point.getX(), point.getY());}
   
   void markAsOccupied(int x, int y, bool occupied = true)
-  {
-    if (occupied)
-    {
-      getState(x, y) |= flagOccupied;
-      markAsNeighbor(x - 1, y - 1);
-      markAsNeighbor(x - 1, y);
-      markAsNeighbor(x - 1, y + 1);
-      markAsNeighbor(x, y - 1);
-      markAsNeighbor(x, y + 1);
-      markAsNeighbor(x + 1, y - 1);
-      markAsNeighbor(x + 1, y);
-      markAsNeighbor(x + 1, y + 1);
-    }
-    else
-    {
-      getState(x, y) &= ~flagOccupied;
-      undoNeighborState(x - 1, y - 1);
-      undoNeighborState(x - 1, y);
-      undoNeighborState(x - 1, y + 1);
-      undoNeighborState(x, y - 1);
-      undoNeighborState(x, y + 1);
-      undoNeighborState(x + 1, y - 1);
-      undoNeighborState(x + 1, y);
-      undoNeighborState(x + 1, y + 1);
-    }
-  }
+    {setBit(planeOccupied, x, y, occupied);}
 
   void markAsOccupied(const MorpionPoint& point, bool occupied = true)
     {markAsOccupied(point.getX(), point.getY(), occupied);}
 
   bool isNeighbor(int x, int y) const
-    {return (getState(x, y) & flagNeighbor) == flagNeighbor;}
+  {
+    return isOccupied(x - 1, y - 1) || isOccupied(x - 1, y) || isOccupied(x - 1, y + 1) ||
+            isOccupied(x, y - 1) || isOccupied(x, y + 1) ||
+            isOccupied(x + 1, y - 1) || isOccupied(x + 1, y) || isOccupied(x + 1, y + 1);
+  }
 
   void addSegment(const MorpionPoint& point, const MorpionDirection& direction)
-    {getState(point) |= getFlag(direction);}
+    {setBit(getPlane(direction), point.getX(), point.getY(), true);}
 
   void removeSegment(const MorpionPoint& point, const MorpionDirection& direction)
-    {getState(point) &= ~getFlag(direction);}
+    {setBit(getPlane(direction), point.getX(), point.getY(), false);}
 
   bool hasSegment(int x, int y, const MorpionDirection& direction) const
-    {return (getState(x, y) & getFlag(direction)) != 0;}
+    {return getBit(getPlane(direction), x, y);}
 
   bool hasSegment(const MorpionPoint& point, const MorpionDirection& direction) const
     {return hasSegment(point.getX(), point.getY(), direction);}
 
+  // range of the occupied points and of their neighbors
   void getXYRange(int& minX, int& minY, int& maxX, int& maxY) const
   {
     minX = 0x7FFFFFFF;
     minY = 0x7FFFFFFF;
     maxX = -0x7FFFFFFF;
     maxY = -0x7FFFFFFF;
-    for (size_t i = 0; i < board.size(); ++i)
-      if (board[i] != 0)
+    for (size_t y = 0; y < height; ++y)
+      for (size_t w = 0; w < numWordsPerRow; ++w)
       {
-        int x = ((int)i % width);
-        int y = ((int)i / width);
-        if (x < minX) minX = x;
-        if (y < minY) minY = y;
-        if (x > maxX) maxX = x;
-        if (y > maxY) maxY = y;
+        juce::uint64 word = planes[getWordIndex(planeOccupied, (int)(w * 64), (int)y)];
+        if (!word)
+          continue;
+        int lowestBit = 0, highestBit = 63;
+        while (!((word >> lowestBit) & 1)) ++lowestBit;
+        while (!((word >> highestBit) & 1)) --highestBit;
+        int x1 = (int)(w * 64) + lowestBit - 1;
+        int x2 = (int)(w * 64) + highestBit + 1;
+        if (x1 < minX) minX = x1;
+        if (x2 > maxX) maxX = x2;
+        if ((int)y - 1 < minY) minY = (int)y - 1;
+        if ((int)y + 1 > maxY) maxY = (int)y + 1;
       }
   }
 
 private:
+  enum {planeOccupied = 0, planeNE, planeE, planeSE, planeS, numPlanes};
+
   size_t width;
   size_t height;
-  std::vector<char> board;
+  size_t numWordsPerRow;
+  std::vector<juce::uint64> planes;
 
   void resizeBoard(size_t width, size_t height)
-    {this->width = width; this->height = height; board.resize(width * height, 0);}
-
-  static int getFlag(const MorpionDirection::Direction& dir)
   {
-    switch (dir)
-    {
-    case MorpionDirection::NE: return flagNE;
-    case MorpionDirection::E: return flagE;
-    case MorpionDirection::SE: return flagSE;
-    case MorpionDirection::S: return flagS;
-    default: jassert(false); return 0;
-    }
+    this->width = width;
+    this->height = height;
+    numWordsPerRow = (width + 63) / 64;
+    planes.clear();
+    planes.resize(numPlanes * height * numWordsPerRow, 0);
   }
 
-  void undoNeighborState(int x, int y)
+  size_t getWordIndex(size_t plane, int x, int y) const
+    {return (plane * height + (size_t)y) * numWordsPerRow + ((size_t)x >> 6);}
+
+  bool getBit(size_t plane, int x, int y) const
+    {return isInside(x, y) && ((planes[getWordIndex(plane, x, y)] >> (x & 63)) & 1) != 0;}
+
+  void setBit(size_t plane, int x, int y, bool value)
   {
-    if (!computeIfNeighbor(x, y))
-      getState(x, y) &= ~flagNeighbor;
+    jassert(isInside(x, y));
+    juce::uint64& word = planes[getWordIndex(plane, x, y)];
+    juce::uint64 mask = (juce::uint64)1 << (x & 63);
+    if (value)
+      word |= mask;
+    else
+      word &= ~mask;
   }
 
-  bool computeIfNeighbor(int x, int y) const
+  static size_t getPlane(const MorpionDirection::Direction& dir)
   {
-    return isOccupied(x - 1, y - 1) || isOccupied(x - 1, y) || isOccupied(x - 1, y + 1) ||
-            isOccupied(x, y - 1) || isOccupied(x, y + 1) ||
-            isOccupied(x + 1, y - 1) || isOccupied(x + 1, y) || isOccupied(x + 1, y + 1);
+    switch (dir)
+    {
+    case MorpionDirection::NE: return planeNE;
+    case MorpionDirection::E: return planeE;
+    case MorpionDirection::SE: return planeSE;
+    case MorpionDirection::S: return planeS;
+    default: jassert(false); return planeOccupied;
+    }
   }
-
-  void markAsNeighbor(int x, int y)
-    {getState(x, y) |= flagNeighbor;}
 };
 
 /*
@@ -12,6 +12,7 @@
 # include <ml/Search.h>
 # include <ml/Problem.h>
 # include <oil/UserInterface/ObjectComponent.h>
+# include <oil/Core/BinarySerialisation.h>
 # include "MorpionBoard.h"
 
 namespace lbcpp
@@ -29,8 +30,13 @@ class MorpionAction : public Object
 public:
   MorpionAction(const MorpionPoint& position, const MorpionDirection& direction, size_t requestedIndexInLine, size_t indexInLine)
     : Object(morpionActionClass), position(position), direction(direction), requestedIndexInLine(requestedIndexInLine), indexInLine(indexInLine) {}
+  MorpionAction(const MorpionMove& move)
+    : Object(morpionActionClass), position(move.getPosition()), direction(move.getDirection()), requestedIndexInLine(move.getIndexInLine()), indexInLine(move.getIndexInLine()) {}
   MorpionAction() : requestedIndexInLine(-1), indexInLine(-1) {}
 
+  MorpionMove getMove() const
+    {return MorpionMove(position, direction, indexInLine);}
+
   const MorpionPoint& getPosition() const
     {return position;}
 
@@ -90,6 +96,27 @@ public:
     return true;
   }
 
+  virtual void saveToBinary(BinaryExporter& exporter) const
+  {
+    exporter.writeInteger(position.getX());
+    exporter.writeInteger(position.getY());
+    exporter.writeSize((size_t)(MorpionDirection::Direction)direction);
+    exporter.writeSize(requestedIndexInLine);
+    exporter.writeSize(indexInLine);
+  }
+
+  virtual bool loadFromBinary(BinaryImporter& importer)
+  {
+    int x = (int)importer.readInteger();
+    int y = (int)importer.readInteger();
+    position = MorpionPoint(x, y);
+    size_t dir = importer.readSize();
+    direction = dir < MorpionDirection::none ? (MorpionDirection::Direction)dir : MorpionDirection::none;
+    requestedIndexInLine = importer.readSize();
+    indexInLine = importer.readSize();
+    return importer.isOk();
+  }
+
 private:
   friend class MorpionActionClass;
 
@@ -101,6 +128,18 @@ private:
 
 /*
 ** State
+**
+** The legal moves are maintained incrementally: for each point and each direction, a bit mask
+** tells which indices in line are legal. Since a move only changes the board around its line,
+** only the masks of the nearby points are recomputed after a move, and their previous values
+** are kept so that moves can be undone in constant time. The keys of the non-empty masks are
+** kept in an unordered list, indexed by key so that a key is removed in constant time, and the
+** numbers of moves of the keys of this list are summed in a Fenwick tree, so that the i-th
+** available move is found in O(log n).
+**
+** In addition to the SearchState interface, the state provides an allocation-free interface
+** to play moves (getNumAvailableMoves(), getAvailableMove(), performMove(), undoMove()),
+** meant for playouts.
 */
 class MorpionState;
 typedef ReferenceCountedObjectPtr<MorpionState> MorpionStatePtr;
@@ -109,12 +148,13 @@ class MorpionState : public SearchState
 {
 public:
 	MorpionState(size_t crossLength, bool isDisjoint)
-    : crossLength(crossLength), isDisjoint(isDisjoint)
+    : crossLength(crossLength), isDisjoint(isDisjoint), numAvailableMoves(0)
   {
+    jassert(crossLength >= 3 && crossLength <= 8);
     board.initialize(crossLength);
-    updateAvailableActions();    
+    initializeMoveMasks();
   }
-  MorpionState() : crossLength(0), isDisjoint(false) {}
+  MorpionState() : crossLength(0), isDisjoint(false), numAvailableMoves(0) {}
 
   virtual string toShortString() const
     {return string((int)crossLength) + (isDisjoint ? "D" : "T");}
@@ -123,13 +163,25 @@ public:
   {
     string res = toShortString();
     for (size_t i = 0; i < history.size(); ++i)
-      res += T(" ") + history[i]->toShortString();
+      res += T(" ") + history[i].toString();
     return res;
   }
 
   virtual DomainPtr getActionDomain() const
-    {return availableActions;}
-  
+  {
+    if (!availableActions)
+    {
+      // keys are sorted so that the order of the actions does not depend on the order of the moves
+      std::vector<juce::uint32> keys(moveKeys);
+      std::sort(keys.begin(), keys.end());
+      availableActions = new DiscreteDomain();
+      for (size_t i = 0; i < keys.size(); ++i)
+        for (size_t indexInLine = 0; indexInLine < crossLength; ++indexInLine)
+          if (moveMasks[keys[i]] & (1 << indexInLine))
+            availableActions->addElement(new MorpionAction(makeMove(keys[i], indexInLine)));
+    }
+    return availableActions;
+  }
   
 #if 0
   virtual DoubleVectorPtr getActionFeatures(const SearchStatePtr& state, const ObjectPtr& action) const
@@ -158,55 +210,123 @@ public:
   }
 #endif // 0
 
-	virtual void performTransition(ExecutionContext& context, const ObjectPtr& ac, ObjectPtr* stateBackup = NULL)
+	virtual void performTransition(ExecutionContext& context, const ObjectPtr& action, ObjectPtr* stateBackup = NULL)
 	{
-    MorpionActionPtr action = ac.staticCast<MorpionAction>();
-    addLineOnBoard(action);
-		history.push_back(action);
+    // the masks are restored by undoMove(), only the domain is kept if it was already built; since its
+    // keys are sorted, rebuilding it lazily after undoTransition() gives the actions in the same order
     if (stateBackup)
       *stateBackup = availableActions;
-    updateAvailableActions();
+    performMove(action.staticCast<MorpionAction>()->getMove());
+	}
 
-#if 0
-    OVectorPtr dbg = computeAvailableActionsReference();
-    size_t correctSize = dbg->getNumElements();
-    size_t newSize = availableActions->getNumElements();
-    //jassert(correctSize == newSize);
-    if (correctSize != newSize)
-    {
-      context.enterScope(T("CorrectSize: ") + string((int)correctSize) + T(" NewSize: ") + string((int)newSize));
-      context.resultCallback("state", cloneAndCast<DecisionProblemState>());
-      context.resultCallback("correct", dbg);
-      context.resultCallback("new", availableActions);
-      context.leaveScope();
-    }
-    if (newSize > correctSize)
+	virtual void undoTransition(ExecutionContext& context, const ObjectPtr& stateBackup)
+	{
+    undoMove();
+    availableActions = stateBackup.staticCast<DiscreteDomain>(); // may be null, then rebuilt by getActionDomain()
+	}
+
+	virtual bool isFinalState() const
+	  {return numAvailableMoves == 0;}
+
+  /*
+  ** Allocation-free interface
+  */
+  size_t getNumAvailableMoves() const
+    {return numAvailableMoves;}
+
+  // the order of the moves depends on the order in which they became available
+  MorpionMove getAvailableMove(size_t index) const
+  {
+    jassert(index < numAvailableMoves);
+    // descends the Fenwick tree to find the position of the key that holds the index-th move
+    size_t position = 0;
+    for (size_t step = highestPowerOfTwo(moveCounts.size()); step; step /= 2)
+      if (position + step <= moveCounts.size() && moveCounts[position + step - 1] <= index)
+      {
+        position += step;
+        index -= moveCounts[position - 1];
+      }
+    jassert(position < moveKeys.size());
+    juce::uint32 key = moveKeys[position];
+    unsigned char mask = moveMasks[key];
+    for (size_t indexInLine = 0; ; ++indexInLine)
+      if ((mask & (1 << indexInLine)) && index-- == 0)
+        return makeMove(key, indexInLine);
+  }
+
+  // checks the incremental data structures against a recomputation from the board
+  bool checkMoveMasks() const
+  {
+    size_t numMoves = 0;
+    size_t numKeys = 0;
+    for (juce::uint32 key = 0; key < moveMasks.size(); ++key)
     {
-      for (size_t i = 0; i < newSize; ++i)
+      unsigned char mask = moveMasks[key];
+      MorpionMove move = makeMove(key, 0);
+      if (mask != computeMoveMask(move.getPosition(), move.getDirection()))
+        return false;
+      if (mask)
       {
-        MorpionActionPtr action = availableActions->getAndCast<MorpionAction>(i);
-        size_t j;
-        for (j = 0; j < correctSize; ++j)
-          if (*dbg->getAndCast<MorpionAction>(j) == *action)
-            break;
-        if (j == correctSize)
-          context.informationCallback(T("TOO MUCH ACTION: ") + action->toShortString());
+        if (keyPositions[key] >= moveKeys.size() || moveKeys[keyPositions[key]] != key)
+          return false;
+        ++numKeys;
+        numMoves += countBits(mask);
       }
     }
-#endif // 0
-	}
+    if (numKeys != moveKeys.size() || numMoves != numAvailableMoves || moveCounts.size() != moveKeys.size())
+      return false;
+    for (size_t i = 0; i < moveKeys.size(); ++i)
+    {
+      size_t count = 0;
+      for (size_t j = i + 1 - lowestBit(i + 1); j <= i; ++j)
+        count += countBits(moveMasks[moveKeys[j]]);
+      if (moveCounts[i] != count)
+        return false;
+    }
+    return true;
+  }
 
-	virtual void undoTransition(ExecutionContext& context, const ObjectPtr& stateBackup)
-	{
-    availableActions = stateBackup.staticCast<DiscreteDomain>();
-    jassert(history.size());
-    MorpionActionPtr action = history.back();
+  bool isMoveAvailable(const MorpionMove& move) const
+  {
+    const MorpionPoint& position = move.getPosition();
+    return board.isInside(position.getX(), position.getY()) && move.getIndexInLine() < crossLength &&
+      (moveMasks[getKey(position, move.getDirection())] & (1 << move.getIndexInLine())) != 0;
+  }
+
+  void performMove(const MorpionMove& move)
+  {
+    jassert(isMoveAvailable(move));
+    maskChangesOffsets.push_back(maskChanges.size());
+    addLineOnBoard(move);
+    history.push_back(move);
+    updateMoveMasks(move);
+    availableActions = DiscreteDomainPtr();
+  }
+
+  void undoMove()
+  {
+    jassert(history.size() && maskChangesOffsets.size());
+    size_t offset = maskChangesOffsets.back();
+    maskChangesOffsets.pop_back();
+    while (maskChanges.size() > offset)
+    {
+      std::pair<juce::uint32, unsigned char> change = maskChanges.back();
+      maskChanges.pop_back();
+      setMoveMask(change.first, change.second, false);
+    }
+    removeLineFromBoard(history.back());
     history.pop_back();
-    removeLineFromBoard(action);
-	}
+    availableActions = DiscreteDomainPtr();
+  }
 
-	virtual bool isFinalState() const
-	  {return availableActions->getNumElements() == 0;}
+  // plays random moves until the end of the game and returns the number of moves played
+  size_t playRandomMoves(const RandomGeneratorPtr& random)
+  {
+    size_t res = 0;
+    for (; numAvailableMoves; ++res)
+      performMove(getAvailableMove(random->sampleSize(numAvailableMoves)));
+    return res;
+  }
 
   size_t getCrossLength() const
     {return crossLength;}
@@ -217,7 +337,7 @@ public:
   const MorpionBoard& getBoard() const
     {return board;}
 
-  const std::vector<MorpionActionPtr>& getHistory() const
+  const std::vector<MorpionMove>& getHistory() const
     {return history;}
  
   virtual void saveToXml(XmlExporter& exporter) const
@@ -228,7 +348,7 @@ public:
     {
       exporter.enter("move");
       exporter.setAttribute("index", i);
-      history[i]->saveToXml(exporter);
+      MorpionAction(history[i]).saveToXml(exporter);
       exporter.leave();
     }
     exporter.leave();
@@ -241,24 +361,57 @@ public:
       importer.errorMessage("MorpionState", "No history");
       return false;
     }
-    history.resize(importer.getIntAttribute("size"));
+    std::vector<MorpionMove> moves(importer.getIntAttribute("size"));
     forEachXmlChildElementWithTagName(*importer.getCurrentElement(), elt, T("move"))
     {
       importer.enter(elt);
       size_t index = (size_t)importer.getIntAttribute("index");
       MorpionActionPtr action = new MorpionAction();
-      if (!action->loadFromXml(importer))
+      if (!action->loadFromXml(importer) || index >= moves.size())
         return false;
-      history[index] = action;
+      moves[index] = action->getMove();
       importer.leave();
     }
     importer.leave();
+    if (!replayMoves(moves))
+    {
+      importer.errorMessage("MorpionState", "Invalid history");
+      return false;
+    }
+    return true;
+  }
 
-    board.clear();
-    board.initialize(crossLength);
+  virtual void saveToBinary(BinaryExporter& exporter) const
+  {
+    exporter.writeSize(crossLength);
+    exporter.writeBool(isDisjoint);
+    exporter.writeSize(history.size());
     for (size_t i = 0; i < history.size(); ++i)
-      addLineOnBoard(history[i]);
-    updateAvailableActions();    
+      MorpionAction(history[i]).saveToBinary(exporter);
+  }
+
+  virtual bool loadFromBinary(BinaryImporter& importer)
+  {
+    crossLength = importer.readSize();
+    isDisjoint = importer.readBool();
+    size_t numMoves;
+    if (!importer.readNumElements(numMoves, 5 * sizeof (juce::int64))) // see MorpionAction::saveToBinary()
+      return false;
+    std::vector<MorpionMove> moves(numMoves);
+    for (size_t i = 0; i < moves.size() && importer.isOk(); ++i)
+    {
+      MorpionActionPtr action = new MorpionAction();
+      if (!action->loadFromBinary(importer))
+        return false;
+      moves[i] = action->getMove();
+    }
+    if (!importer.isOk())
+      return false;
+    if (!replayMoves(moves))
+    {
+      importer.errorMessage("MorpionState", "Invalid history");
+      return false;
+    }
     return true;
   }
   
@@ -269,6 +422,13 @@ public:
     target->isDisjoint = isDisjoint;
     target->board = board;
     target->history = history;
+    target->moveMasks = moveMasks;
+    target->moveKeys = moveKeys;
+    target->keyPositions = keyPositions;
+    target->moveCounts = moveCounts;
+    target->numAvailableMoves = numAvailableMoves;
+    target->maskChanges = maskChanges;
+    target->maskChangesOffsets = maskChangesOffsets;
     target->availableActions = availableActions;
   }
 
@@ -283,7 +443,7 @@ public:
       return (int)history.size() - (int)other->history.size();
     for (size_t i = 0; i < history.size(); ++i)
     {
-      int cmp = history[i]->compare(other->history[i]);
+      int cmp = history[i].compare(other->history[i]);
       if (cmp != 0)
         return cmp;
     }
@@ -297,72 +457,191 @@ protected:
   bool isDisjoint;
 
   MorpionBoard board;
-  std::vector<MorpionActionPtr> history;
+  std::vector<MorpionMove> history;
+
+  std::vector<unsigned char> moveMasks; // for each point and direction (see getKey()), the legal indices in line
+  std::vector<juce::uint32> moveKeys;   // keys whose mask is not empty
+  std::vector<juce::uint32> keyPositions; // for each key whose mask is not empty, its position in moveKeys
+  std::vector<size_t> moveCounts;       // Fenwick tree of the numbers of moves of moveKeys: moveCounts[i] sums the range [i + 1 - lowestBit(i + 1), i]
+  size_t numAvailableMoves;
+
+  std::vector< std::pair<juce::uint32, unsigned char> > maskChanges; // previous values of the masks changed by the moves of history
+  std::vector<size_t> maskChangesOffsets;                             // for each move of history, its first entry in maskChanges
 
-  DiscreteDomainPtr availableActions;
+  mutable DiscreteDomainPtr availableActions; // built on demand by getActionDomain()
 
-  void addLineOnBoard(const MorpionActionPtr& action)
+  juce::uint32 getKey(const MorpionPoint& point, const MorpionDirection& direction) const
+    {return (juce::uint32)((point.getY() * board.getWidth() + point.getX()) * 4 + (MorpionDirection::Direction)direction);}
+
+  MorpionMove makeMove(juce::uint32 key, size_t indexInLine) const
   {
-#ifdef JUCE_DEBUG
-    bool ok = false;
-    for (size_t i = 0; i < availableActions->getNumElements(); ++i)
-      if (availableActions->getElement(i)->compare(action) == 0)
-        ok = true;
-    jassert(ok);
-#endif // JUCE_DEBUG
-        
-    int x = action->getPosition().getX();
-    int y = action->getPosition().getY();
+    size_t cell = key / 4;
+    MorpionPoint position((int)(cell % board.getWidth()), (int)(cell / board.getWidth()));
+    return MorpionMove(position, (MorpionDirection::Direction)(key % 4), indexInLine);
+  }
+
+  static size_t countBits(unsigned char mask)
+  {
+    size_t res = 0;
+    for (; mask; mask &= mask - 1)
+      ++res;
+    return res;
+  }
+
+  static size_t lowestBit(size_t value)
+    {return value & (~value + 1);}
+
+  static size_t highestPowerOfTwo(size_t value)
+  {
+    size_t res = 1;
+    while (res * 2 <= value)
+      res *= 2;
+    return value ? res : 0;
+  }
+
+  bool replayMoves(const std::vector<MorpionMove>& moves)
+  {
+    board.clear();
+    board.initialize(crossLength);
+    history.clear();
+    initializeMoveMasks();
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+      if (!isMoveAvailable(moves[i]))
+        return false;
+      performMove(moves[i]);
+    }
+    return true;
+  }
+
+  void addLineOnBoard(const MorpionMove& move)
+  {
+    int x = move.getPosition().getX();
+    int y = move.getPosition().getY();
     jassert(!board.isOccupied(x, y));
     board.markAsOccupied(x, y);
    
-    MorpionPoint position = action->getStartPosition();
+    MorpionPoint position = move.getStartPosition();
     for (size_t i = 0; i < crossLength - 1; ++i)
     {
-      jassert(!board.hasSegment(position, action->getDirection()));
-      board.addSegment(position, action->getDirection());
-      position.incrementIntoDirection(action->getDirection());
+      jassert(!board.hasSegment(position, move.getDirection()));
+      board.addSegment(position, move.getDirection());
+      position.incrementIntoDirection(move.getDirection());
     }
   }
 
-  void removeLineFromBoard(const MorpionActionPtr& action)
+  void removeLineFromBoard(const MorpionMove& move)
   {
-    MorpionPoint position = action->getStartPosition();
+    MorpionPoint position = move.getStartPosition();
     for (size_t i = 0; i < crossLength - 1; ++i)
     {
-      board.removeSegment(position, action->getDirection());
-      position.incrementIntoDirection(action->getDirection());
+      board.removeSegment(position, move.getDirection());
+      position.incrementIntoDirection(move.getDirection());
     }
-    board.markAsOccupied(action->getPosition(), false);
+    board.markAsOccupied(move.getPosition(), false);
   }
 
-  void updateAvailableActions()
+  /*
+  ** Legal moves
+  */
+  void initializeMoveMasks()
   {
-    //if (!availableActions)
-      availableActions = new DiscreteDomain();
-   // else
-   //   availableActions->clear();
+    moveMasks.clear();
+    moveMasks.resize(board.getWidth() * board.getHeight() * 4, 0);
+    moveKeys.clear();
+    keyPositions.clear();
+    keyPositions.resize(moveMasks.size(), 0);
+    moveCounts.clear();
+    numAvailableMoves = 0;
+    maskChanges.clear();
+    maskChangesOffsets.clear();
+    availableActions = DiscreteDomainPtr();
+
     int minX, minY, maxX, maxY;
     board.getXYRange(minX, minY, maxX, maxY);
     for (int x = minX; x <= maxX; ++x)
       for (int y = minY; y <= maxY; ++y)
-          if (!board.isOccupied(x, y) && board.isNeighbor(x, y))     
-            addActionsWithPosition(MorpionPoint(x, y)); // if it can form a line
+        if (board.isInside(x, y))
+          for (size_t dir = MorpionDirection::NE; dir <= MorpionDirection::S; ++dir)
+          {
+            MorpionPoint point(x, y);
+            MorpionDirection direction((MorpionDirection::Direction)dir);
+            setMoveMask(getKey(point, direction), computeMoveMask(point, direction), false);
+          }
   }
 
-  void addActionsWithPosition(const MorpionPoint& position) const
+  // recomputes the masks that may have been changed by the move
+  void updateMoveMasks(const MorpionMove& move)
   {
     for (size_t dir = MorpionDirection::NE; dir <= MorpionDirection::S; ++dir)
     {
       MorpionDirection direction((MorpionDirection::Direction)dir);
-      if (board.isOccupied(position.moveIntoDirection(direction, 1)) || // fast check to discard directions
-          board.isOccupied(position.moveIntoDirection(direction, -1)))
-        addActionsWithPositionAndDirection(position, direction);
+      // the lines through the new point are in range [-crossLength+1, crossLength-1], the lines that
+      // may touch the new segments are in range [-2 crossLength, 2 crossLength]
+      int range = (direction == move.getDirection() ? 2 : 1) * (int)crossLength;
+      for (int delta = -range; delta <= range; ++delta)
+      {
+        MorpionPoint point = move.getPosition().moveIntoDirection(direction, delta);
+        if (board.isInside(point.getX(), point.getY()))
+          setMoveMask(getKey(point, direction), computeMoveMask(point, direction), true);
+      }
     }
   }
 
-  void addActionsWithPositionAndDirection(const MorpionPoint& point, const MorpionDirection& direction) const
+  void setMoveMask(juce::uint32 key, unsigned char mask, bool recordChange)
   {
+    unsigned char previousMask = moveMasks[key];
+    if (mask == previousMask)
+      return;
+    if (recordChange)
+      maskChanges.push_back(std::make_pair(key, previousMask));
+    size_t count = countBits(mask);
+    size_t previousCount = countBits(previousMask);
+    numAvailableMoves = numAvailableMoves + count - previousCount;
+    moveMasks[key] = mask;
+    if (!previousMask)
+    {
+      // appending to a Fenwick tree: the new node also sums the previous positions of its range
+      size_t position = moveKeys.size();
+      keyPositions[key] = (juce::uint32)position;
+      moveKeys.push_back(key);
+      size_t sum = count;
+      for (size_t i = position; i > position + 1 - lowestBit(position + 1); i -= lowestBit(i))
+        sum += moveCounts[i - 1];
+      moveCounts.push_back(sum);
+    }
+    else if (!mask)
+    {
+      // the last key is moved into the freed position, then the last position is removed
+      size_t position = keyPositions[key];
+      size_t last = moveKeys.size() - 1;
+      if (position != last)
+      {
+        juce::uint32 lastKey = moveKeys[last];
+        addToMoveCount(position, (int)countBits(moveMasks[lastKey]) - (int)previousCount);
+        moveKeys[position] = lastKey;
+        keyPositions[lastKey] = (juce::uint32)position;
+      }
+      moveKeys.pop_back();
+      moveCounts.pop_back();
+    }
+    else
+      addToMoveCount(keyPositions[key], (int)count - (int)previousCount);
+  }
+
+  void addToMoveCount(size_t position, int delta)
+  {
+    for (size_t i = position; i < moveCounts.size(); i += lowestBit(i + 1))
+      moveCounts[i] += delta;
+  }
+
+  unsigned char computeMoveMask(const MorpionPoint& point, const MorpionDirection& direction) const
+  {
+    if (board.isOccupied(point) ||
+        (!board.isOccupied(point.moveIntoDirection(direction, 1)) && // fast check to discard directions
+         !board.isOccupied(point.moveIntoDirection(direction, -1))))
+      return 0;
+
     MorpionPoint previousPt;
     int delta;
    
@@ -411,159 +690,14 @@ protected:
     // compute minIndexInLine and maxIndexInLine
     int minDelta = juce::jmax(lowestPoint, lowestSegment);
     int maxDelta = juce::jmin(highestPoint, highestSegment);
-    int maxIndexInLine = juce::jmin(crossLength - 1, -minDelta);
-    int minIndexInLine = juce::jmax(0, crossLength - 1 - maxDelta);
-    
-    if (minIndexInLine > maxIndexInLine)
-      return;
-    else if (minIndexInLine == maxIndexInLine)
-      availableActions->addElement(new MorpionAction(point, direction, maxIndexInLine, maxIndexInLine));
-    else
-    {
-       for (int indexInLine = minIndexInLine; indexInLine <= maxIndexInLine; ++indexInLine)
-         availableActions->addElement(new MorpionAction(point, direction, indexInLine, indexInLine));
-#if 0
-      /*std::cout << "Lowest Point: " << lowestPoint << " Segment: " << lowestSegment
-              << ", Highest Point: " << highestPoint << " Segment: " << highestSegment
-              << ", Indices: " << minIndexInLine << " -- " << maxIndexInLine << std::endl;*/
-      //std::cout << "Penalties: ";
-      std::vector<size_t> penalties(maxIndexInLine - minIndexInLine + 1);
-      size_t bestPenalty = (size_t)-1;
-      int bestIndexInLine = 0;
-      int minDistance = (int)crossLength + (isDisjoint ? 1 : -1);
-      for (int indexInLine = minIndexInLine; indexInLine <= maxIndexInLine; ++indexInLine)
-      {
-        int firstPoint = -indexInLine;
-        int lastPoint = firstPoint + (int)crossLength - 1;
-        //std::cout << lowestSegment << " " << firstPoint << " " << lastPoint << " " << highestSegment << std::endl;
-        int distanceFromLowestSegment = firstPoint - lowestSegment;
-        int distanceFromHighestSegment = highestSegment - lastPoint;
-        jassert(distanceFromLowestSegment >= 0 && distanceFromHighestSegment >= 0);
-        
-        size_t penalty = (distanceFromLowestSegment < minDistance ? distanceFromLowestSegment : 0) +
-                          (distanceFromHighestSegment < minDistance ? distanceFromHighestSegment : 0);
-        //std::cout << penalty << std::flush;
-        penalties[indexInLine - minIndexInLine] = penalty;
-        if (penalty < bestPenalty)
-          bestPenalty = penalty, bestIndexInLine = indexInLine;
-      }
-      //std::cout << std::endl;
-      for (int indexInLine = minIndexInLine; indexInLine <= maxIndexInLine; ++indexInLine)
-      {
-        size_t requestedIndexInLine = (size_t)indexInLine;
-        size_t obtainedIndexInLine = requestedIndexInLine;
-
-        // change the index in line if the action is dominated
-        if (penalties[indexInLine - minIndexInLine] > bestPenalty)
-        {
-          size_t nearestIndexDistance = crossLength;
-          for (int indexInLine2 = minIndexInLine; indexInLine2 <= maxIndexInLine; ++indexInLine2)
-            if (penalties[indexInLine2 - minIndexInLine] == bestPenalty)
-            {
-              size_t distance = (size_t)abs(indexInLine2 - indexInLine);
-              if (distance < nearestIndexDistance)
-                nearestIndexDistance = distance, obtainedIndexInLine = (size_t)indexInLine2;
-            }
-        }
-        availableActions->append(MorpionAction(point, direction, requestedIndexInLine, obtainedIndexInLine));
-      }
-#endif // 0
-    }
-  }
-
-#if 0
-  OVectorPtr computeAvailableActionsReference() const
-  {
-		OVectorPtr res = new OVector(morpionActionClass, 0);
-    int minSizeX, maxSizeX, minSizeY, maxSizeY;
-    board.getXRange(minSizeX, maxSizeX);
-    board.getYRange(minSizeY, maxSizeY);
-    for (int x = minSizeX - 1; x <= maxSizeX + 1; ++x)
-      for (int y = minSizeY - 1; y <= maxSizeY + 1; ++y)
-          if (!board.isOccupied(x,y))        
-            exhaustiveList(x,y, res); // if it can form a line
-    return res;    
-  }
-
-  void exhaustiveList(int x, int y, OVectorPtr res) const
-  {
-    MorpionPoint position(x, y);
-    
-    for (size_t dir = 0; dir < 4; ++dir)
-    { 
-      MorpionDirection direction((MorpionDirection::Direction)dir);
-      
-      if (!board.isOccupied(position.moveIntoDirection(direction, 1)) &&
-          !board.isOccupied(position.moveIntoDirection(direction, -1)))
-        continue;
-      
-      // there are 5 different index lines
-      for (size_t index=0;index<crossLength;++index)
-      {
-        // look if it is a possible move
-        MorpionAction action(position, direction, index);
-        jassert(ensureDiscontinuity(action) == ensureDiscontinuity2(action));
-        if (ensureDiscontinuity(action))
-        {
-          bool isValid = true;
-          MorpionPoint otherPosition = action.getStartPosition();
-          for (size_t i = 0; i < crossLength; ++i)
-          {
-            if (i != index && !board.isOccupied(otherPosition))
-            {
-              isValid = false;
-              break;
-            }
-            otherPosition.incrementIntoDirection(direction);
-          }
-            
-          if (isValid)
-            res->append(new MorpionAction(position, direction, index, index));
-        }
-      }
-    }
-  }
-
-  static int project(const MorpionPoint& point, const MorpionDirection& direction)
-    {return point.getX() * direction.getDx() + point.getY() * direction.getDy();}
-
-  static int projectOrtho(const MorpionPoint& point, const MorpionDirection& direction)
-    {return point.getX() * direction.getDy() - point.getY() * direction.getDx();}
-
-  bool ensureDiscontinuity(const MorpionAction& action) const
-  {
-    MorpionDirection dir = action.getDirection();
-    int a = project(action.getStartPosition(), dir);
-    int b = project(action.getEndPosition(crossLength), dir);
-    int o = projectOrtho(action.getPosition(), dir);
+    int maxIndexInLine = juce::jmin((int)crossLength - 1, -minDelta);
+    int minIndexInLine = juce::jmax(0, (int)crossLength - 1 - maxDelta);
     
-    jassert(a < b);
-
-    for (size_t line = 0; line < history.size(); ++line)
-      if (history[line]->getDirection() == dir && o == projectOrtho(history[line]->getPosition(), dir)) // quick check-up
-      {
-        int c = project(history[line]->getStartPosition(), dir);
-        int d = project(history[line]->getEndPosition(crossLength), dir);
-        jassert(c < d);
-        
-        bool ok = c > b || d < a;
-        if (!ok)
-          return false;
-      }
-    return true;
-  }
-  
-  bool ensureDiscontinuity2(const MorpionAction& action) const
-  {
-    for (size_t line = 0; line < history.size(); ++line)
-      if (history[line]->getDirection() == action.getDirection())
-        for(size_t check=0;check<crossLength;++check) // the 5 points of the existing line
-          for(size_t newLine=0;newLine<crossLength;++newLine) // the 5 points of the new line
-            if(history[line]->getLinePoint(check)==action.getLinePoint(newLine))
-                return false;
-    return true;
+    unsigned char res = 0;
+    for (int indexInLine = minIndexInLine; indexInLine <= maxIndexInLine; ++indexInLine)
+      res |= (unsigned char)(1 << indexInLine);
+    return res;
   }
-#endif // 0
 };
 
 extern ClassPtr morpionStateClass;
@@ -640,14 +774,14 @@ public:
     int boardPixelsY = (edgePixels + getHeight() - boardPixelsHeight) / 2;
 
     // paint lines
-    const std::vector<MorpionActionPtr>& history = state->getHistory();
+    const std::vector<MorpionMove>& history = state->getHistory();
     g.setColour(juce::Colours::grey);
     for (size_t i = 0; i < history.size(); ++i)
     {
-      MorpionPoint startPosition = history[i]->getStartPosition();
+      MorpionPoint startPosition = history[i].getStartPosition();
       int sx = boardPixelsX + (startPosition.getX() - xMin) * edgePixels;
       int sy = boardPixelsY + (startPosition.getY() - yMin) * edgePixels;
-      MorpionPoint endPosition = history[i]->getEndPosition(state->getCrossLength());
+      MorpionPoint endPosition = history[i].getEndPosition(state->getCrossLength());
       int ex = boardPixelsX + (endPosition.getX() - xMin) * edgePixels;
       int ey = boardPixelsY + (endPosition.getY() - yMin) * edgePixels;
       paintLine(g, sx, sy, ex, ey, edgePixels);
@@ -669,7 +803,7 @@ public:
     // paint actions
     for (size_t i = 0; i < history.size(); ++i)
     {
-      MorpionPoint position = history[i]->getPosition();
+      MorpionPoint position = history[i].getPosition();
       int px = boardPixelsX + (position.getX() - xMin) * edgePixels;
       int py = boardPixelsY + (position.getY() - yMin) * edgePixels;
       paintAction(g, i, px, py, edgePixels);
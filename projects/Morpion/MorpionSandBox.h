@@ -98,6 +98,199 @@ public:
   }
 };
 
+/*
+** Measures how the parallel NRPA solvers scale with the number of workers (1, 2, 4, ..., maxNumWorkers).
+** Each configuration makes the same numRuns runs of numEvaluations evaluations, and reports its mean
+** score, its evaluations per second and its speed-up with respect to one worker.
+** The beam NRPA is run with a beam of maxNumWorkers elements, with sequential and parallel sub-searches.
+*/
+class MorpionNRPAScalingBenchmark : public WorkUnit
+{
+public:
+  MorpionNRPAScalingBenchmark() : crossLength(5), isDisjoint(true), level(2), numIterationsPerLevel(20), synchronisationPeriod(1), numEvaluations(10000), numRuns(3), maxNumWorkers(8) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    ProblemPtr problem = new MorpionProblem(crossLength, isDisjoint);
+    SamplerPtr sampler = logLinearActionCodeSearchSampler(new MorpionActionCodeGenerator(), 0.1, 1.0);
+
+    std::vector<size_t> numWorkers;
+    for (size_t n = 1; n < maxNumWorkers; n *= 2)
+      numWorkers.push_back(n);
+    numWorkers.push_back(juce::jmax(1, (int)maxNumWorkers));
+
+    for (size_t leafParallelism = 0; leafParallelism <= 1; ++leafParallelism)
+    {
+      context.enterScope(leafParallelism ? "Leaf parallel NRPA" : "Root parallel NRPA");
+      double referenceTime = 0.0;
+      for (size_t i = 0; i < numWorkers.size(); ++i)
+      {
+        SolverPtr solver = parallelNRPASolver(sampler, level, numIterationsPerLevel, numWorkers[i], synchronisationPeriod, leafParallelism != 0);
+        double time = runSolver(context, string((int)numWorkers[i]) + " workers", problem, solver, numWorkers[i], referenceTime);
+        if (i == 0)
+          referenceTime = time;
+      }
+      context.leaveScope();
+    }
+
+    context.enterScope("Beam NRPA");
+    double referenceTime = runSolver(context, "Sequential", problem, repeatSolver(beamNRPASolver(sampler, level, numIterationsPerLevel, maxNumWorkers, 1, false)), 1, 0.0);
+    runSolver(context, "Parallel", problem, repeatSolver(beamNRPASolver(sampler, level, numIterationsPerLevel, maxNumWorkers, 1, true)), maxNumWorkers, referenceTime);
+    context.leaveScope();
+    return ObjectPtr();
+  }
+
+protected:
+  friend class MorpionNRPAScalingBenchmarkClass;
+
+  size_t crossLength;
+  bool isDisjoint;
+  size_t level;
+  size_t numIterationsPerLevel;
+  size_t synchronisationPeriod;
+  size_t numEvaluations;
+  size_t numRuns;
+  size_t maxNumWorkers;
+
+  // returns the mean time of a run
+  double runSolver(ExecutionContext& context, const string& name, ProblemPtr problem, SolverPtr solver, size_t numWorkers, double referenceTime)
+  {
+    context.enterScope(name);
+    RandomGeneratorPtr previousRandom = context.getRandomGenerator();
+    ScalarVariableStatisticsPtr scores = new ScalarVariableStatistics("score");
+    double time = 0.0;
+    for (size_t run = 0; run < numRuns; ++run)
+    {
+      context.setRandomGenerator(new RandomGenerator((juce::uint32)run + 1)); // the same runs for all the configurations
+      FitnessPtr bestFitness;
+      SolverCallbackPtr callback = compositeSolverCallback(storeBestFitnessSolverCallback(bestFitness), maxEvaluationsSolverCallback(numEvaluations));
+      double startTime = juce::Time::getMillisecondCounterHiRes();
+      solver->solve(context, problem, callback);
+      time += (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+      if (bestFitness)
+        scores->push(bestFitness->getValue(0));
+    }
+    context.setRandomGenerator(previousRandom);
+    time /= numRuns ? numRuns : 1;
+
+    context.resultCallback("numWorkers", numWorkers);
+    context.resultCallback("score", scores->getMean());
+    context.resultCallback("time", time);
+    context.resultCallback("evaluationsPerSecond", time > 0.0 ? numEvaluations / time : 0.0);
+    if (referenceTime > 0.0)
+      context.resultCallback("speedUp", time > 0.0 ? referenceTime / time : 0.0);
+    context.leaveScope(scores);
+    return time;
+  }
+};
+
+/*
+** Plays random sequences of moves and undos on a Morpion state, and checks after each of them that
+** the incrementally maintained legal moves match a recomputation from the board, and that
+** getAvailableMove() enumerates each legal move once.
+*/
+class MorpionStateCheck : public WorkUnit
+{
+public:
+  MorpionStateCheck() : crossLength(5), isDisjoint(false), numGames(20) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    size_t numErrors = 0;
+    size_t numOperations = 0;
+    for (size_t game = 0; game < numGames; ++game)
+    {
+      MorpionStatePtr state = new MorpionState(crossLength, isDisjoint);
+      // moves are more frequent than undos, so that the games go until the end
+      while (state->getNumAvailableMoves())
+      {
+        if (state->getHistory().size() && random->sampleBool(0.3))
+          state->undoMove();
+        else
+          state->performMove(state->getAvailableMove(random->sampleSize(state->getNumAvailableMoves())));
+        ++numOperations;
+        if (!checkState(state))
+          ++numErrors;
+      }
+      while (state->getHistory().size())
+      {
+        state->undoMove();
+        ++numOperations;
+        if (!checkState(state))
+          ++numErrors;
+      }
+    }
+
+    context.resultCallback(T("numOperations"), numOperations);
+    context.resultCallback(T("numErrors"), numErrors);
+    if (numErrors)
+      context.errorCallback(string((int)numErrors) + T(" inconsistent states"));
+    else
+      context.informationCallback(T("All states are consistent"));
+    return Boolean::create(numErrors == 0);
+  }
+
+protected:
+  friend class MorpionStateCheckClass;
+
+  size_t crossLength;
+  bool isDisjoint;
+  size_t numGames;
+
+  static bool checkState(const MorpionStatePtr& state)
+  {
+    if (!state->checkMoveMasks())
+      return false;
+    std::set<string> moves;
+    for (size_t i = 0; i < state->getNumAvailableMoves(); ++i)
+    {
+      MorpionMove move = state->getAvailableMove(i);
+      if (!state->isMoveAvailable(move) || !moves.insert(move.toString()).second)
+        return false;
+    }
+    return true;
+  }
+};
+
+/*
+** Measures the number of random playouts per second from the initial Morpion state, with the
+** allocation-free interface of MorpionState, as in the NRPA rollouts.
+*/
+class MorpionPlayoutBenchmark : public WorkUnit
+{
+public:
+  MorpionPlayoutBenchmark() : crossLength(5), isDisjoint(false), numPlayouts(10000) {}
+
+  virtual ObjectPtr run(ExecutionContext& context)
+  {
+    RandomGeneratorPtr random = context.getRandomGenerator();
+    MorpionStatePtr state = new MorpionState(crossLength, isDisjoint);
+    ScalarVariableStatisticsPtr lengths = new ScalarVariableStatistics("length");
+    double startTime = juce::Time::getMillisecondCounterHiRes();
+    for (size_t i = 0; i < numPlayouts; ++i)
+    {
+      size_t length = state->playRandomMoves(random);
+      lengths->push((double)length);
+      for (size_t j = 0; j < length; ++j)
+        state->undoMove();
+    }
+    double time = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    context.resultCallback(T("time"), time);
+    context.resultCallback(T("playoutsPerSecond"), time > 0.0 ? numPlayouts / time : 0.0);
+    context.resultCallback(T("movesPerSecond"), time > 0.0 ? lengths->getSum() / time : 0.0);
+    return lengths;
+  }
+
+protected:
+  friend class MorpionPlayoutBenchmarkClass;
+
+  size_t crossLength;
+  bool isDisjoint;
+  size_t numPlayouts;
+};
+
 }; /* namespace lbcpp */
 
 #endif // !MORPION_SANDBOX_H_